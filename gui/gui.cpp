@@ -85,6 +85,7 @@ void Plus4EmuGUI::init_()
   browseFileStatus = 1;
   browseFileWindow = (Fl_Native_File_Chooser *) 0;
   windowToShow = (Fl_Window *) 0;
+  prvProcessCPUTime = Plus4Emu::Timer::getProcessCPUTime();
   diskConfigWindow = (Plus4EmuGUI_DiskConfigWindow *) 0;
   displaySettingsWindow = (Plus4EmuGUI_DisplayConfigWindow *) 0;
   keyboardConfigWindow = (Plus4EmuGUI_KbdConfigWindow *) 0;
@@ -129,11 +130,12 @@ void Plus4EmuGUI::init_()
 void Plus4EmuGUI::updateDisplay_windowTitle()
 {
   if (oldPauseFlag) {
-    std::sprintf(&(windowTitleBuf[0]), "plus4emu 1.2.11 (paused)");
+    std::sprintf(&(windowTitleBuf[0]), "plus4emu 1.2.11 (paused)%s",
+                 perfCountersText.c_str());
   }
   else {
-    std::sprintf(&(windowTitleBuf[0]), "plus4emu 1.2.11 (%d%%)",
-                 int(oldSpeedPercentage));
+    std::sprintf(&(windowTitleBuf[0]), "plus4emu 1.2.11 (%d%%)%s",
+                 int(oldSpeedPercentage), perfCountersText.c_str());
   }
   mainWindow->label(&(windowTitleBuf[0]));
 }
@@ -309,6 +311,8 @@ void Plus4EmuGUI::updateDisplay(double t)
   }
   if (flDisplay->haveFramesPending())
     t = t * 0.5;
+  else if (oldPauseFlag)
+    t = t * 4.0;        // nothing to update while paused
   if (updateDisplayEntered) {
     // if re-entering this function:
     Fl::wait(t);
@@ -432,9 +436,54 @@ void Plus4EmuGUI::updateDisplay(double t)
   }
   if (printerWindow->window->shown())
     printerWindow->updateWindow(vmThreadStatus);
-  if (statsTimer.getRealTime() >= 0.25) {
+  double  statsTime = statsTimer.getRealTime();
+  if (statsTime >= 0.25) {
     statsTimer.reset();
     int32_t newSpeedPercentage = int32_t(vmThreadStatus.speedPercentage + 0.5f);
+#ifdef ENABLE_PERF_COUNTERS
+    {
+      // show the time spent per frame (in milliseconds) by each subsystem
+      const Plus4Emu::VirtualMachine::PerformanceCounters&  p =
+          vmThreadStatus.perfCounters;
+      char    tmpBuf[160];
+      tmpBuf[0] = '\0';
+      if (p.frameCount > 0U) {
+        std::sprintf(&(tmpBuf[0]),
+                     " TED:%.2f SID:%.2f FD:%.2f PR:%.2f VC:%.2f AU:%.2f "
+                     "DSP:%.2f",
+                     p.tedTime * 0.001, p.sidTime * 0.001,
+                     p.floppyDriveTime * 0.001, p.printerTime * 0.001,
+                     p.videoCaptureTime * 0.001, p.audioOutputTime * 0.001,
+                     p.displayTime * 0.001);
+      }
+      // audio output and input to display latency in milliseconds
+      if (vmThreadStatus.audioLatency > 0.0f) {
+        std::sprintf(&(tmpBuf[std::strlen(&(tmpBuf[0]))]),
+                     " AL:%.0f/%.0f",
+                     double(vmThreadStatus.audioLatency) * 1000.0,
+                     double(vmThreadStatus.audioLatencyMax) * 1000.0);
+      }
+      double  inputLatency = 0.0;
+      double  inputLatencyMax = 0.0;
+      if (flDisplay->getInputLatencyStats(inputLatency, inputLatencyMax)) {
+        // keep the last values until there is a new input event
+        char    tmpBuf2[48];
+        std::sprintf(&(tmpBuf2[0]), " IL:%.0f/%.0f",
+                     inputLatency * 1000.0, inputLatencyMax * 1000.0);
+        inputLatencyText = &(tmpBuf2[0]);
+      }
+      std::strcat(&(tmpBuf[0]), inputLatencyText.c_str());
+      // total CPU usage of the process, as a percentage of one core
+      double  cpuTime = Plus4Emu::Timer::getProcessCPUTime();
+      std::sprintf(&(tmpBuf[std::strlen(&(tmpBuf[0]))]), " CPU:%.0f%%",
+                   (cpuTime - prvProcessCPUTime) * 100.0 / statsTime);
+      prvProcessCPUTime = cpuTime;
+      if (perfCountersText != &(tmpBuf[0])) {
+        perfCountersText = &(tmpBuf[0]);
+        oldSpeedPercentage = -1;
+      }
+    }
+#endif
     if (newSpeedPercentage != oldSpeedPercentage) {
       oldSpeedPercentage = newSpeedPercentage;
       updateDisplay_windowTitle();
@@ -473,6 +522,8 @@ void Plus4EmuGUI::errorMessage(const char *msg)
     errorMessageText->label("");
   errorMessageWindow->set_modal();
   windowToShow = errorMessageWindow;
+  // wake up the main thread if it is waiting for events
+  Fl::awake();
   while (true) {
     Fl::unlock();
     try {
@@ -1404,7 +1455,10 @@ void Plus4EmuGUI::applyEmulatorConfiguration(bool updateWindowFlag_)
       bool    updateMenuFlag_ =
           config.soundSettingsChanged | config.vmProcessPriorityChanged;
       config.applySettings();
+      // the timer is not needed if the audio output is the clock master;
+      // with display sync, it still limits the speed to 100%
       vmThread.setSpeedPercentage(config.vm.speedPercentage == 100U &&
+                                  config.vm.syncMode == 0 &&
                                   config.sound.enabled ?
                                   0 : int(config.vm.speedPercentage));
       if (config.joystickSettingsChanged) {
@@ -27,6 +27,7 @@
 #include "ted.hpp"
 #include "vm.hpp"
 #include "plus4vm.hpp"
+#include "prgcache.hpp"
 
 #include <typeinfo>
 
@@ -501,6 +502,49 @@ extern "C" PLUS4EMU_EXPORT void Plus4VM_SetEnableACIAEmulation(
   vm->getVM().setEnableACIAEmulation(bool(isEnabled));
 }
 
+extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SetACIAHostPort(
+    Plus4VM *vm, int type, const char *name, const char *outFileName)
+{
+  try {
+    vm->getVM().setACIAHostPort(type,
+                                std::string(name ? name : ""),
+                                std::string(outFileName ? outFileName : ""));
+  }
+  catch (std::exception& e) {
+    vm->setLastErrorMessage(e.what());
+    if (typeid(e) == typeid(std::bad_alloc))
+      return PLUS4EMU_BAD_ALLOC;
+    return PLUS4EMU_ERROR;
+  }
+  return PLUS4EMU_SUCCESS;
+}
+
+extern "C" PLUS4EMU_EXPORT long Plus4VM_GetACIAHostPortName(
+    Plus4VM *vm, char *buf, size_t bufSize)
+{
+  size_t  len = 0;
+  try {
+    std::string s = vm->getVM().getACIAHostPortName();
+    len = s.length();
+    size_t  i = 0;
+    while (i < len && (i + 1) < bufSize) {
+      buf[i] = s[i];
+      i++;
+    }
+    if (i < bufSize)
+      buf[i] = '\0';
+  }
+  catch (std::exception& e) {
+    if (bufSize > 0)
+      buf[0] = '\0';
+    vm->setLastErrorMessage(e.what());
+    if (typeid(e) == typeid(std::bad_alloc))
+      return long(PLUS4EMU_BAD_ALLOC);
+    return long(PLUS4EMU_ERROR);
+  }
+  return long(len);
+}
+
 extern "C" PLUS4EMU_EXPORT void Plus4VM_SetSIDConfiguration(
     Plus4VM *vm, int sidFlags, int enableDigiBlaster, int outputVolume)
 {
@@ -594,6 +638,21 @@ extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_PasteText(
   return PLUS4EMU_SUCCESS;
 }
 
+extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_TypeText(
+    Plus4VM *vm, const char *s, int tokenizeBASIC)
+{
+  try {
+    vm->getVM().typeText(s, (tokenizeBASIC != 0));
+  }
+  catch (std::exception& e) {
+    vm->setLastErrorMessage(e.what());
+    if (typeid(e) == typeid(std::bad_alloc))
+      return PLUS4EMU_BAD_ALLOC;
+    return PLUS4EMU_ERROR;
+  }
+  return PLUS4EMU_SUCCESS;
+}
+
 extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SetPrinterType(
     Plus4VM *vm, int n)
 {
@@ -613,8 +672,7 @@ extern "C" PLUS4EMU_EXPORT int Plus4VM_GetPrinterPageWidth(Plus4VM *vm)
 {
   int     w = 0;
   int     h = 0;
-  const uint8_t *buf = (uint8_t *) 0;
-  vm->getVM().getPrinterOutput(buf, w, h);
+  vm->getVM().getPrinterPageSize(w, h);
   return w;
 }
 
@@ -622,8 +680,7 @@ extern "C" PLUS4EMU_EXPORT int Plus4VM_GetPrinterPageHeight(Plus4VM *vm)
 {
   int     w = 0;
   int     h = 0;
-  const uint8_t *buf = (uint8_t *) 0;
-  vm->getVM().getPrinterOutput(buf, w, h);
+  vm->getVM().getPrinterPageSize(w, h);
   return h;
 }
 
@@ -632,7 +689,7 @@ extern "C" PLUS4EMU_EXPORT const uint8_t * Plus4VM_GetPrinterOutput(Plus4VM *vm)
   int     w = 0;
   int     h = 0;
   const uint8_t *buf = (uint8_t *) 0;
-  vm->getVM().getPrinterOutput(buf, w, h);
+  vm->getVM().getPrinterOutput(buf, w, h, 0, 0x7FFFFFFF);
   return buf;
 }
 
@@ -692,6 +749,21 @@ extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SetPrinterOutputFile(
   return PLUS4EMU_SUCCESS;
 }
 
+extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SetPrinterPageOutputFile(
+    Plus4VM *vm, const char *fileName)
+{
+  try {
+    vm->getVM().setPrinterPageOutputFile(fileName);
+  }
+  catch (std::exception& e) {
+    vm->setLastErrorMessage(e.what());
+    if (typeid(e) == typeid(std::bad_alloc))
+      return PLUS4EMU_BAD_ALLOC;
+    return PLUS4EMU_ERROR;
+  }
+  return PLUS4EMU_SUCCESS;
+}
+
 extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_GetStatus(
     Plus4VM *vm, Plus4VM_Status *vmStatus)
 {
@@ -1270,6 +1342,36 @@ extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_LoadProgram(
   return PLUS4EMU_SUCCESS;
 }
 
+extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_LoadProgramCached(
+    Plus4VM *vm, const char *fileName)
+{
+  try {
+    vm->getVM().loadProgramCached(fileName);
+  }
+  catch (std::exception& e) {
+    vm->setLastErrorMessage(e.what());
+    if (typeid(e) == typeid(std::bad_alloc))
+      return PLUS4EMU_BAD_ALLOC;
+    return PLUS4EMU_ERROR;
+  }
+  return PLUS4EMU_SUCCESS;
+}
+
+extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_InjectProgram(
+    Plus4VM *vm, const uint8_t *buf, size_t nBytes)
+{
+  try {
+    vm->getVM().injectProgram(buf, nBytes);
+  }
+  catch (std::exception& e) {
+    vm->setLastErrorMessage(e.what());
+    if (typeid(e) == typeid(std::bad_alloc))
+      return PLUS4EMU_BAD_ALLOC;
+    return PLUS4EMU_ERROR;
+  }
+  return PLUS4EMU_SUCCESS;
+}
+
 extern "C" PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_RecordDemo(
     Plus4VM *vm, const char *fileName)
 {
@@ -1352,6 +1454,48 @@ extern "C" PLUS4EMU_EXPORT int Plus4VM_GetIsPlayingDemo(Plus4VM *vm)
   return int(vm->getVM().getIsPlayingDemo());
 }
 
+extern "C" PLUS4EMU_EXPORT void Plus4VM_GetPerformanceCounters(
+    Plus4VM *vm, Plus4_PerformanceCounters *p)
+{
+  Plus4Emu::VirtualMachine::PerformanceCounters tmp;
+  vm->getVM().getPerformanceCounters(tmp);
+  p->totalTime = tmp.totalTime;
+  p->tedTime = tmp.tedTime;
+  p->sidTime = tmp.sidTime;
+  p->floppyDriveTime = tmp.floppyDriveTime;
+  p->printerTime = tmp.printerTime;
+  p->videoCaptureTime = tmp.videoCaptureTime;
+  p->audioOutputTime = tmp.audioOutputTime;
+  p->displayTime = tmp.displayTime;
+  p->tapeTime = tmp.tapeTime;
+  p->frameCount = tmp.frameCount;
+}
+
+extern "C" PLUS4EMU_EXPORT void Plus4VM_ResetPerformanceCounters(Plus4VM *vm)
+{
+  vm->getVM().resetPerformanceCounters();
+}
+
+// ----------------------------------------------------------------------------
+
+extern "C" PLUS4EMU_EXPORT int Plus4_LoadProgramList(const char *fileName)
+{
+  try {
+    return int(Plus4::ProgramCache::getInstance().loadManifest(fileName));
+  }
+  catch (std::bad_alloc&) {
+    return int(PLUS4EMU_BAD_ALLOC);
+  }
+  catch (std::exception&) {
+  }
+  return int(PLUS4EMU_ERROR);
+}
+
+extern "C" PLUS4EMU_EXPORT void Plus4_ClearProgramCache(void)
+{
+  Plus4::ProgramCache::getInstance().clear();
+}
+
 // ----------------------------------------------------------------------------
 
 extern "C" PLUS4EMU_EXPORT void Plus4_ColorToYUV(
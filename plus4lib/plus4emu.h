@@ -217,6 +217,31 @@ PLUS4EMU_EXPORT void Plus4VM_SetVideoClockFrequency(
  * Set if the 6551 ACIA should be emulated (0: no).
  */
 PLUS4EMU_EXPORT void Plus4VM_SetEnableACIAEmulation(Plus4VM *vm, int isEnabled);
+/*!
+ * Connect the emulated ACIA to a host byte stream. 'type' can be one of:
+ *   0: none (default)
+ *   1: replay received data from file 'name' (may be NULL), and write the
+ *      transmitted data to file 'outFileName' (may be NULL)
+ *   2: pseudo terminal ('name' is ignored); the name of the slave device can
+ *      be queried with Plus4VM_GetACIAHostPortName()
+ *   3: connect to the Unix domain socket 'name'
+ * Received data is buffered, and the output is written at the end of each
+ * Plus4VM_Run() call, which returns an error if reading or writing failed,
+ * or the other end of the socket has been closed. If the host does not read
+ * the output, the emulated transmitter waits instead of discarding data.
+ * Changing the host port stops any demo playback or recording.
+ */
+PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SetACIAHostPort(
+    Plus4VM *vm, int type, const char *name, const char *outFileName);
+/*!
+ * Copy the name of the device the ACIA is connected to (e.g. the slave side
+ * of the pseudo terminal) to 'buf', which is expected to have enough space for
+ * 'bufSize' characters (including the '\0' character at the end of the
+ * string). The return value is the length of the name, or a negative
+ * Plus4Emu_Error code on error.
+ */
+PLUS4EMU_EXPORT long Plus4VM_GetACIAHostPortName(
+    Plus4VM *vm, char *buf, size_t bufSize);
 /*!
  * Set SID emulation parameters. 'outputVolume' should be specified in decibels
  * (-8 to +2). 'sidFlags' can be the sum of:
@@ -277,6 +302,17 @@ PLUS4EMU_EXPORT long Plus4VM_CopyText(
  */
 PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_PasteText(
     Plus4VM *vm, const char *s, int xPos, int yPos);
+/*!
+ * Type the text from 's' on the keyboard of the emulated machine, running the
+ * emulation until all characters are read by the editor. The keyboard buffer
+ * is refilled as soon as it is empty, so this is much faster than
+ * Plus4VM_PasteText(). If 'tokenizeBASIC' is non-zero, lines beginning with a
+ * line number are tokenized and stored directly in the BASIC program memory
+ * instead of being typed. Returns PLUS4EMU_ERROR if the editor does not read
+ * the input within a few seconds of emulated time.
+ */
+PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_TypeText(
+    Plus4VM *vm, const char *s, int tokenizeBASIC);
 /*!
  * Set the type of printer to be emulated:
  *   0: disable printer emulation (default)
@@ -348,6 +384,20 @@ PLUS4EMU_EXPORT void Plus4VM_SetPrinterFormFeedOn(Plus4VM *vm, int n);
  */
 PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SetPrinterOutputFile(
     Plus4VM *vm, const char *fileName, int asciiMode);
+/*!
+ * Write each completed printer page to a separate image file, with the page
+ * number inserted before the extension of 'fileName' (e.g. "print0001.png");
+ * the format is PBM if the extension is ".pbm", and PNG otherwise. A page is
+ * completed when the paper reaches the bottom margin (printing continues on a
+ * new page), or when Plus4VM_ClearPrinterOutput() is called. The files are
+ * written on a separate thread, so a large number of pages can be printed in
+ * batch mode without slowing down the emulation.
+ * If 'fileName' is NULL or empty, then the current page is written if it is
+ * not empty, and the output is closed.
+ * NOTE: printer emulation must be enabled before calling this function.
+ */
+PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SetPrinterPageOutputFile(
+    Plus4VM *vm, const char *fileName);
 /*!
  * Returns status information about the emulated machine (see also the comments
  * for functions that return individual status values).
@@ -755,6 +805,34 @@ PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_SaveProgram(
  */
 PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_LoadProgram(
     Plus4VM *vm, const char *fileName);
+/*!
+ * Load a PRG or P00 format program (or the first program from a ZIP archive)
+ * like Plus4VM_LoadProgram(), using a program cache that is shared by all
+ * virtual machines. The file is read only on the first call with the same
+ * file name, later calls copy the program data directly to RAM.
+ */
+PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_LoadProgramCached(
+    Plus4VM *vm, const char *fileName);
+/*!
+ * Load a program in PRG format (load address followed by the data) of
+ * 'nBytes' bytes from 'buf', and set BASIC pointers like
+ * Plus4VM_LoadProgram().
+ */
+PLUS4EMU_EXPORT Plus4Emu_Error Plus4VM_InjectProgram(
+    Plus4VM *vm, const uint8_t *buf, size_t nBytes);
+/*!
+ * Load all programs listed in a text file into the shared program cache.
+ * The file contains one program file name per line; relative names are
+ * interpreted from the directory of the list file, and empty lines or lines
+ * beginning with '#' are ignored. Returns the number of programs on success,
+ * or a negative Plus4Emu_Error code on error.
+ */
+PLUS4EMU_EXPORT int Plus4_LoadProgramList(const char *fileName);
+/*!
+ * Remove all programs from the shared program cache. This function must not
+ * be called while another thread is loading a program.
+ */
+PLUS4EMU_EXPORT void Plus4_ClearProgramCache(void);
 /*!
  * Save a snapshot with clock frequency and timing settings, and start demo
  * recording to memory. The output file is written only when the recording is
@@ -785,6 +863,37 @@ PLUS4EMU_EXPORT int Plus4VM_GetIsRecordingDemo(Plus4VM *vm);
  * a demo.
  */
 PLUS4EMU_EXPORT int Plus4VM_GetIsPlayingDemo(Plus4VM *vm);
+/*!
+ * Average real time (in microseconds) spent per emulated video frame in each
+ * subsystem. 'tedTime' is the time used by TED and the main CPU, calculated as
+ * the total minus all the other values. 'frameCount' is the number of frames
+ * the averages were calculated from.
+ */
+typedef struct Plus4_PerformanceCounters_ {
+  double    totalTime;
+  double    tedTime;
+  double    sidTime;
+  double    floppyDriveTime;
+  double    printerTime;
+  double    videoCaptureTime;
+  double    audioOutputTime;
+  double    displayTime;
+  double    tapeTime;
+  uint32_t  frameCount;
+} Plus4_PerformanceCounters;
+/*!
+ * Store the performance counters measured since the last call of
+ * Plus4VM_ResetPerformanceCounters() (or since the creation of 'vm') in 'p'.
+ * The counters are not reset by this function. If the library was built
+ * without performance counter support (ENABLE_PERF_COUNTERS), or no video
+ * frame has been completed yet, all values are zero.
+ */
+PLUS4EMU_EXPORT void Plus4VM_GetPerformanceCounters(
+    Plus4VM *vm, Plus4_PerformanceCounters *p);
+/*!
+ * Clear the performance counters, and start a new measurement interval.
+ */
+PLUS4EMU_EXPORT void Plus4VM_ResetPerformanceCounters(Plus4VM *vm);
 
  /* ======================================================================== */
 
@@ -454,6 +454,7 @@ namespace Plus4 {
   void Filter::set_chip_model(chip_model model)
   {
     sid_model = model;
+    Vi_prv = -0x40000000;
     /* We initialize the state variables again just to make sure that
      * the earlier model didn't leave behind some foreign, unrecoverable
      * state. Hopefully set_chip_model() only occurs simultaneously with
@@ -488,6 +489,7 @@ namespace Plus4 {
     Vhp = 0;
     Vbp = Vbp_x = Vbp_vc = 0;
     Vlp = Vlp_x = Vlp_vc = 0;
+    Vi_prv = -0x40000000;
 
     set_w0();
     set_Q();
@@ -529,6 +531,7 @@ namespace Plus4 {
   // Set filter cutoff frequency.
   void Filter::set_w0()
   {
+    Vi_prv = -0x40000000;
     model_filter_t& f = model_filter[sid_model];
     int Vw = Vw_bias + f.f0_dac[fc];
     Vddt_Vw_2 = unsigned(f.kVddt - Vw)*unsigned(f.kVddt - Vw) >> 1;
@@ -631,6 +634,7 @@ namespace Plus4 {
   */
   void Filter::set_Q()
   {
+    Vi_prv = -0x40000000;
     // Cutoff for MOS 6581.
     // The coefficient 8 is dispensed of later by right-shifting 3 times
     // (2 ^ 3 = 8).
@@ -665,6 +669,7 @@ namespace Plus4 {
   // Set input routing bits.
   void Filter::set_sum_mix()
   {
+    Vi_prv = -0x40000000;
     // NB! voice3off (mode bit 7) only affects voice 3 if it is routed directly
     // to the mixer.
     sum = (enabled ? filt : 0x00) & voice_mask;
@@ -414,6 +414,14 @@ namespace Plus4 {
     int v2;
     int v1;
 
+    // Filter input on the previous 6581 single cycle clock, or an invalid
+    // value (-0x40000000) if the state or parameters have been changed
+    // since then.
+    int Vi_prv;
+    // True if clocking the 6581 filter with an input of Vi_prv would not
+    // change its state.
+    bool fixed_point;
+
     // Cutoff frequency DAC voltage, resonance.
     int Vddt_Vw_2, Vw_bias;
     int _8_div_Q;
@@ -549,9 +557,26 @@ namespace Plus4 {
     // Calculate filter outputs.
     if (sid_model == 0) {
       // MOS 6581.
-      Vlp = solve_integrate_6581(1, Vbp, Vlp_x, Vlp_vc, f);
-      Vbp = solve_integrate_6581(1, Vhp, Vbp_x, Vbp_vc, f);
-      Vhp = f.summer[offset + f.gain[_8_div_Q][Vbp] + Vlp + Vi];
+      if (PLUS4EMU_EXPECT(Vi != Vi_prv)) {
+        Vlp = solve_integrate_6581(1, Vbp, Vlp_x, Vlp_vc, f);
+        Vbp = solve_integrate_6581(1, Vhp, Vbp_x, Vbp_vc, f);
+        Vhp = f.summer[offset + f.gain[_8_div_Q][Vbp] + Vlp + Vi];
+        Vi_prv = Vi;
+        fixed_point = false;
+      }
+      else if (!fixed_point) {
+        // After a single cycle clock, all the other state variables depend
+        // only on the capacitor charges and the input; if these have not
+        // changed, then the filter has settled at a fixed point, and the
+        // integrators can be skipped until the input changes (this is
+        // typically the case if no playing voices are routed into it).
+        int Vlp_vc_prv = Vlp_vc;
+        int Vbp_vc_prv = Vbp_vc;
+        Vlp = solve_integrate_6581(1, Vbp, Vlp_x, Vlp_vc, f);
+        Vbp = solve_integrate_6581(1, Vhp, Vbp_x, Vbp_vc, f);
+        Vhp = f.summer[offset + f.gain[_8_div_Q][Vbp] + Vlp + Vi];
+        fixed_point = (Vlp_vc == Vlp_vc_prv && Vbp_vc == Vbp_vc_prv);
+      }
     }
     else {
       // MOS 8580. FIXME: Not yet using op-amp model.
@@ -661,6 +686,7 @@ namespace Plus4 {
     // Maximum delta cycles for filter fixpoint iteration to converge
     // is approximately 3.
     cycle_count delta_t_flt = 3;
+    Vi_prv = -0x40000000;
 
     if (sid_model == 0) {
       // MOS 6581.
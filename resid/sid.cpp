@@ -364,6 +364,16 @@ namespace Plus4 {
     reinterpret_cast< SID * >(userData)->clock_fast();
   }
 
+  // --------------------------------------------------------------------------
+  // SID clocking - delta_t cycles, simplified version.
+  // --------------------------------------------------------------------------
+  void SID::clock_fast(cycle_count delta_t)
+  {
+    for ( ; delta_t > 0; delta_t--) {
+      clock_fast();
+    }
+  }
+
   // --------------------------------------------------------------------------
   // SID clocking - delta_t cycles.
   // --------------------------------------------------------------------------
@@ -43,6 +43,8 @@ namespace Plus4 {
 
     // callback function for Plus4VM, 'userData' is a pointer to "this"
     static PLUS4EMU_REGPARM1 void clockCallback(void *userData);
+    // run 'delta_t' cycles of the same emulation as clockCallback()
+    void clock_fast(cycle_count delta_t);
     PLUS4EMU_INLINE void clock();
     void clock(cycle_count delta_t);
     void reset();
@@ -28,6 +28,7 @@ static const uint32_t aciaBaudRateTable[16] = {
 namespace Plus4 {
 
   ACIA6551::ACIA6551()
+    : hostPort((ACIAHostPort *) 0)
   {
     this->reset();
   }
@@ -106,6 +107,13 @@ namespace Plus4 {
       transmitState++;
       break;
     case 23:                            // end of stop bit
+      if (hostPort && !(statusRegister & 0x10)) {
+        if (!hostPort->sendByte(transmitDataRegister & getDataBitsMask())) {
+          // the host is not reading the data: keep the transmit data
+          // register full, and try again on the next half bit
+          break;
+        }
+      }
       transmitState = 0;
       transmitContinuousMark = bool(statusRegister & 0x10);
       statusRegister |= uint8_t(0x10);
@@ -123,6 +131,12 @@ namespace Plus4 {
       // using baud rate as receiver clock
       switch (receiveState) {
       case 0:                           // start bit
+        if (hostPort) {
+          int     c = hostPort->receiveByte();
+          if (c < 0)
+            break;              // no data, the input is idle
+          receiveShiftRegister = uint8_t(c);
+        }
         receiveState++;
         break;
       case 1:
@@ -168,7 +182,7 @@ namespace Plus4 {
         receiveState++;
         break;
       case 19:
-        if ((commandRegister & 0xC0) == 0x00) {
+        if ((commandRegister & 0xC0) == 0x00 && !hostPort) {
           // parity error
           statusRegister |= uint8_t(0x01);
         }
@@ -179,7 +193,10 @@ namespace Plus4 {
           uint8_t tmp = uint8_t((controlRegister & 0xE0)
                                 | ((commandRegister & 0x20) >> 1));
           if ((tmp & 0x80) == 0x00 || tmp == 0x90) {
-            if (!(statusRegister & 0x02)) {
+            if (hostPort) {
+              receiveCompleted();
+            }
+            else if (!(statusRegister & 0x02)) {
               // receive data register full, framing error
               statusRegister |= uint8_t(0x0A);
               if (!(commandRegister & 0x02))
@@ -197,7 +214,10 @@ namespace Plus4 {
         receiveState++;
         break;
       case 22:
-        if (!(statusRegister & 0x02)) {
+        if (hostPort) {
+          receiveCompleted();
+        }
+        else if (!(statusRegister & 0x02)) {
           // receive data register full, framing error
           statusRegister |= uint8_t(0x0A);
           if (!(commandRegister & 0x02))
@@ -218,11 +238,30 @@ namespace Plus4 {
     }
   }
 
+  void ACIA6551::receiveCompleted()
+  {
+    if (statusRegister & 0x08) {
+      // receive data register is still full: overrun, the byte is lost
+      statusRegister |= uint8_t(0x04);
+      return;
+    }
+    receiveDataRegister = receiveShiftRegister & getDataBitsMask();
+    statusRegister |= uint8_t(0x08);
+    if (!(commandRegister & 0x02))
+      statusRegister |= uint8_t(0x80);
+  }
+
   uint8_t ACIA6551::readRegister(uint16_t addr)
   {
     switch (addr & 0x0003) {
     case 0x0000:                        // read receive data register
-      statusRegister &= uint8_t(0xF7);
+      if (hostPort) {
+        // also clear the overrun, framing and parity error flags
+        statusRegister &= uint8_t(0xF0);
+      }
+      else {
+        statusRegister &= uint8_t(0xF7);
+      }
       return receiveDataRegister;
     case 0x0001:                        // read status register
       {
@@ -289,6 +328,7 @@ namespace Plus4 {
     receiveState = 25;
     transmitContinuousMark = true;
     halfBitFlag = false;
+    receiveShiftRegister = 0x00;
   }
 
   void ACIA6551::saveSnapshot(uint8_t *buf)
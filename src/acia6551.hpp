@@ -21,6 +21,7 @@
 #define PLUS4EMU_ACIA6551_HPP
 
 #include "plus4emu.hpp"
+#include "aciaport.hpp"
 
 namespace Plus4 {
 
@@ -42,8 +43,18 @@ namespace Plus4 {
     int         receiveState;
     bool        transmitContinuousMark;
     bool        halfBitFlag;
+    // byte being received from the host port
+    uint8_t     receiveShiftRegister;
+    // if not NULL, transmitted data is written to, and received data is
+    // read from this port; otherwise, the receiver input is always low
+    ACIAHostPort  *hostPort;
     // --------
     void runHalfBit();
+    void receiveCompleted();
+    inline uint8_t getDataBitsMask() const
+    {
+      return uint8_t(0xFF >> ((controlRegister & 0x60) >> 5));
+    }
    public:
     ACIA6551();
     virtual ~ACIA6551();
@@ -51,14 +62,27 @@ namespace Plus4 {
     {
       return bool(commandRegister & 0x01);
     }
-    inline void runOneCycle()
+    // run the ACIA for 'nCycles' clock cycles; the time spent is
+    // proportional to the number of bit events, rather than clock cycles
+    inline void run(uint32_t nCycles)
     {
       if (this->isEnabled()) {
-        cyclesRemaining--;
-        if (!cyclesRemaining)
+        while (nCycles >= cyclesRemaining) {
+          nCycles -= cyclesRemaining;
           this->runHalfBit();
+        }
+        cyclesRemaining -= nCycles;
       }
     }
+    // returns the number of clock cycles until the next bit event
+    inline uint32_t getCyclesRemaining() const
+    {
+      return cyclesRemaining;
+    }
+    inline void setHostPort(ACIAHostPort *port)
+    {
+      hostPort = port;
+    }
     inline bool getInterruptFlag() const
     {
       return bool(statusRegister & 0x80);
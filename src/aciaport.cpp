@@ -0,0 +1,393 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "plus4emu.hpp"
+#include "aciaport.hpp"
+
+#ifndef WIN32
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/types.h>
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <termios.h>
+#endif
+
+namespace Plus4 {
+
+  class ACIAHostPort_File : public ACIAHostPort {
+   private:
+    std::FILE *inFile;
+    std::FILE *outFile;
+    std::string fileName;
+   protected:
+    virtual size_t readData(uint8_t *buf, size_t nBytes);
+    virtual size_t writeData(const uint8_t *buf, size_t nBytes);
+   public:
+    ACIAHostPort_File(const std::string& name,
+                      const std::string& outFileName);
+    virtual ~ACIAHostPort_File();
+    virtual std::string getName() const;
+  };
+
+#ifndef WIN32
+
+  class ACIAHostPort_FD : public ACIAHostPort {
+   protected:
+    int         fd;
+    bool        isSocket;
+    // set after end of file or an I/O error, to stop reading or writing
+    bool        inputClosed;
+    bool        outputClosed;
+    std::string deviceName;
+    virtual size_t readData(uint8_t *buf, size_t nBytes);
+    virtual size_t writeData(const uint8_t *buf, size_t nBytes);
+    void setNonBlocking();
+   public:
+    ACIAHostPort_FD();
+    virtual ~ACIAHostPort_FD();
+    virtual std::string getName() const;
+  };
+
+  class ACIAHostPort_PTY : public ACIAHostPort_FD {
+   public:
+    ACIAHostPort_PTY();
+    virtual ~ACIAHostPort_PTY();
+  };
+
+  class ACIAHostPort_UnixSocket : public ACIAHostPort_FD {
+   public:
+    ACIAHostPort_UnixSocket(const std::string& name);
+    virtual ~ACIAHostPort_UnixSocket();
+  };
+
+#endif  // !WIN32
+
+  // --------------------------------------------------------------------------
+
+  ACIAHostPort::ACIAHostPort()
+    : inputBufferPos(0),
+      inputBufferSize(0),
+      outputBufferSize(0),
+      pollSkipCnt(0),
+      writeSkipCnt(0),
+      errorMessage((char *) 0)
+  {
+  }
+
+  ACIAHostPort::~ACIAHostPort()
+  {
+  }
+
+  bool ACIAHostPort::fillInputBuffer()
+  {
+    inputBufferPos = 0;
+    inputBufferSize = 0;
+    if (pollSkipCnt > 0) {
+      // avoid calling the host I/O functions on every bit while idle
+      pollSkipCnt--;
+      return false;
+    }
+    inputBufferSize = readData(&(inputBuffer[0]), bufferSize);
+    if (inputBufferSize < 1) {
+      pollSkipCnt = pollInterval - 1;
+      return false;
+    }
+    return true;
+  }
+
+  bool ACIAHostPort::flushFullBuffer()
+  {
+    if (writeSkipCnt > 0) {
+      // avoid calling the host I/O functions on every bit while the
+      // output is blocked
+      writeSkipCnt--;
+      return false;
+    }
+    flush();
+    if (outputBufferSize >= bufferSize) {
+      writeSkipCnt = pollInterval - 1;
+      return false;
+    }
+    return true;
+  }
+
+  void ACIAHostPort::flush()
+  {
+    if (outputBufferSize > 0) {
+      size_t  n = writeData(&(outputBuffer[0]), outputBufferSize);
+      if (n >= outputBufferSize) {
+        outputBufferSize = 0;
+      }
+      else if (n > 0) {
+        // keep the bytes not written yet
+        std::memmove(&(outputBuffer[0]), &(outputBuffer[n]),
+                     outputBufferSize - n);
+        outputBufferSize = outputBufferSize - n;
+      }
+    }
+  }
+
+  std::string ACIAHostPort::getName() const
+  {
+    return std::string("");
+  }
+
+  ACIAHostPort * ACIAHostPort::create(int type, const std::string& name,
+                                      const std::string& outFileName)
+  {
+    switch (type) {
+    case TYPE_NONE:
+      return (ACIAHostPort *) 0;
+    case TYPE_FILE:
+      return new ACIAHostPort_File(name, outFileName);
+#ifndef WIN32
+    case TYPE_PTY:
+      return new ACIAHostPort_PTY();
+    case TYPE_UNIX_SOCKET:
+      return new ACIAHostPort_UnixSocket(name);
+#else
+    case TYPE_PTY:
+    case TYPE_UNIX_SOCKET:
+      throw Plus4Emu::Exception("ACIA host port type is not supported "
+                                "on this platform");
+#endif
+    }
+    throw Plus4Emu::Exception("invalid ACIA host port type");
+  }
+
+  // --------------------------------------------------------------------------
+
+  ACIAHostPort_File::ACIAHostPort_File(const std::string& name,
+                                       const std::string& outFileName)
+    : ACIAHostPort(),
+      inFile((std::FILE *) 0),
+      outFile((std::FILE *) 0),
+      fileName(name)
+  {
+    if (name.length() > 0) {
+      inFile = std::fopen(name.c_str(), "rb");
+      if (!inFile)
+        throw Plus4Emu::Exception("error opening ACIA input file");
+    }
+    if (outFileName.length() > 0) {
+      outFile = std::fopen(outFileName.c_str(), "wb");
+      if (!outFile) {
+        if (inFile)
+          std::fclose(inFile);
+        throw Plus4Emu::Exception("error opening ACIA output file");
+      }
+    }
+  }
+
+  ACIAHostPort_File::~ACIAHostPort_File()
+  {
+    flush();
+    if (outFile)
+      std::fclose(outFile);
+    if (inFile)
+      std::fclose(inFile);
+  }
+
+  size_t ACIAHostPort_File::readData(uint8_t *buf, size_t nBytes)
+  {
+    if (!inFile)
+      return 0;
+    size_t  n = std::fread(buf, sizeof(uint8_t), nBytes, inFile);
+    if (n < nBytes && std::ferror(inFile)) {
+      // stop reading the input file
+      std::fclose(inFile);
+      inFile = (std::FILE *) 0;
+      setError("error reading ACIA input file");
+    }
+    return n;
+  }
+
+  size_t ACIAHostPort_File::writeData(const uint8_t *buf, size_t nBytes)
+  {
+    if (outFile) {
+      if (std::fwrite(buf, sizeof(uint8_t), nBytes, outFile) != nBytes ||
+          std::fflush(outFile) != 0) {
+        // stop writing the output file
+        std::fclose(outFile);
+        outFile = (std::FILE *) 0;
+        setError("error writing ACIA output file");
+      }
+    }
+    return nBytes;
+  }
+
+  std::string ACIAHostPort_File::getName() const
+  {
+    return fileName;
+  }
+
+  // --------------------------------------------------------------------------
+
+#ifndef WIN32
+
+  ACIAHostPort_FD::ACIAHostPort_FD()
+    : ACIAHostPort(),
+      fd(-1),
+      isSocket(false),
+      inputClosed(false),
+      outputClosed(false),
+      deviceName("")
+  {
+  }
+
+  ACIAHostPort_FD::~ACIAHostPort_FD()
+  {
+    if (fd >= 0) {
+      flush();
+      ::close(fd);
+    }
+  }
+
+  void ACIAHostPort_FD::setNonBlocking()
+  {
+    int     flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+      ::close(fd);
+      fd = -1;
+      throw Plus4Emu::Exception("error setting up ACIA host port");
+    }
+  }
+
+  size_t ACIAHostPort_FD::readData(uint8_t *buf, size_t nBytes)
+  {
+    while (!inputClosed) {
+      ssize_t n = ::read(fd, buf, nBytes);
+      if (n > 0)
+        return size_t(n);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+          break;                // no data available
+        if (errno == EIO && !isSocket)
+          break;                // the slave side of the PTY is not open
+      }
+      inputClosed = true;
+      setError(n == 0 ? "ACIA host port connection closed"
+                        : "error reading ACIA host port");
+    }
+    return 0;
+  }
+
+  size_t ACIAHostPort_FD::writeData(const uint8_t *buf, size_t nBytes)
+  {
+    size_t  nWritten = 0;
+    while (nWritten < nBytes) {
+      if (outputClosed)
+        return nBytes;          // discard the data after an error
+      ssize_t n;
+#ifdef MSG_NOSIGNAL
+      if (isSocket)
+        n = ::send(fd, buf + nWritten, nBytes - nWritten, MSG_NOSIGNAL);
+      else
+#endif
+        n = ::write(fd, buf + nWritten, nBytes - nWritten);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+          break;                // the rest is written later
+        if (errno == EIO && !isSocket) {
+          // the slave side of the PTY is not open, there is no one to
+          // receive the data
+          return nBytes;
+        }
+        outputClosed = true;
+        setError("error writing ACIA host port");
+        return nBytes;
+      }
+      nWritten = nWritten + size_t(n);
+    }
+    return nWritten;
+  }
+
+  std::string ACIAHostPort_FD::getName() const
+  {
+    return deviceName;
+  }
+
+  ACIAHostPort_PTY::ACIAHostPort_PTY()
+    : ACIAHostPort_FD()
+  {
+    fd = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0)
+      throw Plus4Emu::Exception("error opening pseudo terminal");
+    const char  *s = (char *) 0;
+    if (::grantpt(fd) == 0 && ::unlockpt(fd) == 0)
+      s = ::ptsname(fd);
+    if (!s) {
+      ::close(fd);
+      fd = -1;
+      throw Plus4Emu::Exception("error opening pseudo terminal");
+    }
+    deviceName = s;
+    // disable echo and line editing, so that the data is passed unchanged
+    int     slaveFD = ::open(s, O_RDWR | O_NOCTTY);
+    if (slaveFD >= 0) {
+      struct termios  tios;
+      if (::tcgetattr(slaveFD, &tios) == 0) {
+        ::cfmakeraw(&tios);
+        (void) ::tcsetattr(slaveFD, TCSANOW, &tios);
+      }
+      ::close(slaveFD);
+    }
+    setNonBlocking();
+  }
+
+  ACIAHostPort_PTY::~ACIAHostPort_PTY()
+  {
+  }
+
+  ACIAHostPort_UnixSocket::ACIAHostPort_UnixSocket(const std::string& name)
+    : ACIAHostPort_FD()
+  {
+    struct sockaddr_un  addr;
+    std::memset(&addr, 0, sizeof(addr));
+    if (name.length() < 1 || name.length() >= sizeof(addr.sun_path))
+      throw Plus4Emu::Exception("invalid socket name");
+    addr.sun_family = AF_UNIX;
+    std::strcpy(&(addr.sun_path[0]), name.c_str());
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+      throw Plus4Emu::Exception("error creating socket");
+    isSocket = true;
+    if (::connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+      ::close(fd);
+      fd = -1;
+      throw Plus4Emu::Exception("error connecting to socket");
+    }
+    deviceName = name;
+    setNonBlocking();
+  }
+
+  ACIAHostPort_UnixSocket::~ACIAHostPort_UnixSocket()
+  {
+  }
+
+#endif  // !WIN32
+
+}       // namespace Plus4
+
@@ -0,0 +1,126 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef PLUS4EMU_ACIAPORT_HPP
+#define PLUS4EMU_ACIAPORT_HPP
+
+#include "plus4emu.hpp"
+
+namespace Plus4 {
+
+  // byte stream connected to the emulated 6551 ACIA; data is buffered in
+  // both directions, so that the host I/O functions are called only once
+  // per block of bytes
+
+  class ACIAHostPort {
+   public:
+    enum {
+      TYPE_NONE = 0,
+      TYPE_FILE = 1,
+      TYPE_PTY = 2,
+      TYPE_UNIX_SOCKET = 3
+    };
+   private:
+    static const size_t bufferSize = 4096;
+    // number of receiveByte() calls to skip after reading no data
+    static const int    pollInterval = 64;
+    uint8_t   inputBuffer[bufferSize];
+    size_t    inputBufferPos;
+    size_t    inputBufferSize;
+    uint8_t   outputBuffer[bufferSize];
+    size_t    outputBufferSize;
+    int       pollSkipCnt;
+    // number of sendByte() calls to reject without trying to write the
+    // full output buffer again
+    int       writeSkipCnt;
+    const char  *errorMessage;
+    bool fillInputBuffer();
+    bool flushFullBuffer();
+   protected:
+    // read at most 'nBytes' bytes to 'buf' without blocking, and return
+    // the number of bytes actually read; end of file and errors other than
+    // no data being available should be reported with setError()
+    virtual size_t readData(uint8_t *buf, size_t nBytes) = 0;
+    // write at most 'nBytes' bytes from 'buf' without blocking, and return
+    // the number of bytes actually written; the rest is kept in the output
+    // buffer and written again later. This is called while the ACIA is
+    // being emulated, so errors must be reported with setError() instead
+    // of throwing an exception
+    virtual size_t writeData(const uint8_t *buf, size_t nBytes) = 0;
+    inline void setError(const char *msg)
+    {
+      if (!errorMessage)
+        errorMessage = msg;
+    }
+   public:
+    ACIAHostPort();
+    virtual ~ACIAHostPort();
+    // returns the next byte received from the host, or -1 if there is
+    // no data available
+    inline int receiveByte()
+    {
+      if (inputBufferPos >= inputBufferSize) {
+        if (!fillInputBuffer())
+          return -1;
+      }
+      return int(inputBuffer[inputBufferPos++]);
+    }
+    // returns false if the byte cannot be sent yet because the output
+    // buffer is full and the host is not reading the data; in this case,
+    // sendByte() should be called again later with the same byte
+    inline bool sendByte(uint8_t c)
+    {
+      if (outputBufferSize >= bufferSize) {
+        if (!flushFullBuffer())
+          return false;
+      }
+      outputBuffer[outputBufferSize++] = c;
+      return true;
+    }
+    // write as much of the buffered output data as possible
+    void flush();
+    // returns the message of the first host I/O error since the previous
+    // call, or NULL if there was no error
+    inline const char *checkError()
+    {
+      const char  *msg = errorMessage;
+      errorMessage = (char *) 0;
+      return msg;
+    }
+    // returns the name of the device the port is connected to (e.g. the
+    // slave side of a pseudo terminal)
+    virtual std::string getName() const;
+    /*!
+     * Create a new host port of type 'type':
+     *   TYPE_FILE:         replay received data from 'name', and write
+     *                      the transmitted data to 'outFileName' (if it
+     *                      is not empty)
+     *   TYPE_PTY:          create a pseudo terminal ('name' is ignored)
+     *   TYPE_UNIX_SOCKET:  connect to the Unix domain socket 'name'
+     * Returns NULL if 'type' is TYPE_NONE. On error, Plus4Emu::Exception
+     * is thrown.
+     */
+    static ACIAHostPort *create(int type, const std::string& name,
+                                const std::string& outFileName);
+  };
+
+}       // namespace Plus4
+
+#endif  // PLUS4EMU_ACIAPORT_HPP
+
@@ -0,0 +1,169 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "plus4emu.hpp"
+#include "basictok.hpp"
+
+#include <vector>
+
+namespace Plus4 {
+
+  // BASIC 3.5 keywords, in the order of their tokens (0x80 to 0xFD)
+  static const char *basicKeywordTable[126] = {
+    "END",      "FOR",      "NEXT",     "DATA",     "INPUT#",   "INPUT",
+    "DIM",      "READ",     "LET",      "GOTO",     "RUN",      "IF",
+    "RESTORE",  "GOSUB",    "RETURN",   "REM",      "STOP",     "ON",
+    "WAIT",     "LOAD",     "SAVE",     "VERIFY",   "DEF",      "POKE",
+    "PRINT#",   "PRINT",    "CONT",     "LIST",     "CLR",      "CMD",
+    "SYS",      "OPEN",     "CLOSE",    "GET",      "NEW",      "TAB(",
+    "TO",       "FN",       "SPC(",     "THEN",     "NOT",      "STEP",
+    "+",        "-",        "*",        "/",        "^",        "AND",
+    "OR",       ">",        "=",        "<",        "SGN",      "INT",
+    "ABS",      "USR",      "FRE",      "POS",      "SQR",      "RND",
+    "LOG",      "EXP",      "COS",      "SIN",      "TAN",      "ATN",
+    "PEEK",     "LEN",      "STR$",     "VAL",      "ASC",      "CHR$",
+    "LEFT$",    "RIGHT$",   "MID$",     "GO",       "RGR",      "RCLR",
+    "RLUM",     "JOY",      "RDOT",     "DEC",      "HEX$",     "ERR$",
+    "INSTR",    "ELSE",     "RESUME",   "TRAP",     "TRON",     "TROFF",
+    "SOUND",    "VOL",      "AUTO",     "PUDEF",    "GRAPHIC",  "PAINT",
+    "CHAR",     "BOX",      "CIRCLE",   "GSHAPE",   "SSHAPE",   "DRAW",
+    "LOCATE",   "COLOR",    "SCNCLR",   "SCALE",    "HELP",     "DO",
+    "LOOP",     "EXIT",     "DIRECTORY", "DSAVE",   "DLOAD",    "HEADER",
+    "SCRATCH",  "COLLECT",  "COPY",     "RENAME",   "BACKUP",   "DELETE",
+    "RENUMBER", "KEY",      "MONITOR",  "USING",    "UNTIL",    "WHILE"
+  };
+
+  static const uint8_t  tokenDATA = 0x83;
+  static const uint8_t  tokenREM = 0x8F;
+  static const uint8_t  tokenPRINT = 0x99;
+
+  // returns the length of the keyword matched at 's', and stores the token
+  // in 'token', or returns zero if there is no match; like in the BASIC
+  // interpreter, a shifted character ends an abbreviated keyword, and the
+  // comparison continues with the next keyword in the table if all characters
+  // of the current one are equal, but the last one is not unshifted
+
+  static size_t findBASICKeyword(uint8_t& token,
+                                 const uint8_t *s, size_t nBytes)
+  {
+    for (size_t i = 0; i < 126; i++) {
+      size_t  k = i;
+      size_t  l = 0;
+      for (size_t j = 0; j < nBytes; j++) {
+        bool    lastChar = (basicKeywordTable[k][l + 1] == '\0');
+        uint8_t c = uint8_t(basicKeywordTable[k][l]);
+        if (lastChar)
+          c = c | 0x80;
+        uint8_t d = uint8_t(s[j] - c);
+        if (d == 0x80) {
+          token = uint8_t(i | 0x80);
+          return (j + 1);
+        }
+        if (d != 0x00)
+          break;
+        l++;
+        if (lastChar) {
+          if (++k >= 126)
+            break;
+          l = 0;
+        }
+      }
+    }
+    return 0;
+  }
+
+  void tokenizeBASICLine(std::vector< uint8_t >& buf,
+                         const uint8_t *s, size_t nBytes)
+  {
+    // convert characters to the codes read back from the screen
+    std::vector< uint8_t >  lineBuf;
+    bool    quoteMode = false;
+    for (size_t i = 0; i < nBytes; i++) {
+      uint8_t c = s[i];
+      if (c >= 0x60 && c <= 0x7F)
+        c = c + 0x60;
+      else if (c >= 0xE0 && c <= 0xFE)
+        c = c - 0x40;
+      if (c == 0xDE)
+        c = 0xFF;               // pi
+      else if ((c & 0x7F) < 0x20 && !quoteMode)
+        continue;               // control characters are not stored
+      if (c == 0x22)
+        quoteMode = !quoteMode;
+      lineBuf.push_back(c);
+    }
+    while (lineBuf.size() > 0 && lineBuf.back() == 0x20)
+      lineBuf.pop_back();
+    // crunch keywords
+    size_t  i = 0;
+    bool    dataMode = false;
+    while (i < lineBuf.size()) {
+      uint8_t c = lineBuf[i];
+      if (c == 0x22) {
+        // copy string until the closing quote
+        buf.push_back(c);
+        for (i++; i < lineBuf.size(); ) {
+          c = lineBuf[i++];
+          buf.push_back(c);
+          if (c == 0x22)
+            break;
+        }
+        continue;
+      }
+      if (c == 0x20 || dataMode || (c >= 0x30 && c <= 0x3B)) {
+        if (c == 0x3A)
+          dataMode = false;
+        buf.push_back(c);
+        i++;
+        continue;
+      }
+      if (c >= 0x80 && c != 0xFF) {
+        // shifted characters other than pi are ignored outside of
+        // strings and DATA
+        i++;
+        continue;
+      }
+      if (c == 0x3F) {
+        buf.push_back(tokenPRINT);
+        i++;
+        continue;
+      }
+      uint8_t token = 0x00;
+      size_t  n = findBASICKeyword(token, &(lineBuf.front()) + i,
+                                   lineBuf.size() - i);
+      if (!n) {
+        buf.push_back(c);
+        i++;
+        continue;
+      }
+      buf.push_back(token);
+      i += n;
+      if (token == tokenDATA) {
+        dataMode = true;
+      }
+      else if (token == tokenREM) {
+        // copy the rest of the line without any conversion
+        for ( ; i < lineBuf.size(); i++)
+          buf.push_back(lineBuf[i]);
+      }
+    }
+  }
+
+}       // namespace Plus4
+
@@ -0,0 +1,43 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef PLUS4EMU_BASICTOK_HPP
+#define PLUS4EMU_BASICTOK_HPP
+
+#include "plus4emu.hpp"
+
+#include <vector>
+
+namespace Plus4 {
+
+  /*!
+   * Convert a line of BASIC 3.5 program text (PETSCII, 'nBytes' characters,
+   * without the line number and terminating carriage return) to tokenized
+   * format, using the same rules as the BASIC interpreter, and append the
+   * result to 'buf'. Trailing spaces are removed, and characters are
+   * converted to the codes that would be read back from the screen by the
+   * editor. No terminating zero byte is written.
+   */
+  void tokenizeBASICLine(std::vector< uint8_t >& buf,
+                         const uint8_t *s, size_t nBytes);
+
+}       // namespace Plus4
+
+#endif  // PLUS4EMU_BASICTOK_HPP
+
@@ -22,7 +22,7 @@
 #include "comprlib.hpp"
 #include "decompm2.hpp"
 
-#define COMPRESS_MAX_THREADS    4
+#define COMPRESS_MAX_THREADS    16
 #define COMPRESS_BLOCK_SIZE     65536
 
 namespace Plus4Emu {
@@ -674,116 +674,255 @@ namespace Plus4Emu {
 
   // ==========================================================================
 
-  class CompressorThread : public Thread {
+  struct StreamCompressorJob {
+    // the previous segment (if any) followed by the one to be compressed
+    std::vector< unsigned char >  inBuf;
+    size_t  startPos;
+    bool    isLastSegment;
+    bool    isStarted;
+    bool    doneFlag;
+    bool    errorFlag;
+    std::vector< unsigned int >   outBuf;
+    // --------
+    StreamCompressorJob()
+      : startPos(0),
+        isLastSegment(false),
+        isStarted(false),
+        doneFlag(false),
+        errorFlag(false)
+    {
+    }
+  };
+
+  class StreamCompressorThread : public Thread {
    private:
     Compressor_M2 compressor;
+    Mutex       mutex;
+    ThreadLock  jobDoneLock;
+    // --------
+    void compressSegment(StreamCompressorJob& job_);
    public:
-    std::vector< unsigned int > outBuf;
-    const unsigned char *inBuf;
-    size_t  inBufSize;
-    size_t  startPos;
-    size_t  blockSize;
-    bool    errorFlag;
+    // these are protected by the mutex
+    StreamCompressorJob *job;
+    bool    quitFlag;
     // --------
-    CompressorThread();
-    virtual ~CompressorThread();
+    StreamCompressorThread(Mutex& mutex_, ThreadLock& jobDoneLock_);
+    virtual ~StreamCompressorThread();
     virtual void run();
   };
 
-  CompressorThread::CompressorThread()
-    : inBuf((unsigned char *) 0),
-      inBufSize(0),
-      startPos(0),
-      blockSize(Compressor_M2::maxRepeatDist),
-      errorFlag(false)
+  StreamCompressorThread::StreamCompressorThread(Mutex& mutex_,
+                                                 ThreadLock& jobDoneLock_)
+    : mutex(mutex_),
+      jobDoneLock(jobDoneLock_),
+      job((StreamCompressorJob *) 0),
+      quitFlag(false)
   {
   }
 
-  CompressorThread::~CompressorThread()
+  StreamCompressorThread::~StreamCompressorThread()
   {
   }
 
-  void CompressorThread::run()
+  void StreamCompressorThread::compressSegment(StreamCompressorJob& job_)
   {
-    try {
-      if (!inBuf)
-        return;
-      std::vector< unsigned int > tmpBuf;
-      size_t  dataSizePos = 0;
-      while (startPos < inBufSize) {
-        size_t  nBytes = blockSize;
-        if ((startPos + nBytes) > inBufSize)
-          nBytes = inBufSize - startPos;
-        compressor.compressDataBlock(tmpBuf, inBuf, startPos, nBytes, inBufSize,
-                                     ((startPos + nBytes) >= inBufSize), true);
-        // append compressed data to output buffer
-        size_t  prvSize = outBuf.size();
-        if ((startPos % Compressor_M2::maxRepeatDist) == 0) {
-          dataSizePos = prvSize;
-          outBuf.resize(prvSize + tmpBuf.size() + 1);
-          outBuf[dataSizePos] = (unsigned int) tmpBuf.size();
-          prvSize++;
-        }
-        else {
-          outBuf.resize(prvSize + tmpBuf.size());
-          outBuf[dataSizePos] =
-              outBuf[dataSizePos] + (unsigned int) tmpBuf.size();
-        }
-        std::memcpy(&(outBuf.front()) + prvSize, &(tmpBuf.front()),
-                    tmpBuf.size() * sizeof(unsigned int));
-        startPos = startPos + blockSize;
-        if ((startPos % Compressor_M2::maxRepeatDist) == 0) {
-          startPos = startPos + (Compressor_M2::maxRepeatDist
-                                 * (COMPRESS_MAX_THREADS - 1));
-        }
-      }
+    std::vector< unsigned int > tmpBuf;
+    size_t  bufSize = job_.inBuf.size();
+    for (size_t startPos = job_.startPos; startPos < bufSize; ) {
+      size_t  nBytes = COMPRESS_BLOCK_SIZE;
+      if ((startPos + nBytes) > bufSize)
+        nBytes = bufSize - startPos;
+      compressor.compressDataBlock(
+          tmpBuf, &(job_.inBuf.front()), startPos, nBytes, bufSize,
+          (job_.isLastSegment && (startPos + nBytes) >= bufSize), true);
+      // append compressed data to output buffer
+      job_.outBuf.insert(job_.outBuf.end(), tmpBuf.begin(), tmpBuf.end());
+      startPos = startPos + nBytes;
     }
-    catch (std::exception) {
-      errorFlag = true;
+  }
+
+  void StreamCompressorThread::run()
+  {
+    while (true) {
+      mutex.lock();
+      StreamCompressorJob *job_ = job;
+      bool    quitFlag_ = quitFlag;
+      mutex.unlock();
+      if (quitFlag_)
+        break;
+      if (!job_) {
+        Thread::wait();
+        continue;
+      }
+      bool    errorFlag = false;
+      try {
+        compressSegment(*job_);
+      }
+      catch (...) {
+        errorFlag = true;
+      }
+      // the input data is no longer needed
+      std::vector< unsigned char >().swap(job_->inBuf);
+      mutex.lock();
+      job_->errorFlag = errorFlag;
+      job_->doneFlag = true;
+      job = (StreamCompressorJob *) 0;
+      mutex.unlock();
+      jobDoneLock.notify();
     }
   }
 
   // --------------------------------------------------------------------------
 
-  void compressData(std::vector< unsigned char >& outBuf,
-                    const unsigned char *inBuf, size_t inBufSize)
+  StreamCompressor::StreamCompressor(int nThreads)
+    : mutex(),
+      jobDoneLock(false),
+      maxThreads(1),
+      maxJobs(2),
+      outBufReadCnt(0),
+      savedBufPos(0x7FFFFFFF),
+      shiftReg(0x01),
+      finishFlag(false)
   {
-    outBuf.clear();
-    if (inBufSize < 1 || !inBuf)
-      return;
-    CompressorThread  *compressorThreads[COMPRESS_MAX_THREADS];
-    for (int i = 0; i < COMPRESS_MAX_THREADS; i++)
-      compressorThreads[i] = (CompressorThread *) 0;
+    if (nThreads < 1)
+      nThreads = getProcessorCount();
+    maxThreads = size_t(nThreads < COMPRESS_MAX_THREADS ?
+                        nThreads : COMPRESS_MAX_THREADS);
+    maxJobs = maxThreads * 2;
+    threads.reserve(maxThreads);
+    for (int i = 0; i < 256; i++)
+      checksumTable[i] = (unsigned char) i;
+  }
+
+  StreamCompressor::~StreamCompressor()
+  {
+    stopThreads();
+  }
+
+  void StreamCompressor::stopThreads()
+  {
+    mutex.lock();
+    for (size_t i = 0; i < threads.size(); i++)
+      threads[i]->quitFlag = true;
+    mutex.unlock();
+    for (size_t i = 0; i < threads.size(); i++) {
+      threads[i]->join();
+      delete threads[i];
+    }
+    threads.clear();
+    while (jobs.size() > 0) {
+      delete jobs.front();
+      jobs.pop_front();
+    }
+  }
+
+  void StreamCompressor::submitSegment(bool isLastSegment)
+  {
+    StreamCompressorJob *job = new StreamCompressorJob();
     try {
-      size_t  startPos = 0;
-      int     nThreads = 0;
-      while (nThreads < COMPRESS_MAX_THREADS && startPos < inBufSize) {
-        compressorThreads[nThreads] = new CompressorThread();
-        compressorThreads[nThreads]->inBuf = inBuf;
-        compressorThreads[nThreads]->inBufSize = inBufSize;
-        compressorThreads[nThreads]->startPos = startPos;
-        compressorThreads[nThreads]->blockSize = COMPRESS_BLOCK_SIZE;
-        startPos = startPos + Compressor_M2::maxRepeatDist;
-        nThreads++;
-      }
-      for (int i = 0; i < nThreads; i++)
-        compressorThreads[i]->start();
-      for (int i = 0; i < nThreads; i++) {
-        compressorThreads[i]->join();
-        // startPos is now the read position of the output buffer of the thread
-        compressorThreads[i]->startPos = 0;
-      }
-      size_t        savedBufPos = 0x7FFFFFFF;
-      unsigned char shiftReg = 0x01;
-      for (int i = 0; true; i++) {
-        if (i >= nThreads)
-          i = 0;
-        if (!compressorThreads[i]) {
-          // end of compressed data for all threads
-          if (shiftReg != 0x01) {
-            while (!(shiftReg & 0x80))
-              shiftReg = shiftReg << 1;
-            shiftReg = (shiftReg & 0x7F) << 1;
+      job->inBuf.reserve(prvSegment.size() + curSegment.size());
+      job->inBuf.insert(job->inBuf.end(),
+                        prvSegment.begin(), prvSegment.end());
+      job->inBuf.insert(job->inBuf.end(),
+                        curSegment.begin(), curSegment.end());
+      job->startPos = prvSegment.size();
+      job->isLastSegment = isLastSegment;
+      mutex.lock();
+      jobs.push_back(job);
+      mutex.unlock();
+    }
+    catch (...) {
+      delete job;
+      throw;
+    }
+    prvSegment.swap(curSegment);
+    curSegment.clear();
+    processJobs(maxJobs - 1);
+  }
+
+  void StreamCompressor::processJobs(size_t maxJobCnt)
+  {
+    while (true) {
+      std::vector< StreamCompressorThread * > startedThreads;
+      mutex.lock();
+      std::list< StreamCompressorJob * >::iterator  i = jobs.begin();
+      for (size_t j = 0; i != jobs.end() && j < threads.size(); j++) {
+        if (threads[j]->job)
+          continue;
+        while (i != jobs.end() && (*i)->isStarted)
+          i++;
+        if (i == jobs.end())
+          break;
+        // start compressing the next segment on an idle thread
+        (*i)->isStarted = true;
+        threads[j]->job = *i;
+        startedThreads.push_back(threads[j]);
+      }
+      while (i != jobs.end() && (*i)->isStarted)
+        i++;
+      bool    newThreadNeeded =
+          (i != jobs.end() && threads.size() < maxThreads);
+      StreamCompressorJob *job = (StreamCompressorJob *) 0;
+      if (jobs.size() > 0 && jobs.front()->doneFlag) {
+        job = jobs.front();
+        jobs.pop_front();
+      }
+      mutex.unlock();
+      for (size_t j = 0; j < startedThreads.size(); j++)
+        startedThreads[j]->start();
+      if (newThreadNeeded) {
+        threads.push_back(new StreamCompressorThread(mutex, jobDoneLock));
+        continue;
+      }
+      if (job) {
+        // pack the output of the finished jobs in the original order
+        try {
+          if (job->errorFlag)
+            throw Exception("error compressing data");
+          packOutputData(job->outBuf);
+        }
+        catch (...) {
+          delete job;
+          throw;
+        }
+        delete job;
+        continue;
+      }
+      if (jobs.size() <= maxJobCnt)
+        break;
+      jobDoneLock.wait(100);
+    }
+  }
+
+  void StreamCompressor::packOutputData(const std::vector< unsigned int >& buf)
+  {
+    if (outBufReadCnt < 1 && outBuf.size() < 1)
+      outBuf.push_back(0x00);           // reserve space for checksum byte
+    for (size_t i = 0; i < buf.size(); i++) {
+      unsigned int  c = buf[i];
+      if (c >= 0x80000000U) {
+        // special case for literal bytes, which are stored byte-aligned
+        if (shiftReg != 0x01 && savedBufPos >= outBuf.size()) {
+          // reserve space for the shift register to be stored later when
+          // it is full, and save the write position
+          savedBufPos = outBuf.size();
+          outBuf.push_back(0x00);
+        }
+        unsigned int  nBytes = ((c & 0x7F000000U) + 0x07000000U) >> 27;
+        while (nBytes > 0U) {
+          nBytes--;
+          outBuf.push_back((unsigned char) ((c >> (nBytes * 8U)) & 0xFFU));
+        }
+      }
+      else {
+        unsigned int  nBits = c >> 24;
+        c = c & 0x00FFFFFFU;
+        for (unsigned int k = nBits; k > 0U; ) {
+          k--;
+          unsigned int  b = (unsigned int) (bool(c & (1U << k)));
+          bool          srFull = bool(shiftReg & 0x80);
+          shiftReg = ((shiftReg & 0x7F) << 1) | (unsigned char) b;
+          if (srFull) {
             if (savedBufPos >= outBuf.size()) {
               outBuf.push_back(shiftReg);
             }
@@ -794,76 +933,134 @@ namespace Plus4Emu {
             }
             shiftReg = 0x01;
           }
-          // calculate checksum
-          unsigned char crcVal = 0xFF;
-          for (size_t j = outBuf.size() - 1; j > 0; j--) {
-            unsigned char tmp = crcVal ^ outBuf[j];
-            crcVal = (((tmp << 1) | ((tmp >> 7) & 0x01)) + 0xAC) & 0xFF;
-          }
-          crcVal = (unsigned char) ((0x0180 - 0xAC) >> 1) ^ crcVal;
-          outBuf[0] = crcVal;
-          break;
-        }
-        if (compressorThreads[i]->errorFlag)
-          throw Exception("error compressing data");
-        if (compressorThreads[i]->startPos
-            >= compressorThreads[i]->outBuf.size()) {
-          // end of compressed data for this thread
-          delete compressorThreads[i];
-          compressorThreads[i] = (CompressorThread *) 0;
-          continue;
         }
-        // pack output data
-        if (outBuf.size() < 1)
-          outBuf.push_back(0x00);       // reserve space for checksum byte
-        startPos = compressorThreads[i]->startPos + 1;
-        compressorThreads[i]->startPos =
-            startPos + size_t(compressorThreads[i]->outBuf[startPos - 1]);
-        for (size_t j = startPos; j < compressorThreads[i]->startPos; j++) {
-          unsigned int  c = compressorThreads[i]->outBuf[j];
-          if (c >= 0x80000000U) {
-            // special case for literal bytes, which are stored byte-aligned
-            if (shiftReg != 0x01 && savedBufPos >= outBuf.size()) {
-              // reserve space for the shift register to be stored later when
-              // it is full, and save the write position
-              savedBufPos = outBuf.size();
-              outBuf.push_back(0x00);
-            }
-            unsigned int  nBytes = ((c & 0x7F000000U) + 0x07000000U) >> 27;
-            while (nBytes > 0U) {
-              nBytes--;
-              outBuf.push_back((unsigned char) ((c >> (nBytes * 8U)) & 0xFFU));
-            }
-          }
-          else {
-            unsigned int  nBits = c >> 24;
-            c = c & 0x00FFFFFFU;
-            for (unsigned int k = nBits; k > 0U; ) {
-              k--;
-              unsigned int  b = (unsigned int) (bool(c & (1U << k)));
-              bool          srFull = bool(shiftReg & 0x80);
-              shiftReg = ((shiftReg & 0x7F) << 1) | (unsigned char) b;
-              if (srFull) {
-                if (savedBufPos >= outBuf.size()) {
-                  outBuf.push_back(shiftReg);
-                }
-                else {
-                  // store at saved position if any literal bytes were inserted
-                  outBuf[savedBufPos] = shiftReg;
-                  savedBufPos = 0x7FFFFFFF;
-                }
-                shiftReg = 0x01;
-              }
-            }
-          }
+      }
+    }
+  }
+
+  void StreamCompressor::flushOutputData()
+  {
+    if (shiftReg != 0x01) {
+      while (!(shiftReg & 0x80))
+        shiftReg = shiftReg << 1;
+      shiftReg = (shiftReg & 0x7F) << 1;
+      if (savedBufPos >= outBuf.size()) {
+        outBuf.push_back(shiftReg);
+      }
+      else {
+        // store at saved position if any literal bytes were inserted
+        outBuf[savedBufPos] = shiftReg;
+        savedBufPos = 0x7FFFFFFF;
+      }
+      shiftReg = 0x01;
+    }
+  }
+
+  void StreamCompressor::writeData(const unsigned char *buf, size_t nBytes)
+  {
+    if (finishFlag)
+      throw Exception("internal error: StreamCompressor::writeData() "
+                      "called after finish()");
+    try {
+      while (nBytes > 0) {
+        if (curSegment.size() >= Compressor_M2::maxRepeatDist) {
+          // there is more data, so the current segment is not the last one
+          submitSegment(false);
         }
+        if (curSegment.capacity() < Compressor_M2::maxRepeatDist)
+          curSegment.reserve(Compressor_M2::maxRepeatDist);
+        size_t  n = Compressor_M2::maxRepeatDist - curSegment.size();
+        n = (n < nBytes ? n : nBytes);
+        curSegment.insert(curSegment.end(), buf, buf + n);
+        buf = buf + n;
+        nBytes = nBytes - n;
       }
     }
     catch (...) {
-      for (int i = 0; i < COMPRESS_MAX_THREADS; i++) {
-        if (compressorThreads[i])
-          delete compressorThreads[i];
+      stopThreads();
+      throw;
+    }
+  }
+
+  void StreamCompressor::finish()
+  {
+    if (finishFlag)
+      return;
+    finishFlag = true;
+    try {
+      if (curSegment.size() > 0)
+        submitSegment(true);
+      processJobs(0);
+      flushOutputData();
+    }
+    catch (...) {
+      stopThreads();
+      throw;
+    }
+    stopThreads();
+    std::vector< unsigned char >().swap(prvSegment);
+    std::vector< unsigned char >().swap(curSegment);
+  }
+
+  size_t StreamCompressor::readData(std::vector< unsigned char >& buf)
+  {
+    // the shift register may still be written at the saved position
+    size_t  n = (savedBufPos < outBuf.size() ? savedBufPos : outBuf.size());
+    if (n < 1)
+      return 0;
+    buf.insert(buf.end(), outBuf.begin(), outBuf.begin() + n);
+    // update checksum: each byte (except the first one, which is the
+    // checksum) is applied to the result in reverse order as
+    // c = ((c ^ b) rotated left by 1) + 0xAC, so the inverse of this
+    // function is applied to the table
+    for (size_t i = (outBufReadCnt > 0 ? 0 : 1); i < n; i++) {
+      unsigned char b = outBuf[i];
+      for (int j = 0; j < 256; j++) {
+        unsigned char c = (checksumTable[j] - 0xAC) & 0xFF;
+        checksumTable[j] = (((c >> 1) | (c << 7)) & 0xFF) ^ b;
+      }
+    }
+    outBuf.erase(outBuf.begin(), outBuf.begin() + n);
+    if (savedBufPos < 0x7FFFFFFF)
+      savedBufPos = savedBufPos - n;
+    outBufReadCnt = outBufReadCnt + n;
+    return n;
+  }
+
+  unsigned char StreamCompressor::getChecksum() const
+  {
+    unsigned char crcVal = 0xFF;
+    for (int i = 0; i < 256; i++) {
+      if (checksumTable[i] == 0xFF) {
+        crcVal = (unsigned char) i;
+        break;
       }
+    }
+    return ((unsigned char) ((0x0180 - 0xAC) >> 1) ^ crcVal);
+  }
+
+  // --------------------------------------------------------------------------
+
+  void compressData(std::vector< unsigned char >& outBuf,
+                    const unsigned char *inBuf, size_t inBufSize)
+  {
+    outBuf.clear();
+    if (inBufSize < 1 || !inBuf)
+      return;
+    try {
+      StreamCompressor  compressor;
+      for (size_t i = 0; i < inBufSize; ) {
+        size_t  n = Compressor_M2::maxRepeatDist;
+        n = (n < (inBufSize - i) ? n : (inBufSize - i));
+        compressor.writeData(inBuf + i, n);
+        (void) compressor.readData(outBuf);
+        i = i + n;
+      }
+      compressor.finish();
+      (void) compressor.readData(outBuf);
+      outBuf[0] = compressor.getChecksum();
+    }
+    catch (...) {
       outBuf.clear();
       throw;
     }
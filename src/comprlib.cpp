@@ -1141,6 +1141,289 @@ namespace Plus4Compress {
 
   // --------------------------------------------------------------------------
 
+  template <typename T>
+  static bool compareSuffixes(const T *s, size_t n, size_t p1, size_t p2)
+  {
+    // returns true if the suffix at 'p1' is less than the one at 'p2'
+    for ( ; p1 < n && p2 < n; p1++, p2++) {
+      if (s[p1] != s[p2])
+        return (s[p1] < s[p2]);
+    }
+    return (p1 >= n);
+  }
+
+  template <typename T>
+  static void induceSortSuffixes(unsigned int *sa, const T *s, size_t n,
+                                 const std::vector< bool >& sType,
+                                 const std::vector< unsigned int >& lmsPos,
+                                 const std::vector< unsigned int >& lBucket,
+                                 const std::vector< unsigned int >& sBucket,
+                                 std::vector< unsigned int >& tmpBucket)
+  {
+    for (size_t i = 0; i < n; i++)
+      sa[i] = 0xFFFFFFFFU;
+    tmpBucket = sBucket;
+    for (size_t i = 0; i < lmsPos.size(); i++)
+      sa[tmpBucket[size_t(s[lmsPos[i]])]++] = lmsPos[i];
+    // induce L-type suffixes from left to right
+    tmpBucket = lBucket;
+    sa[tmpBucket[size_t(s[n - 1])]++] = (unsigned int) (n - 1);
+    for (size_t i = 0; i < n; i++) {
+      unsigned int  p = sa[i];
+      if (p != 0xFFFFFFFFU && p > 0U && !sType[p - 1U])
+        sa[tmpBucket[size_t(s[p - 1U])]++] = p - 1U;
+    }
+    // induce S-type suffixes from right to left
+    tmpBucket = lBucket;
+    for (size_t i = n; i-- > 0; ) {
+      unsigned int  p = sa[i];
+      if (p != 0xFFFFFFFFU && p > 0U && sType[p - 1U])
+        sa[--tmpBucket[size_t(s[p - 1U]) + 1]] = p - 1U;
+    }
+  }
+
+  // Create the suffix array of s[0..n-1] in 'sa', using the SA-IS algorithm
+  // by G. Nong, S. Zhang and W. H. Chan. All characters must be in the
+  // range 0 to maxValue. The size of the temporary buffers allocated is
+  // added to 'memUsed', and the maximum of 'memUsed' is stored in 'memPeak'.
+
+  template <typename T>
+  static void suffixArraySAIS(unsigned int *sa, const T *s, size_t n,
+                              size_t maxValue,
+                              size_t& memUsed, size_t& memPeak)
+  {
+    if (n < 16) {
+      // use simple insertion sort for very short strings
+      for (size_t i = 0; i < n; i++) {
+        size_t  j = i;
+        for ( ; j > 0 && compareSuffixes(s, n, i, size_t(sa[j - 1])); j--)
+          sa[j] = sa[j - 1];
+        sa[j] = (unsigned int) i;
+      }
+      return;
+    }
+    // classify suffixes as L-type (false) or S-type (true)
+    std::vector< bool > sType(n, false);
+    for (size_t i = n - 1; i-- > 0; ) {
+      if (s[i] == s[i + 1])
+        sType[i] = sType[i + 1];
+      else
+        sType[i] = (s[i] < s[i + 1]);
+    }
+    // calculate the start positions of the L-type and S-type part of
+    // each bucket
+    std::vector< unsigned int > lBucket(maxValue + 2, 0U);
+    std::vector< unsigned int > sBucket(maxValue + 2, 0U);
+    std::vector< unsigned int > tmpBucket(maxValue + 2, 0U);
+    for (size_t i = 0; i < n; i++) {
+      if (!sType[i])
+        sBucket[size_t(s[i])]++;
+      else
+        lBucket[size_t(s[i]) + 1]++;
+    }
+    for (size_t i = 0; i <= maxValue; i++) {
+      sBucket[i] += lBucket[i];
+      lBucket[i + 1] += sBucket[i];
+    }
+    // find leftmost S-type positions, and sort them
+    std::vector< unsigned int > lmsNum(n, 0xFFFFFFFFU);
+    std::vector< unsigned int > lmsPos;
+    for (size_t i = 1; i < n; i++) {
+      if (!sType[i - 1] && sType[i]) {
+        lmsNum[i] = (unsigned int) lmsPos.size();
+        lmsPos.push_back((unsigned int) i);
+      }
+    }
+    size_t  m = lmsPos.size();
+    size_t  bytesAllocated = (n >> 3) + ((maxValue + 2) * 12) + (n * 4)
+                             + (lmsPos.capacity() * 4) + (m * 16);
+    memUsed += bytesAllocated;
+    memPeak = (memUsed > memPeak ? memUsed : memPeak);
+    induceSortSuffixes(sa, s, n, sType, lmsPos, lBucket, sBucket, tmpBucket);
+    if (m > 0) {
+      // name the sorted LMS substrings, and sort them recursively
+      // if they are not unique
+      std::vector< unsigned int > sortedLMS;
+      sortedLMS.reserve(m);
+      for (size_t i = 0; i < n; i++) {
+        if (lmsNum[sa[i]] != 0xFFFFFFFFU)
+          sortedLMS.push_back(sa[i]);
+      }
+      std::vector< unsigned int > lmsNames(m, 0U);
+      unsigned int  maxName = 0U;
+      for (size_t i = 1; i < m; i++) {
+        size_t  p1 = sortedLMS[i - 1];
+        size_t  p2 = sortedLMS[i];
+        size_t  n1 = lmsNum[p1] + 1U;
+        size_t  n2 = lmsNum[p2] + 1U;
+        size_t  endPos1 = (n1 < m ? size_t(lmsPos[n1]) : n);
+        size_t  endPos2 = (n2 < m ? size_t(lmsPos[n2]) : n);
+        bool    isEqual = false;
+        if ((endPos1 - p1) == (endPos2 - p2)) {
+          for ( ; p1 < endPos1 && s[p1] == s[p2]; p1++, p2++)
+            ;
+          isEqual = (p1 < n && p2 < n && s[p1] == s[p2]);
+        }
+        if (!isEqual)
+          maxName++;
+        lmsNames[lmsNum[sortedLMS[i]]] = maxName;
+      }
+      if (size_t(maxName) + 1 < m) {
+        suffixArraySAIS(&(sortedLMS.front()), &(lmsNames.front()), m,
+                        size_t(maxName), memUsed, memPeak);
+      }
+      else {
+        for (size_t i = 0; i < m; i++)
+          sortedLMS[lmsNames[i]] = (unsigned int) i;
+      }
+      for (size_t i = 0; i < m; i++)
+        sortedLMS[i] = lmsPos[sortedLMS[i]];
+      induceSortSuffixes(sa, s, n, sType, sortedLMS,
+                         lBucket, sBucket, tmpBucket);
+    }
+    memUsed -= bytesAllocated;
+  }
+
+  LCPIntervalTree::LCPIntervalTree()
+    : nextPos(1U),
+      workspaceSize(0)
+  {
+  }
+
+  LCPIntervalTree::~LCPIntervalTree()
+  {
+  }
+
+  void LCPIntervalTree::buildTree(const unsigned char *inBuf,
+                                  size_t startPos, size_t endPos,
+                                  size_t maxLen)
+  {
+    size_t  n = endPos - startPos;
+    if (endPos < startPos || n > 0x003FFFFE || maxLen > 1023) {
+      throw Plus4Emu::Exception("LCPIntervalTree::buildTree(): "
+                                "invalid input buffer size or match length");
+    }
+    this->clear();
+    if (n < 1)
+      return;
+    const unsigned char *s = inBuf + startPos;
+    // create suffix array
+    intervals.resize(n);
+    posData.resize(n + 1);
+    size_t  memUsed = ((n * 2) + 1) * sizeof(unsigned int);
+    workspaceSize = memUsed;
+    suffixArraySAIS(&(intervals.front()), s, n, 255, memUsed, workspaceSize);
+    // calculate longest common prefix array using the algorithm by
+    // T. Kasai et al., with the lengths limited to maxLen;
+    // intervals[N] = (LCP(N - 1, N) << 22) | suffixArray[N]
+    unsigned int  *rank = &(posData.front());
+    for (size_t i = 0; i < n; i++)
+      rank[intervals[i]] = (unsigned int) i;
+    size_t  l = 0;
+    for (size_t i = 0; i < n; i++) {
+      size_t  r = rank[i];
+      if (!r) {
+        l = 0;
+        continue;
+      }
+      size_t  j = size_t(intervals[r - 1] & 0x003FFFFFU);
+      size_t  maxLen_ = n - (i > j ? i : j);
+      maxLen_ = (maxLen_ < maxLen ? maxLen_ : maxLen);
+      while (l < maxLen_ && s[i + l] == s[j + l])
+        l++;
+      intervals[r] = (unsigned int) ((l << 22) | i);
+      l = l - size_t(l > 0);
+    }
+    // enumerate the lcp-intervals by scanning the suffix and LCP arrays,
+    // using a stack of the intervals currently open (see also the paper
+    // "Replacing suffix trees with enhanced suffix arrays" by M. I.
+    // Abouelhoda et al.); the interval references overwrite the suffix
+    // array, and posData[P + 1] is set to the deepest interval containing
+    // the suffix at position P
+    std::vector< unsigned int > openIntervals(maxLen + 2, 0U);
+    unsigned int  *top = &(openIntervals.front());
+    unsigned int  prvPos = intervals[0] & 0x003FFFFFU;
+    unsigned int  nextIndex = 1U;
+    intervals[0] = 0U;
+    for (size_t i = 1; i < n; i++) {
+      unsigned int  nextPos_ = intervals[i] & 0x003FFFFFU;
+      unsigned int  nextLCP = intervals[i] & 0xFFC00000U;
+      unsigned int  topLCP = *top & 0xFFC00000U;
+      if (nextLCP > topLCP)                     // open new interval
+        *(++top) = nextLCP | (nextIndex++);
+      posData[prvPos + 1U] = *top;
+      while (nextLCP < topLCP) {
+        // close the deepest open interval
+        unsigned int  closedIndex = *(top--) & 0x003FFFFFU;
+        topLCP = *top & 0xFFC00000U;
+        if (nextLCP > topLCP) {
+          // new interval that contains the closed one
+          *(++top) = nextLCP | (nextIndex++);
+        }
+        intervals[closedIndex] = *top;
+      }
+      prvPos = nextPos_;
+    }
+    posData[prvPos + 1U] = *top;
+    for ( ; top > &(openIntervals.front()); top--)
+      intervals[*top & 0x003FFFFFU] = *(top - 1);
+    nextPos = 1U;
+  }
+
+  size_t LCPIntervalTree::findMatches(unsigned int *offsTable,
+                                      size_t maxDistance)
+  {
+    // this is based on the lcp-interval tree match finder in wimlib
+    // by Eric Biggers
+    unsigned int  curPos = nextPos++;
+    unsigned int  ref = posData[curPos];
+    unsigned int  superRef;
+    posData[curPos] = 0U;
+    // ascend until a visited interval or a child of the root is reached,
+    // and link the unvisited intervals to the current position
+    while (((superRef = intervals[ref & 0x003FFFFFU]) & 0xFFC00000U) != 0U) {
+      intervals[ref & 0x003FFFFFU] = curPos;
+      ref = superRef;
+    }
+    if (!superRef) {
+      // no matches: root, or an unvisited child of the root
+      if (ref)
+        intervals[ref & 0x003FFFFFU] = curPos;
+      return 0;
+    }
+    // ascend further indirectly, using the position links
+    size_t  maxLen = 0;
+    unsigned int  matchPos = superRef;
+    while (true) {
+      while ((superRef = posData[matchPos]) > ref)
+        matchPos = intervals[superRef & 0x003FFFFFU];
+      intervals[ref & 0x003FFFFFU] = curPos;
+      posData[matchPos] = ref;
+      if (offsTable) {
+        unsigned int  d = curPos - matchPos;
+        if (size_t(d) <= maxDistance) {
+          size_t  len = size_t(ref >> 22);
+          maxLen = (len > maxLen ? len : maxLen);
+          offsTable[len] = d - 1U;
+        }
+      }
+      if (!superRef)
+        break;
+      ref = superRef;
+      matchPos = intervals[ref & 0x003FFFFFU];
+    }
+    return maxLen;
+  }
+
+  void LCPIntervalTree::clear()
+  {
+    intervals.clear();
+    posData.clear();
+    nextPos = 1U;
+  }
+
+  // --------------------------------------------------------------------------
+
   void LZSearchTable::sortFunc(unsigned int *startPtr, unsigned int *endPtr,
                                const unsigned char *buf, size_t bufSize,
                                unsigned int *tmpBuf, size_t maxLen,
@@ -1235,6 +1518,9 @@ namespace Plus4Compress {
                                size_t lengthMaxValue, size_t maxOffs1,
                                size_t maxOffs2, size_t maxOffs)
     : rt(maxOffs << 4),
+      lcpTree(),
+      matchFinderType_(MATCH_FINDER_RADIX_TREE),
+      workspaceSize_(0),
       minLength_(uint32_t(minLength)),
       maxLength_(uint32_t(maxLength)),
       lengthMaxValue_(uint32_t(lengthMaxValue)),
@@ -1255,22 +1541,10 @@ namespace Plus4Compress {
         (maxOffs2_ > 1U ? (maxOffs2_ < maxOffs_ ? maxOffs2_ : maxOffs_) : 1U);
   }
 
-  void LZSearchTable::findMatches(const unsigned char *buf,
-                                  size_t offs_, size_t nBytes_)
+  void LZSearchTable::findMatches_RT(const unsigned char *buf,
+                                     size_t offs_, size_t nBytes_,
+                                     unsigned int *offsTable)
   {
-    if (!buf || nBytes_ < 1 ||
-        ((offs_ | nBytes_ | (offs_ + nBytes_)) & ~(size_t(0x7FFFFFFF))) != 0) {
-      throw Plus4Emu::Exception("LZSearchTable::findMatches(): "
-                                "invalid input buffer size");
-    }
-    if (matchTable.size() > 0) {
-      matchTable.clear();
-      matchTableBuf.clear();
-    }
-    matchTable.resize(nBytes_, 0xFFFFFFFFU);
-    if (matchTableBuf.capacity() < 1024)
-      matchTableBuf.reserve(1024);
-    matchTableBuf.push_back(0U);
     size_t  maxLength = maxLength_;
     unsigned int  maxOffs = maxOffs_;
     size_t  bufSize = offs_ + nBytes_;
@@ -1281,7 +1555,6 @@ namespace Plus4Compress {
     std::vector< unsigned int >   suffixArray;
     std::vector< unsigned int >   invSuffixArray;
     std::vector< unsigned short > prvMatchLenTable;
-    std::vector< unsigned int >   offsTable(maxLength + 1, maxOffs);
     // find RLE (offset = 1) matches
     for (size_t i = nBytes_; i-- > 1; ) {
       if (buf[offs_ + i] == buf[offs_ + i - 1]) {
@@ -1354,8 +1627,7 @@ namespace Plus4Compress {
           size_t  rleLen = rleLengthTable[i - offs_];
           size_t  rtLen = 0;
           if (rleLen < maxLen) {
-            rtLen = rt.findMatches(&(offsTable.front()), buf, i,
-                                   maxLen, maxOffs);
+            rtLen = rt.findMatches(offsTable, buf, i, maxLen, maxOffs);
           }
           if (rleLen > rtLen) {
             rtLen = rleLen;
@@ -1364,7 +1636,7 @@ namespace Plus4Compress {
           rt.addString(buf, i, maxLen);
           if (rtLen < rtMaxLen) {
             // all matches have already been found at this position
-            addMatches(i - offs_, &(offsTable.front()), rtLen);
+            addMatches(i - offs_, offsTable, rtLen);
             continue;
           }
           maxLen = rtLen;
@@ -1421,11 +1693,68 @@ namespace Plus4Compress {
           }
         }
         // store the matches that were found
-        addMatches(i - offs_, &(offsTable.front()), maxLen);
+        addMatches(i - offs_, offsTable, maxLen);
       }
+      size_t  workspaceSize =
+          ((rt.buf.capacity() + suffixArray.capacity()
+            + invSuffixArray.capacity()) * sizeof(unsigned int))
+          + ((prvMatchLenTable.capacity() + rleLengthTable.capacity())
+             * sizeof(unsigned short));
+      if (workspaceSize > workspaceSize_)
+        workspaceSize_ = workspaceSize;
       rt.clear();
       startPos = endPos;
     }
+  }
+
+  void LZSearchTable::findMatches_SA(const unsigned char *buf,
+                                     size_t offs_, size_t nBytes_,
+                                     unsigned int *offsTable)
+  {
+    size_t  maxOffs = maxOffs_;
+    size_t  startPos = (offs_ > maxOffs ? (offs_ - maxOffs) : 0);
+    size_t  bufSize = offs_ + nBytes_;
+    lcpTree.buildTree(buf, startPos, bufSize, maxLength_);
+    if (lcpTree.getWorkspaceSize() > workspaceSize_)
+      workspaceSize_ = lcpTree.getWorkspaceSize();
+    for (size_t i = startPos; i < offs_; i++)
+      (void) lcpTree.findMatches((unsigned int *) 0);
+    for (size_t i = offs_; i < bufSize; i++) {
+      size_t  maxLen = lcpTree.findMatches(offsTable, maxOffs);
+      addMatches(i - offs_, offsTable, maxLen);
+    }
+    lcpTree.clear();
+  }
+
+  void LZSearchTable::findMatches(const unsigned char *buf,
+                                  size_t offs_, size_t nBytes_)
+  {
+    if (!buf || nBytes_ < 1 ||
+        ((offs_ | nBytes_ | (offs_ + nBytes_)) & ~(size_t(0x7FFFFFFF))) != 0) {
+      throw Plus4Emu::Exception("LZSearchTable::findMatches(): "
+                                "invalid input buffer size");
+    }
+    if (matchTable.size() > 0) {
+      matchTable.clear();
+      matchTableBuf.clear();
+    }
+    matchTable.resize(nBytes_, 0xFFFFFFFFU);
+    if (matchTableBuf.capacity() < 1024)
+      matchTableBuf.reserve(1024);
+    matchTableBuf.push_back(0U);
+    size_t  maxLength = maxLength_;
+    workspaceSize_ = 0;
+    {
+      std::vector< unsigned int > offsTable(maxLength + 1, maxOffs_);
+      size_t  startPos = (offs_ > size_t(maxOffs_) ? (offs_ - maxOffs_) : 0);
+      if (matchFinderType_ == MATCH_FINDER_SUFFIX_ARRAY &&
+          ((offs_ + nBytes_) - startPos) <= 0x003FFFFE) {
+        findMatches_SA(buf, offs_, nBytes_, &(offsTable.front()));
+      }
+      else {
+        findMatches_RT(buf, offs_, nBytes_, &(offsTable.front()));
+      }
+    }
     // find very long matches
     size_t  lengthMaxValue = lengthMaxValue_;
     if (lengthMaxValue <= maxLength || nBytes_ < 2)
@@ -1444,6 +1773,12 @@ namespace Plus4Compress {
     }
   }
 
+  void LZSearchTable::setMatchFinderType(int n)
+  {
+    matchFinderType_ = (n == MATCH_FINDER_SUFFIX_ARRAY ?
+                        MATCH_FINDER_SUFFIX_ARRAY : MATCH_FINDER_RADIX_TREE);
+  }
+
   LZSearchTable::~LZSearchTable()
   {
   }
@@ -228,7 +228,61 @@ namespace Plus4Compress {
 
   // --------------------------------------------------------------------------
 
+  // Alternative to RadixTree, using the lcp-interval tree built from the
+  // suffix array and longest common prefix array of the whole input data.
+  // The suffix array is created with the SA-IS algorithm, so building the
+  // tree takes linear time, and matches are found in linear time in the
+  // number of matches reported. Each interval and position is stored in a
+  // single 32-bit word, limiting the input size to 0x003FFFFE bytes, and
+  // the maximum match length to 1023.
+
+  class LCPIntervalTree {
+   protected:
+    friend class LZSearchTable;
+    // Interval references are stored as (LCP << 22) | interval_index, where
+    // interval 0 with LCP = 0 is the root of the tree.
+    // intervals[N] is the reference of the parent of interval N if it has
+    // not been visited yet, or the position + 1 of the most recent suffix
+    // visited in it.
+    std::vector< unsigned int > intervals;
+    // posData[P + 1] is the reference of the first interval above the
+    // ones most recently visited by the suffix at position P
+    std::vector< unsigned int > posData;
+    unsigned int  nextPos;
+    // peak size of temporary buffers used by buildTree(), in bytes
+    size_t        workspaceSize;
+   public:
+    LCPIntervalTree();
+    ~LCPIntervalTree();
+    // builds the tree for the data in inBuf[startPos..endPos-1], with the
+    // match lengths limited to maxLen
+    void buildTree(const unsigned char *inBuf, size_t startPos, size_t endPos,
+                   size_t maxLen);
+    // writes the shortest offset - 1 of matches found to offsTable[1..maxLen]
+    // (each offset is stored only at its maximum length), and returns the
+    // maximum length; this needs to be called for each position in order,
+    // starting from the 'startPos' specified in buildTree(). If 'offsTable'
+    // is NULL, no matches are returned, only the position is skipped
+    size_t findMatches(unsigned int *offsTable,
+                       size_t maxDistance = 0xFFFFFFFFU);
+    void clear();
+    inline size_t getWorkspaceSize() const
+    {
+      return workspaceSize;
+    }
+  };
+
+  // --------------------------------------------------------------------------
+
   class LZSearchTable {
+   public:
+    enum {
+      // radix tree for short matches, and suffix array sorted with merge
+      // sort for the longer ones (this is the default)
+      MATCH_FINDER_RADIX_TREE = 0,
+      // lcp-interval tree (see LCPIntervalTree above)
+      MATCH_FINDER_SUFFIX_ARRAY = 1
+    };
    protected:
     // for each buffer position P, matchTableBuf[matchTable[P]] is the
     // first element of an array of match length/offset pairs packed in
@@ -239,6 +293,9 @@ namespace Plus4Compress {
     // space allocated for matchTable
     std::vector< unsigned int > matchTableBuf;
     RadixTree   rt;
+    LCPIntervalTree lcpTree;
+    int         matchFinderType_;
+    size_t      workspaceSize_;
     uint32_t    minLength_;
     uint32_t    maxLength_;
     uint32_t    lengthMaxValue_;
@@ -251,6 +308,10 @@ namespace Plus4Compress {
                          unsigned int *tmpBuf, size_t maxLen,
                          const unsigned short *rleLenTable);
     void addMatches(size_t bufPos, unsigned int *offsTable, size_t maxLen);
+    void findMatches_RT(const unsigned char *buf, size_t offs_, size_t nBytes_,
+                        unsigned int *offsTable);
+    void findMatches_SA(const unsigned char *buf, size_t offs_, size_t nBytes_,
+                        unsigned int *offsTable);
    public:
     // minLength:   minimum match length
     // maxLength:   maximum match length for optimal search (must be <= 1023)
@@ -267,6 +328,22 @@ namespace Plus4Compress {
     //          still searched
     // nBytes_: data size after 'offs_'
     void findMatches(const unsigned char *buf, size_t offs_, size_t nBytes_);
+    // set the algorithm to be used by findMatches() (MATCH_FINDER_RADIX_TREE
+    // or MATCH_FINDER_SUFFIX_ARRAY); the matches found are the same, except
+    // in the case of highly redundant input data with very long matches.
+    // MATCH_FINDER_SUFFIX_ARRAY falls back to the radix tree if the input
+    // data is too large
+    void setMatchFinderType(int n);
+    inline int getMatchFinderType() const
+    {
+      return matchFinderType_;
+    }
+    // returns the peak size in bytes of the temporary buffers used by the
+    // last findMatches() call, not including the match table
+    inline size_t getWorkspaceSize() const
+    {
+      return workspaceSize_;
+    }
     // Returns pointer to an array of matches found at 'bufPos', sorted
     // in descending order by length and distance. Each match is stored as
     // an unsigned integer with the length in the lower 10 bits and the
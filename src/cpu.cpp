@@ -57,6 +57,11 @@ namespace Plus4 {
       memoryReadCallbacks((M7501MemoryReadCallback *) 0),
       memoryWriteCallbacks((M7501MemoryWriteCallback *) 0),
       memoryCallbackUserData((void *) 0),
+      memoryPageTable((uint8_t **) 0),
+      memoryReadPageTable((uint8_t **) 0),
+      memoryPageDataBus(&dummyDataBus),
+      dummyDataBus(0xFF),
+      memoryCallbacksChanged(true),
       breakPointTable((uint8_t *) 0),
       breakPointCnt(0U),
       singleStepMode(0),
@@ -72,8 +77,14 @@ namespace Plus4 {
       memoryWriteCallbacks = new M7501MemoryWriteCallback[65536];
       for (size_t i = 0; i < 65536; i++)
         memoryWriteCallbacks[i] = &dummyMemoryWriteCallback;
+      memoryPageTable = new uint8_t*[768];
+      for (size_t i = 0; i < 768; i++)
+        memoryPageTable[i] = (uint8_t *) 0;
+      memoryReadPageTable = memoryPageTable;
     }
     catch (...) {
+      if (memoryPageTable)
+        delete[] memoryPageTable;
       if (memoryWriteCallbacks)
         delete[] memoryWriteCallbacks;
       if (memoryReadCallbacks)
@@ -86,6 +97,8 @@ namespace Plus4 {
   {
     if (breakPointTable)
       delete[] breakPointTable;
+    if (memoryPageTable)
+      delete[] memoryPageTable;
     if (memoryWriteCallbacks)
       delete[] memoryWriteCallbacks;
     if (memoryReadCallbacks)
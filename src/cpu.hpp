@@ -160,6 +160,18 @@ namespace Plus4 {
     M7501MemoryReadCallback   *memoryReadCallbacks;
     M7501MemoryWriteCallback  *memoryWriteCallbacks;
     void        *memoryCallbackUserData;
+    // direct pointers to 256 byte pages of plain RAM or ROM that can be
+    // accessed without calling the memory callbacks (NULL entries use the
+    // callbacks); there are two alternate sets of 256 read pages, followed
+    // by 256 write pages
+    uint8_t     **memoryPageTable;
+    // the currently selected set of read pages
+    uint8_t     **memoryReadPageTable;
+    // direct page accesses store the data bus value here, similarly to
+    // what the memory callbacks typically do
+    uint8_t     *memoryPageDataBus;
+    uint8_t     dummyDataBus;
+    bool        memoryCallbacksChanged;
     uint8_t     *breakPointTable;
     unsigned int  breakPointCnt;
     // 0: normal mode, 1: single step, 2: step over, 3: trace
@@ -174,12 +186,62 @@ namespace Plus4 {
    protected:
     inline uint8_t readMemory(uint16_t addr)
     {
+      const uint8_t *p = memoryReadPageTable[addr >> 8];
+      if (p) {
+        uint8_t value = p[addr & 0xFF];
+        *memoryPageDataBus = value;
+        return value;
+      }
       return (memoryReadCallbacks[addr](memoryCallbackUserData, addr));
     }
     inline void writeMemory(uint16_t addr, uint8_t value)
     {
+      uint8_t *p = memoryPageTable[(addr >> 8) | 0x0200];
+      if (p) {
+        *memoryPageDataBus = value;
+        p[addr & 0xFF] = value;
+        return;
+      }
       memoryWriteCallbacks[addr](memoryCallbackUserData, addr, value);
     }
+    // always calls the read callback, ignoring the page table; this should
+    // be used if the callback may read from a memory map other than the
+    // one the page table was set up for
+    inline uint8_t readMemoryCallback(uint16_t addr)
+    {
+      return (memoryReadCallbacks[addr](memoryCallbackUserData, addr));
+    }
+    // returns true if any memory callback has been changed since the
+    // last call to this function
+    inline bool checkMemoryCallbacksChanged()
+    {
+      bool    retval = memoryCallbacksChanged;
+      memoryCallbacksChanged = false;
+      return retval;
+    }
+    // set the direct pointer to page 'n' (0 to 255) of read page set 'k'
+    // (0 or 1); 'p' points to the first byte of the page, or is NULL to
+    // use the callbacks
+    inline void setMemoryReadPage(int k, uint8_t n, const uint8_t *p)
+    {
+      memoryPageTable[((unsigned int) k << 8) | (unsigned int) n] =
+          const_cast<uint8_t *>(p);
+    }
+    // select the read page set to be used (0 or 1)
+    inline void selectMemoryReadPages(int k)
+    {
+      memoryReadPageTable = &(memoryPageTable[(unsigned int) k << 8]);
+    }
+    // set the direct pointer to write page 'n' (0 to 255)
+    inline void setMemoryWritePage(uint8_t n, uint8_t *p)
+    {
+      memoryPageTable[(unsigned int) n | 0x0200U] = p;
+    }
+    // set the location where direct page accesses store the data bus value
+    inline void setMemoryPageDataBus(uint8_t *p)
+    {
+      memoryPageDataBus = (p ? p : &dummyDataBus);
+    }
    public:
     M7501();
     virtual ~M7501();
@@ -187,11 +249,16 @@ namespace Plus4 {
                                       M7501MemoryReadCallback func)
     {
       memoryReadCallbacks[addr_] = func;
+      memoryPageTable[addr_ >> 8] = (uint8_t *) 0;
+      memoryPageTable[(addr_ >> 8) | 0x0100] = (uint8_t *) 0;
+      memoryCallbacksChanged = true;
     }
     inline void setMemoryWriteCallback(uint16_t addr_,
                                        M7501MemoryWriteCallback func)
     {
       memoryWriteCallbacks[addr_] = func;
+      memoryPageTable[(addr_ >> 8) | 0x0200] = (uint8_t *) 0;
+      memoryCallbacksChanged = true;
     }
     inline void setMemoryCallbackUserData(void *userData)
     {
@@ -22,20 +22,39 @@
 
 namespace Plus4Emu {
 
+  PLUS4EMU_INLINE unsigned int Decompressor::readBit()
+  {
+    if (PLUS4EMU_UNLIKELY(shiftRegisterCnt < 1)) {
+      if (inputBufferPosition >= inputBufferSize)
+        throw Exception("unexpected end of compressed data");
+      shiftRegister = inputBuffer[inputBufferPosition++];
+      shiftRegisterCnt = 8;
+    }
+    unsigned int  retval = (unsigned int) (shiftRegister >> 7);
+    shiftRegister = (shiftRegister & 0x7F) << 1;
+    shiftRegisterCnt--;
+    return retval;
+  }
+
   unsigned int Decompressor::readBits(size_t nBits)
   {
+    // literal bytes are interleaved with the bit stream, so only the
+    // current byte can be buffered; read as many bits at once from it
+    // as possible
     unsigned int  retval = 0U;
-    for (size_t i = 0; i < nBits; i++) {
-      if (PLUS4EMU_UNLIKELY(!(shiftRegister & 0x7F))) {
+    while (nBits > 0) {
+      if (shiftRegisterCnt < 1) {
         if (inputBufferPosition >= inputBufferSize)
           throw Exception("unexpected end of compressed data");
         shiftRegister = inputBuffer[inputBufferPosition++];
-        retval = (retval << 1) | ((shiftRegister >> 7) & 0x01);
-        shiftRegister = (shiftRegister << 1) | 0x01;
-        continue;
+        shiftRegisterCnt = 8;
       }
-      retval = (retval << 1) | ((shiftRegister >> 7) & 0x01);
-      shiftRegister = shiftRegister << 1;
+      int     n = (nBits < size_t(shiftRegisterCnt) ?
+                   int(nBits) : shiftRegisterCnt);
+      retval = (retval << n) | (unsigned int) (shiftRegister >> (8 - n));
+      shiftRegister = (unsigned char) ((unsigned int) shiftRegister << n);
+      shiftRegisterCnt = shiftRegisterCnt - n;
+      nBits = nBits - size_t(n);
     }
     return retval;
   }
@@ -49,10 +68,10 @@ namespace Plus4Emu {
 
   unsigned int Decompressor::readMatchLength()
   {
-    if (!readBits(1))
+    if (!readBit())
       return 0x80000001U;                       // literal byte
     unsigned char slotNum = 0;
-    while (readBits(1) != 0U) {
+    while (readBit() != 0U) {
       if (++slotNum >= 8)
         return (readBits(8) + 0x80000011U);     // literal sequence
     }
@@ -98,26 +117,40 @@ namespace Plus4Emu {
       buf.reserve(((buf.size() + (buf.size() >> 2)) | 0xFFFF) + 1);
     unsigned int  nSymbols = readBits(16) + 1U;
     bool    isLastBlock = readBits(1);
+    // a block is at most 64K bytes, so the output buffer is extended by
+    // that size in advance, and truncated to the actual size at the end
+    size_t  startPos = buf.size();
+    size_t  blockSize = 0;
+    buf.resize(startPos + 65536);
+    unsigned char *outPtr = &(buf.front()) + startPos;
     if (!readBits(1)) {
       // compression disabled: copy literal data
-      do {
-        buf.push_back(readLiteralByte());
-      } while (--nSymbols);
+      if ((inputBufferSize - inputBufferPosition) < size_t(nSymbols))
+        throw Exception("unexpected end of compressed data");
+      std::memcpy(outPtr, inputBuffer + inputBufferPosition, nSymbols);
+      inputBufferPosition = inputBufferPosition + nSymbols;
+      blockSize = nSymbols;
     }
     else {
       readDecodeTables();
-      size_t  blockSize = 0;
       do {
         unsigned int  matchLength = readMatchLength();
+        size_t  writePos = blockSize;
         blockSize += size_t(matchLength & 0x7FFFFFFFU);
         if (PLUS4EMU_UNLIKELY(blockSize > 65536))
           throw Exception("error in compressed data");
         if (matchLength >= 0x80000000U) {
           // literal sequence
           matchLength &= 0x7FFFFFFFU;
-          do {
-            buf.push_back(readLiteralByte());
-          } while (--matchLength);
+          if (matchLength == 1U) {
+            outPtr[writePos] = readLiteralByte();
+            continue;
+          }
+          if ((inputBufferSize - inputBufferPosition) < size_t(matchLength))
+            throw Exception("unexpected end of compressed data");
+          std::memcpy(outPtr + writePos, inputBuffer + inputBufferPosition,
+                      matchLength);
+          inputBufferPosition = inputBufferPosition + matchLength;
         }
         else {
           // get match offset:
@@ -135,16 +168,25 @@ namespace Plus4Emu {
                        (unsigned char) readBits(offs3PrefixSize),
                        &(offs3DecodeTable[0]));
           }
-          if (offs > buf.size())
+          if (offs > (startPos + writePos))
             throw Exception("error in compressed data");
-          size_t  lzMatchReadPos = buf.size() - offs;
-          do {
-            buf.push_back(buf[lzMatchReadPos]);
-            lzMatchReadPos++;
-          } while (--matchLength);
+          // copy match, 8 bytes at a time if it does not overlap with
+          // the output within 8 bytes
+          unsigned char *p = outPtr + writePos;
+          const unsigned char *q = p - offs;
+          if (offs >= 8U) {
+            for ( ; matchLength >= 8U; matchLength -= 8U) {
+              std::memcpy(p, q, 8);
+              p = p + 8;
+              q = q + 8;
+            }
+          }
+          for ( ; matchLength > 0U; matchLength--)
+            *(p++) = *(q++);
         }
       } while (--nSymbols);
     }
+    buf.resize(startPos + blockSize);
     if (buf.size() > 0x04000000)
       throw Exception("error in compressed data");
     return isLastBlock;
@@ -152,7 +194,8 @@ namespace Plus4Emu {
 
   Decompressor::Decompressor()
     : offs3PrefixSize(2),
-      shiftRegister(0x80),
+      shiftRegister(0x00),
+      shiftRegisterCnt(0),
       inputBuffer((unsigned char *) 0),
       inputBufferSize(0),
       inputBufferPosition(0)
@@ -183,14 +226,14 @@ namespace Plus4Emu {
     inputBuffer = inBuf;
     inputBufferSize = inBufSize;
     inputBufferPosition = 1;
-    shiftRegister = 0x80;
+    shiftRegister = 0x00;
+    shiftRegisterCnt = 0;
     while (!decompressDataBlock(outBuf))
       ;
-    // on successful decompression, all input data must be consumed
-    if (!(inputBufferPosition >= inputBufferSize &&
-          !(shiftRegister & (shiftRegister - 1)))) {
+    // on successful decompression, all input data must be consumed,
+    // and the unused bits of the last byte must be zero
+    if (!(inputBufferPosition >= inputBufferSize && shiftRegister == 0x00))
       throw Exception("error in compressed data");
-    }
   }
 
   // --------------------------------------------------------------------------
@@ -21,7 +21,9 @@
 #define PLUS4EMU_DECOMPM2_HPP
 
 #include "plus4emu.hpp"
+#include "system.hpp"
 #include <vector>
+#include <list>
 
 namespace Plus4Emu {
 
@@ -33,10 +35,12 @@ namespace Plus4Emu {
     unsigned int  offs3DecodeTable[32 * 2];
     size_t        offs3PrefixSize;
     unsigned char shiftRegister;
+    int           shiftRegisterCnt;
     const unsigned char *inputBuffer;
     size_t        inputBufferSize;
     size_t        inputBufferPosition;
     // --------
+    PLUS4EMU_INLINE unsigned int readBit();
     unsigned int readBits(size_t nBits);
     unsigned char readLiteralByte();
     // returns LZ match length (1..65535),
@@ -61,6 +65,79 @@ namespace Plus4Emu {
   extern void compressData(std::vector< unsigned char >& outBuf,
                            const unsigned char *inBuf, size_t inBufSize);
 
+  // --------------------------------------------------------------------------
+
+  struct StreamCompressorJob;
+  class StreamCompressorThread;
+
+  /*!
+   * Compresses data in the same format as compressData(), with the input
+   * written and the output read in chunks of any size. The input is split
+   * into 128 KB segments, which are compressed in parallel, and the output
+   * of each segment is available from readData() as soon as it and all
+   * the previous segments are done. writeData() blocks while too many
+   * segments are being compressed, so the memory used does not depend on
+   * the total data size.
+   * The first byte of the output is a checksum of all the remaining bytes;
+   * readData() returns it as zero, and the correct value can be queried
+   * with getChecksum() after finish() and reading all data.
+   */
+  class StreamCompressor {
+   private:
+    std::vector< StreamCompressorThread * > threads;
+    // segments being compressed, in the order of the input data
+    std::list< StreamCompressorJob * >      jobs;
+    Mutex         mutex;
+    ThreadLock    jobDoneLock;
+    size_t        maxThreads;
+    size_t        maxJobs;
+    std::vector< unsigned char >  prvSegment;
+    std::vector< unsigned char >  curSegment;
+    // compressed data not read yet
+    std::vector< unsigned char >  outBuf;
+    size_t        outBufReadCnt;
+    size_t        savedBufPos;
+    unsigned char shiftReg;
+    bool          finishFlag;
+    // checksumTable[N] is the checksum state that results in N after the
+    // bytes read so far
+    unsigned char checksumTable[256];
+    // --------
+    void submitSegment(bool isLastSegment);
+    // start waiting jobs on idle threads, and pack the output of the ones
+    // that are done; if 'maxJobCnt' is less than the number of jobs, wait
+    // until enough jobs are finished
+    void processJobs(size_t maxJobCnt);
+    void packOutputData(const std::vector< unsigned int >& buf);
+    void flushOutputData();
+    void stopThreads();
+   public:
+    /*!
+     * Create compressor using up to 'nThreads' threads; if 'nThreads' is
+     * zero, the number of processors is used.
+     */
+    StreamCompressor(int nThreads = 0);
+    virtual ~StreamCompressor();
+    /*!
+     * Add 'nBytes' bytes of input data.
+     */
+    void writeData(const unsigned char *buf, size_t nBytes);
+    /*!
+     * Compress any remaining input data, and end the compressed stream.
+     * writeData() cannot be called after this.
+     */
+    void finish();
+    /*!
+     * Append the compressed data available so far to 'buf', and return
+     * the number of bytes added.
+     */
+    size_t readData(std::vector< unsigned char >& buf);
+    /*!
+     * Returns the correct value of the first output byte.
+     */
+    unsigned char getChecksum() const;
+  };
+
 }       // namespace Plus4Emu
 
 #endif  // PLUS4EMU_DECOMPM2_HPP
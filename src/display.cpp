@@ -219,6 +219,11 @@ namespace Plus4Emu {
     (void) isEnabled;
   }
 
+  void VideoDisplay::syncToDisplay(bool isEnabled)
+  {
+    (void) isEnabled;
+  }
+
   // --------------------------------------------------------------------------
 
   template <>
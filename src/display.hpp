@@ -130,6 +130,31 @@ namespace Plus4Emu {
      * maximum of 50.
      */
     virtual void limitFrameRate(bool isEnabled);
+    /*!
+     * If enabled, sendVideoOutput() waits at the end of each frame until
+     * the display has caught up, so that the emulation is synchronized to
+     * the display refresh rate.
+     */
+    virtual void syncToDisplay(bool isEnabled);
+    /*!
+     * Calculate a hash of 'nBytes' bytes of video data for one line, which
+     * is used to detect lines that have not changed since the previous
+     * frame. 'buf' must be aligned to a 32-bit boundary, and 'seed' should
+     * be derived from any other line parameters that affect decoding.
+     * The return value is always odd.
+     */
+    static inline uint32_t calculateLineHash(const uint8_t *buf, size_t nBytes,
+                                             uint32_t seed)
+    {
+      const uint32_t  *p = reinterpret_cast<const uint32_t *>(buf);
+      uint32_t  h = (seed ^ uint32_t(nBytes)) * 0x9E3779B1U;
+      size_t    n = nBytes >> 2;
+      for (size_t i = 0; i < n; i++)
+        h = (((h << 7) | (h >> 25)) ^ p[i]) * 0x9E3779B1U;
+      for (size_t i = (n << 2); i < nBytes; i++)
+        h = (((h << 7) | (h >> 25)) ^ uint32_t(buf[i])) * 0x9E3779B1U;
+      return ((h ^ (h >> 16)) | 1U);
+    }
   };
 
   template <typename T>
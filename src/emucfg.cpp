@@ -93,6 +93,9 @@ namespace Plus4Emu {
     defineConfigurationVariable(*this, "vm.speedPercentage",
                                 vm.speedPercentage, 100U,
                                 soundSettingsChanged, 0.0, 1000.0);
+    defineConfigurationVariable(*this, "vm.syncMode",
+                                vm.syncMode, int(0),
+                                soundSettingsChanged, 0.0, 2.0);
     defineConfigurationVariable(*this, "vm.serialBusDelayOffset",
                                 vm.serialBusDelayOffset, int(0),
                                 vmConfigurationChanged, -100.0, 100.0);
@@ -483,6 +486,9 @@ namespace Plus4Emu {
     if (soundSettingsChanged) {
       bool    soundEnableFlag = (sound.enabled && vm.speedPercentage == 100U);
       videoDisplay.limitFrameRate(vm.speedPercentage == 0U);
+      videoDisplay.syncToDisplay(vm.syncMode == 1 &&
+                                 vm.speedPercentage == 100U);
+      audioOutput.setRateControlEnabled(vm.syncMode != 0);
       vm_.setEnableAudioOutput(soundEnableFlag);
       if (!soundEnableFlag) {
         // close device if sound is disabled
@@ -44,6 +44,13 @@ namespace Plus4Emu {
       unsigned int  cpuClockFrequency;
       unsigned int  videoClockFrequency;
       unsigned int  speedPercentage;    // NOTE: this uses soundSettingsChanged
+      // clock the emulation is synchronized to at 100% speed (uses
+      // soundSettingsChanged):
+      //   0: audio output (if sound is enabled)
+      //   1: display (the emulation waits for the display to receive each
+      //      frame, and audio is resampled to keep the latency constant)
+      //   2: timer (audio is resampled to keep the latency constant)
+      int           syncMode;
       int           serialBusDelayOffset;
       int           sidOutputVolume;
       int           processPriority;    // uses vmProcessPriorityChanged
@@ -25,6 +25,16 @@
 #include <cmath>
 #include <map>
 
+#if !defined(WIN32) && (defined(__GLIBC__) || defined(__linux__))
+#  include <stdio.h>
+#  include <sys/types.h>
+#  define PLUS4EMU_HAVE_FOPENCOOKIE   1
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+      defined(__OpenBSD__) || defined(__DragonFly__)
+#  include <stdio.h>
+#  define PLUS4EMU_HAVE_FUNOPEN       1
+#endif
+
 static const unsigned char plus4EmuFile_Magic[16] = {
   0x5D, 0x12, 0xE4, 0xF4, 0xC9, 0xDA, 0xB6, 0x42,
   0x01, 0x33, 0xDE, 0x07, 0xD2, 0x34, 0xF2, 0x22
@@ -78,20 +88,28 @@ namespace Plus4Emu {
     return uint32_t(h);
   }
 
+  class CRC32Table {
+   public:
+    uint32_t  t[256];
+    CRC32Table()
+    {
+      for (uint32_t i = 0U; i < 256U; i++) {
+        uint32_t  crc = i;
+        for (int j = 0; j < 8; j++)
+          crc = (crc >> 1) ^ ((crc & 1U) ? 0xEDB88320U : 0U);
+        t[i] = crc;
+      }
+    }
+  };
+
+  static const CRC32Table crc32Table;
+
   PLUS4EMU_REGPARM2 uint32_t File::crc_32(const unsigned char *buf,
                                           size_t nBytes)
   {
-    static const uint32_t crc32Table[4] = {
-      0x00000000U, 0x76DC4190U, 0xEDB88320U, 0x9B64C2B0U
-    };
     uint32_t  crc = ~0U;
-    for ( ; nBytes > 0; buf++, nBytes--) {
-      unsigned char c = *buf;
-      crc = (crc >> 2) ^ crc32Table[(crc ^ uint32_t(c)) & 3U];
-      crc = (crc >> 2) ^ crc32Table[(crc ^ uint32_t(c >> 2)) & 3U];
-      crc = (crc >> 2) ^ crc32Table[(crc ^ uint32_t(c >> 4)) & 3U];
-      crc = (crc >> 2) ^ crc32Table[(crc ^ uint32_t(c >> 6)) & 3U];
-    }
+    for ( ; nBytes > 0; buf++, nBytes--)
+      crc = (crc >> 8) ^ crc32Table.t[(crc ^ uint32_t(*buf)) & 0xFFU];
     return ~crc;
   }
 
@@ -507,6 +525,42 @@ namespace Plus4Emu {
       throw Exception("CRC error in file data");
   }
 
+  // compress 'nBytes' bytes of data from 'buf' to 'f', writing the output
+  // as it becomes available; the checksum at the beginning of the file is
+  // updated at the end. Returns false on write errors
+
+  static bool writeCompressedFile(std::FILE *f,
+                                  const unsigned char *buf, size_t nBytes)
+  {
+    StreamCompressor  compressor;
+    std::vector< unsigned char >  tmpBuf;
+    bool    err = false;
+    for (size_t i = 0; i <= nBytes; ) {
+      if (i < nBytes) {
+        size_t  n = nBytes - i;
+        n = (n < 0x00010000 ? n : 0x00010000);
+        compressor.writeData(buf + i, n);
+        i = i + n;
+      }
+      else {
+        compressor.finish();
+        i++;
+      }
+      if (compressor.readData(tmpBuf) > 0) {
+        if (std::fwrite(&(tmpBuf.front()),
+                        sizeof(unsigned char), tmpBuf.size(), f)
+            != tmpBuf.size()) {
+          err = true;
+        }
+        tmpBuf.clear();
+      }
+    }
+    unsigned char c = compressor.getChecksum();
+    if (std::fseek(f, 0L, SEEK_SET) < 0 || std::fputc(c, f) == EOF)
+      err = true;
+    return !err;
+  }
+
   void File::writeFile(const char *fileName, bool useHomeDirectory,
                        bool enableCompression)
   {
@@ -530,20 +584,6 @@ namespace Plus4Emu {
     buf.writeUInt32(uint32_t(PLUS4EMU_CHUNKTYPE_END_OF_FILE));
     buf.writeUInt32(0U);
     buf.writeUInt32(hash_32(buf.getData() + startPos, 8));
-    if (enableCompression) {
-      try {
-        std::vector< unsigned char >  tmpBuf;
-        compressData(tmpBuf, buf.getData(), startPos + 12);
-        buf.clear();
-        buf.setPosition(tmpBuf.size());
-        std::memcpy(const_cast< unsigned char * >(buf.getData()),
-                    &(tmpBuf.front()), tmpBuf.size());
-      }
-      catch (...) {
-        buf.clear();
-        throw Exception("error compressing file");
-      }
-    }
     if (fileName != (char*) 0 && fileName[0] != '\0') {
       std::string fullName;
       if (useHomeDirectory)
@@ -552,13 +592,27 @@ namespace Plus4Emu {
         fullName = fileName;
       std::FILE *f = fileOpen(fullName.c_str(), "wb");
       if (f) {
-        err = !(enableCompression ||
-                std::fwrite(&(plus4EmuFile_Magic[0]), 1, 16, f) == 16);
-        if (!err) {
-          if (std::fwrite(buf.getData(),
-                          sizeof(unsigned char), buf.getDataSize(), f)
-              != buf.getDataSize()) {
-            err = true;
+        if (enableCompression) {
+          // the compressed data is written directly to the file, so that
+          // it does not need to be stored in memory
+          try {
+            err = !writeCompressedFile(f, buf.getData(), startPos + 12);
+          }
+          catch (...) {
+            std::fclose(f);
+            fileRemove(fullName.c_str());
+            buf.clear();
+            throw Exception("error compressing file");
+          }
+        }
+        else {
+          err = (std::fwrite(&(plus4EmuFile_Magic[0]), 1, 16, f) != 16);
+          if (!err) {
+            if (std::fwrite(buf.getData(),
+                            sizeof(unsigned char), buf.getDataSize(), f)
+                != buf.getDataSize()) {
+              err = true;
+            }
           }
         }
         if (std::fclose(f) != 0)
@@ -742,39 +796,55 @@ namespace Plus4Emu {
     return n;
   }
 
-  PLUS4EMU_INLINE unsigned int ZIPFile::readBit()
+  void ZIPFile::fillBitBuffer()
   {
-    if (PLUS4EMU_UNLIKELY(shiftRegisterCnt < 1)) {
-      shiftRegister = readByte();
-      shiftRegisterCnt = 8;
+    if ((inBufPos + 8) <= inBuf.size()) {
+      const unsigned char *p = &(inBuf.front()) + inBufPos;
+      do {
+        bitBuf = bitBuf | (uint64_t(*(p++)) << bitCnt);
+        bitCnt = bitCnt + 8U;
+      } while (bitCnt <= 56U);
+      inBufPos = size_t(p - &(inBuf.front()));
+      return;
     }
-    unsigned int  retval = (unsigned int) (shiftRegister & 0x01);
-    shiftRegister = shiftRegister >> 1;
-    shiftRegisterCnt--;
-    return retval;
+    // near the end of the input buffer, pad with at most 8 zero bytes;
+    // releaseBitBuffer() checks if any of these were actually used
+    do {
+      unsigned char c = 0x00;
+      if (inBufPos < inBuf.size())
+        c = inBuf[inBufPos];
+      else if (inBufPos >= (inBuf.size() + 8))
+        throw Exception("unexpected end of file");
+      inBufPos++;
+      bitBuf = bitBuf | (uint64_t(c) << bitCnt);
+      bitCnt = bitCnt + 8U;
+    } while (bitCnt <= 56U);
   }
 
-  unsigned int ZIPFile::readBits(size_t nBits)
+  void ZIPFile::releaseBitBuffer()
   {
-    unsigned int  retval = 0U;
-    for (unsigned char i = 0; i < (unsigned char) nBits; ) {
-      if (PLUS4EMU_UNLIKELY(shiftRegisterCnt < 1)) {
-        shiftRegister = readByte();
-        shiftRegisterCnt = 8;
-      }
-      unsigned char n = (unsigned char) nBits - i;
-      if (n > (unsigned char) shiftRegisterCnt)
-        n = (unsigned char) shiftRegisterCnt;
-      retval |= (((unsigned int) shiftRegister & ((1U << n) - 1U)) << i);
-      shiftRegister = shiftRegister >> n;
-      shiftRegisterCnt = shiftRegisterCnt - n;
-      i = i + n;
-    }
+    // discard any remaining bits of the current byte, and return the
+    // unused whole bytes to the input buffer
+    inBufPos = inBufPos - size_t(bitCnt >> 3);
+    bitBuf = 0U;
+    bitCnt = 0U;
+    if (inBufPos > inBuf.size())
+      throw Exception("unexpected end of file");
+  }
+
+  PLUS4EMU_INLINE unsigned int ZIPFile::readBits(unsigned int nBits)
+  {
+    if (PLUS4EMU_UNLIKELY(bitCnt < nBits))
+      fillBitBuffer();
+    unsigned int  retval = (unsigned int) bitBuf & ((1U << nBits) - 1U);
+    bitBuf = bitBuf >> nBits;
+    bitCnt = bitCnt - nBits;
     return retval;
   }
 
-  unsigned int ZIPFile::huffmanDecode(int huffTable)
+  unsigned int ZIPFile::huffmanDecodeSlow(int huffTable)
   {
+    // decode codes not found in the lookup table one bit at a time
     int     tmp = 0;
     int     cnt = -1;
     const unsigned int  *symCntTable =
@@ -786,14 +856,33 @@ namespace Plus4Emu {
     do {
       if (++cnt >= 15)
         throw Plus4Emu::Exception("error in compressed data");
-      tmp = ((tmp << 1) | int(readBit())) - int(symCntTable[cnt]);
+      tmp = ((tmp << 1) | int((unsigned int) (bitBuf >> cnt) & 1U))
+            - int(symCntTable[cnt]);
     } while (tmp >= 0);
     tmp = tmp + int(offsetTable[cnt]);
     if (decodeTable[tmp] == 0xFFFFFFFFU)
       throw Plus4Emu::Exception("error in compressed data");
+    bitBuf = bitBuf >> (cnt + 1);
+    bitCnt = bitCnt - (unsigned int) (cnt + 1);
     return decodeTable[tmp];
   }
 
+  PLUS4EMU_INLINE unsigned int ZIPFile::huffmanDecode(int huffTable)
+  {
+    if (PLUS4EMU_UNLIKELY(bitCnt < 15U))
+      fillBitBuffer();
+    unsigned int  c;
+    if (huffTable == 0)
+      c = huffmanFastTable0[(unsigned int) bitBuf & 0x03FFU];
+    else
+      c = huffmanFastTable1[(unsigned int) bitBuf & 0x01FFU];
+    if (PLUS4EMU_UNLIKELY(!c))
+      return huffmanDecodeSlow(huffTable);
+    bitBuf = bitBuf >> (c & 15U);
+    bitCnt = bitCnt - (c & 15U);
+    return (c >> 4);
+  }
+
   void ZIPFile::buildDecodeTable(int huffTable,
                                  const unsigned char *lenBuf, size_t nSymbols)
   {
@@ -826,6 +915,37 @@ namespace Plus4Emu {
         offsetTable[len] = offs + 1U;
       }
     }
+    // build lookup table for the short codes
+    unsigned int  *fastTable =
+        (huffTable == 0 ? huffmanFastTable0 : huffmanFastTable1);
+    unsigned int  fastBits = (huffTable == 0 ? 10U : 9U);
+    for (unsigned int i = 0U; i < (1U << fastBits); i++)
+      fastTable[i] = 0U;
+    unsigned int  nextCode[16];
+    {
+      unsigned int  code = 0U;
+      for (unsigned int i = 1U; i <= 15U; i++) {
+        code = (code + (i > 1U ? symCntTable[i - 2U] : 0U)) << 1;
+        nextCode[i] = code;
+      }
+    }
+    for (size_t i = 0; i < nSymbols; i++) {
+      unsigned int  len = lenBuf[i];
+      if (!len)
+        continue;
+      unsigned int  code = nextCode[len];
+      nextCode[len] = code + 1U;
+      if (code >= (1U << len))          // over-subscribed code lengths
+        throw Plus4Emu::Exception("error in compressed data");
+      if (len > fastBits)
+        continue;
+      // Huffman codes are stored in the input stream MSB first
+      unsigned int  n = 0U;
+      for (unsigned int j = 0U; j < len; j++)
+        n = n | (((code >> j) & 1U) << (len - (j + 1U)));
+      for ( ; n < (1U << fastBits); n = n + (1U << len))
+        fastTable[n] = ((unsigned int) i << 4) | len;
+    }
   }
 
   void ZIPFile::huffmanInit(unsigned char blockType)
@@ -890,37 +1010,47 @@ namespace Plus4Emu {
   bool ZIPFile::decompressDataBlock(std::vector< unsigned char >& buf)
   {
     static const size_t maxDataSize = 0x04000000;
-    bool    isLastBlock = bool(readBit());
+    bool    isLastBlock = bool(readBits(1));
     unsigned char blockType = (unsigned char) readBits(2);
     if (blockType == 3)
       throw Plus4Emu::Exception("error in compressed data");
-    if ((buf.size() + 65536) > buf.capacity())
-      buf.reserve(((buf.size() + (buf.size() >> 2)) | 0xFFFF) + 1);
     if (!blockType) {
       // uncompressed data
-      shiftRegisterCnt = 0;
+      (void) readBits(bitCnt & 7U);
+      releaseBitBuffer();
       unsigned int  blockSize = readUInt32();
       blockSize = blockSize ^ ((~blockSize & 0xFFFFU) << 16);
       if (!(blockSize >= 1U && blockSize <= 0xFFFFU))
         throw Plus4Emu::Exception("error in compressed data");
-      do {
-        if (PLUS4EMU_UNLIKELY(buf.size() >= maxDataSize))
-          throw Plus4Emu::Exception("error in compressed data");
-        buf.push_back((unsigned char) readByte());
-      } while (--blockSize);
+      if (size_t(blockSize) > (inBuf.size() - inBufPos))
+        throw Exception("unexpected end of file");
+      if (PLUS4EMU_UNLIKELY((buf.size() + size_t(blockSize)) > maxDataSize))
+        throw Plus4Emu::Exception("error in compressed data");
+      buf.insert(buf.end(), inBuf.begin() + inBufPos,
+                 inBuf.begin() + (inBufPos + size_t(blockSize)));
+      inBufPos = inBufPos + size_t(blockSize);
       return isLastBlock;
     }
     huffmanInit(blockType);
+    // the output buffer is extended in large steps, 'outPos' is the actual
+    // size of the uncompressed data
+    size_t  outPos = buf.size();
     unsigned int  prvDistance = 0U;
     while (true) {
+      if (PLUS4EMU_UNLIKELY((outPos + 258) > buf.size())) {
+        size_t  newSize = ((outPos + (outPos >> 1)) | 0xFFFF) + 1;
+        if (newSize > (maxDataSize + 258))
+          newSize = maxDataSize + 258;
+        buf.resize(newSize);
+      }
       unsigned int  c = huffmanDecode(0);
       if (c == 0x0100U)
         break;
       if (c < 0x0100U) {
         // literal character
-        if (PLUS4EMU_UNLIKELY(buf.size() >= maxDataSize))
+        if (PLUS4EMU_UNLIKELY(outPos >= maxDataSize))
           throw Plus4Emu::Exception("error in compressed data");
-        buf.push_back((unsigned char) c);
+        buf[outPos++] = (unsigned char) c;
         continue;
       }
       // decode length:
@@ -961,15 +1091,28 @@ namespace Plus4Emu {
           d = ((((c & 1U) | 2U) << nBits) | readBits(nBits)) + 1U;
         }
       }
-      if (!(d > 0U && d <= (unsigned int) buf.size()))
+      if (!(d > 0U && size_t(d) <= outPos))
         throw Plus4Emu::Exception("error in compressed data");
       prvDistance = d;
-      if (PLUS4EMU_UNLIKELY((buf.size() + size_t(len)) > maxDataSize))
+      if (PLUS4EMU_UNLIKELY((outPos + size_t(len)) > maxDataSize))
         throw Plus4Emu::Exception("error in compressed data");
-      do {
-        buf.push_back(buf[buf.size() - size_t(d)]);
-      } while (--len);
+      unsigned char *dstPtr = &(buf.front()) + outPos;
+      const unsigned char *srcPtr = dstPtr - d;
+      outPos = outPos + size_t(len);
+      if (d >= len) {
+        std::memcpy(dstPtr, srcPtr, len);
+      }
+      else if (d == 1U) {
+        std::memset(dstPtr, *srcPtr, len);
+      }
+      else {
+        // overlapping copy
+        do {
+          *(dstPtr++) = *(srcPtr++);
+        } while (--len);
+      }
     }
+    buf.resize(outPos);
     return isLastBlock;
   }
 
@@ -981,10 +1124,12 @@ namespace Plus4Emu {
       huffmanSymCntTable1((unsigned int *) 0),
       huffmanOffsetTable1((unsigned int *) 0),
       huffmanDecodeTable1((unsigned int *) 0),
-      shiftRegister(0x00),
-      shiftRegisterCnt(0)
+      huffmanFastTable0((unsigned int *) 0),
+      huffmanFastTable1((unsigned int *) 0),
+      bitBuf(0U),
+      bitCnt(0U)
   {
-    size_t  totalTableSize = 15 + 15 + 288 + 15 + 15 + 32;
+    size_t  totalTableSize = 15 + 15 + 288 + 15 + 15 + 32 + 1024 + 512;
     huffmanSymCntTable0 = new unsigned int[totalTableSize];
     for (size_t i = 0; i < totalTableSize; i++)
       huffmanSymCntTable0[i] = 0U;
@@ -993,6 +1138,8 @@ namespace Plus4Emu {
     huffmanSymCntTable1 = &(huffmanDecodeTable0[288]);
     huffmanOffsetTable1 = &(huffmanSymCntTable1[15]);
     huffmanDecodeTable1 = &(huffmanOffsetTable1[15]);
+    huffmanFastTable0 = &(huffmanDecodeTable1[32]);
+    huffmanFastTable1 = &(huffmanFastTable0[1024]);
 
     std::FILE *f = fileOpen(fileName, "rb");
     if (!f)
@@ -1093,11 +1240,12 @@ namespace Plus4Emu {
       }
       else if (m == 0x0008) {           // Deflate
         size_t  endPos = inBufPos + compressedSize;
-        shiftRegister = 0x00;
-        shiftRegisterCnt = 0;
+        bitBuf = 0U;
+        bitCnt = 0U;
         // decompress all data blocks
         while (!decompressDataBlock(buf))
           ;
+        releaseBitBuffer();
         // on successful decompression, all input data must be consumed
         if (inBufPos != endPos)
           throw Exception("error in compressed data");
@@ -1117,8 +1265,155 @@ namespace Plus4Emu {
 
   // --------------------------------------------------------------------------
 
+  class MemoryImageFile {
+   private:
+    std::vector< unsigned char >  buf;
+    size_t  pos;
+    MemoryImageFile(std::vector< unsigned char >& buf_)
+      : pos(0)
+    {
+      buf.swap(buf_);
+    }
+    size_t read(char *p, size_t n)
+    {
+      if (pos >= buf.size() || n < 1)
+        return 0;
+      if (n > (buf.size() - pos))
+        n = buf.size() - pos;
+      std::memcpy(p, &(buf.front()) + pos, n);
+      pos += n;
+      return n;
+    }
+    size_t write(const char *p, size_t n)
+    {
+      // writes only modify the private copy of the image data
+      if (n < 1)
+        return 0;
+      if (pos > buf.size() || n > (buf.size() - pos))
+        buf.resize(pos + n, 0x00);
+      std::memcpy(&(buf.front()) + pos, p, n);
+      pos += n;
+      return n;
+    }
+    bool seek(long& offs, int whence)
+    {
+      long    basePos = 0L;
+      if (whence == SEEK_CUR)
+        basePos = long(pos);
+      else if (whence == SEEK_END)
+        basePos = long(buf.size());
+      else if (whence != SEEK_SET)
+        return false;
+      if ((offs < 0L && (basePos + offs) < 0L) ||
+          (offs > 0L && (basePos + offs) < basePos)) {
+        return false;
+      }
+      pos = size_t(basePos + offs);
+      offs = long(pos);
+      return true;
+    }
+#ifdef PLUS4EMU_HAVE_FOPENCOOKIE
+    static ssize_t readCallback(void *userData, char *buf_, size_t n)
+    {
+      return ssize_t(reinterpret_cast< MemoryImageFile * >(userData)->read(
+                         buf_, n));
+    }
+    static ssize_t writeCallback(void *userData, const char *buf_, size_t n)
+    {
+      return ssize_t(reinterpret_cast< MemoryImageFile * >(userData)->write(
+                         buf_, n));
+    }
+    static int seekCallback(void *userData, off64_t *offs, int whence)
+    {
+      long    n = long(*offs);
+      if (off64_t(n) != *offs)
+        return -1;
+      if (!reinterpret_cast< MemoryImageFile * >(userData)->seek(n, whence))
+        return -1;
+      *offs = off64_t(n);
+      return 0;
+    }
+#elif defined(PLUS4EMU_HAVE_FUNOPEN)
+    static int readCallback(void *userData, char *buf_, int n)
+    {
+      if (n <= 0)
+        return 0;
+      return int(reinterpret_cast< MemoryImageFile * >(userData)->read(
+                     buf_, size_t(n)));
+    }
+    static int writeCallback(void *userData, const char *buf_, int n)
+    {
+      if (n <= 0)
+        return 0;
+      return int(reinterpret_cast< MemoryImageFile * >(userData)->write(
+                     buf_, size_t(n)));
+    }
+    static fpos_t seekCallback(void *userData, fpos_t offs, int whence)
+    {
+      long    n = long(offs);
+      if (fpos_t(n) != offs)
+        return fpos_t(-1);
+      if (!reinterpret_cast< MemoryImageFile * >(userData)->seek(n, whence))
+        return fpos_t(-1);
+      return fpos_t(n);
+    }
+#endif
+    static int closeCallback(void *userData)
+    {
+      delete reinterpret_cast< MemoryImageFile * >(userData);
+      return 0;
+    }
+   public:
+    static std::FILE *open(std::vector< unsigned char >& buf_);
+  };
+
+  std::FILE *MemoryImageFile::open(std::vector< unsigned char >& buf_)
+  {
+    std::FILE *f = (std::FILE *) 0;
+#if defined(PLUS4EMU_HAVE_FOPENCOOKIE) || defined(PLUS4EMU_HAVE_FUNOPEN)
+    MemoryImageFile *p = new MemoryImageFile(buf_);
+#  ifdef PLUS4EMU_HAVE_FOPENCOOKIE
+    cookie_io_functions_t   ioFuncs;
+    ioFuncs.read = &readCallback;
+    ioFuncs.write = &writeCallback;
+    ioFuncs.seek = &seekCallback;
+    ioFuncs.close = &closeCallback;
+    f = fopencookie(p, "r+b", ioFuncs);
+#  else
+    f = funopen(p, &readCallback, &writeCallback, &seekCallback,
+                &closeCallback);
+#  endif
+    if (!f) {
+      buf_.swap(p->buf);
+      delete p;
+    }
+#endif
+    if (!f) {
+      // fall back to a temporary file if memory streams are not supported
+      f = std::tmpfile();
+      if (!f ||
+          (buf_.size() > 0 &&
+           std::fwrite(&(buf_.front()), sizeof(unsigned char), buf_.size(), f)
+           != buf_.size()) ||
+          std::fflush(f) != 0 ||
+          std::fseek(f, 0L, SEEK_SET) < 0) {
+        if (f)
+          std::fclose(f);
+        return (std::FILE *) 0;
+      }
+      buf_.clear();
+    }
+    return f;
+  }
+
+  std::FILE *openMemoryFile(std::vector< unsigned char >& buf)
+  {
+    return MemoryImageFile::open(buf);
+  }
+
   std::FILE *openPlus4ImageFile(const char *fileName,
-                                int& fileType, bool& isReadOnly)
+                                int& fileType, bool& isReadOnly,
+                                std::string *imageFileName)
   {
     if (!(fileType >= 0 && fileType <= 2))
       fileType = -1;
@@ -1129,18 +1424,15 @@ namespace Plus4Emu {
       std::string s;
       if (!zipFile.getFile(buf, s, fileType))
         throw Exception("no matching file found in archive");
-      std::FILE *f = std::tmpfile();
-      if (!f ||
-          std::fwrite(&(buf.front()), sizeof(unsigned char), buf.size(), f)
-          != buf.size() ||
-          std::fflush(f) != 0 ||
-          std::fseek(f, 0L, SEEK_SET) < 0) {
-        if (f)
-          std::fclose(f);
-        throw Exception("error creating temporary file");
-      }
+      std::FILE *f = openMemoryFile(buf);
+      if (!f)
+        throw Exception("error opening image file from archive");
+      if (imageFileName)
+        (*imageFileName) = s;
       return f;
     }
+    if (imageFileName)
+      (*imageFileName) = fileName;
     std::FILE *f = (std::FILE *) 0;
     if (!isReadOnly)
       f = fileOpen(fileName, "r+b");
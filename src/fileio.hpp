@@ -138,15 +138,22 @@ namespace Plus4Emu {
     unsigned int  *huffmanSymCntTable1;
     unsigned int  *huffmanOffsetTable1;
     unsigned int  *huffmanDecodeTable1;
-    unsigned char shiftRegister;
-    int           shiftRegisterCnt;
+    // lookup tables indexed with the next 10 (main table) or 9 (distance
+    // codes) input bits, each entry is (symbol << 4) | code_length, or zero
+    // if the code is longer or invalid
+    unsigned int  *huffmanFastTable0;
+    unsigned int  *huffmanFastTable1;
+    uint64_t      bitBuf;
+    unsigned int  bitCnt;
     // --------
     unsigned char readByte();
     uint16_t readUInt16();
     uint32_t readUInt32();
-    PLUS4EMU_INLINE unsigned int readBit();
-    unsigned int readBits(size_t nBits);
-    unsigned int huffmanDecode(int huffTable);
+    void fillBitBuffer();
+    void releaseBitBuffer();
+    PLUS4EMU_INLINE unsigned int readBits(unsigned int nBits);
+    unsigned int huffmanDecodeSlow(int huffTable);
+    PLUS4EMU_INLINE unsigned int huffmanDecode(int huffTable);
     void buildDecodeTable(int huffTable,
                           const unsigned char *lenBuf, size_t nSymbols);
     void huffmanInit(unsigned char blockType);
@@ -174,13 +181,27 @@ namespace Plus4Emu {
    */
   std::FILE *createDiskImage(const char *fileName);
 
+  /*!
+   * Create a stdio stream for reading and writing the contents of 'buf',
+   * which is moved to the stream and cleared. Writes only change the private
+   * in-memory copy of the data, and are discarded when the stream is closed.
+   * If memory streams are not supported on the host system, a temporary file
+   * created with std::tmpfile() is used instead.
+   * Returns NULL on error.
+   */
+  std::FILE *openMemoryFile(std::vector< unsigned char >& buf);
+
   /*!
    * Open or create a D64, D81, TAP, PRG or P00 file. If the file name ends
    * with ".zip" (case insensitive), then the first matching file from the
-   * archive is extracted to a temporary file created with std::tmpfile().
+   * archive is uncompressed to memory, and returned as a stream created
+   * with openMemoryFile(). If 'imageFileName' is not NULL, the name of the
+   * file that has been opened (either 'fileName', or the name of the file
+   * in the archive) is stored in it.
    */
-  std::FILE *openPlus4ImageFile(const char *fileName,
-                                int& fileType, bool& isReadOnly);
+  std::FILE *openPlus4ImageFile(
+      const char *fileName, int& fileType, bool& isReadOnly,
+      std::string *imageFileName = (std::string *) 0);
 
 }       // namespace Plus4Emu
 
@@ -64,6 +64,19 @@ namespace Plus4Emu {
         Fl::awake();
         threadLock.wait(1);
       }
+      if (syncToDisplayFlag) {
+        // wait until the display has received the previous frames, but not
+        // longer than 100 ms, in case the window is not being updated
+        for (int i = 0; i < 50; i++) {
+          messageQueueMutex.lock();
+          bool    waitFlag = (framesPending > 1 && !exitFlag);
+          messageQueueMutex.unlock();
+          if (!waitFlag)
+            break;
+          Fl::awake();
+          threadLock.wait(2);
+        }
+      }
     }
   }
 
@@ -102,8 +115,14 @@ namespace Plus4Emu {
       videoResampleEnabled(false),
       exitFlag(false),
       limitFrameRateFlag(false),
+      syncToDisplayFlag(false),
       displayParameters(),
       savedDisplayParameters(),
+      inputEventTime(-1.0),
+      lastFrameTime(-1.0),
+      inputLatencySum(0.0),
+      inputLatencyMax(0.0),
+      inputLatencyCnt(0U),
       fltkEventCallback(&defaultFLTKEventCallback),
       fltkEventCallbackUserData((void *) 0),
       screenshotCallback((void (*)(void *, const unsigned char *, int, int)) 0),
@@ -160,6 +179,7 @@ namespace Plus4Emu {
 
   int FLTKDisplay_::handle(int event)
   {
+    checkInputEvent(event);
     return fltkEventCallback(fltkEventCallbackUserData, event);
   }
 
@@ -259,6 +279,7 @@ namespace Plus4Emu {
         Message_LineData  *m = nextLine;
         nextLine = (Message_LineData *) 0;
         m->lineNum = curLine;
+        m->calculateHash();
         queueMessage(m);
       }
     }
@@ -362,6 +383,40 @@ namespace Plus4Emu {
     limitFrameRateFlag = isEnabled;
   }
 
+  void FLTKDisplay_::syncToDisplay(bool isEnabled)
+  {
+    syncToDisplayFlag = isEnabled;
+  }
+
+  bool FLTKDisplay_::getInputLatencyStats(double& avgLatency,
+                                          double& maxLatency)
+  {
+    if (inputLatencyCnt < 1U) {
+      avgLatency = 0.0;
+      maxLatency = 0.0;
+      return false;
+    }
+    avgLatency = inputLatencySum / double(long(inputLatencyCnt));
+    maxLatency = inputLatencyMax;
+    inputLatencySum = 0.0;
+    inputLatencyMax = 0.0;
+    inputLatencyCnt = 0U;
+    return true;
+  }
+
+  void FLTKDisplay_::frameDisplayed()
+  {
+    // if the frame was completed after the last input event, update the
+    // input latency statistics
+    if (inputEventTime >= 0.0 && lastFrameTime > inputEventTime) {
+      double  t = latencyTimer.getRealTime() - inputEventTime;
+      inputLatencySum = inputLatencySum + t;
+      inputLatencyMax = (t > inputLatencyMax ? t : inputLatencyMax);
+      inputLatencyCnt++;
+      inputEventTime = -1.0;
+    }
+  }
+
   void FLTKDisplay_::checkScreenshotCallback()
   {
     if (!screenshotCallbackFlag)
@@ -463,7 +518,8 @@ namespace Plus4Emu {
       }
       return;
     }
-    Message *m = allocateMessage<Message_FrameDone>();
+    Message_FrameDone *m = allocateMessage<Message_FrameDone>();
+    m->timeStamp = latencyTimer.getRealTime();
     queueMessage(m);
   }
 
@@ -788,6 +844,7 @@ namespace Plus4Emu {
     if (redrawFlag) {
       redrawFlag = false;
       displayFrame();
+      frameDisplayed();
     }
   }
 
@@ -841,6 +898,7 @@ namespace Plus4Emu {
         framesPendingFlag = (framesPending > 0);
         messageQueueMutex.unlock();
         redrawFlag = true;
+        lastFrameTime = static_cast<Message_FrameDone *>(m)->timeStamp;
         deleteMessage(m);
         int     n = lastLineNum;
         prvFrameWasOdd = bool(n & 1);
@@ -890,6 +948,7 @@ namespace Plus4Emu {
 
   int FLTKDisplay::handle(int event)
   {
+    checkInputEvent(event);
     return fltkEventCallback(fltkEventCallbackUserData, event);
   }
 
@@ -59,6 +59,8 @@ namespace Plus4Emu {
       uint32_t  buf_[180];
       // number of bytes in buffer
       size_t    nBytes_;
+      // hash of the line data, flags, and line length (see calculateHash())
+      uint32_t  hash_;
      public:
       // line number
       int       lineNum;
@@ -71,6 +73,7 @@ namespace Plus4Emu {
         : Message(MsgType_LineData)
       {
         nBytes_ = 0;
+        hash_ = 0U;
         lineNum = 0;
         flags = 0x00;
         lineLength = 0;
@@ -90,9 +93,21 @@ namespace Plus4Emu {
         buf = reinterpret_cast<unsigned char *>(&(buf_[0]));
         nBytes = nBytes_;
       }
+      // should be called when the line is complete, before it is queued
+      inline void calculateHash()
+      {
+        hash_ = VideoDisplay::calculateLineHash(
+                    reinterpret_cast<unsigned char *>(&(buf_[0])), nBytes_,
+                    uint32_t(flags) | (uint32_t(lineLength) << 8));
+      }
+      inline uint32_t getHash() const
+      {
+        return hash_;
+      }
       bool operator==(const Message_LineData& r) const
       {
-        if (r.nBytes_ != nBytes_ || r.flags != this->flags)
+        if (r.hash_ != hash_ ||
+            r.nBytes_ != nBytes_ || r.flags != this->flags)
           return false;
         size_t  n = (nBytes_ + 3) >> 2;
         for (size_t i = 0; i < n; i++) {
@@ -104,8 +119,11 @@ namespace Plus4Emu {
     };
     class Message_FrameDone : public Message {
      public:
+      // time when the frame was completed (see latencyTimer)
+      double    timeStamp;
       Message_FrameDone()
-        : Message(MsgType_FrameDone)
+        : Message(MsgType_FrameDone),
+          timeStamp(0.0)
       {
       }
     };
@@ -150,6 +168,14 @@ namespace Plus4Emu {
     void checkScreenshotCallback();
     void frameDone();
     void lineDone();
+    void frameDisplayed();
+    // record the time of the first keyboard or mouse button event since
+    // the last frame was displayed, for measuring the input latency
+    inline void checkInputEvent(int event)
+    {
+      if ((event == FL_KEYDOWN || event == FL_PUSH) && inputEventTime < 0.0)
+        inputEventTime = latencyTimer.getRealTime();
+    }
     // ----------------
     Message       *messageQueue;
     Message       *lastMessage;
@@ -183,9 +209,20 @@ namespace Plus4Emu {
     volatile bool videoResampleEnabled;
     volatile bool exitFlag;
     volatile bool limitFrameRateFlag;
+    volatile bool syncToDisplayFlag;
     DisplayParameters   displayParameters;
     DisplayParameters   savedDisplayParameters;
     Timer         limitFrameRateTimer;
+    // used by both threads, and is never reset
+    Timer         latencyTimer;
+    // time of the last input event that has not been displayed yet,
+    // or -1.0 if there is none
+    double        inputEventTime;
+    // time stamp of the last frame received by checkEvents()
+    double        lastFrameTime;
+    double        inputLatencySum;
+    double        inputLatencyMax;
+    uint32_t      inputLatencyCnt;
     ThreadLock    threadLock;
     int           (*fltkEventCallback)(void *, int);
     void          *fltkEventCallbackUserData;
@@ -249,6 +286,21 @@ namespace Plus4Emu {
      * maximum of 50.
      */
     virtual void limitFrameRate(bool isEnabled);
+    /*!
+     * If enabled, sendVideoOutput() waits at the end of each frame until
+     * the display has caught up, so that the emulation is synchronized to
+     * the display refresh rate.
+     */
+    virtual void syncToDisplay(bool isEnabled);
+    /*!
+     * Store the average and maximum time (in seconds) from a keyboard or
+     * mouse button event to the display of the first frame completed after
+     * the event, since the previous call, and reset the statistics. This
+     * does not include the time the emulated program needs to respond.
+     * Returns false if there is no data, in which case both values are set
+     * to zero.
+     */
+    bool getInputLatencyStats(double& avgLatency, double& maxLatency);
    protected:
     virtual void draw();
    public:
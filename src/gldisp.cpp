@@ -153,6 +153,75 @@ static bool queryGLShaderFunctions()
 #  include "shaders.hpp"
 #endif
 
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#  define GL_PIXEL_UNPACK_BUFFER        0x88EC
+#endif
+
+#ifndef WIN32
+#  define   glBindBuffer_         glBindBuffer
+#  define   glBufferData_         glBufferData
+#  define   glDeleteBuffers_      glDeleteBuffers
+#  define   glGenBuffers_         glGenBuffers
+#  define   glMapBuffer_          glMapBuffer
+#  define   glUnmapBuffer_        glUnmapBuffer
+#else
+static PFNGLBINDBUFFERPROC      glBindBuffer_ = (PFNGLBINDBUFFERPROC) 0;
+static PFNGLBUFFERDATAPROC      glBufferData_ = (PFNGLBUFFERDATAPROC) 0;
+static PFNGLDELETEBUFFERSPROC   glDeleteBuffers_ = (PFNGLDELETEBUFFERSPROC) 0;
+static PFNGLGENBUFFERSPROC      glGenBuffers_ = (PFNGLGENBUFFERSPROC) 0;
+static PFNGLMAPBUFFERPROC       glMapBuffer_ = (PFNGLMAPBUFFERPROC) 0;
+static PFNGLUNMAPBUFFERPROC     glUnmapBuffer_ = (PFNGLUNMAPBUFFERPROC) 0;
+static bool queryGLBufferFunctions()
+{
+  glBindBuffer_ = (PFNGLBINDBUFFERPROC) wglGetProcAddress("glBindBuffer");
+  if (!glBindBuffer_)
+    return false;
+  glBufferData_ = (PFNGLBUFFERDATAPROC) wglGetProcAddress("glBufferData");
+  if (!glBufferData_)
+    return false;
+  glDeleteBuffers_ =
+      (PFNGLDELETEBUFFERSPROC) wglGetProcAddress("glDeleteBuffers");
+  if (!glDeleteBuffers_)
+    return false;
+  glGenBuffers_ = (PFNGLGENBUFFERSPROC) wglGetProcAddress("glGenBuffers");
+  if (!glGenBuffers_)
+    return false;
+  glMapBuffer_ = (PFNGLMAPBUFFERPROC) wglGetProcAddress("glMapBuffer");
+  if (!glMapBuffer_)
+    return false;
+  glUnmapBuffer_ = (PFNGLUNMAPBUFFERPROC) wglGetProcAddress("glUnmapBuffer");
+  if (!glUnmapBuffer_)
+    return false;
+  return true;
+}
+#endif
+
+// size of one pixel buffer object: 296 lines of 768 32-bit pixels
+static const size_t pixelBufferSize = 768 * 296 * 4;
+
+static bool havePixelBufferObjects()
+{
+  // pixel buffer objects are core in OpenGL 2.1, but may also be available
+  // as an extension in older versions
+  const char  *s = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+  if (!s)
+    return false;
+  int     majorVersion = 0;
+  int     minorVersion = 0;
+  if (std::sscanf(s, "%d.%d", &majorVersion, &minorVersion) != 2)
+    return false;
+  if (majorVersion < 2 || (majorVersion == 2 && minorVersion < 1)) {
+    s = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+    if (!s || !std::strstr(s, "GL_ARB_pixel_buffer_object"))
+      return false;
+  }
+#ifdef WIN32
+  if (!queryGLBufferFunctions())
+    return false;
+#endif
+  return true;
+}
+
 static void setTextureParameters(int displayQuality)
 {
   glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
@@ -355,16 +424,22 @@ namespace Plus4Emu {
       colormap16(),
       colormap32_0(),
       colormap32_1(),
-      linesChanged((bool *) 0),
+      textureLineHashes((uint32_t *) 0),
       textureSpace((unsigned char *) 0),
-      textureBuffer16((uint16_t *) 0),
-      textureBuffer32((uint32_t *) 0),
       textureID(0UL),
+      pixelBufferIndex(0),
+      pixelBufferMode(-1),
+      mappedPixelBuffer((unsigned char *) 0),
+      textureLinesUpdated((bool *) 0),
+      textureUpdateWidth(384),
+      textureLineBytes(384 * 2),
       forceUpdateLineCnt(0),
       forceUpdateLineMask(0),
       redrawFlag(false),
       yuvTextureMode(false),
       prvFrameWasOdd(false),
+      resampleTimeoutActive(false),
+      resampleIdleCnt(0),
       lastLineNum(-2),
       displayFrameRate(60.0),
       inputFrameRate(50.0),
@@ -381,14 +456,17 @@ namespace Plus4Emu {
 #endif
       for (size_t n = 0; n < 4; n++)
         frameRingBuffer[n] = (Message_LineData **) 0;
-      linesChanged = new bool[289];
-      for (size_t n = 0; n < 289; n++)
-        linesChanged[n] = false;
+      for (size_t n = 0; n < 3; n++)
+        pixelBufferIDs[n] = 0UL;
+      textureLineHashes = new uint32_t[296];
+      for (size_t n = 0; n < 296; n++)
+        textureLineHashes[n] = 0U;
+      textureLinesUpdated = new bool[296];
+      for (size_t n = 0; n < 296; n++)
+        textureLinesUpdated[n] = false;
       // max. texture size = 768x14, 32 bits
       textureSpace = new unsigned char[768 * 14 * 4];
       std::memset(textureSpace, 0, 768 * 14 * 4);
-      textureBuffer16 = reinterpret_cast<uint16_t *>(textureSpace);
-      textureBuffer32 = reinterpret_cast<uint32_t *>(textureSpace);
       for (size_t n = 0; n < 4; n++) {
         frameRingBuffer[n] = new Message_LineData*[578];
         for (size_t yc = 0; yc < 578; yc++)
@@ -396,8 +474,10 @@ namespace Plus4Emu {
       }
     }
     catch (...) {
-      if (linesChanged)
-        delete[] linesChanged;
+      if (textureLineHashes)
+        delete[] textureLineHashes;
+      if (textureLinesUpdated)
+        delete[] textureLinesUpdated;
       if (textureSpace)
         delete[] textureSpace;
       for (size_t n = 0; n < 4; n++) {
@@ -413,15 +493,17 @@ namespace Plus4Emu {
 
   OpenGLDisplay::~OpenGLDisplay()
   {
-    Fl::remove_idle(&fltkIdleCallback, (void *) this);
+    setResampleTimeout(false);
     deleteShader();
+    deletePixelBuffers();
     if (textureID) {
       GLuint  tmp = GLuint(textureID);
       textureID = 0UL;
       glDeleteTextures(1, &tmp);
     }
     delete[] textureSpace;
-    delete[] linesChanged;
+    delete[] textureLineHashes;
+    delete[] textureLinesUpdated;
     for (size_t n = 0; n < 4; n++) {
       for (size_t yc = 0; yc < 578; yc++) {
         Message *m = frameRingBuffer[n][yc];
@@ -472,12 +554,13 @@ namespace Plus4Emu {
     }
     if (displayParameters.displayQuality != dp.displayQuality ||
         displayParameters.bufferingMode != dp.bufferingMode) {
-      Fl::remove_idle(&fltkIdleCallback, (void *) this);
+      setResampleTimeout(false);
       if (displayParameters.bufferingMode != dp.bufferingMode ||
           displayParameters.displayQuality == 3 || dp.displayQuality == 3) {
         // if TV emulation (quality=3) or double buffering mode
         // has changed, also need to generate a new texture ID
         deleteShader();
+        deletePixelBuffers();
 #ifdef WIN32
         glBlendColor__ = (PFNGLBLENDCOLORPROC) 0;
 #  ifdef ENABLE_GL_SHADERS
@@ -498,7 +581,7 @@ namespace Plus4Emu {
       }
       if (dp.bufferingMode == 2) {
         videoResampleEnabled = true;
-        Fl::add_idle(&fltkIdleCallback, (void *) this);
+        setResampleTimeout(true);
         displayFrameRateTimer.reset();
         inputFrameRateTimer.reset();
       }
@@ -664,22 +747,175 @@ namespace Plus4Emu {
     }
   }
 
+  bool OpenGLDisplay::checkTextureLine(size_t n,
+                                       Message_LineData **lineBuffers_,
+                                       int lineNum)
+  {
+    // returns true if row 'n' of the texture needs to be updated,
+    // i.e. the line it would be decoded from has changed
+    uint32_t  h = 2U;
+    if (lineNum >= 0 && lineNum < 578) {
+      if (lineBuffers_[lineNum] != (Message_LineData *) 0)
+        h = lineBuffers_[lineNum]->getHash();
+      else if (lineBuffers_[lineNum ^ 1] != (Message_LineData *) 0)
+        h = lineBuffers_[lineNum ^ 1]->getHash();
+    }
+    if (h == textureLineHashes[n])
+      return false;
+    textureLineHashes[n] = h;
+    return true;
+  }
+
+  void OpenGLDisplay::deletePixelBuffers()
+  {
+    if (pixelBufferIDs[0]) {
+      if (mappedPixelBuffer) {
+        glUnmapBuffer_(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+        mappedPixelBuffer = (unsigned char *) 0;
+      }
+      GLuint  tmp[3];
+      for (int i = 0; i < 3; i++) {
+        tmp[i] = GLuint(pixelBufferIDs[i]);
+        pixelBufferIDs[i] = 0UL;
+      }
+      glDeleteBuffers_(3, &(tmp[0]));
+    }
+    pixelBufferMode = -1;
+  }
+
+  void OpenGLDisplay::beginTextureUpdate(int width)
+  {
+    // 'width' is 384 for 16-bit R5G6B5, or 768 for 32-bit texture data
+    textureUpdateWidth = width;
+    textureLineBytes = size_t(width) * (width < 768 ? 2 : 4);
+    if (PLUS4EMU_UNLIKELY(pixelBufferMode < 0)) {
+      pixelBufferMode = 0;
+      if (havePixelBufferObjects()) {
+        GLuint  tmp[3];
+        glGenBuffers_(3, &(tmp[0]));
+        for (int i = 0; i < 3; i++)
+          pixelBufferIDs[i] = (unsigned long) tmp[i];
+        pixelBufferMode = 1;
+      }
+    }
+  }
+
+  unsigned char * OpenGLDisplay::getTextureLineBuffer(size_t n, size_t n0)
+  {
+    // returns a pointer to the buffer for row 'n' of the texture; n0 is the
+    // first row of the current group of lines to be loaded
+    if (pixelBufferMode > 0) {
+      if (!mappedPixelBuffer) {
+        // use the pixel buffers in a round robin fashion, and discard the
+        // previous contents so that mapping does not wait for the GPU
+        pixelBufferIndex = (pixelBufferIndex < 2 ? (pixelBufferIndex + 1) : 0);
+        glBindBuffer_(GL_PIXEL_UNPACK_BUFFER,
+                      GLuint(pixelBufferIDs[pixelBufferIndex]));
+        glBufferData_(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(pixelBufferSize),
+                      (GLvoid *) 0, GL_STREAM_DRAW);
+        mappedPixelBuffer = reinterpret_cast<unsigned char *>(
+                                glMapBuffer_(GL_PIXEL_UNPACK_BUFFER,
+                                             GL_WRITE_ONLY));
+        if (!mappedPixelBuffer) {
+          glBindBuffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+          pixelBufferMode = 0;
+        }
+      }
+      if (mappedPixelBuffer)
+        return (mappedPixelBuffer + (n * textureLineBytes));
+    }
+    return (textureSpace + ((n - n0) * textureLineBytes));
+  }
+
+  void OpenGLDisplay::loadTextureLines(size_t n0, size_t nLines)
+  {
+    if (mappedPixelBuffer) {
+      // the lines are loaded from the pixel buffer by endTextureUpdate()
+      for (size_t i = 0; i < nLines; i++)
+        textureLinesUpdated[n0 + i] = true;
+      return;
+    }
+    if (textureUpdateWidth < 768) {
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(n0), 384, GLsizei(nLines),
+                      GL_RGB, GL_UNSIGNED_SHORT_5_6_5, textureSpace);
+    }
+    else {
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(n0), 768, GLsizei(nLines),
+                      GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, textureSpace);
+    }
+  }
+
+  void OpenGLDisplay::endTextureUpdate()
+  {
+    if (!mappedPixelBuffer)
+      return;
+    mappedPixelBuffer = (unsigned char *) 0;
+    if (glUnmapBuffer_(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+      // the contents of the buffer have been lost, need to update all lines
+      // on the next frame
+      for (size_t n = 0; n < 296; n++) {
+        textureLineHashes[n] = 0U;
+        textureLinesUpdated[n] = false;
+      }
+      glBindBuffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+      return;
+    }
+    // load each contiguous range of updated lines with a single
+    // asynchronous transfer from the pixel buffer
+    size_t  n = 0;
+    while (true) {
+      while (n < 296 && !textureLinesUpdated[n])
+        n++;
+      if (n >= 296)
+        break;
+      size_t  n0 = n;
+      do {
+        textureLinesUpdated[n++] = false;
+      } while (n < 296 && textureLinesUpdated[n]);
+      const GLvoid  *p = (const GLvoid *) (n0 * textureLineBytes);
+      if (textureUpdateWidth < 768) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(n0), 384, GLsizei(n - n0),
+                        GL_RGB, GL_UNSIGNED_SHORT_5_6_5, p);
+      }
+      else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(n0), 768, GLsizei(n - n0),
+                        GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, p);
+      }
+    }
+    glBindBuffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
   void OpenGLDisplay::drawFrame_quality0(Message_LineData **lineBuffers_,
                                          double x0, double y0,
                                          double x1, double y1, bool oddFrame_)
   {
     // half horizontal resolution, no interlace (384x288)
     // no texture filtering or effects
+    beginTextureUpdate(384);
     for (size_t yc = 0; yc < 288; yc += 8) {
+      // find the range of lines that have changed since the last update
+      size_t  firstLine = 8;
+      size_t  lastLine = 0;
       for (size_t offs = 0; offs < 8; offs++) {
+        int     lineNum = int(((yc + offs + 1) << 1) + size_t(oddFrame_));
+        if (checkTextureLine(yc + offs, lineBuffers_, lineNum)) {
+          firstLine = (firstLine < offs ? firstLine : offs);
+          lastLine = offs;
+        }
+      }
+      if (firstLine > lastLine)
+        continue;
+      for (size_t offs = firstLine; offs <= lastLine; offs++) {
         // decode video data and build 16-bit texture
-        decodeLine_quality0(&(textureBuffer16[offs * 384]), lineBuffers_,
+        unsigned char *bufp = getTextureLineBuffer(yc + offs, yc + firstLine);
+        decodeLine_quality0(reinterpret_cast<uint16_t *>(bufp), lineBuffers_,
                             ((yc + offs + 1) << 1) + size_t(oddFrame_));
       }
       // load texture
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(yc), 384, 8,
-                      GL_RGB, GL_UNSIGNED_SHORT_5_6_5, textureSpace);
+      loadTextureLines(yc + firstLine, lastLine + 1 - firstLine);
     }
+    endTextureUpdate();
     // update display
     glBegin(GL_QUADS);
     glTexCoord2f(GLfloat(0.0), GLfloat(0.0));
@@ -698,16 +934,31 @@ namespace Plus4Emu {
                                          double x1, double y1, bool oddFrame_)
   {
     // half horizontal resolution, no interlace (384x288)
+    beginTextureUpdate(384);
     for (size_t yc = 0; yc < 588; yc += 28) {
+      // find the range of lines that have changed since the last update
+      size_t  firstLine = 14;
+      size_t  lastLine = 0;
+      for (size_t offs = 0; offs < 14; offs++) {
+        if (checkTextureLine((yc >> 1) + offs, lineBuffers_,
+                             int(yc + (offs << 1) + size_t(oddFrame_)))) {
+          firstLine = (firstLine < offs ? firstLine : offs);
+          lastLine = offs;
+        }
+      }
+      if (firstLine > lastLine)
+        continue;
       // decode video data and build 16-bit texture
-      for (size_t offs = size_t(oddFrame_); offs < 28; offs += 2) {
-        decodeLine_quality0(&(textureBuffer16[(offs >> 1) * 384]),
-                            lineBuffers_, yc + offs);
+      for (size_t offs = firstLine; offs <= lastLine; offs++) {
+        unsigned char *bufp = getTextureLineBuffer((yc >> 1) + offs,
+                                                   (yc >> 1) + firstLine);
+        decodeLine_quality0(reinterpret_cast<uint16_t *>(bufp), lineBuffers_,
+                            yc + (offs << 1) + size_t(oddFrame_));
       }
       // load texture
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(yc >> 1), 384, 14,
-                      GL_RGB, GL_UNSIGNED_SHORT_5_6_5, textureSpace);
+      loadTextureLines((yc >> 1) + firstLine, lastLine + 1 - firstLine);
     }
+    endTextureUpdate();
     // update display
     GLfloat txtycf0 = GLfloat(1.0 / 512.0);
     GLfloat txtycf1 = GLfloat(289.0 / 512.0);
@@ -733,16 +984,32 @@ namespace Plus4Emu {
                                          double x1, double y1, bool oddFrame_)
   {
     // full horizontal resolution, no interlace (768x288)
+    beginTextureUpdate(768);
     for (size_t yc = 0; yc < 588; yc += 28) {
+      // find the range of lines that have changed since the last update
+      size_t  firstLine = 14;
+      size_t  lastLine = 0;
+      for (size_t offs = 0; offs < 14; offs++) {
+        if (checkTextureLine((yc >> 1) + offs, lineBuffers_,
+                             int(yc + (offs << 1) + size_t(oddFrame_)))) {
+          firstLine = (firstLine < offs ? firstLine : offs);
+          lastLine = offs;
+        }
+      }
+      if (firstLine > lastLine)
+        continue;
       // decode video data and build 32-bit texture
-      for (size_t offs = size_t(oddFrame_); offs < 28; offs += 2) {
-        decodeLine_quality3(&(textureBuffer32[(offs >> 1) * 768]),
-                            lineBuffers_, yc + offs, colormap32_0);
+      for (size_t offs = firstLine; offs <= lastLine; offs++) {
+        unsigned char *bufp = getTextureLineBuffer((yc >> 1) + offs,
+                                                   (yc >> 1) + firstLine);
+        decodeLine_quality3(reinterpret_cast<uint32_t *>(bufp), lineBuffers_,
+                            int(yc + (offs << 1) + size_t(oddFrame_)),
+                            colormap32_0);
       }
       // load texture
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(yc >> 1), 768, 14,
-                      GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, textureSpace);
+      loadTextureLines((yc >> 1) + firstLine, lastLine + 1 - firstLine);
     }
+    endTextureUpdate();
     // update display
     GLfloat txtycf0 = GLfloat(1.0 / 512.0);
     GLfloat txtycf1 = GLfloat(289.0 / 512.0);
@@ -772,19 +1039,38 @@ namespace Plus4Emu {
     if (enableShader() != yuvTextureMode) {
       yuvTextureMode = !yuvTextureMode;
       setColormap_quality3(displayParameters);
+      for (size_t yc = 0; yc < 296; yc++)
+        textureLineHashes[yc] = 0U;
     }
     // full horizontal resolution, interlace (768x576), TV emulation
+    beginTextureUpdate(768);
     for (int yc = -4; yc < 584; yc += 28) {
+      // find the range of lines that have changed since the last update
+      int     firstLine = 14;
+      int     lastLine = 0;
+      for (int offs = 0; offs < 14; offs++) {
+        if (checkTextureLine(size_t(((yc + 4) >> 1) + offs), lineBuffers_,
+                             yc + (offs << 1) + int(oddFrame_))) {
+          firstLine = (firstLine < offs ? firstLine : offs);
+          lastLine = offs;
+        }
+      }
+      if (firstLine > lastLine)
+        continue;
       // decode video data and build 32-bit texture
-      for (int offs = int(oddFrame_); offs < 28; offs += 2) {
-        decodeLine_quality3(&(textureBuffer32[(offs >> 1) * 768]),
-                            lineBuffers_, yc + offs,
-                            (((yc + offs) & 2) ? colormap32_1 : colormap32_0));
+      size_t  n0 = size_t(((yc + 4) >> 1) + firstLine);
+      for (int offs = firstLine; offs <= lastLine; offs++) {
+        int     lineNum = yc + (offs << 1) + int(oddFrame_);
+        unsigned char *bufp =
+            getTextureLineBuffer(n0 + size_t(offs - firstLine), n0);
+        decodeLine_quality3(reinterpret_cast<uint32_t *>(bufp),
+                            lineBuffers_, lineNum,
+                            ((lineNum & 2) ? colormap32_1 : colormap32_0));
       }
       // load texture
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint((yc + 4) >> 1), 768, 14,
-                      GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, textureSpace);
+      loadTextureLines(n0, size_t(lastLine + 1 - firstLine));
     }
+    endTextureUpdate();
     // update display
     double  yOffs = (y1 - y0) * (double(int(oddFrame_) - 2) / 576.0);
     double  ycf0 = y0 + yOffs;
@@ -804,12 +1090,25 @@ namespace Plus4Emu {
     disableShader();
   }
 
-  void OpenGLDisplay::fltkIdleCallback(void *userData_)
+  void OpenGLDisplay::fltkTimeoutCallback(void *userData_)
+  {
+    // nothing to do here, the timeout only wakes up Fl::wait() so that
+    // checkEvents() and redraw() are called; this limits the display
+    // update rate to 250 Hz if buffer swaps are not synchronized to the
+    // vertical retrace
+    Fl::repeat_timeout(0.004, &fltkTimeoutCallback, userData_);
+  }
+
+  void OpenGLDisplay::setResampleTimeout(bool isEnabled)
   {
-    (void) userData_;
-    Fl::unlock();
-    Timer::wait(0.000001);
-    Fl::lock();
+    resampleIdleCnt = 0;
+    if (isEnabled == resampleTimeoutActive)
+      return;
+    resampleTimeoutActive = isEnabled;
+    if (isEnabled)
+      Fl::add_timeout(0.004, &fltkTimeoutCallback, (void *) this);
+    else
+      Fl::remove_timeout(&fltkTimeoutCallback, (void *) this);
   }
 
   void OpenGLDisplay::displayFrame()
@@ -874,51 +1173,20 @@ namespace Plus4Emu {
       glBlendColor__ = (PFNGLBLENDCOLORPROC) wglGetProcAddress("glBlendColor");
 #endif
 
+    if (forceUpdateLineMask) {
+      // make sure that all lines are updated at a slow rate
+      for (size_t yc = 0; yc < 296; yc++) {
+        if (forceUpdateLineMask & (uint8_t(1) << uint8_t((yc >> 3) & 7)))
+          textureLineHashes[yc] = 0U;
+      }
+      forceUpdateLineMask = 0;
+    }
     if (displayParameters.displayQuality == 0 &&
         displayParameters.bufferingMode == 0) {
       // half horizontal resolution, no interlace (384x288)
       // no texture filtering or effects
-      if (forceUpdateLineMask) {
-        // make sure that all lines are updated at a slow rate
-        for (size_t yc = 0; yc < 289; yc++) {
-          if (forceUpdateLineMask & (uint8_t(1) << uint8_t((yc >> 3) & 7)))
-            linesChanged[yc] = true;
-        }
-        forceUpdateLineMask = 0;
-      }
       glDisable(GL_BLEND);
-      for (size_t yc = 0; yc < 288; yc += 8) {
-        size_t  offs;
-        // quality=0 with single buffered display is special case: only those
-        // lines are updated that have changed since the last frame
-        for (offs = 0; offs < 8; offs++) {
-          if (linesChanged[yc + offs + 1])
-            break;
-        }
-        if (offs == 8)
-          continue;
-        for (offs = 0; offs < 8; offs++) {
-          linesChanged[yc + offs + 1] = false;
-          // decode video data and build 16-bit texture
-          decodeLine_quality0(&(textureBuffer16[offs * 384]), lineBuffers,
-                              ((yc + offs + 1) << 1) + size_t(prvFrameWasOdd));
-        }
-        // load texture
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(yc), 384, 8,
-                        GL_RGB, GL_UNSIGNED_SHORT_5_6_5, textureSpace);
-      }
-      // update display (FIXME: the whole screen is now always redrawn,
-      // but loading the texture is the more CPU expensive operation)
-      glBegin(GL_QUADS);
-      glTexCoord2f(GLfloat(0.0), GLfloat(0.0));
-      glVertex2f(GLfloat(x0), GLfloat(y0));
-      glTexCoord2f(GLfloat(384.0 / 512.0), GLfloat(0.0));
-      glVertex2f(GLfloat(x1), GLfloat(y0));
-      glTexCoord2f(GLfloat(384.0 / 512.0), GLfloat(288.0 / 512.0));
-      glVertex2f(GLfloat(x1), GLfloat(y1));
-      glTexCoord2f(GLfloat(0.0), GLfloat(288.0 / 512.0));
-      glVertex2f(GLfloat(x0), GLfloat(y1));
-      glEnd();
+      drawFrame_quality0(lineBuffers, x0, y0, x1, y1, prvFrameWasOdd);
       // clean up
       glBindTexture(GL_TEXTURE_2D, GLuint(savedTextureID));
       glPopMatrix();
@@ -1067,6 +1335,7 @@ namespace Plus4Emu {
     glBindTexture(GL_TEXTURE_2D, tmp);
     setTextureParameters(displayParameters.displayQuality);
     initializeTexture(displayParameters, textureSpace);
+    forceUpdateLineMask = 0xFF;
     glBindTexture(GL_TEXTURE_2D, GLuint(savedTextureID));
     // clear display
     glDisable(GL_TEXTURE_2D);
@@ -1124,6 +1393,7 @@ namespace Plus4Emu {
     if (redrawFlag || videoResampleEnabled) {
       redrawFlag = false;
       displayFrame();
+      frameDisplayed();
       if (videoResampleEnabled) {
         double  t = displayFrameRateTimer.getRealTime();
         displayFrameRateTimer.reset();
@@ -1162,22 +1432,6 @@ namespace Plus4Emu {
             deleteMessage(lineBuffers[lineNum ^ 1]);
             lineBuffers[lineNum ^ 1] = (Message_LineData *) 0;
           }
-          if (displayParameters.displayQuality == 0) {
-            if (!displayParameters.bufferingMode) {
-              // check if this line has changed
-              int     lineNum_ = (lineNum & (~(int(1)))) | int(prvFrameWasOdd);
-              if (lineBuffers[lineNum_] != (Message_LineData *) 0 &&
-                  *(lineBuffers[lineNum_]) == *msg) {
-                if (lineNum == lineNum_) {
-                  deleteMessage(m);
-                  continue;
-                }
-              }
-              else {
-                linesChanged[lineNum >> 1] = true;
-              }
-            }
-          }
           if (lineBuffers[lineNum])
             deleteMessage(lineBuffers[lineNum]);
           lineBuffers[lineNum] = msg;
@@ -1191,6 +1445,7 @@ namespace Plus4Emu {
         framesPendingFlag = (framesPending > 0);
         messageQueueMutex.unlock();
         redrawFlag = true;
+        lastFrameTime = static_cast<Message_FrameDone *>(m)->timeStamp;
         deleteMessage(m);
         int     yc = lastLineNum;
         prvFrameWasOdd = bool(yc & 1);
@@ -1201,7 +1456,6 @@ namespace Plus4Emu {
           do {
             yc++;
             if (lineBuffers[yc]) {
-              linesChanged[yc >> 1] = true;
               deleteMessage(lineBuffers[yc]);
               lineBuffers[yc] = (Message_LineData *) 0;
             }
@@ -1211,6 +1465,7 @@ namespace Plus4Emu {
         if (screenshotCallbackFlag)
           checkScreenshotCallback();
         if (videoResampleEnabled) {
+          setResampleTimeout(true);
           double  t = inputFrameRateTimer.getRealTime();
           inputFrameRateTimer.reset();
           t = (t > 0.002 ? (t < 0.25 ? t : 0.25) : 0.002);
@@ -1228,15 +1483,19 @@ namespace Plus4Emu {
         msg = static_cast<Message_SetParameters *>(m);
         applyDisplayParameters(msg->dp);
         displayParameters = msg->dp;
-        for (size_t yc = 0; yc < 289; yc++)
-          linesChanged[yc] = true;
+        forceUpdateLineMask = 0xFF;
       }
       deleteMessage(m);
     }
     if (noInputTimer.getRealTime() > 0.5) {
       noInputTimer.reset(0.25);
-      if (videoResampleEnabled)
+      if (videoResampleEnabled) {
         copyFrameToRingBuffer();
+        // stop waking up the GUI thread if there is no input
+        // (e.g. the emulation is paused) for about two seconds
+        if (++resampleIdleCnt >= 7)
+          setResampleTimeout(false);
+      }
       redrawFlag = true;
       if (screenshotCallbackFlag)
         checkScreenshotCallback();
@@ -1247,11 +1506,12 @@ namespace Plus4Emu {
       forceUpdateLineCnt &= uint8_t(7);
       forceUpdateTimer.reset();
     }
-    return (redrawFlag | videoResampleEnabled);
+    return (redrawFlag | resampleTimeoutActive);
   }
 
   int OpenGLDisplay::handle(int event)
   {
+    checkInputEvent(event);
     return fltkEventCallback(fltkEventCallbackUserData, event);
   }
 
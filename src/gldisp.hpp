@@ -43,6 +43,13 @@ namespace Plus4Emu {
     void decodeLine_quality3(uint32_t *outBuf,
                              Message_LineData **lineBuffers_, int lineNum,
                              const VideoDisplayColormap<uint32_t>& colormap);
+    bool checkTextureLine(size_t n, Message_LineData **lineBuffers_,
+                          int lineNum);
+    void deletePixelBuffers();
+    void beginTextureUpdate(int width);
+    unsigned char *getTextureLineBuffer(size_t n, size_t n0);
+    void loadTextureLines(size_t n0, size_t nLines);
+    void endTextureUpdate();
     void drawFrame_quality0(Message_LineData **lineBuffers_,
                             double x0, double y0, double x1, double y1,
                             bool oddFrame_);
@@ -56,23 +63,41 @@ namespace Plus4Emu {
                             double x0, double y0, double x1, double y1,
                             bool oddFrame_);
     void copyFrameToRingBuffer();
-    static void fltkIdleCallback(void *userData_);
+    static void fltkTimeoutCallback(void *userData_);
+    void setResampleTimeout(bool isEnabled);
     void displayFrame();
     // ----------------
     VideoDisplayColormap<uint16_t>  colormap16;
     VideoDisplayColormap<uint32_t>  colormap32_0;
     VideoDisplayColormap<uint32_t>  colormap32_1;
-    bool          *linesChanged;
+    // hash of the line last loaded into each row of the texture (2: blank
+    // line, 0: the row needs to be updated)
+    uint32_t      *textureLineHashes;
     // 768x14 subtexture in 16-bit R5G6B5, or 32-bit R8G8B8 or Y8U8V8 format
     unsigned char *textureSpace;
-    uint16_t      *textureBuffer16;
-    uint32_t      *textureBuffer32;
     unsigned long textureID;
+    // pixel buffer objects used for streaming texture data, if supported
+    // by the OpenGL implementation (pixelBufferMode: -1: not checked yet,
+    // 0: not available, 1: available)
+    unsigned long pixelBufferIDs[3];
+    int           pixelBufferIndex;
+    int           pixelBufferMode;
+    // the currently mapped pixel buffer (NULL if none)
+    unsigned char *mappedPixelBuffer;
+    // true for the texture rows in the mapped buffer that need to be loaded
+    bool          *textureLinesUpdated;
+    int           textureUpdateWidth;     // 384 (16-bit) or 768 (32-bit)
+    size_t        textureLineBytes;
     uint8_t       forceUpdateLineCnt;
     uint8_t       forceUpdateLineMask;
     bool          redrawFlag;
     bool          yuvTextureMode;
     bool          prvFrameWasOdd;
+    // true if the timeout that wakes up the GUI thread for resampling
+    // to the monitor refresh rate is currently active
+    bool          resampleTimeoutActive;
+    // number of times the display was updated without any new input frames
+    int           resampleIdleCnt;
     int           lastLineNum;
     Timer         noInputTimer;
     Timer         forceUpdateTimer;
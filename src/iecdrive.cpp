@@ -23,10 +23,19 @@
 #include "iecdrive.hpp"
 
 #include <cmath>
+#include <ctime>
 #include <map>
+#include <set>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
 
+#if defined(__linux) || defined(__linux__)
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#  define PLUS4EMU_HAVE_INOTIFY     1
+#endif
+
 static const size_t maxFileCnt = 4096;
 
 static const unsigned char  directoryStartLine[32] = {
@@ -121,6 +130,24 @@ static const char *errorMessages[75] = {
   " DRIVE NOT READY"            // 74
 };
 
+// returns the modification time of a file or directory, or -1 on error;
+// if 'fileSize' is not NULL, the size of the file is also stored there
+
+static int64_t getFileModificationTime(const char *fileName,
+                                       int64_t *fileSize = (int64_t *) 0)
+{
+#ifndef WIN32
+  struct stat   st;
+#else
+  struct _stat  st;
+#endif
+  if (Plus4Emu::fileStat(fileName, &st) != 0)
+    return int64_t(-1);
+  if (fileSize)
+    *fileSize = int64_t(st.st_size);
+  return int64_t(st.st_mtime);
+}
+
 namespace Plus4 {
 
   ParallelIECDrive::Plus4FileName::Plus4FileName()
@@ -325,6 +352,10 @@ namespace Plus4 {
       recordDirtyFlag(false),
       fileDBUpdateFlag(true),
       writeProtectFlag(false),
+      fileDBHasDuplicates(false),
+      dirNotifyFD(-1),
+      dirModTime(0),
+      fileDBUpdateTime(0),
       currentWorkingDirectory(""),
       bufPos(0),
       bufBytes(0),
@@ -347,6 +378,7 @@ namespace Plus4 {
   {
     for (int i = 0; i < 16; i++)
       filesOpened[i].clear();
+    closeDirectoryNotify();
   }
 
   void ParallelIECDrive::reset()
@@ -365,7 +397,6 @@ namespace Plus4 {
     currentIOMode = 0;
     secondaryAddress = 0x00;
     recordDirtyFlag = false;
-    fileDBUpdateFlag = true;
     bufPos = 0;
     bufBytes = 0;
     setErrorMessage(73);
@@ -373,7 +404,8 @@ namespace Plus4 {
     for (int i = 0; i < 16; i++)
       filesOpened[i].clear();
     recordLength = 0;
-    fileDB.clear();
+    // rebuild the file database on the next access
+    fileDBUpdateFlag = true;
     directoryIterator = fileDB.end();
   }
 
@@ -676,16 +708,44 @@ namespace Plus4 {
   }
 
   void ParallelIECDrive::updateFileDB()
+  {
+    directoryIterator = fileDB.end();
+    if (!fileDBUpdateFlag) {
+      if (!checkDirectoryChanges())
+        return;
+    }
+    rebuildFileDB();
+  }
+
+  void ParallelIECDrive::rebuildFileDB()
   {
     DIR       *d = (DIR *) 0;
-    std::FILE *f = (std::FILE *) 0;
     try {
       fileDB.clear();
+      hostFileDB.clear();
+      fileDBHasDuplicates = false;
       directoryIterator = fileDB.end();
+      closeDirectoryNotify();
       if (currentWorkingDirectory.length() < 1) {
         fileDBUpdateFlag = false;
         return;
       }
+#ifdef PLUS4EMU_HAVE_INOTIFY
+      // start watching the directory before reading it, so that no changes
+      // are missed
+      dirNotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (dirNotifyFD >= 0) {
+        if (inotify_add_watch(dirNotifyFD, currentWorkingDirectory.c_str(),
+                              IN_CREATE | IN_DELETE | IN_CLOSE_WRITE
+                              | IN_MOVED_FROM | IN_MOVED_TO
+                              | IN_DELETE_SELF | IN_MOVE_SELF
+                              | IN_ONLYDIR) < 0) {
+          closeDirectoryNotify();
+        }
+      }
+#endif
+      dirModTime = getFileModificationTime(currentWorkingDirectory.c_str());
+      fileDBUpdateTime = int64_t(std::time((std::time_t *) 0));
       d = opendir(currentWorkingDirectory.c_str());
       if (!d) {
         fileDBUpdateFlag = false;
@@ -695,87 +755,12 @@ namespace Plus4 {
         struct dirent *e = readdir(d);
         if (!e)
           break;
-        const char    *baseName = &(e->d_name[0]);
-        size_t        nameLen = std::strlen(baseName);
-        if (nameLen < 5)
-          continue;
-        const char    *s = &(baseName[nameLen - 4]);
-        if (s[0] != '.')
-          continue;
-        char          fileType = '\0';
-        unsigned char recordSize = 0;
-        if ((s[1] == 'P' || s[1] == 'p') &&
-            (s[2] == 'R' || s[2] == 'r') &&
-            (s[3] == 'G' || s[3] == 'g')) {
-          fileType = 'p';
-        }
-        else if ((s[2] >= '0' && s[2] <= '9') &&
-                 (s[3] >= '0' && s[3] <= '9')) {
-          if (s[1] == 'P' || s[1] == 'p')
-            fileType = 'P';
-          if (s[1] == 'R' || s[1] == 'r')
-            fileType = 'R';
-          if (s[1] == 'S' || s[1] == 's')
-            fileType = 'S';
-          if (s[1] == 'U' || s[1] == 'u')
-            fileType = 'U';
-        }
-        if (fileType == '\0')
-          continue;
-        Plus4FileName plus4Name;
-        for (size_t i = 0; i < (nameLen - 4); i++)
-          plus4Name.appendCharacter(baseName[i]);
-        std::string   fullName = currentWorkingDirectory;
-        if (fullName[fullName.length() - 1] != '/' &&
-            fullName[fullName.length() - 1] != '\\') {
-#ifdef WIN32
-          fullName += '\\';
-#else
-          fullName += '/';
-#endif
-        }
-        fullName += baseName;
-        f = Plus4Emu::fileOpen(fullName.c_str(), "rb");
-        if (!f)
-          continue;
-        if (fileType != 'p') {
-          // check header of P00, R00, S00, and U00 files
-          unsigned char hdrData[26];
-          size_t        hdrLen =
-              std::fread(&(hdrData[0]), sizeof(unsigned char), 26, f);
-          std::fclose(f);
-          f = (std::FILE *) 0;
-          if (hdrLen < 26)
-            continue;
-          if (!(hdrData[0] == 0x43 && hdrData[1] == 0x36 &&     // "C6"
-                hdrData[2] == 0x34 && hdrData[3] == 0x46 &&     // "4F"
-                hdrData[4] == 0x69 && hdrData[5] == 0x6C &&     // "il"
-                hdrData[6] == 0x65 && hdrData[7] == 0x00)) {    // "e\0"
-            continue;
-          }
-          if (hdrData[8] == 0x00)
-            continue;                   // empty name is invalid
-          if (fileType == 'R') {
-            recordSize = hdrData[25];
-            if (recordSize < 1 || recordSize > 254)
-              continue;                 // REL file with invalid record size
-          }
-          plus4Name.clear();
-          for (int i = 8; i < 24 && hdrData[i] != 0x00; i++)
-            plus4Name.appendPlus4Character(hdrData[i]);
-        }
-        else {
-          std::fclose(f);
-          f = (std::FILE *) 0;
-        }
-        addFileToDB(plus4Name, fullName, fileType, recordSize);
+        addHostFileToDB(&(e->d_name[0]));
       } while (fileDB.size() < maxFileCnt);
       closedir(d);
       d = (DIR *) 0;
     }
     catch (...) {
-      if (f)
-        std::fclose(f);
       if (d)
         closedir(d);
       throw;
@@ -783,6 +768,153 @@ namespace Plus4 {
     fileDBUpdateFlag = false;
   }
 
+  bool ParallelIECDrive::checkDirectoryChanges()
+  {
+    if (currentWorkingDirectory.length() < 1)
+      return false;
+#ifdef PLUS4EMU_HAVE_INOTIFY
+    if (dirNotifyFD >= 0) {
+      std::set< std::string > changedFiles;
+      long    evBuf[1024];
+      while (true) {
+        ssize_t n = read(dirNotifyFD, &(evBuf[0]), sizeof(evBuf));
+        if (n <= 0)
+          break;
+        const char  *p = reinterpret_cast< const char * >(&(evBuf[0]));
+        ssize_t i = 0;
+        while ((i + ssize_t(sizeof(struct inotify_event))) <= n) {
+          const struct inotify_event  *e =
+              reinterpret_cast< const struct inotify_event * >(p + i);
+          if (e->mask & (IN_Q_OVERFLOW | IN_IGNORED | IN_UNMOUNT
+                         | IN_DELETE_SELF | IN_MOVE_SELF)) {
+            return true;
+          }
+          if (e->len > 0 && e->name[0] != '\0')
+            changedFiles.insert(std::string(&(e->name[0])));
+          i = i + ssize_t(sizeof(struct inotify_event) + e->len);
+        }
+      }
+      for (std::set< std::string >::iterator i = changedFiles.begin();
+           i != changedFiles.end();
+           i++) {
+        // if the database is full, files skipped previously may need to be
+        // added
+        if (fileDB.size() >= maxFileCnt)
+          return true;
+        std::map< std::string, Plus4FileName >::iterator  i_ =
+            hostFileDB.find(getHostFileName((*i).c_str()));
+        if (i_ != hostFileDB.end()) {
+          // the file that was hidden by this one would need to be restored
+          if (fileDBHasDuplicates)
+            return true;
+          fileDB.erase((*i_).second);
+          hostFileDB.erase(i_);
+        }
+        addHostFileToDB((*i).c_str());
+      }
+      return false;
+    }
+#endif
+    // without change notification, check the modification time of the
+    // directory
+    int64_t t = getFileModificationTime(currentWorkingDirectory.c_str());
+    if (t < 0 || t != dirModTime)
+      return true;
+    // the time stamp has a resolution of (at least) one second, so changes
+    // made shortly after the last update may not be detected yet
+    return ((fileDBUpdateTime - dirModTime) < 2);
+  }
+
+  void ParallelIECDrive::closeDirectoryNotify()
+  {
+#ifdef PLUS4EMU_HAVE_INOTIFY
+    if (dirNotifyFD >= 0)
+      close(dirNotifyFD);
+#endif
+    dirNotifyFD = -1;
+  }
+
+  std::string ParallelIECDrive::getHostFileName(const char *baseName) const
+  {
+    std::string   fullName = currentWorkingDirectory;
+    if (fullName[fullName.length() - 1] != '/' &&
+        fullName[fullName.length() - 1] != '\\') {
+#ifdef WIN32
+      fullName += '\\';
+#else
+      fullName += '/';
+#endif
+    }
+    fullName += baseName;
+    return fullName;
+  }
+
+  void ParallelIECDrive::addHostFileToDB(const char *baseName)
+  {
+    size_t        nameLen = std::strlen(baseName);
+    if (nameLen < 5)
+      return;
+    const char    *s = &(baseName[nameLen - 4]);
+    if (s[0] != '.')
+      return;
+    char          fileType = '\0';
+    unsigned char recordSize = 0;
+    if ((s[1] == 'P' || s[1] == 'p') &&
+        (s[2] == 'R' || s[2] == 'r') &&
+        (s[3] == 'G' || s[3] == 'g')) {
+      fileType = 'p';
+    }
+    else if ((s[2] >= '0' && s[2] <= '9') &&
+             (s[3] >= '0' && s[3] <= '9')) {
+      if (s[1] == 'P' || s[1] == 'p')
+        fileType = 'P';
+      if (s[1] == 'R' || s[1] == 'r')
+        fileType = 'R';
+      if (s[1] == 'S' || s[1] == 's')
+        fileType = 'S';
+      if (s[1] == 'U' || s[1] == 'u')
+        fileType = 'U';
+    }
+    if (fileType == '\0')
+      return;
+    Plus4FileName plus4Name;
+    for (size_t i = 0; i < (nameLen - 4); i++)
+      plus4Name.appendCharacter(baseName[i]);
+    std::string   fullName = getHostFileName(baseName);
+    std::FILE     *f = Plus4Emu::fileOpen(fullName.c_str(), "rb");
+    if (!f)
+      return;
+    if (fileType != 'p') {
+      // check header of P00, R00, S00, and U00 files
+      unsigned char hdrData[26];
+      size_t        hdrLen =
+          std::fread(&(hdrData[0]), sizeof(unsigned char), 26, f);
+      std::fclose(f);
+      if (hdrLen < 26)
+        return;
+      if (!(hdrData[0] == 0x43 && hdrData[1] == 0x36 &&         // "C6"
+            hdrData[2] == 0x34 && hdrData[3] == 0x46 &&         // "4F"
+            hdrData[4] == 0x69 && hdrData[5] == 0x6C &&         // "il"
+            hdrData[6] == 0x65 && hdrData[7] == 0x00)) {        // "e\0"
+        return;
+      }
+      if (hdrData[8] == 0x00)
+        return;                         // empty name is invalid
+      if (fileType == 'R') {
+        recordSize = hdrData[25];
+        if (recordSize < 1 || recordSize > 254)
+          return;                       // REL file with invalid record size
+      }
+      plus4Name.clear();
+      for (int i = 8; i < 24 && hdrData[i] != 0x00; i++)
+        plus4Name.appendPlus4Character(hdrData[i]);
+    }
+    else {
+      std::fclose(f);
+    }
+    addFileToDB(plus4Name, fullName, fileType, recordSize);
+  }
+
   int ParallelIECDrive::createFile(std::FILE*& f,
                                    const Plus4FileName& fileName, char fileType,
                                    int recSize)
@@ -886,19 +1018,47 @@ namespace Plus4 {
       tmp.fullName = fullName;
       tmp.fileType = fileType;
       tmp.recordSize = (unsigned char) recordSize;
+      tmp.fileSize = 0;
+      tmp.modTime = getFileModificationTime(fullName.c_str(), &tmp.fileSize);
       fileDB.insert(std::pair< Plus4FileName, FileDBEntry >(fileName, tmp));
     }
     else {
       // or modify already existing one
+      if ((*i_).second.fullName != fullName) {
+        hostFileDB.erase((*i_).second.fullName);
+        fileDBHasDuplicates = true;
+      }
       (*i_).second.fullName = fullName;
       (*i_).second.fileType = fileType;
       (*i_).second.recordSize = (unsigned char) recordSize;
+      (*i_).second.fileSize = 0;
+      (*i_).second.modTime =
+          getFileModificationTime(fullName.c_str(), &((*i_).second.fileSize));
     }
+    hostFileDB[fullName] = fileName;
     directoryIterator = fileDB.end();
   }
 
   ParallelIECDrive::Plus4FileName
       ParallelIECDrive::findFile(const Plus4FileName& fileName)
+  {
+    Plus4FileName nameFound = findFileInDB(fileName);
+    if (nameFound.fileNameLen < 1 || dirNotifyFD >= 0 || fileDBUpdateFlag)
+      return nameFound;
+    // a file rewritten in place does not change the time stamp of the
+    // directory, so check the one that was found
+    const FileDBEntry&  e = fileDB[nameFound];
+    int64_t fileSize = 0;
+    int64_t t = getFileModificationTime(e.fullName.c_str(), &fileSize);
+    if (t >= 0 && t == e.modTime && fileSize == e.fileSize)
+      return nameFound;
+    fileDBUpdateFlag = true;
+    updateFileDB();
+    return findFileInDB(fileName);
+  }
+
+  ParallelIECDrive::Plus4FileName
+      ParallelIECDrive::findFileInDB(const Plus4FileName& fileName)
   {
     if (fileName.fileNameLen < 1)
       return Plus4FileName("");         // invalid (empty) name
@@ -914,11 +1074,29 @@ namespace Plus4 {
         return (*i_).first;
       }
     }
-    // find file name with wildcards
-    std::map< Plus4FileName, FileDBEntry >::iterator  i_ = fileDB.begin();
+    // find file name with wildcards: only the names that begin with the
+    // characters before the first wildcard need to be checked, and these
+    // are stored in a contiguous range of the database
+    Plus4FileName prefix;
+    for (int i = 0;
+         i < fileName.fileNameLen &&
+         fileName.fileName[i] != 0x2A && fileName.fileName[i] != 0x3F;
+         i++) {
+      prefix.appendPlus4Character(fileName.fileName[i]);
+    }
+    std::map< Plus4FileName, FileDBEntry >::iterator  i_ =
+        fileDB.lower_bound(prefix);
     while (i_ != fileDB.end()) {
       const Plus4FileName&  fName = (*i_).first;
       int     i = 0;
+      if (fName.fileNameLen < prefix.fileNameLen)
+        break;
+      for ( ; i < prefix.fileNameLen; i++) {
+        if (fName.fileName[i] != prefix.fileName[i])
+          break;
+      }
+      if (i < prefix.fileNameLen)
+        break;                          // end of range, not found
       while (true) {
         if (i >= fileName.fileNameLen) {
           if (i >= fName.fileNameLen)
@@ -1882,6 +2060,7 @@ namespace Plus4 {
       setErrorMessage(26);              // "write protect on"
       return false;
     }
+    hostFileDB.erase(fileDB[fileName].fullName);
     fileDB.erase(fileName);
     directoryIterator = fileDB.end();
     return true;
@@ -57,6 +57,8 @@ namespace Plus4 {
       char          fileType;   // 'p': PRG, 'P': P00, 'R': R00,
                                 // 'S': S00, 'U': U00
       unsigned char recordSize; // record size for REL files, zero otherwise
+      int64_t       modTime;    // modification time and size of the file
+      int64_t       fileSize;   // when it was added to the database
     };
     struct FileTableEntry {
       Plus4FileName fileName;
@@ -93,7 +95,15 @@ namespace Plus4 {
     bool    recordDirtyFlag;    // true if data was written to this REL record
     bool    fileDBUpdateFlag;   // true if file database needs to be rebuilt
     bool    writeProtectFlag;   // do not allow any write operations if true
+    bool    fileDBHasDuplicates;    // true if a host file is hidden by
+                                    // another one with the same Plus/4 name
     std::map< Plus4FileName, FileDBEntry >  fileDB;
+    // full host file name -> Plus/4 file name, used for updating the
+    // database incrementally when only some of the files have changed
+    std::map< std::string, Plus4FileName >  hostFileDB;
+    int             dirNotifyFD;    // inotify file descriptor, or -1
+    int64_t         dirModTime;     // modification time of the directory
+    int64_t         fileDBUpdateTime;   // time of the last full update
     std::string     currentWorkingDirectory;
     FileTableEntry  filesOpened[16];
     unsigned char   buf[256];
@@ -114,12 +124,24 @@ namespace Plus4 {
     void updateParallelInterface();
     int listenNextByte(uint8_t n);
     int talkNextByte(uint8_t& n);
+    // update the file database if there are any changes in the working
+    // directory; this is fast if nothing has changed since the last call
     void updateFileDB();
+    void rebuildFileDB();
+    // returns true if the file database needs to be rebuilt, otherwise
+    // updates the entries of changed files only
+    bool checkDirectoryChanges();
+    void closeDirectoryNotify();
+    std::string getHostFileName(const char *baseName) const;
+    void addHostFileToDB(const char *baseName);
     // returns 0 on success, -1 if open failed, -2 on too many files
     int createFile(std::FILE*& f, const Plus4FileName& fileName, char fileType,
                    int recSize = 254);
     void addFileToDB(const Plus4FileName& fileName, const std::string& fullName,
                      char fileType, int recordSize);
+    Plus4FileName findFileInDB(const Plus4FileName& fileName);
+    // like findFile(), but without change notification, the database is
+    // also rebuilt if the file found has been modified since it was added
     Plus4FileName findFile(const Plus4FileName& fileName);
     void setErrorMessage(int n, int t = 0, int s = 0);
     void openFile();
@@ -209,6 +209,7 @@ namespace Plus4 {
       ted.cpuMemoryReadMap |= 0x0678U;
       ted.tedDMAReadMap |= 0x0678U;
       ted.tedBitmapReadMap |= 0x0678U;
+      ted.updateCPUMemoryPages();
       return;
     }
     ted.hannesRegister = value;
@@ -220,6 +221,7 @@ namespace Plus4 {
     ted.cpuMemoryReadMap = (ted.cpuMemoryReadMap & 0x7980U) | tmp;
     ted.tedDMAReadMap = (ted.tedDMAReadMap & 0x7980U) | tmp;
     ted.tedBitmapReadMap = (ted.tedBitmapReadMap & 0x7980U) | tmp;
+    ted.updateCPUMemoryPages();
   }
 
   PLUS4EMU_REGPARM3 void TED7360::write_register_FDDx(
@@ -232,6 +234,7 @@ namespace Plus4 {
     ted.cpuMemoryReadMap = (ted.cpuMemoryReadMap & 0x07F8U) | tmp;
     ted.tedDMAReadMap = (ted.tedDMAReadMap & 0x07F8U) | tmp;
     ted.tedBitmapReadMap = (ted.tedBitmapReadMap & 0x07F8U) | tmp;
+    ted.updateCPUMemoryPages();
   }
 
   PLUS4EMU_REGPARM3 void TED7360::write_register_FF3E(
@@ -243,6 +246,7 @@ namespace Plus4 {
     ted.memoryReadMap |= 0x0080U;
     ted.cpuMemoryReadMap |= 0x0080U;
     ted.tedDMAReadMap |= 0x0080U;
+    ted.selectCPUMemoryReadPages();
   }
 
   PLUS4EMU_REGPARM3 void TED7360::write_register_FF3F(
@@ -254,10 +258,99 @@ namespace Plus4 {
     ted.memoryReadMap &= 0x7F78U;
     ted.cpuMemoryReadMap &= 0x7F78U;
     ted.tedDMAReadMap &= 0x7F78U;
+    ted.selectCPUMemoryReadPages();
   }
 
   // --------------------------------------------------------------------------
 
+  void TED7360::checkCPUMemoryPages()
+  {
+    for (unsigned int i = 0U; i < 256U; i++) {
+      M7501MemoryReadCallback   readFunc = (M7501MemoryReadCallback) 0;
+      M7501MemoryWriteCallback  writeFunc = (M7501MemoryWriteCallback) 0;
+      uint8_t   readOffs = 0xFF;
+      uint8_t   writeOffs = 0xFF;
+      if (i < 0x10U) {
+        readFunc = &read_memory_0000_to_0FFF;
+        writeFunc = &write_memory_0000_to_0FFF;
+        readOffs = 4;
+        writeOffs = 4;
+      }
+      else if (i < 0x40U) {
+        readFunc = &read_memory_1000_to_3FFF;
+        writeFunc = &write_memory_1000_to_3FFF;
+        readOffs = 0;
+        writeOffs = 0;
+      }
+      else if (i < 0x80U) {
+        readFunc = &read_memory_4000_to_7FFF;
+        writeFunc = &write_memory_4000_to_7FFF;
+        readOffs = 1;
+        writeOffs = 1;
+      }
+      else if (i < 0xC0U) {
+        readFunc = &read_memory_8000_to_BFFF;
+        writeFunc = &write_memory_8000_to_BFFF;
+        readOffs = 2;
+        writeOffs = 2;
+      }
+      else if (i < 0xFCU) {
+        readFunc = &read_memory_C000_to_FBFF;
+        writeFunc = &write_memory_C000_to_FCFF;
+        readOffs = 3;
+        writeOffs = 3;
+      }
+      else if (i == 0xFCU) {
+        readFunc = &read_memory_FC00_to_FCFF;
+        writeFunc = &write_memory_C000_to_FCFF;
+        readOffs = 5;
+        writeOffs = 3;
+      }
+      // I/O and TED registers at FD00-FFFF always use the callbacks
+      for (unsigned int j = 0U; j < 256U; j++) {
+        uint16_t  addr = uint16_t((i << 8) | j);
+        if (getMemoryReadCallback(addr) != readFunc)
+          readOffs = 0xFF;
+        if (getMemoryWriteCallback(addr) != writeFunc)
+          writeOffs = 0xFF;
+      }
+      cpuReadPageMapOffset[i] = readOffs;
+      cpuWritePageMapOffset[i] = writeOffs;
+    }
+  }
+
+  void TED7360::updateCPUMemoryPages()
+  {
+    if (checkMemoryCallbacksChanged())
+      checkCPUMemoryPages();
+    // read page set 0 is used with RAM selected at 8000-FFFF (FF3F),
+    // and set 1 with ROM (FF3E)
+    for (int k = 0; k < 2; k++) {
+      unsigned int  readMap =
+          (cpuMemoryReadMap & 0x7F78U) | ((unsigned int) k << 7);
+      for (unsigned int i = 0U; i < 256U; i++) {
+        const uint8_t *p = (uint8_t *) 0;
+        if (cpuReadPageMapOffset[i] < 8) {
+          p = segmentTable[memoryMapTable[readMap + cpuReadPageMapOffset[i]]];
+          if (p)
+            p = p + ((i << 8) & 0x3F00U);
+        }
+        setMemoryReadPage(k, uint8_t(i), p);
+      }
+    }
+    for (unsigned int i = 0U; i < 256U; i++) {
+      uint8_t   *p = (uint8_t *) 0;
+      if (cpuWritePageMapOffset[i] < 8) {
+        p = segmentTable[memoryMapTable[memoryWriteMap
+                                        + cpuWritePageMapOffset[i]]];
+        if (p)
+          p = p + ((i << 8) & 0x3F00U);
+      }
+      setMemoryWritePage(uint8_t(i), p);
+    }
+    selectCPUMemoryReadPages();
+  }
+
   uint8_t TED7360::getMemoryPage(int n) const
   {
     return memoryMapTable[cpuMemoryReadMap + ((unsigned int) n & 3U)];
@@ -288,7 +381,7 @@ namespace Plus4 {
     ted_.memoryReadMap =
         (forceRAM_ ? (cpuMemoryReadMap & 0x7F78U) : cpuMemoryReadMap);
     ted_.dataBusState = uint8_t(0xFF);
-    uint8_t retval = ted_.readMemory(addr);
+    uint8_t retval = ted_.readMemoryCallback(addr);
     ted_.memoryReadMap = savedMemoryReadMap;
     ted_.dataBusState = savedDataBusState;
     return retval;
@@ -331,6 +424,7 @@ namespace Plus4 {
         segmentTable[segment] = (uint8_t *) 0;
       }
     }
+    updateCPUMemoryPages();
   }
 
   void TED7360::initializeRAMSegment(uint8_t *p)
@@ -58,7 +58,7 @@ namespace Plus4 {
       inputBufferBytesUsed(0),
       inputBufferSize(131072),
       inputBuffer((uint8_t *) 0),
-      pageBuf((uint8_t *) 0),
+      page(pageWidth, pageHeight),
       changeFlag(true),
       outFileASCIIMode(false),
       outFile((std::FILE *) 0)
@@ -66,15 +66,6 @@ namespace Plus4 {
     inputBuffer = new uint8_t[inputBufferSize];
     for (size_t i = 0; i < inputBufferSize; i++)
       inputBuffer[i] = 0x00;
-    try {
-      pageBuf = new uint8_t[pageWidth * pageHeight];
-    }
-    catch (...) {
-      delete[] inputBuffer;
-      throw;
-    }
-    for (size_t i = 0; i < size_t(pageWidth * pageHeight); i++)
-      pageBuf[i] = 0xFF;        // clear to white
     this->reset();
   }
 
@@ -88,7 +79,6 @@ namespace Plus4 {
       std::fclose(outFile);
     }
     delete[] inputBuffer;
-    delete[] pageBuf;
   }
 
   void MPS801::setROMImage(int n, const uint8_t *romData_)
@@ -142,8 +132,13 @@ namespace Plus4 {
       headPosY = headPosY + (((headPosY - marginTop) % 21) < 10 ? 10 : 11);
     else
       headPosY = headPosY + 7;
-    if (headPosY > (pageHeight - marginBottom))
-      pageFullFlag = true;
+    if (headPosY > (pageHeight - marginBottom)) {
+      // if writing pages to image files, continue on a new page
+      if (page.ejectPage())
+        headPosY = marginTop;
+      else
+        pageFullFlag = true;
+    }
   }
 
   void MPS801::printBitmap(uint8_t b)
@@ -158,8 +153,7 @@ namespace Plus4 {
         int     y = headPosY + i;
         if (headPosX >= 0 && headPosX < pageWidth &&
             y >= 0 && y < pageHeight) {
-          int     n = (y * pageWidth) + headPosX;
-          pageBuf[n] = (pageBuf[n] >> 3) + (pageBuf[n] >> 4);
+          page.plotDot(headPosX, y);
         }
       }
     }
@@ -492,7 +486,12 @@ namespace Plus4 {
 
   const uint8_t * MPS801::getPageData() const
   {
-    return pageBuf;
+    return page.getPageData(0, pageHeight);
+  }
+
+  const uint8_t * MPS801::getPageData(int y0, int y1) const
+  {
+    return page.getPageData(y0, y1);
   }
 
   int MPS801::getPageWidth() const
@@ -508,8 +507,8 @@ namespace Plus4 {
   void MPS801::clearPage()
   {
     changeFlag = true;
-    for (size_t i = 0; i < size_t(pageWidth * pageHeight); i++)
-      pageBuf[i] = 0xFF;        // clear to white
+    if (!page.ejectPage())
+      page.clear();
     headPosX = marginLeft;
     headPosY = marginTop;
     pageFullFlag = false;
@@ -578,6 +577,13 @@ namespace Plus4 {
     outFileASCIIMode = asciiMode;
   }
 
+  void MPS801::setPageOutputFile(const char *fileName)
+  {
+    page.setOutputFile(fileName);
+    if (pageFullFlag && page.haveOutputFile())
+      clearPage();                      // continue printing on a new page
+  }
+
   void MPS801::reset()
   {
     idleMode = false;
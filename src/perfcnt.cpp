@@ -0,0 +1,84 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "plus4emu.hpp"
+#include "system.hpp"
+#include "perfcnt.hpp"
+
+namespace Plus4Emu {
+
+  PerformanceCounterTable::PerformanceCounterTable()
+    : frameCnt(0U),
+      startTimeStamp(0U),
+      timer()
+  {
+    this->reset();
+  }
+
+  PerformanceCounterTable::~PerformanceCounterTable()
+  {
+  }
+
+  uint64_t PerformanceCounterTable::getTimeStamp_()
+  {
+    // used on architectures without a time stamp counter;
+    // returns the time in nanoseconds
+    static Timer  timer_;
+    return uint64_t(timer_.getRealTime() * 1000000000.0);
+  }
+
+  void PerformanceCounterTable::reset()
+  {
+    for (int i = 0; i < int(COUNTERS); i++) {
+      ticks[i] = 0U;
+      totalTicks[i] = 0U;
+    }
+    frameCnt = 0U;
+    startTimeStamp = getTimeStamp();
+    timer.reset();
+  }
+
+  void PerformanceCounterTable::frameDone()
+  {
+    for (int i = 0; i < int(COUNTERS); i++) {
+      totalTicks[i] += ticks[i];
+      ticks[i] = 0U;
+    }
+    frameCnt++;
+  }
+
+  uint32_t PerformanceCounterTable::getAverageFrameTimes(double *buf)
+  {
+    uint32_t  nFrames = frameCnt;
+    if (nFrames > 0U) {
+      // calibrate the time stamp counter against the real time clock
+      double    t = timer.getRealTime();
+      uint64_t  nTicks = getTimeStamp() - startTimeStamp;
+      double    usPerTick = 0.0;
+      if (nTicks > 0U)
+        usPerTick = (t * 1000000.0) / double(int64_t(nTicks));
+      usPerTick = usPerTick / double(long(nFrames));
+      for (int i = 0; i < int(COUNTERS); i++)
+        buf[i] = double(int64_t(totalTicks[i])) * usPerTick;
+    }
+    return nFrames;
+  }
+
+}       // namespace Plus4Emu
+
@@ -0,0 +1,116 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef PLUS4EMU_PERFCNT_HPP
+#define PLUS4EMU_PERFCNT_HPP
+
+#include "plus4emu.hpp"
+#include "system.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#  include <intrin.h>
+#endif
+
+namespace Plus4Emu {
+
+  class PerformanceCounterTable {
+   public:
+    enum {
+      TOTAL = 0,
+      SID,
+      FLOPPY,
+      PRINTER,
+      VIDEO_CAPTURE,
+      AUDIO,
+      DISPLAY,
+      TAPE,
+      COUNTERS
+    };
+    // time stamp counter ticks spent in each subsystem in the current frame
+    uint64_t  ticks[COUNTERS];
+   private:
+    uint64_t  totalTicks[COUNTERS];
+    uint32_t  frameCnt;
+    uint64_t  startTimeStamp;
+    Timer     timer;
+    static uint64_t getTimeStamp_();
+   public:
+    PerformanceCounterTable();
+    ~PerformanceCounterTable();
+    /*!
+     * Clear all counters, and restart time stamp counter calibration.
+     */
+    void reset();
+    /*!
+     * Add the ticks counted in the current frame to the totals.
+     */
+    void frameDone();
+    /*!
+     * Store the average time (in microseconds) per frame spent in each
+     * subsystem since the last reset() in 'buf' (COUNTERS elements). The
+     * counters are not changed. Returns the number of frames the averages
+     * were calculated from; if it is zero, 'buf' is not changed.
+     */
+    uint32_t getAverageFrameTimes(double *buf);
+    static PLUS4EMU_INLINE uint64_t getTimeStamp()
+    {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+      uint32_t  l, h;
+      __asm__ __volatile__ ("rdtsc" : "=a" (l), "=d" (h));
+      return (uint64_t(l) | (uint64_t(h) << 32));
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+      return uint64_t(__rdtsc());
+#else
+      return getTimeStamp_();
+#endif
+    }
+  };
+
+  class PerformanceCounterScope {
+   private:
+    uint64_t& counter;
+    uint64_t  startTime;
+   public:
+    PLUS4EMU_INLINE PerformanceCounterScope(uint64_t& counter_)
+      : counter(counter_),
+        startTime(PerformanceCounterTable::getTimeStamp())
+    {
+    }
+    PLUS4EMU_INLINE ~PerformanceCounterScope()
+    {
+      counter += (PerformanceCounterTable::getTimeStamp() - startTime);
+    }
+  };
+
+}       // namespace Plus4Emu
+
+// time the rest of the enclosing block, and add it to counter 'n__'
+// of PerformanceCounterTable 't__'; the scopes are compiled only if
+// ENABLE_PERF_COUNTERS is defined
+
+#ifdef ENABLE_PERF_COUNTERS
+#  define PLUS4EMU_PERF_SCOPE(t__, n__)                                     \
+      Plus4Emu::PerformanceCounterScope perfCounterScope_##n__(             \
+          (t__).ticks[Plus4Emu::PerformanceCounterTable::n__])
+#else
+#  define PLUS4EMU_PERF_SCOPE(t__, n__)
+#endif
+
+#endif  // PLUS4EMU_PERFCNT_HPP
+
@@ -26,6 +26,7 @@
 
 #include <cmath>
 #include <vector>
+#include <map>
 #include <typeinfo>
 
 #include "resid/sid.hpp"
@@ -38,6 +39,8 @@
 #include "iecdrive.hpp"
 #include "system.hpp"
 #include "charconv.hpp"
+#include "prgcache.hpp"
+#include "basictok.hpp"
 
 static void writeDemoTimeCnt(Plus4Emu::File::Buffer& buf, uint64_t n)
 {
@@ -98,21 +101,30 @@ namespace Plus4 {
 
   void Plus4VM::TED7360_::playSample(int16_t sampleValue)
   {
-    int32_t tmp = vm.soundOutputAccumulator;
-    if (tmp != 0) {
-      vm.soundOutputAccumulator = 0;
-      tmp = (tmp >= -1048576 ? (tmp < 1048576 ? tmp : 1048576) : -1048576);
-      tmp = int32_t((uint32_t(tmp * vm.sidOutputVolume)
-                     + uint32_t(0x80004000UL)) >> 15) - int32_t(65536);
+    if (!vm.sidEnabled) {
+      vm.sendSoundOutput(sampleValue);
+      return;
+    }
+    SIDSampleBufEntry&  e = vm.sidSampleBuf[vm.sidSamplesPending];
+    e.accumulator = vm.soundOutputAccumulator;
+    e.sidCycles = vm.sidCyclesPending;
+    e.tedOutput = sampleValue;
+    vm.soundOutputAccumulator = 0;
+    vm.sidCyclesPending = 0;
+    // video capture needs the sound output signal on every cycle
+    if (++(vm.sidSamplesPending)
+        >= uint32_t(sizeof(vm.sidSampleBuf) / sizeof(SIDSampleBufEntry)) ||
+        vm.videoCapture) {
+      vm.syncSID();
     }
-    vm.soundOutputSignal = tmp + int32_t(sampleValue);
-    vm.sendMonoAudioOutput(vm.soundOutputSignal);
   }
 
   void Plus4VM::TED7360_::videoOutputCallback(const uint8_t *buf, size_t nBytes)
   {
-    if (vm.getIsDisplayEnabled())
+    if (vm.getIsDisplayEnabled()) {
+      PLUS4EMU_PERF_SCOPE(vm.perfCounters, DISPLAY);
       vm.display.sendVideoOutput(buf, nBytes);
+    }
   }
 
   void Plus4VM::TED7360_::ntscModeChangeCallback(bool isNTSC_)
@@ -123,6 +135,7 @@ namespace Plus4 {
   void Plus4VM::TED7360_::breakPointCallback(int type,
                                              uint16_t addr, uint8_t value)
   {
+    vm.syncSID();
     vm.breakPointCallback(vm.breakPointCallbackUserData, 0, type, addr, value);
   }
 
@@ -144,6 +157,7 @@ namespace Plus4 {
   {
     TED7360_& ted = *(reinterpret_cast<TED7360_ *>(userData));
     if (ted.vm.sidEnabled) {
+      ted.vm.syncSID();
       uint8_t regNum = uint8_t(addr & 0x001F);
       if (ted.vm.digiBlasterEnabled && regNum >= 0x1E) {
         if (regNum == 0x1E) {
@@ -172,10 +186,11 @@ namespace Plus4 {
     ted.dataBusState = value;
     if (PLUS4EMU_UNLIKELY(!ted.vm.sidEnabled)) {
       ted.vm.sidEnabled = true;
-      if (!(ted.vm.sidFlags & 4))
-        ted.setCallback(&SID::clockCallback, ted.vm.sid_, 1);
-      else
-        ted.setCallback(&(ted.vm.sidCallbackC64), &(ted.vm), 1);
+      ted.vm.setCallback_(&sidCallback, &(ted.vm), 1,
+                          Plus4Emu::PerformanceCounterTable::SID);
+    }
+    else {
+      ted.vm.syncSID();
     }
     uint8_t regNum = uint8_t(addr & 0x001F);
     if (regNum == 0x1E) {
@@ -332,7 +347,9 @@ namespace Plus4 {
     TED7360_& ted = *(reinterpret_cast<TED7360_ *>(userData));
     ted.dataBusState = value;
     if (ted.vm.aciaEnabled) {
+      ted.vm.runACIA();
       ted.vm.acia_.writeRegister(addr, value);
+      ted.vm.runACIA();
       if (ted.vm.acia_.isEnabled())
         ted.vm.setEnableACIACallback(true);
     }
@@ -426,13 +443,14 @@ namespace Plus4 {
     if (is1541HighAccuracy) {
       func = serialDevices[n]->getHighAccuracyProcessCallback();
       if (func) {
-        ted->setCallback(func, userData, 3);
+        setCallback_(func, userData, 3,
+                     Plus4Emu::PerformanceCounterTable::FLOPPY);
         return;
       }
     }
     func = serialDevices[n]->getProcessCallback();
     if (func)
-      ted->setCallback(func, userData, 1);
+      setCallback_(func, userData, 1, Plus4Emu::PerformanceCounterTable::FLOPPY);
   }
 
   void Plus4VM::removeFloppyCallback(int n)
@@ -442,19 +460,39 @@ namespace Plus4 {
     void    *userData = serialDevices[n]->getProcessCallbackUserData();
     func = serialDevices[n]->getProcessCallback();
     if (func)
-      ted->setCallback(func, userData, 0);
+      setCallback_(func, userData, 0, Plus4Emu::PerformanceCounterTable::FLOPPY);
     func = serialDevices[n]->getHighAccuracyProcessCallback();
     if (func)
-      ted->setCallback(func, userData, 0);
+      setCallback_(func, userData, 0, Plus4Emu::PerformanceCounterTable::FLOPPY);
   }
 
   void Plus4VM::resetACIA()
   {
     acia_.reset();
     aciaTimeRemaining = int64_t(0);
+    runACIA();
     setEnableACIACallback(true);
   }
 
+  void Plus4VM::runACIA()
+  {
+    // clock frequency is 1.8432 MHz
+    const int64_t aciaCycleTime = int64_t(2330168889UL);
+    if (aciaTimeRemaining > 0) {
+      int64_t nCycles = ((aciaTimeRemaining - 1) / aciaCycleTime) + 1;
+      aciaTimeRemaining -= (nCycles * aciaCycleTime);
+      if (acia_.isEnabled())
+        acia_.run(uint32_t(nCycles));
+    }
+    // calculate the time until the clock cycle on which the next half bit
+    // is completed, or if the ACIA is disabled, just make sure that
+    // aciaTimeRemaining does not overflow
+    uint32_t  n = 65536U;
+    if (acia_.isEnabled() && acia_.getCyclesRemaining() <= n)
+      n = acia_.getCyclesRemaining();
+    aciaEventTime = int64_t(n > 0U ? (n - 1U) : 0U) * aciaCycleTime;
+  }
+
   M7501 * Plus4VM::getDebugCPU()
   {
     if (currentDebugContext == 0)
@@ -500,21 +538,67 @@ namespace Plus4 {
     vm.soundOutputAccumulator += vm.tapeFeedbackSignal;
   }
 
-  PLUS4EMU_REGPARM1 void Plus4VM::sidCallbackC64(void *userData)
+  PLUS4EMU_REGPARM1 void Plus4VM::sidCallback(void *userData)
   {
     Plus4VM&  vm = *(reinterpret_cast<Plus4VM *>(userData));
+    vm.sidCyclesPending++;
+  }
+
+  void Plus4VM::runSID(uint32_t nCycles)
+  {
+    PLUS4EMU_PERF_SCOPE(perfCounters, SID);
+    if (!(sidFlags & 4)) {
+      sid_->clock_fast(cycle_count(nCycles));
+      return;
+    }
     // FIXME: the accuracy and sound quality of this solution could be improved
-    if (PLUS4EMU_UNLIKELY(!(--(vm.sidCycleCnt)))) {
+    while (nCycles > 0U) {
+      uint32_t  n = uint32_t(sidCycleCnt) - 1U;
+      if (n >= nCycles) {
+        sid_->clock_fast(cycle_count(nCycles));
+        sidCycleCnt = uint8_t(sidCycleCnt - nCycles);
+        break;
+      }
+      sid_->clock_fast(cycle_count(n));
+      nCycles = nCycles - (n + 1U);
       // on every 9th TED single clock cycle (7th if NTSC),
       // run the SID emulation twice and average the outputs
-      vm.sidCycleCnt = (uint8_t(vm.tedInputClockFrequency >> 24) << 1) + 7;
-      vm.soundOutputAccumulator = (vm.soundOutputAccumulator << 1) + 0x40000001;
-      SID::clockCallback(vm.sid_);
-      SID::clockCallback(vm.sid_);
-      vm.soundOutputAccumulator = (vm.soundOutputAccumulator >> 1) - 0x20000000;
-      return;
+      sidCycleCnt = (uint8_t(tedInputClockFrequency >> 24) << 1) + 7;
+      soundOutputAccumulator = (soundOutputAccumulator << 1) + 0x40000001;
+      sid_->clock_fast(2);
+      soundOutputAccumulator = (soundOutputAccumulator >> 1) - 0x20000000;
+    }
+  }
+
+  void Plus4VM::sendSoundOutput(int16_t tedOutput)
+  {
+    int32_t tmp = soundOutputAccumulator;
+    if (tmp != 0) {
+      soundOutputAccumulator = 0;
+      tmp = (tmp >= -1048576 ? (tmp < 1048576 ? tmp : 1048576) : -1048576);
+      tmp = int32_t((uint32_t(tmp * sidOutputVolume)
+                     + uint32_t(0x80004000UL)) >> 15) - int32_t(65536);
+    }
+    soundOutputSignal = tmp + int32_t(tedOutput);
+    PLUS4EMU_PERF_SCOPE(perfCounters, AUDIO);
+    sendMonoAudioOutput(soundOutputSignal);
+  }
+
+  void Plus4VM::syncSID()
+  {
+    // sound output accumulated since the last buffered sample
+    int32_t tmp = soundOutputAccumulator;
+    for (uint32_t i = 0U; i < sidSamplesPending; i++) {
+      soundOutputAccumulator = sidSampleBuf[i].accumulator;
+      runSID(sidSampleBuf[i].sidCycles);
+      sendSoundOutput(sidSampleBuf[i].tedOutput);
+    }
+    sidSamplesPending = 0U;
+    soundOutputAccumulator = tmp;
+    if (sidCyclesPending) {
+      runSID(sidCyclesPending);
+      sidCyclesPending = 0U;
     }
-    SID::clockCallback(vm.sid_);
   }
 
   PLUS4EMU_REGPARM1 void Plus4VM::demoPlayCallback(void *userData)
@@ -613,15 +697,68 @@ namespace Plus4 {
   {
     Plus4VM&  vm = *(reinterpret_cast<Plus4VM *>(userData));
     vm.aciaTimeRemaining += (vm.tedTimesliceLength >> 1);
-    while (vm.aciaTimeRemaining > 0) {
-      // clock frequency is 1.8432 MHz
-      vm.aciaTimeRemaining -= int64_t(2330168889UL);
-      vm.acia_.runOneCycle();
-    }
-    if (vm.acia_.getInterruptFlag())
+    if (vm.aciaTimeRemaining > vm.aciaEventTime)
+      vm.runACIA();
+    if (vm.acia_.getInterruptFlag()) {
       vm.ted->interruptRequest(true);
-    else if (!vm.acia_.isEnabled())
+    }
+    else if (!vm.acia_.isEnabled()) {
+      vm.runACIA();
       vm.setEnableACIACallback(false);
+    }
+  }
+
+  PLUS4EMU_REGPARM1 void Plus4VM::profiledCallback(void *userData)
+  {
+    ProfiledCallback& p = *(reinterpret_cast<ProfiledCallback *>(userData));
+    Plus4Emu::PerformanceCounterScope perfCounterScope_(*(p.counter));
+    p.func(p.userData);
+  }
+
+  void Plus4VM::setCallback_(PLUS4EMU_REGPARM1 void (*func)(void *userData),
+                             void *userData_, int flags_, int perfCounterNdx)
+  {
+#ifdef ENABLE_PERF_COUNTERS
+    if (!func)
+      return;
+    ProfiledCallback  *p = (ProfiledCallback *) 0;
+    for (int i = 0; i < 8; i++) {
+      if (profiledCallbacks[i].func == func &&
+          profiledCallbacks[i].userData == userData_) {
+        p = &(profiledCallbacks[i]);
+        break;
+      }
+    }
+    if (!p) {
+      if (!flags_) {
+        ted->setCallback(func, userData_, 0);
+        return;
+      }
+      for (int i = 0; i < 8; i++) {
+        if (!profiledCallbacks[i].func) {
+          p = &(profiledCallbacks[i]);
+          break;
+        }
+      }
+      if (!p) {
+        // no free slot, call the function without profiling
+        ted->setCallback(func, userData_, flags_);
+        return;
+      }
+      p->func = func;
+      p->userData = userData_;
+    }
+    p->counter = &(perfCounters.ticks[perfCounterNdx]);
+    ted->setCallback(&profiledCallback, p, flags_);
+    if (!flags_) {
+      p->func = (PLUS4EMU_REGPARM1 void (*)(void *)) 0;
+      p->userData = (void *) 0;
+      p->counter = (uint64_t *) 0;
+    }
+#else
+    (void) perfCounterNdx;
+    ted->setCallback(func, userData_, flags_);
+#endif
   }
 
   PLUS4EMU_REGPARM1 void Plus4VM::pasteTextCallback(void *userData)
@@ -831,6 +968,8 @@ namespace Plus4 {
       digiBlasterOutput(0x80),
       sidCycleCnt(4),
       sidFlags(0),
+      sidCyclesPending(0U),
+      sidSamplesPending(0U),
       is1541HighAccuracy(true),
       serialBusDelayOffset(0),
       floppyROM_1541((uint8_t *) 0),
@@ -853,6 +992,8 @@ namespace Plus4 {
       videoCapture((Plus4Emu::VideoCapture *) 0),
       acia_(),
       aciaTimeRemaining(0),
+      aciaEventTime(0),
+      aciaHostPort((ACIAHostPort *) 0),
       aciaEnabled(false),
       aciaCallbackFlag(false),
       drive8Is1551(false),
@@ -864,10 +1005,17 @@ namespace Plus4 {
       pasteTextCursorPositionX(-1),
       pasteTextCursorPositionY(-1),
       pasteTextBufferPos(0),
-      pasteTextBuffer((char *) 0)
+      pasteTextBuffer((char *) 0),
+      perfCounters(),
+      perfCounterFrameTime(0)
   {
     for (int i = 0; i < 12; i++)
       serialDevices[i] = (SerialDevice *) 0;
+    for (int i = 0; i < 8; i++) {
+      profiledCallbacks[i].func = (PLUS4EMU_REGPARM1 void (*)(void *)) 0;
+      profiledCallbacks[i].userData = (void *) 0;
+      profiledCallbacks[i].counter = (uint64_t *) 0;
+    }
     sid_ = new SID(soundOutputAccumulator);
     try {
       sid_->set_chip_model(MOS8580);
@@ -934,6 +1082,8 @@ namespace Plus4 {
     delete sid_;
     if (videoBreakPoints)
       delete[] videoBreakPoints;
+    if (aciaHostPort)
+      delete aciaHostPort;
   }
 
   void Plus4VM::run(size_t microseconds)
@@ -955,18 +1105,38 @@ namespace Plus4 {
         ted->setTapeInput(false);
         tapeFeedbackSignal = 0;
       }
-      ted->setCallback(&tapeCallback, this, (tapeCallbackFlag ? 1 : 0));
+      setCallback_(&tapeCallback, this, (tapeCallbackFlag ? 1 : 0),
+                   Plus4Emu::PerformanceCounterTable::TAPE);
     }
     tedTimeRemaining = tedTimeRemaining + (int64_t(microseconds) << 32);
     int32_t tedCycles = int32_t(double(tedTimeRemaining)
                                 * double(int32_t(tedInputClockFrequency))
                                 * (1.0 / 4294967296000000.0));
     if (tedCycles >= 0) {
+      PLUS4EMU_PERF_SCOPE(perfCounters, TOTAL);
       tedCycles = tedCycles - ted->run(tedCycles);
       tedTimeRemaining = tedTimeRemaining
                          - int64_t(double(tedCycles) * 4294967296000000.0
                                    / double(int32_t(tedInputClockFrequency)));
     }
+    syncSID();
+    if (aciaHostPort)
+      aciaHostPort->flush();
+#ifdef ENABLE_PERF_COUNTERS
+    perfCounterFrameTime += microseconds;
+    size_t  framePeriod = (!ted->getIsNTSCMode() ? 20000 : 16683);
+    if (perfCounterFrameTime >= framePeriod) {
+      perfCounterFrameTime -= framePeriod;
+      perfCounters.frameDone();
+    }
+#endif
+    if (aciaHostPort) {
+      // host I/O errors are recorded while the ACIA is running, and
+      // reported here, outside of the emulation callbacks
+      const char  *errorMessage = aciaHostPort->checkError();
+      if (errorMessage)
+        throw Plus4Emu::Exception(errorMessage);
+    }
   }
 
   void Plus4VM::reset(bool isColdReset)
@@ -974,6 +1144,7 @@ namespace Plus4 {
     stopDemoPlayback();         // TODO: should be recorded as an event ?
     stopDemoRecording(false);
     removePasteTextCallback();
+    syncSID();
     ted->reset(isColdReset);
     setTapeMotorState(false);
     sid_->reset();
@@ -981,8 +1152,8 @@ namespace Plus4 {
     sid_->input(0);
     if (isColdReset) {
       sidEnabled = false;
-      ted->setCallback(&SID::clockCallback, sid_, 0);
-      ted->setCallback(&sidCallbackC64, this, 0);
+      setCallback_(&sidCallback, this, 0,
+                   Plus4Emu::PerformanceCounterTable::SID);
       disableUnusedFloppyDrives();
     }
     resetFloppyDrive(-1);
@@ -1157,9 +1328,36 @@ namespace Plus4 {
     }
   }
 
+  void Plus4VM::setACIAHostPort(int type, const std::string& name,
+                                const std::string& outFileName)
+  {
+    ACIAHostPort  *newPort =
+        ACIAHostPort::create(type, name, outFileName);
+    if (newPort || aciaHostPort) {
+      // received data cannot be recorded in demos, so connecting or
+      // disconnecting a host port stops any demo playback or recording,
+      // like other configuration changes; the demo file is closed by
+      // getVMStatus(), which also notifies the user interface
+      stopDemoPlayback();
+      stopDemoRecording(false);
+    }
+    acia_.setHostPort(newPort);
+    if (aciaHostPort)
+      delete aciaHostPort;
+    aciaHostPort = newPort;
+  }
+
+  std::string Plus4VM::getACIAHostPortName() const
+  {
+    if (!aciaHostPort)
+      return std::string("");
+    return aciaHostPort->getName();
+  }
+
   void Plus4VM::setSIDConfiguration(uint8_t sidFlags_, bool enableDigiBlaster,
                                     int outputVolume)
   {
+    syncSID();
     sidFlags_ = sidFlags_ & 7;
     if (sidFlags_ != sidFlags) {
       uint8_t changeMask = sidFlags_ ^ sidFlags;
@@ -1173,10 +1371,6 @@ namespace Plus4 {
         stopDemoRecording(false);
         if (changeMask & 2)
           ted->setEnableC64CompatibleSID(bool(sidFlags_ & 2));
-        if (sidEnabled && (changeMask & 4) != 0) {
-          ted->setCallback(&SID::clockCallback, sid_, int(!(sidFlags_ & 4)));
-          ted->setCallback(&sidCallbackC64, this, int(bool(sidFlags_ & 4)));
-        }
       }
     }
     digiBlasterEnabled = enableDigiBlaster;
@@ -1200,12 +1394,13 @@ namespace Plus4 {
     if (sidEnabled) {
       stopDemoPlayback();
       stopDemoRecording(false);
+      syncSID();
       sid_->reset();
       digiBlasterOutput = 0x80;
       sid_->input(0);
       sidEnabled = false;
-      ted->setCallback(&SID::clockCallback, sid_, 0);
-      ted->setCallback(&sidCallbackC64, this, 0);
+      setCallback_(&sidCallback, this, 0,
+                   Plus4Emu::PerformanceCounterTable::SID);
     }
   }
 
@@ -1271,6 +1466,168 @@ namespace Plus4 {
     ted->setCallback(&pasteTextCallback, (void *) this, 1);
   }
 
+  bool Plus4VM::waitForEditorInput(size_t timeout)
+  {
+    // run emulation in short time slices until all characters are read from
+    // the keyboard buffer, and the editor is waiting for input again
+    while (ted->readMemoryCPU(0x00EF) != 0 ||
+           ted->readMemoryCPU(0x055D) != 0 ||
+           !checkEditorMode()) {
+      if (timeout < 500)
+        return false;
+      timeout -= 500;
+      run(500);
+    }
+    return true;
+  }
+
+  void Plus4VM::typeKeys(const std::vector< uint8_t >& buf)
+  {
+    size_t  bufPos = 0;
+    while (bufPos < buf.size()) {
+      // time out after about 5 seconds (or 2 seconds for the first character)
+      if (!waitForEditorInput(bufPos > 0 ? 5000000 : 2000000))
+        throw Plus4Emu::Exception("timeout waiting for keyboard input");
+      // store characters in keyboard buffer until it is full or end of line
+      int     charCnt = 0;
+      uint8_t c = 0x00;
+      do {
+        c = buf[bufPos++];
+        ted->writeMemoryCPU(uint16_t(0x0527 + charCnt), c);
+        charCnt++;
+      } while (charCnt < 10 && c != 0x0D && bufPos < buf.size());
+      ted->writeMemoryCPU(0x00EF, uint8_t(charCnt));
+    }
+  }
+
+  void Plus4VM::storeBASICLines(const std::vector< uint8_t >& buf)
+  {
+    // wait until any previously typed lines are processed
+    if (!waitForEditorInput(5000000))
+      throw Plus4Emu::Exception("timeout waiting for keyboard input");
+    std::map< uint16_t, std::vector< uint8_t > >  lines;
+    uint16_t  startAddr = uint16_t(ted->readMemoryCPU(0x002B, true))
+                          | (uint16_t(ted->readMemoryCPU(0x002C, true)) << 8);
+    uint16_t  endAddr = uint16_t(ted->readMemoryCPU(0x0037, true))
+                        | (uint16_t(ted->readMemoryCPU(0x0038, true)) << 8);
+    // read the current program
+    uint32_t  addr = startAddr;
+    while ((addr + 4U) < endAddr) {
+      if (ted->readMemoryCPU(uint16_t(addr + 1U), true) == 0x00)
+        break;                  // end of program
+      uint8_t   l = ted->readMemoryCPU(uint16_t(addr + 2U), true);
+      uint8_t   h = ted->readMemoryCPU(uint16_t(addr + 3U), true);
+      uint16_t  lineNum = uint16_t(l) | (uint16_t(h) << 8);
+      std::vector< uint8_t >& lineBuf = lines[lineNum];
+      lineBuf.clear();
+      for (addr = addr + 4U; addr < endAddr; addr++) {
+        uint8_t c = ted->readMemoryCPU(uint16_t(addr), true);
+        if (c == 0x00)
+          break;
+        lineBuf.push_back(c);
+      }
+      addr++;
+    }
+    // add, replace, or delete lines
+    for (size_t i = 0; i < buf.size(); ) {
+      size_t  j = i;
+      while (j < buf.size() && buf[j] != 0x0D)
+        j++;
+      uint32_t  lineNum = 0U;
+      for ( ; i < j && (buf[i] == 0x20 || (buf[i] >= 0x30 && buf[i] <= 0x39));
+           i++) {
+        if (buf[i] != 0x20) {
+          lineNum = (lineNum * 10U) + uint32_t(buf[i] - 0x30);
+          if (lineNum > 63999U)
+            throw Plus4Emu::Exception("invalid BASIC line number");
+        }
+      }
+      std::vector< uint8_t >  lineBuf;
+      if (i < j)
+        Plus4::tokenizeBASICLine(lineBuf, &(buf.front()) + i, j - i);
+      if (lineBuf.size() > 0)
+        lines[uint16_t(lineNum)] = lineBuf;
+      else
+        lines.erase(uint16_t(lineNum));
+      i = j + 1;
+    }
+    // write the new program, and set the BASIC pointers
+    std::vector< uint8_t >  prgBuf;
+    for (std::map< uint16_t, std::vector< uint8_t > >::const_iterator i_ =
+             lines.begin(); i_ != lines.end(); i_++) {
+      uint32_t  nextLineAddr =
+          uint32_t(startAddr) + uint32_t(prgBuf.size() + i_->second.size() + 5);
+      if ((nextLineAddr + 2U) > endAddr)
+        throw Plus4Emu::Exception("out of memory for BASIC program");
+      prgBuf.push_back(uint8_t(nextLineAddr & 0xFFU));
+      prgBuf.push_back(uint8_t((nextLineAddr >> 8) & 0xFFU));
+      prgBuf.push_back(uint8_t(i_->first & 0xFF));
+      prgBuf.push_back(uint8_t((i_->first >> 8) & 0xFF));
+      prgBuf.insert(prgBuf.end(), i_->second.begin(), i_->second.end());
+      prgBuf.push_back(0x00);
+    }
+    prgBuf.push_back(0x00);
+    prgBuf.push_back(0x00);
+    ted->injectProgram(&(prgBuf.front()), prgBuf.size(), startAddr);
+  }
+
+  void Plus4VM::typeText(const char *s, bool tokenizeBASIC)
+  {
+    if (s == (char *) 0 || s[0] == '\0')
+      return;           // nothing to type
+    if (isRecordingDemo | isPlayingDemo)
+      return;
+    removePasteTextCallback();
+    bool    lowerCaseMode = bool(ted->readMemoryCPU(0xFF13) & 0x04);
+    std::vector< uint8_t >  keyBuf;
+    std::vector< uint8_t >  basicBuf;
+    size_t  bufPos = 0;
+    bool    eofFlag = false;
+    do {
+      // convert the next line to PETSCII
+      std::vector< uint8_t >  lineBuf;
+      while (true) {
+        uint8_t c = Plus4Emu::utf8ToPETSCII(s, bufPos, lowerCaseMode);
+        if (c == 0x00) {
+          eofFlag = true;
+          break;
+        }
+        if (c == 0xFF)
+          continue;             // ignore invalid characters
+        if (c == '\t')
+          c = ' ';              // convert tabs to spaces
+        lineBuf.push_back(c);
+        if (c == 0x0D)
+          break;
+      }
+      size_t  i = 0;
+      while (i < lineBuf.size() && lineBuf[i] == 0x20)
+        i++;
+      if (tokenizeBASIC &&
+          i < lineBuf.size() && lineBuf[i] >= 0x30 && lineBuf[i] <= 0x39) {
+        // numbered program line: type any preceding text first
+        if (keyBuf.size() > 0) {
+          typeKeys(keyBuf);
+          keyBuf.clear();
+        }
+        if (lineBuf.back() != 0x0D)
+          lineBuf.push_back(0x0D);
+        basicBuf.insert(basicBuf.end(), lineBuf.begin(), lineBuf.end());
+      }
+      else if (lineBuf.size() > 0) {
+        if (basicBuf.size() > 0) {
+          storeBASICLines(basicBuf);
+          basicBuf.clear();
+        }
+        keyBuf.insert(keyBuf.end(), lineBuf.begin(), lineBuf.end());
+      }
+    } while (!eofFlag);
+    if (basicBuf.size() > 0)
+      storeBASICLines(basicBuf);
+    if (keyBuf.size() > 0)
+      typeKeys(keyBuf);
+  }
+
   std::string Plus4VM::copyText(int xPos, int yPos) const
   {
     std::string s;
@@ -1429,12 +1786,22 @@ namespace Plus4 {
     }
     if (n == prvPrinterType)
       return;                   // printer type is not changed, nothing to do
+    bool    pageWriteError = false;
     if (prvPrinterType != 0) {
       // delete previous printer object
       printerOutputChangedFlag = true;
       Printer *printer_ = reinterpret_cast<Printer *>(printerDevice);
-      ted->setCallback(printer_->getProcessCallback(),
-                       printer_->getProcessCallbackUserData(), 0);
+      try {
+        // save any remaining pages before the printer is deleted, so that
+        // errors can be reported
+        printer_->setPageOutputFile((char *) 0);
+      }
+      catch (...) {
+        pageWriteError = true;
+      }
+      setCallback_(printer_->getProcessCallback(),
+                   printer_->getProcessCallbackUserData(), 0,
+                   Plus4Emu::PerformanceCounterTable::PRINTER);
       delete printerDevice;
       printerDevice = (SerialDevice *) 0;
       ted->serialPort.removeDevice(printerDeviceNumber);
@@ -1444,8 +1811,9 @@ namespace Plus4 {
       MPS801  *printer_ = new MPS801(ted->serialPort, printerDeviceNumber);
       printerDevice = printer_;
       printer_->setROMImage(5, printerROM_MPS801);
-      ted->setCallback(printer_->getProcessCallback(),
-                       printer_->getProcessCallbackUserData(), 1);
+      setCallback_(printer_->getProcessCallback(),
+                   printer_->getProcessCallbackUserData(), 1,
+                   Plus4Emu::PerformanceCounterTable::PRINTER);
     }
     else if (n >= 2) {          // 1526/MPS-802
       VC1526  *printer_ = new VC1526(ted->serialPort, printerDeviceNumber);
@@ -1453,8 +1821,9 @@ namespace Plus4 {
       printer_->setROMImage(4, printerROM_1526);
       printer_->setEnable1525Mode(n == 3);
       printer_->setFormFeedOn(printerFormFeedOn);
-      ted->setCallback(printer_->getProcessCallback(),
-                       printer_->getProcessCallbackUserData(), 1);
+      setCallback_(printer_->getProcessCallback(),
+                   printer_->getProcessCallbackUserData(), 1,
+                   Plus4Emu::PerformanceCounterTable::PRINTER);
       printer_->setBreakPointCallback(breakPointCallback,
                                       breakPointCallbackUserData);
       M7501   *p = printer_->getCPU();
@@ -1464,14 +1833,17 @@ namespace Plus4 {
         p->setBreakOnInvalidOpcode(ted->getIsBreakOnInvalidOpcode());
       }
     }
+    if (pageWriteError)
+      throw Plus4Emu::Exception("error writing printer page image file");
   }
 
-  void Plus4VM::getPrinterOutput(const uint8_t*& buf_, int& w_, int& h_) const
+  void Plus4VM::getPrinterOutput(const uint8_t*& buf_, int& w_, int& h_,
+                                 int y0, int y1) const
   {
     Printer *printer_ =
         reinterpret_cast<Printer *>(serialDevices[printerDeviceNumber]);
     if (printer_) {
-      buf_ = printer_->getPageData();
+      buf_ = printer_->getPageData(y0, y1);
       w_ = printer_->getPageWidth();
       h_ = printer_->getPageHeight();
     }
@@ -1482,6 +1854,20 @@ namespace Plus4 {
     }
   }
 
+  void Plus4VM::getPrinterPageSize(int& w_, int& h_) const
+  {
+    Printer *printer_ =
+        reinterpret_cast<Printer *>(serialDevices[printerDeviceNumber]);
+    if (printer_) {
+      w_ = printer_->getPageWidth();
+      h_ = printer_->getPageHeight();
+    }
+    else {
+      w_ = 0;
+      h_ = 0;
+    }
+  }
+
   void Plus4VM::clearPrinterOutput()
   {
     Printer *printer_ =
@@ -1554,6 +1940,21 @@ namespace Plus4 {
     }
   }
 
+  void Plus4VM::setPrinterPageOutputFile(const char *fileName)
+  {
+    Printer *printer_ =
+        reinterpret_cast<Printer *>(serialDevices[printerDeviceNumber]);
+    if (!printer_) {
+      if (fileName != (char *) 0 && fileName[0] != '\0') {
+        throw Plus4Emu::Exception("cannot set printer output file "
+                                  "- printer emulation is not enabled");
+      }
+    }
+    else {
+      printer_->setPageOutputFile(fileName);
+    }
+  }
+
   void Plus4VM::getVMStatus(VMStatus& vmStatus_)
   {
     vmStatus_.tapeReadOnly = getIsTapeReadOnly();
@@ -1603,6 +2004,40 @@ namespace Plus4 {
     vmStatus_.isRecordingDemo = isRecordingDemo;
   }
 
+  void Plus4VM::getPerformanceCounters(
+      VirtualMachine::PerformanceCounters& perfCounters_)
+  {
+    VirtualMachine::getPerformanceCounters(perfCounters_);
+#ifdef ENABLE_PERF_COUNTERS
+    double  t[Plus4Emu::PerformanceCounterTable::COUNTERS];
+    perfCounters_.frameCount = perfCounters.getAverageFrameTimes(&(t[0]));
+    if (!perfCounters_.frameCount)
+      return;
+    perfCounters_.totalTime = t[Plus4Emu::PerformanceCounterTable::TOTAL];
+    perfCounters_.sidTime = t[Plus4Emu::PerformanceCounterTable::SID];
+    perfCounters_.floppyDriveTime =
+        t[Plus4Emu::PerformanceCounterTable::FLOPPY];
+    perfCounters_.printerTime = t[Plus4Emu::PerformanceCounterTable::PRINTER];
+    perfCounters_.videoCaptureTime =
+        t[Plus4Emu::PerformanceCounterTable::VIDEO_CAPTURE];
+    perfCounters_.audioOutputTime =
+        t[Plus4Emu::PerformanceCounterTable::AUDIO];
+    perfCounters_.displayTime = t[Plus4Emu::PerformanceCounterTable::DISPLAY];
+    perfCounters_.tapeTime = t[Plus4Emu::PerformanceCounterTable::TAPE];
+    double  tedTime = perfCounters_.totalTime;
+    for (int i = 1; i < int(Plus4Emu::PerformanceCounterTable::COUNTERS); i++)
+      tedTime -= t[i];
+    perfCounters_.tedTime = (tedTime > 0.0 ? tedTime : 0.0);
+#endif
+  }
+
+  void Plus4VM::resetPerformanceCounters()
+  {
+#ifdef ENABLE_PERF_COUNTERS
+    perfCounters.reset();
+#endif
+  }
+
   void Plus4VM::openVideoCapture(
       int frameRate_,
       bool yuvFormat_,
@@ -1622,7 +2057,8 @@ namespace Plus4 {
                                             frameRate_);
       }
       videoCapture->setClockFrequency(soundClockFrequency << 3);
-      ted->setCallback(&videoCaptureCallback, this, 3);
+      setCallback_(&videoCaptureCallback, this, 3,
+                   Plus4Emu::PerformanceCounterTable::VIDEO_CAPTURE);
     }
     videoCapture->setErrorCallback(errorCallback_, userData_);
     videoCapture->setFileNameCallback(fileNameCallback_, userData_);
@@ -1648,7 +2084,8 @@ namespace Plus4 {
   void Plus4VM::closeVideoCapture()
   {
     if (videoCapture) {
-      ted->setCallback(&videoCaptureCallback, this, 0);
+      setCallback_(&videoCaptureCallback, this, 0,
+                   Plus4Emu::PerformanceCounterTable::VIDEO_CAPTURE);
       delete videoCapture;
       videoCapture = (Plus4Emu::VideoCapture *) 0;
     }
@@ -2349,6 +2786,7 @@ namespace Plus4 {
 
   void Plus4VM::saveState(Plus4Emu::File& f)
   {
+    syncSID();
     ted->saveState(f);
     sid_->saveState(f);
     {
@@ -2363,6 +2801,7 @@ namespace Plus4 {
       buf.writeByte(sidCycleCnt);
       buf.writeBoolean(digiBlasterEnabled);
       buf.writeByte(digiBlasterOutput);
+      runACIA();
       buf.writeBoolean(aciaEnabled);
       buf.writeBoolean(aciaCallbackFlag);
       buf.writeInt64(aciaTimeRemaining);
@@ -2402,6 +2841,23 @@ namespace Plus4 {
     ted->loadProgram(fileName);
   }
 
+  void Plus4VM::loadProgramCached(const char *fileName)
+  {
+    const ProgramCache::Program&  prg =
+        ProgramCache::getInstance().loadProgram(fileName);
+    ted->injectProgram((prg.data.size() > 0 ?
+                        &(prg.data.front()) : (uint8_t *) 0),
+                       prg.data.size(), prg.startAddress);
+  }
+
+  void Plus4VM::injectProgram(const uint8_t *buf, size_t nBytes)
+  {
+    if (nBytes < 2)
+      throw Plus4Emu::Exception("unexpected end of plus4 program file");
+    ted->injectProgram(buf + 2, nBytes - 2,
+                       uint16_t(buf[0]) | (uint16_t(buf[1]) << 8));
+  }
+
   void Plus4VM::recordDemo(Plus4Emu::File& f)
   {
     // turn off tape motor, stop any previous demo recording or playback,
@@ -2496,10 +2952,8 @@ namespace Plus4 {
         sid_->input((int(digiBlasterOutput) << 8) - 32768);
       else
         sid_->input(0);
-      ted->setCallback(&SID::clockCallback, sid_,
-                       int(sidEnabled) & int(!(sidFlags & 4)));
-      ted->setCallback(&sidCallbackC64, this,
-                       int(sidEnabled) & int(bool(sidFlags & 4)));
+      setCallback_(&sidCallback, this, int(sidEnabled),
+                   Plus4Emu::PerformanceCounterTable::SID);
       aciaEnabled = (ted->getRAMSize() >= 64);
       resetACIA();
       if (version >= 0x01000002) {
@@ -2515,6 +2969,7 @@ namespace Plus4 {
           tmpBuf[i] = buf.readByte();
         if (aciaEnabled)
           acia_.loadSnapshot(&(tmpBuf[0]));
+        runACIA();
       }
       if (buf.getPosition() != buf.getDataSize())
         throw Plus4Emu::Exception("trailing garbage at end of "
@@ -27,6 +27,7 @@
 #include "vm.hpp"
 #include "serial.hpp"
 #include "acia6551.hpp"
+#include "perfcnt.hpp"
 
 namespace Plus4Emu {
   class VideoCapture;
@@ -119,6 +120,19 @@ namespace Plus4 {
     // bit 1 = enable write access at $D400-$D41F
     // bit 2 = run SID emulation at C64 clock frequency
     uint8_t   sidFlags;
+    // the SID emulation is run in batches: the TED callback only counts
+    // the cycles, and the TED sound output is buffered until the SID is
+    // synchronized (on register access, and when the buffer is full)
+    uint32_t  sidCyclesPending;
+    uint32_t  sidSamplesPending;
+    struct SIDSampleBufEntry {
+      // sound output accumulated from sources other than the SID
+      int32_t   accumulator;
+      // number of SID cycles to run before mixing this sample
+      uint32_t  sidCycles;
+      int16_t   tedOutput;
+    };
+    SIDSampleBufEntry sidSampleBuf[256];
     bool      is1541HighAccuracy;
     int16_t   serialBusDelayOffset;
     SerialDevice  *serialDevices[12];
@@ -143,6 +157,9 @@ namespace Plus4 {
     Plus4Emu::VideoCapture  *videoCapture;
     ACIA6551  acia_;
     int64_t   aciaTimeRemaining;        // in 2^-32 microsecond units
+    // the ACIA is run only when aciaTimeRemaining exceeds this value
+    int64_t   aciaEventTime;
+    ACIAHostPort  *aciaHostPort;
     bool      aciaEnabled;
     bool      aciaCallbackFlag;
     bool      drive8Is1551;
@@ -155,6 +172,16 @@ namespace Plus4 {
     int       pasteTextCursorPositionY;
     size_t    pasteTextBufferPos;
     char      *pasteTextBuffer;
+    Plus4Emu::PerformanceCounterTable perfCounters;
+    // emulated time since the end of the last frame for performance counters,
+    // in microseconds
+    size_t    perfCounterFrameTime;
+    struct ProfiledCallback {
+      PLUS4EMU_REGPARM1 void (*func)(void *);
+      void      *userData;
+      uint64_t  *counter;
+    };
+    ProfiledCallback  profiledCallbacks[8];
     // ----------------
     void stopDemoPlayback();
     void stopDemoRecording(bool writeFile_);
@@ -162,11 +189,22 @@ namespace Plus4 {
     void addFloppyCallback(int n);
     void removeFloppyCallback(int n);
     void resetACIA();
+    // run the ACIA for all clock cycles elapsed until aciaTimeRemaining,
+    // and calculate the time of the next bit event
+    void runACIA();
     M7501 * getDebugCPU();
     const M7501 * getDebugCPU() const;
     static PLUS4EMU_REGPARM1 void tapeCallback(void *userData);
-    // run SID emulation at 10/9 * TED single clock frequency
-    static PLUS4EMU_REGPARM1 void sidCallbackC64(void *userData);
+    // count SID cycles to be run by syncSID()
+    static PLUS4EMU_REGPARM1 void sidCallback(void *userData);
+    // run 'nCycles' SID cycles; if the C64 clock frequency is used,
+    // the SID emulation is run at 10/9 * TED single clock frequency
+    void runSID(uint32_t nCycles);
+    // mix SID and TED sound output, and send the result to the audio output
+    void sendSoundOutput(int16_t tedOutput);
+    // run the SID emulation for all pending cycles, and mix and send the
+    // buffered sound output
+    void syncSID();
     static PLUS4EMU_REGPARM1 void demoPlayCallback(void *userData);
     static PLUS4EMU_REGPARM1 void demoRecordCallback(void *userData);
     static PLUS4EMU_REGPARM1 void videoBreakPointCheckCallback(void *userData);
@@ -180,10 +218,25 @@ namespace Plus4 {
         aciaCallbackFlag = isEnabled;
       }
     }
+    static PLUS4EMU_REGPARM1 void profiledCallback(void *userData);
+    // Same as TED7360::setCallback(), but if performance counters are
+    // enabled, the time spent in 'func' is added to counter 'perfCounterNdx'
+    // (see PerformanceCounterTable).
+    void setCallback_(PLUS4EMU_REGPARM1 void (*func)(void *userData),
+                      void *userData_, int flags_, int perfCounterNdx);
     static PLUS4EMU_REGPARM1 void pasteTextCallback(void *userData);
     void removePasteTextCallback();
     bool checkEditorMode() const;
     void setCursorPosition_(int xPos, int yPos);
+    // run emulation until the editor is waiting for keyboard input, for at
+    // most 'timeout' microseconds; returns false on timeout
+    bool waitForEditorInput(size_t timeout);
+    // type PETSCII characters, refilling the keyboard buffer as soon as it
+    // is empty
+    void typeKeys(const std::vector< uint8_t >& buf);
+    // tokenize numbered BASIC lines (separated by carriage returns), and
+    // merge them into the program in memory
+    void storeBASICLines(const std::vector< uint8_t >& buf);
    public:
     Plus4VM(Plus4Emu::VideoDisplay&, Plus4Emu::AudioOutput&);
     virtual ~Plus4VM();
@@ -238,6 +291,27 @@ namespace Plus4 {
      * Set if the 6551 ACIA should be emulated.
      */
     virtual void setEnableACIAEmulation(bool isEnabled);
+    /*!
+     * Connect the emulated ACIA to a host byte stream (see aciaport.hpp);
+     * 'type' can be one of:
+     *   0: none (default)
+     *   1: replay received data from file 'name', and write the
+     *      transmitted data to 'outFileName' (if it is not empty)
+     *   2: pseudo terminal; use getACIAHostPortName() to query the name
+     *      of the slave device
+     *   3: Unix domain socket 'name'
+     * Changing the host port stops any demo playback or recording. I/O
+     * errors and a closed connection are reported by run() with an
+     * exception. If the host does not read the output, the emulated
+     * transmitter waits until there is space in the buffer.
+     */
+    virtual void setACIAHostPort(int type, const std::string& name,
+                                 const std::string& outFileName);
+    /*!
+     * Returns the name of the device the ACIA is connected to, or an
+     * empty string if there is no host port.
+     */
+    virtual std::string getACIAHostPortName() const;
     /*!
      * Set SID emulation parameters. 'outputVolume' should be specified in
      * decibels (-8 to +2). 'sidFlags_' can be the sum of:
@@ -284,6 +358,18 @@ namespace Plus4 {
      * first if both are non-negative.
      */
     virtual void pasteText(const char *s, int xPos, int yPos);
+    /*!
+     * Type the text from 's' on the keyboard of the emulated machine, running
+     * the emulation until all characters are read by the editor. Unlike
+     * pasteText(), this function does not return until the last keyboard
+     * buffer full of characters is stored, and the buffer is refilled as soon
+     * as it is empty. If 'tokenizeBASIC' is true, lines beginning with a line
+     * number are not typed, but are tokenized and stored directly in the
+     * BASIC program memory (a line number alone deletes the line).
+     * Throws Plus4Emu::Exception if the editor does not read the input within
+     * a few seconds of emulated time, or on out of memory.
+     */
+    virtual void typeText(const char *s, bool tokenizeBASIC = false);
     /*!
      * Set the type of printer to be emulated:
      *   0: disable printer emulation (default)
@@ -294,11 +380,17 @@ namespace Plus4 {
     virtual void setPrinterType(int n);
     /*!
      * Get the current printer output as an 8-bit greyscale image.
-     * 'buf_' contains 'w_' * 'h_' bytes. If there is no printer, a NULL
-     * buffer pointer, and zero width and height will be returned.
+     * 'buf_' contains 'w_' * 'h_' bytes, of which only lines 'y0' to
+     * 'y1' - 1 are guaranteed to be up to date. If there is no printer,
+     * a NULL buffer pointer, and zero width and height will be returned.
+     */
+    virtual void getPrinterOutput(const uint8_t*& buf_, int& w_, int& h_,
+                                  int y0, int y1) const;
+    /*!
+     * Get the printer page width and height in pixels (zero if there is
+     * no printer), without updating or allocating the page image.
      */
-    virtual void getPrinterOutput(const uint8_t*& buf_,
-                                  int& w_, int& h_) const;
+    virtual void getPrinterPageSize(int& w_, int& h_) const;
     /*!
      * Clear the printer output buffer, and reset the head position to
      * the top of the page.
@@ -313,7 +405,7 @@ namespace Plus4 {
      * Returns the current position of the printer head. 'xPos' is in the
      * range 0 (left) to page width - 1 (right), 'yPos' is in the range 0
      * (top) to page height - 1 (bottom). The page width and height can be
-     * determined with getPrinterOutput().
+     * determined with getPrinterPageSize().
      * If printer emulation is not enabled, -1,-1 is returned.
      */
     virtual void getPrinterHeadPosition(int& xPos, int& yPos);
@@ -338,12 +430,33 @@ namespace Plus4 {
      */
     virtual void setPrinterTextOutputFile(const char *fileName,
                                           bool asciiMode = false);
+    /*!
+     * Write each completed printer page to a separate image file, with the
+     * page number inserted before the extension of 'fileName'; the format is
+     * PBM if the extension is ".pbm", and PNG otherwise. A page is completed
+     * when the paper reaches the bottom margin, or when clearPrinterOutput()
+     * is called. The files are written on a separate thread.
+     * If 'fileName' is NULL or empty, then the current page is written if it
+     * is not empty, and the output is closed.
+     * On error, Plus4Emu::Exception may be thrown.
+     * NOTE: printer emulation must be enabled before calling this function.
+     */
+    virtual void setPrinterPageOutputFile(const char *fileName);
     /*!
      * Returns status information about the emulated machine (see also
      * struct VMStatus above, and the comments for functions that return
      * individual status values).
      */
     virtual void getVMStatus(VirtualMachine::VMStatus& vmStatus_);
+    /*!
+     * Returns the average time spent per video frame in each emulated
+     * subsystem since the previous call of this function, and resets the
+     * counters. This is only implemented if the emulator is built with
+     * ENABLE_PERF_COUNTERS defined, otherwise all values are zero.
+     */
+    virtual void getPerformanceCounters(
+        VirtualMachine::PerformanceCounters& perfCounters_);
+    virtual void resetPerformanceCounters();
     /*!
      * Create video capture object with the specified frame rate (24 to 60)
      * and format (384x288 RLE8 or 384x288 YV12) if it does not exist yet,
@@ -623,6 +736,17 @@ namespace Plus4 {
      * Load program.
      */
     virtual void loadProgram(const char *fileName);
+    /*!
+     * Load program like loadProgram(), but using the program cache shared
+     * by all virtual machines (see prgcache.hpp); the file is read only on
+     * the first call, and the program data is copied directly to RAM.
+     */
+    virtual void loadProgramCached(const char *fileName);
+    /*!
+     * Load program in PRG format (load address followed by the data) from
+     * a memory buffer.
+     */
+    virtual void injectProgram(const uint8_t *buf, size_t nBytes);
     /*!
      * Register all types of file data supported by this class, for use by
      * Plus4Emu::File::processAllChunks(). Note that loading snapshot data
@@ -0,0 +1,241 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "plus4emu.hpp"
+#include "system.hpp"
+#include "fileio.hpp"
+#include "prgcache.hpp"
+
+namespace Plus4 {
+
+  ProgramCache::ProgramCache()
+  {
+  }
+
+  ProgramCache::~ProgramCache()
+  {
+    clear();
+  }
+
+  uint16_t ProgramCache::decodeProgram(std::vector< uint8_t >& buf, bool isP00)
+  {
+    size_t  offs = 0;
+    if (isP00 && buf.size() >= 26) {
+      static const char *p00HeaderMagic = "C64File";
+      bool    isP00Header = true;
+      for (size_t i = 0; i < 8; i++) {
+        if (buf[i] != uint8_t(p00HeaderMagic[i]))
+          isP00Header = false;
+      }
+      if (isP00Header)
+        offs = 26;
+    }
+    if ((buf.size() - offs) < 2)
+      throw Plus4Emu::Exception("unexpected end of plus4 program file");
+    if ((buf.size() - offs) > (0xFFFF + 2))
+      throw Plus4Emu::Exception("plus4 program file has invalid length");
+    uint16_t  addr = uint16_t(buf[offs]) | (uint16_t(buf[offs + 1]) << 8);
+    buf.erase(buf.begin(), buf.begin() + (offs + 2));
+    return addr;
+  }
+
+  ProgramCache::Program * ProgramCache::addProgram_(uint16_t startAddr,
+                                                    const uint8_t *buf,
+                                                    size_t nBytes)
+  {
+    uint32_t  h = Plus4Emu::File::crc_32(buf, nBytes);
+    h = h ^ uint32_t(startAddr);
+    std::multimap< uint32_t, Program * >::iterator  i = programs.find(h);
+    for ( ; i != programs.end() && (*i).first == h; i++) {
+      Program *p = (*i).second;
+      if (p->startAddress == startAddr && p->data.size() == nBytes) {
+        if (nBytes < 1 || std::memcmp(&(p->data.front()), buf, nBytes) == 0)
+          return p;
+      }
+    }
+    Program *p = new Program;
+    try {
+      p->startAddress = startAddr;
+      p->data.resize(nBytes);
+      if (nBytes > 0)
+        std::memcpy(&(p->data.front()), buf, nBytes);
+      programs.insert(std::pair< uint32_t, Program * >(h, p));
+    }
+    catch (...) {
+      delete p;
+      throw;
+    }
+    return p;
+  }
+
+  const ProgramCache::Program& ProgramCache::loadProgram(const char *fileName)
+  {
+    if (fileName == (char *) 0 || fileName[0] == '\0')
+      throw Plus4Emu::Exception("invalid plus4 program file name");
+    std::string fileName_(fileName);
+    mutex_.lock();
+    try {
+      std::map< std::string, Program * >::iterator  i =
+          fileNameIndex.find(fileName_);
+      if (i != fileNameIndex.end()) {
+        Program *p = (*i).second;
+        mutex_.unlock();
+        return *p;
+      }
+    }
+    catch (...) {
+      mutex_.unlock();
+      throw;
+    }
+    mutex_.unlock();
+    // read the file without holding the lock
+    std::vector< uint8_t >  buf;
+    bool    isP00 = false;
+    if (Plus4Emu::checkFileNameExtension(fileName, ".zip")) {
+      Plus4Emu::ZIPFile zipFile(fileName);
+      std::string   s;
+      int     fileType = 0;
+      if (!zipFile.getFile(buf, s, fileType))
+        throw Plus4Emu::Exception("no matching file found in archive");
+      isP00 = Plus4Emu::checkFileNameExtension(s.c_str(), ".p00");
+    }
+    else {
+      std::FILE *f = Plus4Emu::fileOpen(fileName, "rb");
+      if (!f)
+        throw Plus4Emu::Exception("error opening plus4 program file");
+      try {
+        uint8_t tmpBuf[4096];
+        size_t  n;
+        do {
+          n = std::fread(&(tmpBuf[0]), sizeof(uint8_t), 4096, f);
+          buf.insert(buf.end(), &(tmpBuf[0]), &(tmpBuf[0]) + n);
+        } while (n == 4096 && buf.size() <= (0xFFFF + 28));
+      }
+      catch (...) {
+        std::fclose(f);
+        throw;
+      }
+      std::fclose(f);
+      isP00 = Plus4Emu::checkFileNameExtension(fileName, ".p00");
+    }
+    uint16_t  startAddr = decodeProgram(buf, isP00);
+    Program *p = (Program *) 0;
+    mutex_.lock();
+    try {
+      p = addProgram_(startAddr,
+                      (buf.size() > 0 ? &(buf.front()) : (uint8_t *) 0),
+                      buf.size());
+      fileNameIndex[fileName_] = p;
+    }
+    catch (...) {
+      mutex_.unlock();
+      throw;
+    }
+    mutex_.unlock();
+    return *p;
+  }
+
+  const ProgramCache::Program& ProgramCache::addProgram(const uint8_t *buf,
+                                                        size_t nBytes)
+  {
+    if (nBytes < 2)
+      throw Plus4Emu::Exception("unexpected end of plus4 program file");
+    if (nBytes > (0xFFFF + 2))
+      throw Plus4Emu::Exception("plus4 program file has invalid length");
+    uint16_t  startAddr = uint16_t(buf[0]) | (uint16_t(buf[1]) << 8);
+    Program *p = (Program *) 0;
+    mutex_.lock();
+    try {
+      p = addProgram_(startAddr, buf + 2, nBytes - 2);
+    }
+    catch (...) {
+      mutex_.unlock();
+      throw;
+    }
+    mutex_.unlock();
+    return *p;
+  }
+
+  size_t ProgramCache::loadManifest(const char *fileName)
+  {
+    if (fileName == (char *) 0 || fileName[0] == '\0')
+      throw Plus4Emu::Exception("invalid program list file name");
+    std::string dirName;
+    {
+      std::string baseName;
+      Plus4Emu::splitPath(std::string(fileName), dirName, baseName);
+    }
+    std::vector< std::string >  fileNames;
+    std::FILE *f = Plus4Emu::fileOpen(fileName, "rb");
+    if (!f)
+      throw Plus4Emu::Exception("error opening program list file");
+    try {
+      std::string s;
+      int     c;
+      do {
+        c = std::fgetc(f);
+        if (c != EOF && c != '\n' && c != '\r') {
+          s += char(c);
+          continue;
+        }
+        Plus4Emu::stripString(s);
+        if (s.length() > 0 && s[0] != '#') {
+          bool    isAbsolutePath = (s[0] == '/' || s[0] == '\\');
+#ifdef WIN32
+          if (s.length() >= 2 && s[1] == ':')
+            isAbsolutePath = true;
+#endif
+          if (!isAbsolutePath)
+            s = dirName + s;
+          fileNames.push_back(s);
+        }
+        s.clear();
+      } while (c != EOF);
+    }
+    catch (...) {
+      std::fclose(f);
+      throw;
+    }
+    std::fclose(f);
+    for (size_t i = 0; i < fileNames.size(); i++)
+      (void) loadProgram(fileNames[i].c_str());
+    return fileNames.size();
+  }
+
+  void ProgramCache::clear()
+  {
+    mutex_.lock();
+    fileNameIndex.clear();
+    for (std::multimap< uint32_t, Program * >::iterator i = programs.begin();
+         i != programs.end();
+         i++) {
+      delete (*i).second;
+    }
+    programs.clear();
+    mutex_.unlock();
+  }
+
+  ProgramCache& ProgramCache::getInstance()
+  {
+    static ProgramCache programCache;
+    return programCache;
+  }
+
+}       // namespace Plus4
+
@@ -0,0 +1,87 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef PLUS4EMU_PRGCACHE_HPP
+#define PLUS4EMU_PRGCACHE_HPP
+
+#include "plus4emu.hpp"
+#include "system.hpp"
+
+#include <map>
+#include <vector>
+
+namespace Plus4 {
+
+  class ProgramCache {
+   public:
+    struct Program {
+      // load address of the program
+      uint16_t  startAddress;
+      // program data, not including the load address and P00 header
+      std::vector< uint8_t >  data;
+    };
+   protected:
+    Plus4Emu::Mutex mutex_;
+    // programs indexed by the CRC-32 of the load address and data; programs
+    // with the same contents are stored only once
+    std::multimap< uint32_t, Program * >  programs;
+    // programs indexed by the name of the file they were loaded from
+    std::map< std::string, Program * >    fileNameIndex;
+    // --------
+    Program *addProgram_(uint16_t startAddr,
+                         const uint8_t *buf, size_t nBytes);
+    static uint16_t decodeProgram(std::vector< uint8_t >& buf, bool isP00);
+   public:
+    ProgramCache();
+    virtual ~ProgramCache();
+    /*!
+     * Returns the program loaded from a PRG or P00 file, or the first program
+     * found in a ZIP archive. The file is read only on the first call with
+     * the same file name, so changes to the file are not detected until
+     * clear() is called. The returned reference remains valid until clear()
+     * or the destructor is called.
+     */
+    const Program& loadProgram(const char *fileName);
+    /*!
+     * Add a program in PRG format (load address followed by the data) from
+     * a memory buffer, and return a reference to the cached copy.
+     */
+    const Program& addProgram(const uint8_t *buf, size_t nBytes);
+    /*!
+     * Load all programs listed in a text file (one file name per line,
+     * relative names are interpreted from the directory of the list file,
+     * empty lines and lines beginning with '#' are ignored).
+     * Returns the number of programs loaded.
+     */
+    size_t loadManifest(const char *fileName);
+    /*!
+     * Remove all programs from the cache. This must not be called while
+     * any program returned by the cache is still in use.
+     */
+    void clear();
+    /*!
+     * Returns the program cache shared by all virtual machines.
+     */
+    static ProgramCache& getInstance();
+  };
+
+}       // namespace Plus4
+
+#endif  // PLUS4EMU_PRGCACHE_HPP
+
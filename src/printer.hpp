@@ -73,6 +73,17 @@ namespace Plus4 {
      * until the next runOneCycle() or clearPage() call.
      */
     virtual const uint8_t *getPageData() const = 0;
+    /*!
+     * Returns a pointer to the page data like getPageData(), but only lines
+     * 'y0' to 'y1' - 1 are guaranteed to be up to date; this is faster if
+     * only a part of the page is needed.
+     */
+    virtual const uint8_t *getPageData(int y0, int y1) const
+    {
+      (void) y0;
+      (void) y1;
+      return getPageData();
+    }
     /*!
      * Returns the page width in pixels.
      */
@@ -129,6 +140,21 @@ namespace Plus4 {
       (void) fileName;
       (void) asciiMode;
     }
+    /*!
+     * Write each completed page to a separate image file, with the page
+     * number inserted before the extension of 'fileName'; the format is PBM
+     * if the extension is ".pbm", and PNG otherwise. A page is completed when
+     * the paper reaches the bottom margin (the printing then continues on a
+     * new page, at the top margin), or when clearPage() is called.
+     * The files are written on a separate thread.
+     * If 'fileName' is NULL or empty, then the current page is written if it
+     * is not empty, and the output is closed.
+     * On error, Plus4Emu::Exception may be thrown.
+     */
+    virtual void setPageOutputFile(const char *fileName)
+    {
+      (void) fileName;
+    }
     /*!
      * Reset printer.
      */
@@ -0,0 +1,367 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include "plus4emu.hpp"
+#include "system.hpp"
+#include "pngwrite.hpp"
+#include "prtpage.hpp"
+
+#include <list>
+
+namespace Plus4 {
+
+  class PrinterPageWriter : public Plus4Emu::Thread {
+   public:
+    struct Page {
+      int       width;
+      int       height;
+      int       pageNum;
+      uint8_t   *buf;           // may be NULL if no dots were drawn yet
+      std::vector< uint32_t > dotBuf;
+    };
+   private:
+    // maximum number of pages waiting to be written
+    static const size_t maxPagesQueued = 8;
+    std::string fileNamePrefix;
+    std::string fileNameSuffix;
+    bool        pbmFormat;
+    int         pageCnt;
+    bool        stopFlag;
+    bool        errorFlag;
+    std::list< Page * > pageQueue;
+    Plus4Emu::Mutex       mutex_;
+    Plus4Emu::ThreadLock  pageQueuedLock;
+    Plus4Emu::ThreadLock  pageDoneLock;
+    // --------
+    void writePage(Page& page);
+   public:
+    PrinterPageWriter(const char *fileName);
+    virtual ~PrinterPageWriter();
+    // queue page for writing; the object is deleted by the writer thread
+    void queuePage(Page *page);
+    // write all pending pages, and stop the thread; returns false on error
+    bool close();
+   protected:
+    virtual void run();
+  };
+
+  PrinterPageWriter::PrinterPageWriter(const char *fileName)
+    : Thread(),
+      pbmFormat(false),
+      pageCnt(0),
+      stopFlag(false),
+      errorFlag(false)
+  {
+    std::string s(fileName);
+    size_t  n = s.length();
+    for (size_t i = s.length(); i > 0; i--) {
+      char    c = s[i - 1];
+      if (c == '/' || c == '\\' || c == ':')
+        break;
+      if (c == '.') {
+        n = i - 1;
+        break;
+      }
+    }
+    fileNamePrefix = s.substr(0, n);
+    fileNameSuffix = s.substr(n);
+    std::string ext(fileNameSuffix);
+    Plus4Emu::stringToLowerCase(ext);
+    pbmFormat = (ext == ".pbm");
+    if (fileNameSuffix.length() == 0)
+      fileNameSuffix = ".png";
+    this->start();
+  }
+
+  PrinterPageWriter::~PrinterPageWriter()
+  {
+    (void) close();
+    while (pageQueue.size() > 0) {
+      delete[] pageQueue.front()->buf;
+      delete pageQueue.front();
+      pageQueue.pop_front();
+    }
+  }
+
+  void PrinterPageWriter::queuePage(Page *page)
+  {
+    mutex_.lock();
+    while (pageQueue.size() >= maxPagesQueued) {
+      // limit memory usage if pages are printed faster than saved
+      mutex_.unlock();
+      pageDoneLock.wait();
+      mutex_.lock();
+    }
+    page->pageNum = ++pageCnt;
+    try {
+      pageQueue.push_back(page);
+    }
+    catch (...) {
+      mutex_.unlock();
+      delete[] page->buf;
+      delete page;
+      throw;
+    }
+    mutex_.unlock();
+    pageQueuedLock.notify();
+  }
+
+  bool PrinterPageWriter::close()
+  {
+    mutex_.lock();
+    stopFlag = true;
+    mutex_.unlock();
+    pageQueuedLock.notify();
+    this->join();
+    return !errorFlag;
+  }
+
+  void PrinterPageWriter::run()
+  {
+    while (true) {
+      Page    *page = (Page *) 0;
+      mutex_.lock();
+      if (pageQueue.size() > 0) {
+        page = pageQueue.front();
+        pageQueue.pop_front();
+      }
+      else if (stopFlag) {
+        mutex_.unlock();
+        break;
+      }
+      mutex_.unlock();
+      if (!page) {
+        pageQueuedLock.wait();
+        continue;
+      }
+      try {
+        writePage(*page);
+      }
+      catch (...) {
+        errorFlag = true;
+      }
+      delete[] page->buf;
+      delete page;
+      pageDoneLock.notify();
+    }
+  }
+
+  void PrinterPageWriter::writePage(Page& page)
+  {
+    char    tmpBuf[16];
+    std::sprintf(&(tmpBuf[0]), "%04d", page.pageNum);
+    std::string fileName(fileNamePrefix);
+    fileName += &(tmpBuf[0]);
+    fileName += fileNameSuffix;
+    // draw the page, leaving space for a 256 color palette at the beginning
+    // of the buffer, as expected by writePNGImage()
+    size_t  nPixels = size_t(page.width) * size_t(page.height);
+    std::vector< uint8_t >  imageBuf(768 + nPixels, 0xFF);
+    uint8_t *p = &(imageBuf.front()) + 768;
+    if (page.buf) {
+      std::memcpy(p, page.buf, nPixels);
+      delete[] page.buf;
+      page.buf = (uint8_t *) 0;
+    }
+    for (size_t i = 0; i < page.dotBuf.size(); i++) {
+      uint8_t&  c = p[page.dotBuf[i]];
+      c = (c >> 3) + (c >> 4);
+    }
+    if (!pbmFormat) {
+      for (int i = 0; i < 256; i++) {
+        imageBuf[i * 3] = uint8_t(i);
+        imageBuf[i * 3 + 1] = uint8_t(i);
+        imageBuf[i * 3 + 2] = uint8_t(i);
+      }
+      Plus4Emu::writePNGImage(fileName.c_str(), &(imageBuf.front()),
+                              page.width, page.height, 256, true, 32768);
+      return;
+    }
+    // PBM format: pixels darker than 50% grey are black
+    std::FILE *f = Plus4Emu::fileOpen(fileName.c_str(), "wb");
+    if (!f)
+      throw Plus4Emu::Exception("error opening printer page image file");
+    bool    err = (std::fprintf(f, "P4\n%d %d\n", page.width, page.height)
+                   <= 0);
+    std::vector< uint8_t >  lineBuf(size_t((page.width + 7) >> 3));
+    for (int y = 0; y < page.height && !err; y++) {
+      for (size_t i = 0; i < lineBuf.size(); i++)
+        lineBuf[i] = 0x00;
+      for (int x = 0; x < page.width; x++) {
+        if (p[x] < 0x80)
+          lineBuf[x >> 3] |= uint8_t(0x80 >> (x & 7));
+      }
+      p = p + page.width;
+      err = (std::fwrite(&(lineBuf.front()), sizeof(uint8_t), lineBuf.size(),
+                         f) != lineBuf.size());
+    }
+    if ((std::fflush(f) | std::fclose(f)) != 0)
+      err = true;
+    if (err) {
+      Plus4Emu::fileRemove(fileName.c_str());
+      throw Plus4Emu::Exception("error writing printer page image file");
+    }
+  }
+
+  // --------------------------------------------------------------------------
+
+  PrinterPage::PrinterPage(int w, int h)
+    : pageWidth(w),
+      pageHeight(h),
+      pageBuf((uint8_t *) 0),
+      dirtyYMin(h),
+      dirtyYMax(-1),
+      maxDots(size_t(w) * size_t(h) / 4),
+      emptyFlag(true),
+      pageWriter((PrinterPageWriter *) 0)
+  {
+  }
+
+  PrinterPage::~PrinterPage()
+  {
+    if (pageWriter) {
+      // errors cannot be reported from the destructor; the owner should
+      // call setOutputFile(NULL) first (Plus4VM::setPrinterType() does
+      // this when the printer is removed), here the remaining pages are
+      // only saved if possible
+      try {
+        ejectPage();
+      }
+      catch (...) {
+      }
+      (void) pageWriter->close();
+      delete pageWriter;
+    }
+    delete[] pageBuf;
+  }
+
+  void PrinterPage::clearPageBuffer() const
+  {
+    if (!pageBuf)
+      pageBuf = new uint8_t[size_t(pageWidth) * size_t(pageHeight)];
+    std::memset(pageBuf, 0xFF, size_t(pageWidth) * size_t(pageHeight));
+  }
+
+  void PrinterPage::drawDots(int y0, int y1) const
+  {
+    if (!pageBuf)
+      clearPageBuffer();
+    if (y0 <= dirtyYMin && y1 > dirtyYMax) {
+      // draw all dots
+      for (size_t i = 0; i < dotBuf.size(); i++) {
+        uint8_t&  c = pageBuf[dotBuf[i]];
+        c = (c >> 3) + (c >> 4);
+      }
+      dotBuf.clear();
+      dirtyYMin = pageHeight;
+      dirtyYMax = -1;
+      return;
+    }
+    // draw only the dots in the requested lines, and keep the others
+    uint32_t  n0 = uint32_t(y0) * uint32_t(pageWidth);
+    uint32_t  n1 = uint32_t(y1) * uint32_t(pageWidth);
+    size_t    j = 0;
+    int       newYMin = pageHeight;
+    int       newYMax = -1;
+    for (size_t i = 0; i < dotBuf.size(); i++) {
+      uint32_t  n = dotBuf[i];
+      if (n >= n0 && n < n1) {
+        uint8_t&  c = pageBuf[n];
+        c = (c >> 3) + (c >> 4);
+      }
+      else {
+        int     y = int(n / uint32_t(pageWidth));
+        newYMin = (y < newYMin ? y : newYMin);
+        newYMax = (y > newYMax ? y : newYMax);
+        dotBuf[j++] = n;
+      }
+    }
+    dotBuf.resize(j);
+    dirtyYMin = newYMin;
+    dirtyYMax = newYMax;
+  }
+
+  const uint8_t * PrinterPage::getPageData(int y0, int y1) const
+  {
+    y0 = (y0 > 0 ? y0 : 0);
+    y1 = (y1 < pageHeight ? y1 : pageHeight);
+    if (y0 <= dirtyYMax && y1 > dirtyYMin)
+      drawDots(y0, y1);
+    else if (!pageBuf)
+      clearPageBuffer();
+    return pageBuf;
+  }
+
+  void PrinterPage::clear()
+  {
+    if (pageBuf && !emptyFlag)
+      clearPageBuffer();
+    dotBuf.clear();
+    dirtyYMin = pageHeight;
+    dirtyYMax = -1;
+    emptyFlag = true;
+  }
+
+  bool PrinterPage::ejectPage()
+  {
+    if (!pageWriter)
+      return false;
+    if (emptyFlag)
+      return true;
+    PrinterPageWriter::Page *page = new PrinterPageWriter::Page;
+    page->width = pageWidth;
+    page->height = pageHeight;
+    page->pageNum = 0;
+    // the image buffer and dots are moved to the page object, so that
+    // no copying or drawing is needed here
+    page->buf = pageBuf;
+    page->dotBuf.swap(dotBuf);
+    pageBuf = (uint8_t *) 0;
+    dirtyYMin = pageHeight;
+    dirtyYMax = -1;
+    emptyFlag = true;
+    pageWriter->queuePage(page);
+    return true;
+  }
+
+  void PrinterPage::setOutputFile(const char *fileName)
+  {
+    if (pageWriter) {
+      // write the last page, and close the previous output
+      bool    err = false;
+      try {
+        ejectPage();
+      }
+      catch (...) {
+        err = true;
+      }
+      if (!pageWriter->close())
+        err = true;
+      delete pageWriter;
+      pageWriter = (PrinterPageWriter *) 0;
+      if (err)
+        throw Plus4Emu::Exception("error writing printer page image file");
+    }
+    if (fileName == (char *) 0 || fileName[0] == '\0')
+      return;
+    pageWriter = new PrinterPageWriter(fileName);
+  }
+
+}       // namespace Plus4
+
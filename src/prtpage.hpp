@@ -0,0 +1,112 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef PLUS4EMU_PRTPAGE_HPP
+#define PLUS4EMU_PRTPAGE_HPP
+
+#include "plus4emu.hpp"
+
+#include <vector>
+
+namespace Plus4 {
+
+  class PrinterPageWriter;
+
+  // Printer page as an 8-bit greyscale image. Dots are only stored in a log
+  // when they are printed, and are drawn on the image later, when the lines
+  // they are on are actually needed for display or saving. The image buffer
+  // is allocated on first use. Completed pages can optionally be written to
+  // a sequence of image files on a separate thread.
+
+  class PrinterPage {
+   private:
+    int       pageWidth;
+    int       pageHeight;
+    mutable uint8_t *pageBuf;   // pageWidth * pageHeight bytes, or NULL
+    // dots not drawn yet, as y * pageWidth + x
+    mutable std::vector< uint32_t > dotBuf;
+    // range of lines with dots in dotBuf (dirtyYMin > dirtyYMax if none)
+    mutable int dirtyYMin;
+    mutable int dirtyYMax;
+    size_t    maxDots;
+    bool      emptyFlag;
+    PrinterPageWriter *pageWriter;
+    // --------
+    void drawDots(int y0, int y1) const;
+    void clearPageBuffer() const;
+   public:
+    PrinterPage(int w, int h);
+    ~PrinterPage();
+    /*!
+     * Print a dot at 'xPos', 'yPos', which must be in the range 0 to
+     * pageWidth - 1 and 0 to pageHeight - 1, respectively.
+     */
+    PLUS4EMU_INLINE void plotDot(int xPos, int yPos)
+    {
+      dotBuf.push_back(uint32_t(yPos * pageWidth + xPos));
+      dirtyYMin = (yPos < dirtyYMin ? yPos : dirtyYMin);
+      dirtyYMax = (yPos > dirtyYMax ? yPos : dirtyYMax);
+      emptyFlag = false;
+      if (PLUS4EMU_UNLIKELY(dotBuf.size() >= maxDots))
+        drawDots(0, pageHeight);        // limit the size of the dot buffer
+    }
+    /*!
+     * Returns a pointer to the page image (pageWidth * pageHeight bytes),
+     * of which only lines 'y0' to 'y1' - 1 are guaranteed to be up to date.
+     * The buffer remains valid until the next non-const method call.
+     */
+    const uint8_t *getPageData(int y0, int y1) const;
+    /*!
+     * Clear the page to white.
+     */
+    void clear();
+    /*!
+     * Returns true if no dots have been printed since the page was cleared.
+     */
+    inline bool isEmpty() const
+    {
+      return emptyFlag;
+    }
+    /*!
+     * If an output file is set and the page is not empty, write it to the
+     * next image file, and clear the page. Returns false if there is no
+     * output file, and the page is not changed.
+     */
+    bool ejectPage();
+    /*!
+     * Write each ejected page to a separate image file, with the page number
+     * inserted before the extension of 'fileName' (e.g. "print0001.png").
+     * The format is PBM if the extension is ".pbm", and PNG otherwise.
+     * If 'fileName' is NULL or empty, the current page is written if it is
+     * not empty, and the output is closed after all pending pages are saved.
+     * Plus4Emu::Exception is thrown on errors. If the output is still open
+     * when the page is destroyed, any remaining pages are saved, but write
+     * errors are ignored.
+     */
+    void setOutputFile(const char *fileName);
+    inline bool haveOutputFile() const
+    {
+      return (pageWriter != (PrinterPageWriter *) 0);
+    }
+  };
+
+}       // namespace Plus4
+
+#endif  // PLUS4EMU_PRTPAGE_HPP
+
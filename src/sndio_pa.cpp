@@ -65,6 +65,10 @@ namespace Plus4Emu {
       paLockTimeout(0U),
       writeBufIndex(0),
       readBufIndex(0),
+      buffersWritten(0),
+      buffersRead(0),
+      fifoEnabled(false),
+      fifoBufPos(0),
       paStream((PaStream *) 0),
       latencyFramesHW(4096L),
       nextTime(0.0),
@@ -104,42 +108,44 @@ namespace Plus4Emu {
     if (paStream) {
 #ifndef USING_OLD_PORTAUDIO_API
       if (usingBlockingInterface) {
-        // reduce timing jitter
-        double  t = nextTime - timer_.getRealTime();
-        double  periodTime = double(long(nFrames)) / double(sampleRate);
-        long    framesToWrite = Pa_GetStreamWriteAvailable(paStream);
-        switch (int((framesToWrite << 3) / latencyFramesHW)) {
-        case 0:
-          periodTime = periodTime * 2.0;
-          break;
-        case 1:
-          periodTime = periodTime * 1.25;
-          break;
-        case 2:
-          periodTime = periodTime * 1.1;
-          break;
-        case 3:
-          periodTime = periodTime * 1.05;
-          break;
-        case 4:
-          periodTime = periodTime * 0.95;
-          break;
-        case 5:
-          periodTime = periodTime * 0.9;
-          break;
-        default:
-          timer_.reset();
-          nextTime = 0.0;
-          periodTime = 0.0;
-          break;
-        }
-        nextTime = nextTime + periodTime;
-        if (t > 0.00075) {
-          Timer::wait(t);
-        }
-        else if (t < -0.5) {
-          timer_.reset();
-          nextTime = 0.0;
+        if (!rateControlEnabled) {
+          // reduce timing jitter
+          double  t = nextTime - timer_.getRealTime();
+          double  periodTime = double(long(nFrames)) / double(sampleRate);
+          long    framesToWrite = Pa_GetStreamWriteAvailable(paStream);
+          switch (int((framesToWrite << 3) / latencyFramesHW)) {
+          case 0:
+            periodTime = periodTime * 2.0;
+            break;
+          case 1:
+            periodTime = periodTime * 1.25;
+            break;
+          case 2:
+            periodTime = periodTime * 1.1;
+            break;
+          case 3:
+            periodTime = periodTime * 1.05;
+            break;
+          case 4:
+            periodTime = periodTime * 0.95;
+            break;
+          case 5:
+            periodTime = periodTime * 0.9;
+            break;
+          default:
+            timer_.reset();
+            nextTime = 0.0;
+            periodTime = 0.0;
+            break;
+          }
+          nextTime = nextTime + periodTime;
+          if (t > 0.00075) {
+            Timer::wait(t);
+          }
+          else if (t < -0.5) {
+            timer_.reset();
+            nextTime = 0.0;
+          }
         }
         // ring buffer is not used for blocking I/O, so assume nPeriodsSW == 1
         for (size_t i = 0; i < nFrames; i++) {
@@ -148,8 +154,16 @@ namespace Plus4Emu {
           buf_.audioData[buf_.writePos++] = buf[i];
           if (buf_.writePos >= buf_.audioData.size()) {
             buf_.writePos = 0;
-            Pa_WriteStream(paStream,
-                           &(buf_.audioData[0]), buf_.audioData.size() >> 1);
+            long    periodFrames = long(buf_.audioData.size() >> 1);
+            long    framesAvail = Pa_GetStreamWriteAvailable(paStream);
+            // with rate control enabled, discard the data instead of
+            // blocking if there is not enough space in the buffer
+            if (!rateControlEnabled || framesAvail >= periodFrames) {
+              Pa_WriteStream(paStream, &(buf_.audioData[0]),
+                             (unsigned long) periodFrames);
+              framesAvail -= periodFrames;
+            }
+            updateBufferLevel(latencyFramesHW - framesAvail, latencyFramesHW);
           }
         }
       }
@@ -157,21 +171,38 @@ namespace Plus4Emu {
 #endif
       {
         for (size_t i = 0; i < nFrames; i++) {
+          if (rateControlEnabled) {
+            // with rate control enabled, a period is collected in a separate
+            // buffer, and is only copied to the ring buffer if there is a
+            // free slot that the callback does not access
+            fifoBuf[fifoBufPos++] = buf[i];
+            fifoBuf[fifoBufPos++] = buf[i];
+            if (fifoBufPos >= fifoBuf.size()) {
+              fifoBufPos = 0;
+              writeFIFOBuffer();
+            }
+            continue;
+          }
           Buffer& buf_ = buffers[writeBufIndex];
           buf_.audioData[buf_.writePos++] = buf[i];
           buf_.audioData[buf_.writePos++] = buf[i];
           if (buf_.writePos >= buf_.audioData.size()) {
             buf_.writePos = 0;
+            long    periodFrames = long(buf_.audioData.size() >> 1);
+            fifoMutex.lock();
+            fifoEnabled = false;
+            fifoMutex.unlock();
             buf_.paLock.notify();
             if (buf_.epLock.wait(1000)) {
               if (++writeBufIndex >= buffers.size())
                 writeBufIndex = 0;
             }
+            updateBufferLevel(periodFrames, periodFrames, latencyFramesHW);
           }
         }
       }
     }
-    else {
+    else if (!rateControlEnabled) {
       // if there is no audio device, only synchronize to real time
       double  curTime = timer_.getRealTime();
       double  waitTime = nextTime - curTime;
@@ -208,6 +239,43 @@ namespace Plus4Emu {
     AudioOutput::closeDevice();
   }
 
+  void AudioOutput_PortAudio::writeFIFOBuffer()
+  {
+    long    periodFrames = long(fifoBuf.size() >> 1);
+    fifoMutex.lock();
+    fifoEnabled = true;
+    long    buffersQueued = long(buffersWritten - buffersRead);
+    if (buffersQueued <= 0L) {
+      // the FIFO is empty (or rate control has just been enabled), so
+      // continue writing at the position the callback reads next
+      buffersWritten = buffersRead;
+      buffersQueued = 0L;
+      writeBufIndex = readBufIndex;
+    }
+    bool    haveSpace = (size_t(buffersQueued) < buffers.size());
+    fifoMutex.unlock();
+    if (haveSpace) {
+      // the slot at writeBufIndex is not queued, so it is not accessed by
+      // the callback until buffersWritten is incremented
+      Buffer& buf_ = buffers[writeBufIndex];
+      for (size_t i = 0; i < fifoBuf.size(); i++)
+        buf_.audioData[i] = fifoBuf[i];
+      buf_.writePos = 0;
+      fifoMutex.lock();
+      // the buffer is released before the counter is incremented, so the
+      // callback never finds a counted buffer still locked
+      buf_.paLock.notify();
+      buffersWritten++;
+      buffersQueued = long(buffersWritten - buffersRead);
+      fifoMutex.unlock();
+      if (++writeBufIndex >= buffers.size())
+        writeBufIndex = 0;
+    }
+    // if the FIFO is full, the period is discarded
+    updateBufferLevel(buffersQueued * periodFrames,
+                      long(buffers.size()) * periodFrames, latencyFramesHW);
+  }
+
   std::vector< std::string > AudioOutput_PortAudio::getDeviceList()
   {
     std::vector< std::string >  tmp;
@@ -269,6 +337,7 @@ namespace Plus4Emu {
     }
     int16_t *buf = reinterpret_cast<int16_t *>(output);
     size_t  i = 0, nFrames = frameCount;
+    bool    nextBuffer = true;
     (void) input;
 #ifndef USING_OLD_PORTAUDIO_API
     (void) timeInfo;
@@ -279,13 +348,30 @@ namespace Plus4Emu {
     if (nFrames > (p->buffers[p->readBufIndex].audioData.size() >> 1))
       nFrames = p->buffers[p->readBufIndex].audioData.size() >> 1;
     nFrames <<= 1;
-    if (p->buffers[p->readBufIndex].paLock.wait(p->paLockTimeout)) {
-      for ( ; i < nFrames; i++)
-        buf[i] = p->buffers[p->readBufIndex].audioData[i];
+    p->fifoMutex.lock();
+    if (p->fifoEnabled && p->buffersWritten == p->buffersRead) {
+      // with rate control enabled, wait for the next buffer to be written
+      // on underrun, instead of skipping it
+      nextBuffer = false;
+    }
+    p->fifoMutex.unlock();
+    if (nextBuffer) {
+      bool    gotBuffer =
+          p->buffers[p->readBufIndex].paLock.wait(p->paLockTimeout);
+      if (gotBuffer) {
+        for ( ; i < nFrames; i++)
+          buf[i] = p->buffers[p->readBufIndex].audioData[i];
+      }
+      p->buffers[p->readBufIndex].epLock.notify();
+      // the buffer is only counted as played after it has been copied,
+      // so that sendAudioData() does not overwrite it while in use
+      p->fifoMutex.lock();
+      if (gotBuffer)
+        p->buffersRead++;
+      if (++(p->readBufIndex) >= p->buffers.size())
+        p->readBufIndex = 0;
+      p->fifoMutex.unlock();
     }
-    p->buffers[p->readBufIndex].epLock.notify();
-    if (++(p->readBufIndex) >= p->buffers.size())
-      p->readBufIndex = 0;
     for ( ; i < (frameCount << 1); i++)
       buf[i] = 0;
     p->closeDeviceLock.notify();
@@ -300,6 +386,11 @@ namespace Plus4Emu {
   {
     writeBufIndex = 0;
     readBufIndex = 0;
+    fifoMutex.lock();
+    buffersWritten = 0;
+    buffersRead = 0;
+    fifoEnabled = false;
+    fifoMutex.unlock();
     paStream = (PaStream *) 0;
     // find audio device
 #ifndef USING_OLD_PORTAUDIO_API
@@ -392,6 +483,10 @@ namespace Plus4Emu {
       for (int j = 0; j < (periodSize << 1); j++)
         buffers[i].audioData[j] = 0;
     }
+    fifoBuf.resize(size_t(periodSize) << 1);
+    for (size_t i = 0; i < fifoBuf.size(); i++)
+      fifoBuf[i] = 0;
+    fifoBufPos = 0;
     // open audio stream
 #ifndef USING_OLD_PORTAUDIO_API
     PaStreamParameters  streamParams;
@@ -51,6 +51,17 @@ namespace Plus4Emu {
     std::vector< Buffer >   buffers;
     size_t        writeBufIndex;
     size_t        readBufIndex;
+    // number of buffers written and played, and true if the ring buffer
+    // is used as a FIFO (rate control); these are shared with the callback,
+    // and are only accessed with fifoMutex locked
+    size_t        buffersWritten;
+    size_t        buffersRead;
+    bool          fifoEnabled;
+    Mutex         fifoMutex;
+    // with rate control enabled, a period of audio data is collected here
+    // before it is copied to a free slot of the ring buffer
+    std::vector< int16_t >  fifoBuf;
+    size_t        fifoBufPos;
     PaStream      *paStream;
     long          latencyFramesHW;
     Timer         timer_;
@@ -67,6 +78,9 @@ namespace Plus4Emu {
                                  unsigned long frameCount,
                                  PaTimestamp outTime, void *userData);
 #endif
+    // copy 'fifoBuf' to the next free slot of the ring buffer, or discard
+    // it if the FIFO is full
+    void writeFIFOBuffer();
    public:
     AudioOutput_PortAudio();
     virtual ~AudioOutput_PortAudio();
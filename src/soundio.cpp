@@ -28,11 +28,17 @@ namespace Plus4Emu {
   AudioOutput::AudioOutput()
     : outputFileName(""),
       soundFile((SNDFILE *) 0),
+      avgBufferLevel(0.5),
+      latencySum(0.0),
+      latencyMax(0.0),
+      latencyCnt(0U),
       deviceNumber(-1),
       sampleRate(0.0f),
+      adjustedSampleRate(0.0f),
       totalLatency(0.0f),
       nPeriodsHW(0),
-      nPeriodsSW(0)
+      nPeriodsSW(0),
+      rateControlEnabled(false)
   {
   }
 
@@ -99,6 +105,8 @@ namespace Plus4Emu {
     }
     deviceNumber = deviceNumber_;
     sampleRate = sampleRate_;
+    adjustedSampleRate = sampleRate_;
+    avgBufferLevel = 0.5;
     if (deviceNumber >= 0) {
       try {
         openDevice();
@@ -133,6 +141,30 @@ namespace Plus4Emu {
     }
   }
 
+  void AudioOutput::setRateControlEnabled(bool isEnabled)
+  {
+    if (isEnabled != rateControlEnabled) {
+      rateControlEnabled = isEnabled;
+      adjustedSampleRate = sampleRate;
+      avgBufferLevel = 0.5;
+    }
+  }
+
+  bool AudioOutput::getLatencyStats(double& avgLatency, double& maxLatency)
+  {
+    if (latencyCnt < 1U) {
+      avgLatency = 0.0;
+      maxLatency = 0.0;
+      return false;
+    }
+    avgLatency = latencySum / double(long(latencyCnt));
+    maxLatency = latencyMax;
+    latencySum = 0.0;
+    latencyMax = 0.0;
+    latencyCnt = 0U;
+    return true;
+  }
+
   void AudioOutput::sendAudioData(const int16_t *buf, size_t nFrames)
   {
     // NOTE: AudioOutput::sendAudioData() should be called by derived classes
@@ -157,6 +189,8 @@ namespace Plus4Emu {
     // NOTE: AudioOutput::closeDevice() should be called by derived classes
     // to reset internal data
     deviceNumber = -1;
+    adjustedSampleRate = sampleRate;
+    avgBufferLevel = 0.5;
   }
 
   std::vector< std::string > AudioOutput::getDeviceList()
@@ -169,5 +203,26 @@ namespace Plus4Emu {
   {
   }
 
+  void AudioOutput::updateBufferLevel(long framesBuffered, long bufferSize,
+                                      long extraLatency)
+  {
+    framesBuffered = (framesBuffered > 0L ? framesBuffered : 0L);
+    double  t = double(framesBuffered + extraLatency) / double(sampleRate);
+    latencySum = latencySum + t;
+    latencyMax = (t > latencyMax ? t : latencyMax);
+    latencyCnt++;
+    if (!rateControlEnabled || bufferSize < 1L)
+      return;
+    double  l = double(framesBuffered) / double(bufferSize);
+    l = (l < 1.0 ? l : 1.0);
+    avgBufferLevel = avgBufferLevel + ((l - avgBufferLevel) * 0.05);
+    // the sample rate is not changed while recording a sound file,
+    // so that the file is not affected by rate control
+    if (soundFile)
+      return;
+    float   r = float(1.0 + ((0.5 - avgBufferLevel) * 0.01));
+    adjustedSampleRate = float(int(sampleRate * r + 0.5f));
+  }
+
 }       // namespace Plus4Emu
 
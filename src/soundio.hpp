@@ -31,12 +31,21 @@ namespace Plus4Emu {
    private:
     std::string outputFileName;
     SNDFILE *soundFile;
+    // average buffer fill level (0.0 to 1.0) used by rate control
+    double  avgBufferLevel;
+    double  latencySum;
+    double  latencyMax;
+    uint32_t  latencyCnt;
    protected:
     int     deviceNumber;
     float   sampleRate;
+    float   adjustedSampleRate;
     float   totalLatency;
     int     nPeriodsHW;
     int     nPeriodsSW;
+    // if true, sendAudioData() should not block, and the sample rate is
+    // adjusted by updateBufferLevel()
+    bool    rateControlEnabled;
    public:
     AudioOutput();
     virtual ~AudioOutput();
@@ -51,6 +60,29 @@ namespace Plus4Emu {
     {
       return this->sampleRate;
     }
+    /*!
+     * Returns the sample rate at which audio data should be generated;
+     * this differs slightly from getSampleRate() if rate control is enabled.
+     */
+    inline float getAdjustedSampleRate() const
+    {
+      return this->adjustedSampleRate;
+    }
+    /*!
+     * If enabled, sendAudioData() does not wait for space in the buffer
+     * (data that does not fit is discarded), and the sample rate returned by
+     * getAdjustedSampleRate() is varied by up to +/- 0.5% to keep the buffer
+     * about half full. This should be used when the emulation is not
+     * synchronized to the audio output.
+     */
+    void setRateControlEnabled(bool isEnabled);
+    /*!
+     * Store the average and maximum audio output latency (in seconds) since
+     * the previous call in 'avgLatency' and 'maxLatency', and reset the
+     * statistics. Returns false if there is no data, in which case both
+     * values are set to zero.
+     */
+    bool getLatencyStats(double& avgLatency, double& maxLatency);
     /*!
      * Write sound output to the specified file name, closing any
      * previously opened file with a different name.
@@ -73,6 +105,14 @@ namespace Plus4Emu {
     virtual std::vector< std::string > getDeviceList();
    protected:
     virtual void openDevice();
+    /*!
+     * Should be called by derived classes after writing a period of audio
+     * data, with the number of frames currently in a buffer of 'bufferSize'
+     * frames that rate control is applied to, and the additional latency
+     * (in frames) that is not included in the buffer.
+     */
+    void updateBufferLevel(long framesBuffered, long bufferSize,
+                           long extraLatency = 0L);
   };
 
 }       // namespace Plus4Emu
@@ -29,9 +29,7 @@
 #  include <sys/time.h>
 #  include <unistd.h>
 #  include <pthread.h>
-#  if defined(__linux) || defined(__linux__)
-#    include <sys/resource.h>
-#  endif
+#  include <sys/resource.h>
 #endif
 
 #include <errno.h>
@@ -313,6 +311,29 @@ namespace Plus4Emu {
 #endif
   }
 
+  double Timer::getProcessCPUTime()
+  {
+#ifdef WIN32
+    FILETIME  creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(),
+                         &creationTime, &exitTime, &kernelTime, &userTime)) {
+      return 0.0;
+    }
+    uint64_t  t = uint64_t(kernelTime.dwLowDateTime)
+                  + (uint64_t(kernelTime.dwHighDateTime) << 32)
+                  + uint64_t(userTime.dwLowDateTime)
+                  + (uint64_t(userTime.dwHighDateTime) << 32);
+    return (double(int64_t(t)) * 0.0000001);
+#else
+    struct rusage r;
+    if (getrusage(RUSAGE_SELF, &r) != 0)
+      return 0.0;
+    return (double(r.ru_utime.tv_sec) + double(r.ru_stime.tv_sec)
+            + (double(r.ru_utime.tv_usec) + double(r.ru_stime.tv_usec))
+              * 0.000001);
+#endif
+  }
+
   uint32_t Timer::getRandomSeedFromTime()
   {
     uint32_t  tmp1 = uint32_t(getRealTime_() & 0xFFFFFFFFUL);
@@ -325,6 +346,20 @@ namespace Plus4Emu {
 
   // --------------------------------------------------------------------------
 
+  int getProcessorCount()
+  {
+#ifdef WIN32
+    SYSTEM_INFO   systemInfo;
+    GetSystemInfo(&systemInfo);
+    int     n = int(systemInfo.dwNumberOfProcessors);
+#elif defined(_SC_NPROCESSORS_ONLN)
+    int     n = int(sysconf(_SC_NPROCESSORS_ONLN));
+#else
+    int     n = 1;
+#endif
+    return (n > 1 ? n : 1);
+  }
+
   void stripString(std::string& s)
   {
     const std::string&  t = s;
@@ -552,7 +587,16 @@ namespace Plus4Emu {
 #endif
   }
 
-#ifdef WIN32
+#ifndef WIN32
+
+  int fileStat(const char *fileName, void *st)
+  {
+    struct stat *st_ = reinterpret_cast< struct stat * >(st);
+    std::memset(st_, 0, sizeof(struct stat));
+    return stat(fileName, st_);
+  }
+
+#else
 
   void convertToUTF8(std::string& buf, const wchar_t *s)
   {
@@ -155,9 +155,20 @@ namespace Plus4Emu {
     void reset();
     void reset(double t);
     static void wait(double t);
+    /*!
+     * Returns the total user and system CPU time (in seconds) used by all
+     * threads of the process so far.
+     */
+    static double getProcessCPUTime();
     static uint32_t getRandomSeedFromTime();
   };
 
+  /*!
+   * Returns the number of processors available, or 1 if it cannot be
+   * determined.
+   */
+  int getProcessorCount();
+
   /*!
    * Remove leading and trailing whitespace from string.
    */
@@ -218,6 +229,8 @@ namespace Plus4Emu {
   {
     return std::remove(fileName);
   }
+  // 'st' is a pointer to a stat structure
+  int fileStat(const char *fileName, void *st);
 #else
   /*!
    * Convert from wchar_t to UTF-8 encoded string.
@@ -35,6 +35,61 @@ static int cuePointCmpFunc(const void *p1, const void *p2)
   return 0;
 }
 
+// libsndfile virtual I/O functions for reading sound files from streams
+// that have no file descriptor (e.g. files extracted from ZIP archives)
+
+static sf_count_t sfVirtualGetFileLength(void *userData)
+{
+  std::FILE *f = reinterpret_cast< std::FILE * >(userData);
+  long    savedPos = std::ftell(f);
+  if (savedPos < 0L || std::fseek(f, 0L, SEEK_END) < 0)
+    return -1;
+  long    fileSize = std::ftell(f);
+  if (std::fseek(f, savedPos, SEEK_SET) < 0)
+    return -1;
+  return sf_count_t(fileSize);
+}
+
+static sf_count_t sfVirtualSeek(sf_count_t offs, int whence, void *userData)
+{
+  std::FILE *f = reinterpret_cast< std::FILE * >(userData);
+  if (sf_count_t(long(offs)) != offs)
+    return -1;
+  if (std::fseek(f, long(offs), whence) < 0)
+    return -1;
+  return sf_count_t(std::ftell(f));
+}
+
+static sf_count_t sfVirtualRead(void *buf, sf_count_t nBytes, void *userData)
+{
+  if (nBytes <= 0)
+    return 0;
+  return sf_count_t(std::fread(buf, 1, size_t(nBytes),
+                               reinterpret_cast< std::FILE * >(userData)));
+}
+
+static sf_count_t sfVirtualWrite(const void *buf, sf_count_t nBytes,
+                                 void *userData)
+{
+  if (nBytes <= 0)
+    return 0;
+  return sf_count_t(std::fwrite(buf, 1, size_t(nBytes),
+                                reinterpret_cast< std::FILE * >(userData)));
+}
+
+static sf_count_t sfVirtualTell(void *userData)
+{
+  return sf_count_t(std::ftell(reinterpret_cast< std::FILE * >(userData)));
+}
+
+static SF_VIRTUAL_IO  sfVirtualIO = {
+  &sfVirtualGetFileLength,
+  &sfVirtualSeek,
+  &sfVirtualRead,
+  &sfVirtualWrite,
+  &sfVirtualTell
+};
+
 namespace Plus4Emu {
 
   Tape::Tape(int bitsPerSample)
@@ -1007,13 +1062,20 @@ namespace Plus4Emu {
     isReadOnly = (mode == 2);
     SF_INFO sfinfo;
     std::memset(&sfinfo, 0, sizeof(SF_INFO));
-    sf = sf_open_fd(
 #ifdef WIN32
-             _fileno(f),
+    int     fd = _fileno(f);
 #else
-             fileno(f),
+    int     fd = fileno(f);
 #endif
-             (isReadOnly ? SFM_READ : SFM_RDWR), &sfinfo, SF_FALSE);
+    if (fd >= 0) {
+      sf = sf_open_fd(fd, (isReadOnly ? SFM_READ : SFM_RDWR), &sfinfo,
+                      SF_FALSE);
+    }
+    else {
+      // memory streams (see openMemoryFile()) have no file descriptor
+      sf = sf_open_virtual(&sfVirtualIO, (isReadOnly ? SFM_READ : SFM_RDWR),
+                           &sfinfo, (void *) f);
+    }
     if (!sf)
       throw Exception("error opening tape file");
     try {
@@ -1229,7 +1291,8 @@ namespace Plus4Emu {
         }
         catch (...) {
           try {
-            t = new Tape_SoundFile(f, mode, bitsPerSample);
+            t = new Tape_SoundFile(f, (isReadOnly ? 2 : mode),
+                                   bitsPerSample);
           }
           catch (...) {
             try {
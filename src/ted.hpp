@@ -397,11 +397,23 @@ namespace Plus4 {
     void updateVideoMode();
     void initRegisters();
     void initializeRAMSegment(uint8_t *p);
+    // find the pages of the CPU address space that use the default memory
+    // callbacks, and can therefore be accessed directly
+    void checkCPUMemoryPages();
+    // update the direct page pointers of the CPU after any change to the
+    // memory configuration or callbacks
+    void updateCPUMemoryPages();
+    inline void selectCPUMemoryReadPages()
+    {
+      M7501::selectMemoryReadPages(int((cpuMemoryReadMap >> 7) & 1U));
+    }
     // called at single clock frequency / 4
     void calculateSoundOutput();
     void runOneCycle_freezeMode();
     void processDelayedEvents(uint32_t n);
     void checkVerticalEvents();
+    // set BASIC pointers after loading a program ending at 'addr'
+    void setBASICProgramEnd(uint16_t addr);
     // -----------------------------------------------------------------
     static const uint32_t soundDecayCycles = 0x02E000U; // in sound clock cycles
     static const uint8_t  soundVolumeTable[16];
@@ -606,6 +618,11 @@ namespace Plus4 {
     //   6: FD00-FEFF
     //   7: FF00-FFFF
     uint8_t     memoryMapTable[32768];
+    // memory map offset (0 to 7, see above) for each 256 byte page of the
+    // CPU address space that can be read or written directly, or 0xFF if
+    // the memory callbacks need to be used
+    uint8_t     cpuReadPageMapOffset[256];
+    uint8_t     cpuWritePageMapOffset[256];
     // --------
     struct TEDCallback {
       PLUS4EMU_REGPARM1 void (*func)(void *);
@@ -655,10 +672,10 @@ namespace Plus4 {
     {
       memoryReadMap = tedDMAReadMap;    // not sure if this is correct
       if (!(singleClockModeFlags & 0x80)) {
-        (void) readMemory(0xFFFF);
+        (void) readMemoryCallback(0xFFFF);
       }
       else {
-        (void) readMemory(0xFF00 | uint16_t(dramRefreshAddrL));
+        (void) readMemoryCallback(0xFF00 | uint16_t(dramRefreshAddrL));
         dramRefreshAddrL = (dramRefreshAddrL + 1) & 0xFF;
       }
       memoryReadMap = cpuMemoryReadMap;
@@ -844,6 +861,11 @@ namespace Plus4 {
     // load program
     void loadProgram(Plus4Emu::File::Buffer&);
     void loadProgram(const char *fileName);
+    // Copy 'nBytes' bytes of program data to RAM at 'addr' (as seen by the
+    // CPU), and set the BASIC end of program pointers like loadProgram().
+    // Apart from the I/O areas, the data is copied without calling the
+    // memory write callbacks.
+    void injectProgram(const uint8_t *buf, size_t nBytes, uint16_t addr);
     // Read PRG or P00 file header, and return load address.
     // If 'f' is NULL, the file is opened, and the file handle is stored in
     // 'f'. On error, Plus4Emu::Exception is thrown, the file is closed,
@@ -708,6 +708,11 @@ namespace Plus4 {
       addr = (addr + 1) & 0xFFFF;
       len--;
     }
+    setBASICProgramEnd(uint16_t(addr));
+  }
+
+  void TED7360::setBASICProgramEnd(uint16_t addr)
+  {
     writeMemory(0x002D, uint8_t(addr & 0xFF));
     writeMemory(0x002E, uint8_t((addr >> 8) & 0xFF));
     writeMemory(0x002F, uint8_t(addr & 0xFF));
@@ -724,6 +729,49 @@ namespace Plus4 {
     writeMemory(0x009E, uint8_t((addr >> 8) & 0xFF));
   }
 
+  void TED7360::injectProgram(const uint8_t *buf, size_t nBytes, uint16_t addr)
+  {
+    if (nBytes > 0xFFFF)
+      throw Plus4Emu::Exception("plus4 program file has invalid length");
+    uint32_t  startAddr = addr;
+    uint32_t  endAddr = startAddr + uint32_t(nBytes);
+    while (startAddr < endAddr) {
+      uint32_t  addr_ = startAddr & 0xFFFFU;
+      // 0000-0001 and FD00-FFFF are I/O or need special handling, everything
+      // else is copied directly to the RAM segments currently mapped for CPU
+      // writes, one contiguous area at a time
+      uint32_t  areaEnd = 0x10000U;
+      int       n = -1;
+      if (addr_ < 0x0002U) {
+        areaEnd = 0x0002U;
+      }
+      else if (addr_ < 0x1000U) {
+        areaEnd = 0x1000U;
+        n = 4;
+      }
+      else if (addr_ < 0xFD00U) {
+        areaEnd = (addr_ < 0xC000U ? ((addr_ | 0x3FFFU) + 1U) : 0xFD00U);
+        n = int(addr_ >> 14);
+      }
+      size_t    cnt = size_t(areaEnd - addr_);
+      if (cnt > size_t(endAddr - startAddr))
+        cnt = size_t(endAddr - startAddr);
+      uint8_t   *p = (uint8_t *) 0;
+      if (n >= 0)
+        p = segmentTable[memoryMapTable[memoryWriteMap + unsigned(n)]];
+      if (p) {
+        std::memcpy(p + (addr_ & 0x3FFFU), buf, cnt);
+      }
+      else {
+        for (size_t i = 0; i < cnt; i++)
+          writeMemory(uint16_t(addr_ + uint32_t(i)), buf[i]);
+      }
+      buf = buf + cnt;
+      startAddr = startAddr + uint32_t(cnt);
+    }
+    setBASICProgramEnd(uint16_t(endAddr & 0xFFFFU));
+  }
+
   uint16_t TED7360::readPRGFileHeader(std::FILE*& f, const char *fileName)
   {
     if (fileName == (char *) 0 || fileName[0] == '\0') {
@@ -733,10 +781,19 @@ namespace Plus4 {
       }
       throw Plus4Emu::Exception("invalid plus4 program file name");
     }
+    // the P00 header is detected from the name of the file in the archive
+    // when loading from a .zip file
+    bool      isP00 = Plus4Emu::checkFileNameExtension(fileName, ".p00");
     if (!f) {
-      f = Plus4Emu::fileOpen(fileName, "rb");
+      // this also allows loading programs from .zip archives
+      int     fileType = 0;
+      bool    isReadOnly = true;
+      std::string imageFileName;
+      f = Plus4Emu::openPlus4ImageFile(fileName, fileType, isReadOnly,
+                                       &imageFileName);
       if (!f)
         throw Plus4Emu::Exception("error opening plus4 program file");
+      isP00 = Plus4Emu::checkFileNameExtension(imageFileName.c_str(), ".p00");
     }
     uint16_t  addr = 0x0000;
     int       c = std::fgetc(f);
@@ -749,7 +806,7 @@ namespace Plus4 {
         addr |= uint16_t((c & 0xFF) << 8);
         // check for P00 format
         if (addr == 0x3643) {           // "C6"
-          if (Plus4Emu::checkFileNameExtension(fileName, ".p00")) {
+          if (isP00) {
             static const char *p00HeaderMagic = "C64File";
             int     i = 2;
             do {
@@ -806,20 +863,7 @@ namespace Plus4 {
       addr = (addr + 1) & 0xFFFF;
     }
     std::fclose(f);
-    writeMemory(0x002D, uint8_t(addr & 0xFF));
-    writeMemory(0x002E, uint8_t((addr >> 8) & 0xFF));
-    writeMemory(0x002F, uint8_t(addr & 0xFF));
-    writeMemory(0x0030, uint8_t((addr >> 8) & 0xFF));
-    writeMemory(0x0031, uint8_t(addr & 0xFF));
-    writeMemory(0x0032, uint8_t((addr >> 8) & 0xFF));
-    writeMemory(0x0033, readMemoryCPU(0x0037));
-    writeMemory(0x0034, readMemoryCPU(0x0038));
-#if 0
-    writeMemory(0x0035, readMemoryCPU(0x0037));
-    writeMemory(0x0036, readMemoryCPU(0x0038));
-#endif
-    writeMemory(0x009D, uint8_t(addr & 0xFF));
-    writeMemory(0x009E, uint8_t((addr >> 8) & 0xFF));
+    setBASICProgramEnd(uint16_t(addr));
   }
 
   void TED7360::registerChunkTypes(Plus4Emu::File& f)
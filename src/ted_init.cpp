@@ -48,8 +48,11 @@ namespace Plus4 {
     randomSeed = 0;
     Plus4Emu::setRandomSeed(randomSeed,
                             Plus4Emu::Timer::getRandomSeedFromTime());
-    for (int i = 0; i < 256; i++)
+    for (int i = 0; i < 256; i++) {
       segmentTable[i] = (uint8_t *) 0;
+      cpuReadPageMapOffset[i] = 0xFF;
+      cpuWritePageMapOffset[i] = 0xFF;
+    }
     try {
       setRAMSize(64);
     }
@@ -63,6 +66,7 @@ namespace Plus4 {
       throw;
     }
     setMemoryCallbackUserData(this);
+    setMemoryPageDataBus(&dataBusState);
     for (uint16_t i = 0x0000; i <= 0x0FFF; i++) {
       setMemoryReadCallback(i, &read_memory_0000_to_0FFF);
       setMemoryWriteCallback(i, &write_memory_0000_to_0FFF);
@@ -289,6 +293,7 @@ namespace Plus4 {
     tape_motor_state = false;
     tape_write_state = false;
     hannesRegister = uint8_t(0xFF);
+    updateCPUMemoryPages();
   }
 
   void TED7360::reset(bool cold_reset)
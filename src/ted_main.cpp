@@ -257,7 +257,7 @@ namespace Plus4 {
           // perform DMA fetches on even cycle counts
           if (PLUS4EMU_EXPECT(cpuHaltedFlag)) {
             memoryReadMap = tedDMAReadMap;
-            (void) readMemory(uint16_t(dmaBaseAddr | dmaPosition));
+            (void) readMemoryCallback(uint16_t(dmaBaseAddr | dmaPosition));
             memoryReadMap = cpuMemoryReadMap;
           }
           else {
@@ -387,7 +387,7 @@ namespace Plus4 {
               }
               else {
                 // read bitmap data from TED registers
-                (void) readMemory(addr_);
+                (void) readMemoryCallback(addr_);
               }
             }
             else if (addr_ >= 0x8000) {
@@ -402,7 +402,7 @@ namespace Plus4 {
               else if (addr_ < 0xFD00 || addr_ >= 0xFF00) {
                 // read bitmap data from ROM or TED registers
                 memoryReadMap = tedBitmapReadMap;
-                (void) readMemory(addr_);
+                (void) readMemoryCallback(addr_);
                 memoryReadMap = cpuMemoryReadMap;
               }
             }
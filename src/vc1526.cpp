@@ -213,15 +213,12 @@ namespace Plus4 {
       pinState(0x00),
       prvPinState(0x00),
       changeFlag(true),
-      pageBuf((uint8_t *) 0),
+      page(pageWidth, pageHeight),
       breakPointCallback(&defaultBreakPointCallback),
       breakPointCallbackUserData((void *) 0),
       outFileASCIIMode(false),
       outFile((std::FILE *) 0)
   {
-    pageBuf = new uint8_t[pageWidth * pageHeight];
-    for (size_t i = 0; i < size_t(pageWidth * pageHeight); i++)
-      pageBuf[i] = 0xFF;        // clear to white
     cpu.setMemoryCallbackUserData((void *) this);
     for (uint16_t i = 0x0000; i <= 0x1FFF; i++) {
       M7501MemoryReadCallback   readCallback_ = &readMemoryROM;
@@ -267,7 +264,6 @@ namespace Plus4 {
       std::fflush(outFile);
       std::fclose(outFile);
     }
-    delete[] pageBuf;
   }
 
   void VC1526::setROMImage(int n, const uint8_t *romData_)
@@ -288,10 +284,8 @@ namespace Plus4 {
         for (int i = 0; i < 8; i++) {
           if (tmp & 0x80) {
             int     y = headPosYInt + i;
-            if (y >= 0 && y < pageHeight) {
-              int     n = (y * pageWidth) + headPosX;
-              pageBuf[n] = (pageBuf[n] >> 3) + (pageBuf[n] >> 4);
-            }
+            if (y >= 0 && y < pageHeight)
+              page.plotDot(headPosX, y);
           }
           tmp = tmp << 1;
         }
@@ -368,6 +362,14 @@ namespace Plus4 {
         case 1:
           headPosY = (headPosY < pixelToYPos(pageHeight - 1) ?
                       (headPosY + 1) : headPosY);
+          if (headPosY >= pixelToYPos(pageHeight - marginBottom)) {
+            // if writing pages to image files, continue on a new page
+            if (page.ejectPage()) {
+              changeFlag = true;
+              headPosY = headPosY - (pixelToYPos(pageHeight - marginBottom)
+                                     - pixelToYPos(marginTop));
+            }
+          }
           break;
         case 3:
           headPosY = (headPosY > 0 ? (headPosY - 1) : headPosY);
@@ -445,7 +447,12 @@ namespace Plus4 {
 
   const uint8_t * VC1526::getPageData() const
   {
-    return pageBuf;
+    return page.getPageData(0, pageHeight);
+  }
+
+  const uint8_t * VC1526::getPageData(int y0, int y1) const
+  {
+    return page.getPageData(y0, y1);
   }
 
   int VC1526::getPageWidth() const
@@ -461,8 +468,8 @@ namespace Plus4 {
   void VC1526::clearPage()
   {
     changeFlag = true;
-    for (size_t i = 0; i < size_t(pageWidth * pageHeight); i++)
-      pageBuf[i] = 0xFF;        // clear to white
+    if (!page.ejectPage())
+      page.clear();
     headPosY = pixelToYPos(marginTop);
   }
 
@@ -541,6 +548,11 @@ namespace Plus4 {
     }
   }
 
+  void VC1526::setPageOutputFile(const char *fileName)
+  {
+    page.setOutputFile(fileName);
+  }
+
   void VC1526::reset()
   {
     via.reset();
@@ -23,6 +23,7 @@
 #include "plus4emu.hpp"
 #include "serial.hpp"
 #include "printer.hpp"
+#include "prtpage.hpp"
 #include "cpu.hpp"
 #include "via6522.hpp"
 #include "riot6532.hpp"
@@ -90,7 +91,7 @@ namespace Plus4 {
     uint8_t     pinState;
     uint8_t     prvPinState;
     bool        changeFlag;
-    uint8_t     *pageBuf;       // pageWidth * pageHeight bytes
+    PrinterPage page;
     void        (*breakPointCallback)(void *userData,
                                       int debugContext_, int type,
                                       uint16_t addr, uint8_t value);
@@ -169,6 +170,12 @@ namespace Plus4 {
      * until the next runOneCycle() or clearPage() call.
      */
     virtual const uint8_t *getPageData() const;
+    /*!
+     * Returns a pointer to the page data like getPageData(), but only lines
+     * 'y0' to 'y1' - 1 are guaranteed to be up to date; this is faster if
+     * only a part of the page is needed.
+     */
+    virtual const uint8_t *getPageData(int y0, int y1) const;
     /*!
      * Returns the page width in pixels.
      */
@@ -215,6 +222,18 @@ namespace Plus4 {
      */
     virtual void setTextOutputFile(const char *fileName,
                                    bool asciiMode = false);
+    /*!
+     * Write each completed page to a separate image file, with the page
+     * number inserted before the extension of 'fileName'; the format is PBM
+     * if the extension is ".pbm", and PNG otherwise. A page is completed when
+     * the paper reaches the bottom margin (the printing then continues on a
+     * new page, at the top margin), or when clearPage() is called.
+     * The files are written on a separate thread.
+     * If 'fileName' is NULL or empty, then the current page is written if it
+     * is not empty, and the output is closed.
+     * On error, Plus4Emu::Exception may be thrown.
+     */
+    virtual void setPageOutputFile(const char *fileName);
     /*!
      * Reset printer.
      */
@@ -138,6 +138,10 @@ namespace Plus4Emu {
       lineBufBytes(0),
       lineBufLength(0),
       lineBufFlags(0x00),
+      lineBufHash(0U),
+      lineBufSeed(0U),
+      lineHashes((uint32_t *) 0),
+      prvLineData((uint8_t *) 0),
       framesWritten(0),
       duplicateFrames(0),
       fileSize(0),
@@ -155,6 +159,11 @@ namespace Plus4Emu {
         frameRate++;
       lineBuf = reinterpret_cast<uint8_t *>(new uint32_t[720 / 4]);
       std::memset(lineBuf, 0x00, 720);
+      lineHashes = new uint32_t[videoHeight];
+      for (int i = 0; i < videoHeight; i++)
+        lineHashes[i] = 0U;
+      prvLineData = new uint8_t[size_t(videoHeight) * 728];
+      std::memset(prvLineData, 0x00, size_t(videoHeight) * 728);
       audioBufSize = sampleRate / frameRate;
       audioBuf = new int16_t[audioBufSize * audioBuffers];
       for (int i = 0; i < (audioBufSize * audioBuffers); i++)
@@ -164,6 +173,10 @@ namespace Plus4Emu {
     catch (...) {
       if (lineBuf)
         delete[] reinterpret_cast<uint32_t *>(lineBuf);
+      if (lineHashes)
+        delete[] lineHashes;
+      if (prvLineData)
+        delete[] prvLineData;
       if (audioBuf)
         delete[] audioBuf;
       if (audioConverter)
@@ -175,6 +188,8 @@ namespace Plus4Emu {
   VideoCapture::~VideoCapture()
   {
     delete[] reinterpret_cast<uint32_t *>(lineBuf);
+    delete[] lineHashes;
+    delete[] prvLineData;
     delete[] audioBuf;
     delete audioConverter;
   }
@@ -258,8 +273,13 @@ namespace Plus4Emu {
       else if (lineLength < lineLengthMin)
         lineLength = lineLengthMin;
     }
-    if (curLine >= 2 && curLine < ((videoHeight * 2) + 2))
+    if (curLine >= 2 && curLine < ((videoHeight * 2) + 2)) {
+      lineBufSeed = uint32_t(lineBufFlags) | (uint32_t(lineBufLength) << 8)
+                    | (displayParameters.ntscMode ? 0x80000000U : 0U);
+      lineBufHash =
+          VideoDisplay::calculateLineHash(lineBuf, lineBufBytes, lineBufSeed);
       decodeLine((curLine - 2) >> 1);
+    }
     lineBufBytes = 0;
     lineBufLength = 0;
     lineBufFlags = 0x00;
@@ -279,6 +299,31 @@ namespace Plus4Emu {
     vsyncCnt++;
   }
 
+  bool VideoCapture::checkLineUnchanged(int lineNum)
+  {
+    uint8_t   *p = &(prvLineData[size_t(lineNum) * 728]);
+    uint32_t  prvBytes = uint32_t(p[720]) | (uint32_t(p[721]) << 8);
+    uint32_t  prvSeed = uint32_t(p[724]) | (uint32_t(p[725]) << 8)
+                        | (uint32_t(p[726]) << 16) | (uint32_t(p[727]) << 24);
+    if (lineBufHash == lineHashes[lineNum]) {
+      // compare the data as well, so that a hash collision does not leave
+      // a stale line in the output
+      if (prvBytes == uint32_t(lineBufBytes) && prvSeed == lineBufSeed &&
+          std::memcmp(p, lineBuf, lineBufBytes) == 0) {
+        return true;
+      }
+    }
+    lineHashes[lineNum] = lineBufHash;
+    std::memcpy(p, lineBuf, lineBufBytes);
+    p[720] = uint8_t(lineBufBytes & 0xFF);
+    p[721] = uint8_t(lineBufBytes >> 8);
+    p[724] = uint8_t(lineBufSeed & 0xFFU);
+    p[725] = uint8_t((lineBufSeed >> 8) & 0xFFU);
+    p[726] = uint8_t((lineBufSeed >> 16) & 0xFFU);
+    p[727] = uint8_t(lineBufSeed >> 24);
+    return false;
+  }
+
   void VideoCapture::setClockFrequency(size_t freq_)
   {
     freq_ = (freq_ + 4) & (~(size_t(7)));
@@ -514,6 +559,9 @@ namespace Plus4Emu {
 
   void VideoCapture_RLE8::decodeLine(int lineNum)
   {
+    // the frame buffer already contains this line if it has not changed
+    if (checkLineUnchanged(lineNum))
+      return;
     int       xc = 0;
     size_t    bufPos = 0;
     size_t    pixelSample2 = lineBufLength;
@@ -565,6 +613,7 @@ namespace Plus4Emu {
   void VideoCapture_RLE8::clearLine(int lineNum)
   {
     tmpFrameBuf.clearLine(lineNum);
+    lineHashes[lineNum] = 0U;
   }
 
   void VideoCapture_RLE8::frameDone()
@@ -1030,6 +1079,7 @@ namespace Plus4Emu {
       outBufY((uint8_t *) 0),
       outBufV((uint8_t *) 0),
       outBufU((uint8_t *) 0),
+      lineCache((uint32_t *) 0),
       duplicateFrameBitmap((uint8_t *) 0),
       colormap()
   {
@@ -1039,7 +1089,7 @@ namespace Plus4Emu {
       size_t    bufSize3 = (bufSize1 + 3) >> 2;
       size_t    bufSize4 = (bufSize3 + 3) >> 2;
       size_t    totalSize = (3 * (bufSize3 + bufSize4 + bufSize4));
-      totalSize += (bufSize1 + bufSize3 + bufSize3);
+      totalSize += (bufSize1 + bufSize3 + bufSize3 + bufSize1);
       videoBuf = new uint32_t[totalSize];
       totalSize = 0;
       frameBuf0Y = reinterpret_cast<uint8_t *>(&(videoBuf[totalSize]));
@@ -1080,6 +1130,10 @@ namespace Plus4Emu {
       totalSize += bufSize4;
       outBufU = reinterpret_cast<uint8_t *>(&(videoBuf[totalSize]));
       std::memset(outBufU, 0x80, bufSize3);
+      totalSize += bufSize4;
+      lineCache = &(videoBuf[totalSize]);
+      for (size_t i = 0; i < bufSize1; i++)
+        lineCache[i] = 0x08020010U;
       size_t  nBytes = 0x08000000 / size_t(audioBufSize);
       duplicateFrameBitmap = new uint8_t[nBytes];
       std::memset(duplicateFrameBitmap, 0x00, nBytes);
@@ -1129,9 +1183,13 @@ namespace Plus4Emu {
     size_t    pixelSample2 = lineBufLength;
     if (displayParameters.ntscMode)
       videoFlags = videoFlags | 0x10;
-    uint32_t  tmpBuf2[512];
-    if (pixelSample2 == (displayParameters.ntscMode ? 392 : 490) &&
-        !(lineBufFlags & 0x01)) {
+    uint32_t  *tmpBuf2 = &(lineCache[lineNum * videoWidth]);
+    if (checkLineUnchanged(lineNum)) {
+      // the line has not changed, only need to copy the cached pixels
+      // to the frame buffer
+    }
+    else if (pixelSample2 == (displayParameters.ntscMode ? 392 : 490) &&
+             !(lineBufFlags & 0x01)) {
       // faster code for the case when resampling is not needed
       do {
         size_t  n = colormap.convertFourPixels(&(tmpBuf2[xc]),
@@ -84,6 +84,17 @@ namespace Plus4Emu {
     size_t      lineBufBytes;
     size_t      lineBufLength;
     uint8_t     lineBufFlags;
+    // hash of the line data in lineBuf, calculated before decodeLine()
+    uint32_t    lineBufHash;
+    // flags and length of the line in lineBuf, included in the hash
+    uint32_t    lineBufSeed;
+    // hash of the line last decoded for each row of the frame (0: none),
+    // used by decodeLine() to skip lines that have not changed
+    uint32_t    *lineHashes;            // videoHeight entries
+    // copy of the line last decoded for each row: 720 bytes of data
+    // followed by the number of bytes and the hash seed, for checking
+    // lines with matching hashes
+    uint8_t     *prvLineData;           // videoHeight * 728 bytes
     size_t      framesWritten;
     size_t      duplicateFrames;
     size_t      fileSize;
@@ -106,6 +117,10 @@ namespace Plus4Emu {
     virtual void writeAVIHeader() = 0;
     virtual void writeAVIIndex() = 0;
     void lineDone();
+    // returns true if the line in lineBuf is the same as the one last
+    // decoded for row 'lineNum'; otherwise, the line is stored as the new
+    // reference for the row, and false is returned
+    bool checkLineUnchanged(int lineNum);
     void closeFile();
     void errorMessage(const char *msg);
    public:
@@ -199,6 +214,7 @@ namespace Plus4Emu {
     uint8_t     *outBufY;               // 384x288
     uint8_t     *outBufV;               // 192x144
     uint8_t     *outBufU;               // 192x144
+    uint32_t    *lineCache;             // 384x288 decoded pixels
     uint8_t     *duplicateFrameBitmap;
     VideoDisplayColormap<uint32_t>  colormap;
     // ----------------
@@ -147,7 +147,7 @@ namespace Plus4Emu {
     if (audioConverter == (AudioConverter *) 0) {
       if (audioOutputEnabled) {
         // open audio converter if needed
-        audioOutputSampleRate = audioOutput.getSampleRate();
+        audioOutputSampleRate = audioOutput.getAdjustedSampleRate();
         if (audioConverterSampleRate > 0.0f && audioOutputSampleRate > 0.0f) {
           if (audioOutputHighQuality)
             audioConverter = new AudioConverter_<AudioConverterHighQuality>(
@@ -168,8 +168,8 @@ namespace Plus4Emu {
         }
       }
     }
-    else if (audioOutput.getSampleRate() != audioOutputSampleRate) {
-      audioOutputSampleRate = audioOutput.getSampleRate();
+    else if (audioOutput.getAdjustedSampleRate() != audioOutputSampleRate) {
+      audioOutputSampleRate = audioOutput.getAdjustedSampleRate();
       audioConverter->setOutputSampleRate(audioOutputSampleRate);
     }
     writingAudioOutput =
@@ -206,7 +206,7 @@ namespace Plus4Emu {
         delete audioConverter;
         audioConverter = (AudioConverter *) 0;
       }
-      audioOutputSampleRate = audioOutput.getSampleRate();
+      audioOutputSampleRate = audioOutput.getAdjustedSampleRate();
       if (audioOutputEnabled &&
           audioConverterSampleRate > 0.0f && audioOutputSampleRate > 0.0f) {
         if (audioOutputHighQuality)
@@ -355,13 +355,22 @@ namespace Plus4Emu {
   }
 
   void VirtualMachine::getPrinterOutput(const uint8_t*& buf_,
-                                        int& w_, int& h_) const
+                                        int& w_, int& h_,
+                                        int y0, int y1) const
   {
+    (void) y0;
+    (void) y1;
     buf_ = (uint8_t *) 0;
     w_ = 0;
     h_ = 0;
   }
 
+  void VirtualMachine::getPrinterPageSize(int& w_, int& h_) const
+  {
+    w_ = 0;
+    h_ = 0;
+  }
+
   void VirtualMachine::clearPrinterOutput()
   {
   }
@@ -398,6 +407,11 @@ namespace Plus4Emu {
     (void) asciiMode;
   }
 
+  void VirtualMachine::setPrinterPageOutputFile(const char *fileName)
+  {
+    (void) fileName;
+  }
+
   void VirtualMachine::getVMStatus(VMStatus& vmStatus_)
   {
     vmStatus_.tapeReadOnly = getIsTapeReadOnly();
@@ -415,6 +429,25 @@ namespace Plus4Emu {
     vmStatus_.printerLEDState = getPrinterLEDState();
   }
 
+  void VirtualMachine::getPerformanceCounters(
+      PerformanceCounters& perfCounters_)
+  {
+    perfCounters_.totalTime = 0.0;
+    perfCounters_.tedTime = 0.0;
+    perfCounters_.sidTime = 0.0;
+    perfCounters_.floppyDriveTime = 0.0;
+    perfCounters_.printerTime = 0.0;
+    perfCounters_.videoCaptureTime = 0.0;
+    perfCounters_.audioOutputTime = 0.0;
+    perfCounters_.displayTime = 0.0;
+    perfCounters_.tapeTime = 0.0;
+    perfCounters_.frameCount = 0U;
+  }
+
+  void VirtualMachine::resetPerformanceCounters()
+  {
+  }
+
   void VirtualMachine::openVideoCapture(
       int frameRate_,
       bool yuvFormat_,
@@ -881,7 +914,7 @@ namespace Plus4Emu {
         audioConverter->setInputSampleRate(audioConverterSampleRate);
         return;
       }
-      audioOutputSampleRate = audioOutput.getSampleRate();
+      audioOutputSampleRate = audioOutput.getAdjustedSampleRate();
       if (audioOutputEnabled &&
           audioConverterSampleRate > 0.0f && audioOutputSampleRate > 0.0f) {
         if (audioOutputHighQuality)
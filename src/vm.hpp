@@ -107,6 +107,23 @@ namespace Plus4Emu {
       bool      printerOutputChanged;
       uint8_t   printerLEDState;
     };
+    struct PerformanceCounters {
+      // average real time (in microseconds) spent per emulated video frame
+      // in each subsystem; 'tedTime' is the time used by TED and the main
+      // CPU, which is calculated as the total minus all the other values
+      double    totalTime;
+      double    tedTime;
+      double    sidTime;
+      double    floppyDriveTime;
+      double    printerTime;
+      double    videoCaptureTime;
+      double    audioOutputTime;
+      double    displayTime;
+      double    tapeTime;
+      // number of frames the averages were calculated from (zero if there
+      // is no data, or performance counters are not enabled)
+      uint32_t  frameCount;
+    };
     static const uint64_t defaultRAMPattern =
         (uint64_t(0x0000E000UL) | (uint64_t(0x000001F7UL) << 32));
     static const char     *defaultRAMPatternString;
@@ -262,11 +279,17 @@ namespace Plus4Emu {
     virtual void setPrinterType(int n);
     /*!
      * Get the current printer output as an 8-bit greyscale image.
-     * 'buf_' contains 'w_' * 'h_' bytes. If there is no printer, a NULL
-     * buffer pointer, and zero width and height will be returned.
+     * 'buf_' contains 'w_' * 'h_' bytes, of which only lines 'y0' to
+     * 'y1' - 1 are guaranteed to be up to date. If there is no printer,
+     * a NULL buffer pointer, and zero width and height will be returned.
+     */
+    virtual void getPrinterOutput(const uint8_t*& buf_, int& w_, int& h_,
+                                  int y0, int y1) const;
+    /*!
+     * Get the printer page width and height in pixels (zero if there is
+     * no printer), without updating or allocating the page image.
      */
-    virtual void getPrinterOutput(const uint8_t*& buf_,
-                                  int& w_, int& h_) const;
+    virtual void getPrinterPageSize(int& w_, int& h_) const;
     /*!
      * Clear the printer output buffer, and reset the head position to
      * the top of the page.
@@ -281,7 +304,7 @@ namespace Plus4Emu {
      * Returns the current position of the printer head. 'xPos' is in the
      * range 0 (left) to page width - 1 (right), 'yPos' is in the range 0
      * (top) to page height - 1 (bottom). The page width and height can be
-     * determined with getPrinterOutput().
+     * determined with getPrinterPageSize().
      * If printer emulation is not enabled, -1,-1 is returned.
      */
     virtual void getPrinterHeadPosition(int& xPos, int& yPos);
@@ -306,12 +329,36 @@ namespace Plus4Emu {
      */
     virtual void setPrinterTextOutputFile(const char *fileName,
                                           bool asciiMode = false);
+    /*!
+     * Write each completed printer page to a separate image file, with the
+     * page number inserted before the extension of 'fileName'; the format is
+     * PBM if the extension is ".pbm", and PNG otherwise. A page is completed
+     * when the paper reaches the bottom margin, or when clearPrinterOutput()
+     * is called. The files are written on a separate thread.
+     * If 'fileName' is NULL or empty, then the current page is written if it
+     * is not empty, and the output is closed.
+     * On error, Plus4Emu::Exception may be thrown.
+     * NOTE: printer emulation must be enabled before calling this function.
+     */
+    virtual void setPrinterPageOutputFile(const char *fileName);
     /*!
      * Returns status information about the emulated machine (see also
      * struct VMStatus above, and the comments for functions that return
      * individual status values).
      */
     virtual void getVMStatus(VMStatus& vmStatus_);
+    /*!
+     * Returns the average time spent per video frame in each emulated
+     * subsystem since the last call of resetPerformanceCounters() (or since
+     * the virtual machine was created). Reading the counters does not reset
+     * them. This is only implemented if the emulator is built with
+     * ENABLE_PERF_COUNTERS defined, otherwise all values are zero.
+     */
+    virtual void getPerformanceCounters(PerformanceCounters& perfCounters_);
+    /*!
+     * Clear the performance counters, and start a new measurement interval.
+     */
+    virtual void resetPerformanceCounters();
     /*!
      * Create video capture object with the specified frame rate (24 to 60)
      * and format (384x288 RLE8 or 384x288 YV12) if it does not exist yet,
@@ -34,6 +34,37 @@ static void dummyErrorCallback(void *userData_, const char *msg)
   (void) msg;
 }
 
+// calculate the averages for the frames counted between two readings
+// ('prv' and 'cur') of the performance counters, and store them in 'p'
+
+static void calculatePerformanceCounterDelta(
+    Plus4Emu::VirtualMachine::PerformanceCounters& p,
+    const Plus4Emu::VirtualMachine::PerformanceCounters& cur,
+    const Plus4Emu::VirtualMachine::PerformanceCounters& prv)
+{
+  if (cur.frameCount <= prv.frameCount) {
+    // the counters have been reset
+    p = cur;
+    return;
+  }
+  double  n0 = double(long(prv.frameCount));
+  double  n1 = double(long(cur.frameCount));
+  double  d = 1.0 / (n1 - n0);
+  p.totalTime = ((cur.totalTime * n1) - (prv.totalTime * n0)) * d;
+  p.tedTime = ((cur.tedTime * n1) - (prv.tedTime * n0)) * d;
+  p.sidTime = ((cur.sidTime * n1) - (prv.sidTime * n0)) * d;
+  p.floppyDriveTime =
+      ((cur.floppyDriveTime * n1) - (prv.floppyDriveTime * n0)) * d;
+  p.printerTime = ((cur.printerTime * n1) - (prv.printerTime * n0)) * d;
+  p.videoCaptureTime =
+      ((cur.videoCaptureTime * n1) - (prv.videoCaptureTime * n0)) * d;
+  p.audioOutputTime =
+      ((cur.audioOutputTime * n1) - (prv.audioOutputTime * n0)) * d;
+  p.displayTime = ((cur.displayTime * n1) - (prv.displayTime * n0)) * d;
+  p.tapeTime = ((cur.tapeTime * n1) - (prv.tapeTime * n0)) * d;
+  p.frameCount = cur.frameCount - prv.frameCount;
+}
+
 namespace Plus4Emu {
 
   VMThread::VMThread(VirtualMachine& vm_, void *userData_)
@@ -41,6 +72,7 @@ namespace Plus4Emu {
       lockCnt(0UL),
       threadLock1(true),
       threadLock2(true),
+      pauseLock(false),
       messageQueue((Message *) 0),
       lastMessage((Message *) 0),
       freeMessageStack((Message *) 0),
@@ -53,6 +85,9 @@ namespace Plus4Emu {
       avgTimesliceLength(0.002f),
       prvTime(0.0),
       nxtTime(0.0),
+      perfCountersUpdateTime(0.0),
+      audioLatency(0.0f),
+      audioLatencyMax(0.0f),
       userData(userData_),
       errorCallback(&defaultErrorCallback),
       processCallback((void (*)(void *)) 0)
@@ -70,6 +105,8 @@ namespace Plus4Emu {
     vmStatus.printerHeadPositionY = -1;
     vmStatus.printerOutputChanged = true;
     vmStatus.printerLEDState = 0x00;
+    vm.VirtualMachine::getPerformanceCounters(perfCounters);
+    vm.VirtualMachine::getPerformanceCounters(perfCountersTotal);
     for (int i = 0; i < 128; i++)
       keyboardState[i] = false;
     this->start();
@@ -181,7 +218,10 @@ namespace Plus4Emu {
           nxtTime = curTime;
       }
       else {
-        Timer::wait(0.01);
+        // sleep until a message is queued, or the thread is locked,
+        // resumed, or stopped; the timeout is only needed for calling
+        // processCallback periodically
+        (void) pauseLock.wait(100);
         curTime = speedTimer.getRealTime();
         nxtTime = curTime;
       }
@@ -208,6 +248,24 @@ namespace Plus4Emu {
     avgTimesliceLength = (avgTimesliceLength * 0.995f) + (deltaTime * 0.005f);
     try {
       vm.getVMStatus(vmStatus);
+      if (curTime >= perfCountersUpdateTime ||
+          curTime < (perfCountersUpdateTime - 0.5)) {
+        perfCountersUpdateTime = curTime + 0.5;
+        // the counters are not reset here, so that other readers of
+        // VirtualMachine::getPerformanceCounters() see the full totals
+        VirtualMachine::PerformanceCounters tmp;
+        vm.getPerformanceCounters(tmp);
+        if (tmp.frameCount != perfCountersTotal.frameCount) {
+          calculatePerformanceCounterDelta(perfCounters,
+                                           tmp, perfCountersTotal);
+          perfCountersTotal = tmp;
+        }
+        double  avgLatency = 0.0;
+        double  maxLatency = 0.0;
+        (void) vm.getAudioOutput().getLatencyStats(avgLatency, maxLatency);
+        audioLatency = float(avgLatency);
+        audioLatencyMax = float(maxLatency);
+      }
     }
     catch (...) {
       errorFlag = true;
@@ -244,6 +302,9 @@ namespace Plus4Emu {
     else
       speedPercentage = 1000000.0f;
     isPaused = vmThread_.pauseFlag;
+    perfCounters = vmThread_.perfCounters;
+    audioLatency = vmThread_.audioLatency;
+    audioLatencyMax = vmThread_.audioLatencyMax;
     isRecordingDemo = vmThread_.vmStatus.isRecordingDemo;
     isPlayingDemo = vmThread_.vmStatus.isPlayingDemo;
     tapeReadOnly = vmThread_.vmStatus.tapeReadOnly;
@@ -278,6 +339,7 @@ namespace Plus4Emu {
     }
     threadLock1.wait(0);
     threadLock2.wait(0);
+    pauseLock.notify();
     mutex_.unlock();
     bool  tmp = threadLock2.wait(t);
     mutex_.lock();
@@ -309,6 +371,8 @@ namespace Plus4Emu {
   {
     mutex_.lock();
     pauseFlag = n;
+    if (!n)
+      pauseLock.notify();
     mutex_.unlock();
   }
 
@@ -319,6 +383,7 @@ namespace Plus4Emu {
     pauseFlag = true;
     lockCnt = 0UL;
     threadLock1.notify();
+    pauseLock.notify();
     if (joinFlag || !waitFlag_) {
       mutex_.unlock();
       return;
@@ -464,6 +529,7 @@ namespace Plus4Emu {
       messageQueue = m;
     lastMessage = m;
     messageCnt++;
+    pauseLock.notify();
     mutex_.unlock();
   }
 
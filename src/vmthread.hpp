@@ -36,6 +36,13 @@ namespace Plus4Emu {
       int       threadStatus;
       float     speedPercentage;
       bool      isPaused;
+      // updated about twice per second, see also
+      // VirtualMachine::getPerformanceCounters()
+      VirtualMachine::PerformanceCounters perfCounters;
+      // average and maximum audio output latency in seconds (zero if there
+      // is no audio output), updated at the same rate as 'perfCounters'
+      float     audioLatency;
+      float     audioLatencyMax;
       // --------
       VMThreadStatus(VMThread& vmThread_);
     };
@@ -45,6 +52,8 @@ namespace Plus4Emu {
     unsigned long   lockCnt;
     ThreadLock      threadLock1;
     ThreadLock      threadLock2;
+    // signaled when the paused VM thread needs to wake up early
+    ThreadLock      pauseLock;
     Timer           speedTimer;
     Message         *messageQueue;
     Message         *lastMessage;
@@ -58,7 +67,13 @@ namespace Plus4Emu {
     float           avgTimesliceLength;
     double          prvTime;
     double          nxtTime;
+    double          perfCountersUpdateTime;
     VirtualMachine::VMStatus  vmStatus;
+    VirtualMachine::PerformanceCounters perfCounters;
+    // totals at the previous update of 'perfCounters'
+    VirtualMachine::PerformanceCounters perfCountersTotal;
+    float           audioLatency;
+    float           audioLatencyMax;
     void            *userData;
     void            (*errorCallback)(void *userData_, const char *msg);
     void            (*processCallback)(void *userData_);
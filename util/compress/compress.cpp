@@ -21,6 +21,7 @@
 // without any restrictions.
 
 #include "plus4emu.hpp"
+#include "system.hpp"
 #include "compress.hpp"
 #include "compress0.hpp"
 #include "compress1.hpp"
@@ -52,6 +53,87 @@ static bool defaultProgressPercentageCb(void *userData, int n)
 
 namespace Plus4Compress {
 
+  struct CompressorJobQueue {
+    Plus4Emu::Mutex mutex_;
+    bool    (*func)(void *userData, int threadNum, size_t jobNum);
+    void    *userData;
+    size_t  nJobs;
+    size_t  nextJob;
+    bool    abortFlag;
+    bool    errorFlag;
+    std::string errorMessage;
+    // --------
+    CompressorJobQueue()
+      : func((bool (*)(void *, int, size_t)) 0),
+        userData((void *) 0),
+        nJobs(0),
+        nextJob(0),
+        abortFlag(false),
+        errorFlag(false),
+        errorMessage("")
+    {
+    }
+    void processJobs(int threadNum);
+  };
+
+  void CompressorJobQueue::processJobs(int threadNum)
+  {
+    try {
+      while (true) {
+        mutex_.lock();
+        size_t  jobNum = nextJob;
+        if (abortFlag || jobNum >= nJobs) {
+          mutex_.unlock();
+          break;
+        }
+        nextJob++;
+        mutex_.unlock();
+        if (!func(userData, threadNum, jobNum)) {
+          mutex_.lock();
+          abortFlag = true;
+          mutex_.unlock();
+          break;
+        }
+      }
+    }
+    catch (std::exception& e) {
+      mutex_.lock();
+      if (!errorFlag) {
+        errorFlag = true;
+        try {
+          errorMessage = e.what();
+        }
+        catch (...) {
+        }
+      }
+      abortFlag = true;
+      mutex_.unlock();
+    }
+  }
+
+  class CompressorJobThread : public Plus4Emu::Thread {
+   private:
+    CompressorJobQueue& jobQueue;
+    int     threadNum;
+   public:
+    CompressorJobThread(CompressorJobQueue& jobQueue_, int threadNum_)
+      : Plus4Emu::Thread(),
+        jobQueue(jobQueue_),
+        threadNum(threadNum_)
+    {
+    }
+    virtual ~CompressorJobThread()
+    {
+    }
+   protected:
+    virtual void run()
+    {
+      jobQueue.processJobs(threadNum);
+    }
+  };
+
+  // --------------------------------------------------------------------------
+
   void Compressor::progressMessage(const char *msg)
   {
     if (msg == (char *) 0)
@@ -69,6 +151,38 @@ namespace Plus4Compress {
     return true;
   }
 
+  bool Compressor::runParallelJobs(bool (*func)(void *userData,
+                                                int threadNum, size_t jobNum),
+                                   void *userData, size_t nJobs)
+  {
+    CompressorJobQueue  jobQueue;
+    jobQueue.func = func;
+    jobQueue.userData = userData;
+    jobQueue.nJobs = nJobs;
+    int     nThreads = threadCnt;
+    if (size_t(nThreads) > nJobs)
+      nThreads = int(nJobs);
+    std::vector< CompressorJobThread * >  threads;
+    threads.reserve(size_t(nThreads > 1 ? nThreads : 1));
+    try {
+      for (int i = 1; i < nThreads; i++) {
+        threads.push_back(new CompressorJobThread(jobQueue, i));
+        threads.back()->start();
+      }
+    }
+    catch (std::exception&) {
+      // if not all threads could be created, continue with fewer threads
+    }
+    jobQueue.processJobs(0);
+    for (size_t i = 0; i < threads.size(); i++) {
+      threads[i]->join();
+      delete threads[i];
+    }
+    if (jobQueue.errorFlag)
+      throw Plus4Emu::Exception(jobQueue.errorMessage.c_str());
+    return !jobQueue.abortFlag;
+  }
+
   Compressor::Compressor(std::vector< unsigned char >& outBuf_)
     : outBuf(outBuf_),
       progressCnt(0),
@@ -78,7 +192,10 @@ namespace Plus4Compress {
       progressMessageCallback(&defaultProgressMessageCb),
       progressMessageUserData((void *) 0),
       progressPercentageCallback(&defaultProgressPercentageCb),
-      progressPercentageUserData((void *) 0)
+      progressPercentageUserData((void *) 0),
+      threadCnt(1),
+      matchFinderType(0),
+      decompressionSpeed(0)
   {
     outBuf.resize(0);
   }
@@ -98,6 +215,21 @@ namespace Plus4Compress {
     (void) isLastBlock;
   }
 
+  void Compressor::setThreadCount(int n)
+  {
+    threadCnt = (n > 1 ? (n < 64 ? n : 64) : 1);
+  }
+
+  void Compressor::setMatchFinderType(int n)
+  {
+    matchFinderType = (n == 1 ? 1 : 0);
+  }
+
+  void Compressor::setDecompressionSpeed(int n)
+  {
+    decompressionSpeed = (n > 0 ? (n < 32 ? n : 32) : 0);
+  }
+
   void Compressor::setProgressMessageCallback(
       void (*func)(void *userData, const char *msg), void *userData_)
   {
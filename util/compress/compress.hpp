@@ -39,14 +39,40 @@ namespace Plus4Compress {
     void    *progressMessageUserData;
     bool    (*progressPercentageCallback)(void *userData, int n);
     void    *progressPercentageUserData;
+    // maximum number of threads to be used for compression
+    int     threadCnt;
+    // match finder algorithm (see LZSearchTable::setMatchFinderType())
+    int     matchFinderType;
+    // weight of the estimated decompression time (see setDecompressionSpeed())
+    int     decompressionSpeed;
     // --------
     void progressMessage(const char *msg);
     bool setProgressPercentage(int n);
+    // Call func(userData, threadNum, jobNum) for each jobNum in the range
+    // 0 to nJobs - 1, using up to 'threadCnt' threads. Thread 0 is the
+    // calling thread, so only func() calls with threadNum == 0 may display
+    // progress. If any call returns false, the remaining jobs are skipped,
+    // and false is returned. Exceptions are re-thrown in the calling thread
+    // after all threads have finished.
+    bool runParallelJobs(bool (*func)(void *userData,
+                                      int threadNum, size_t jobNum),
+                         void *userData, size_t nJobs);
    public:
     Compressor(std::vector< unsigned char >& outBuf_);
     virtual ~Compressor();
     virtual void setCompressionLevel(int n);
     virtual void addZeroPageUpdate(unsigned int endAddr, bool isLastBlock);
+    // set the number of threads to be used (default: 1); the compressed
+    // data does not depend on the number of threads
+    virtual void setThreadCount(int n);
+    // select the algorithm used for finding matches: 0 (the default) uses a
+    // radix tree, and 1 a suffix array; the compressed data is the same
+    virtual void setMatchFinderType(int n);
+    // trade compression ratio for faster decompression by the SFX module
+    // on the Plus/4: 0 (the default) optimizes for size only, while 1 to 32
+    // make one bit of compressed data worth 128 / n cycles of estimated
+    // decompression time; currently only implemented for method 0
+    virtual void setDecompressionSpeed(int n);
     virtual bool compressData(
         const std::vector< unsigned char >& inBuf, unsigned int startAddr,
         bool isLastBlock, bool enableProgressDisplay = false) = 0;
@@ -67,6 +93,27 @@ namespace Plus4Compress {
         const std::vector< unsigned char >& inBuf) = 0;
   };
 
+  // copy an LZ77 match of 'len' bytes from 'offs' bytes before 'dst';
+  // the source and destination may overlap if 'offs' is less than 'len'
+  static PLUS4EMU_INLINE void copyLZMatch(unsigned char *dst,
+                                          size_t offs, size_t len)
+  {
+    const unsigned char *src = dst - offs;
+    if (offs >= 8) {
+      for ( ; len >= 8; len -= 8) {
+        std::memcpy(dst, src, 8);
+        src = src + 8;
+        dst = dst + 8;
+      }
+    }
+    else if (offs == 1) {
+      std::memset(dst, *src, len);
+      return;
+    }
+    for ( ; len > 0; len--)
+      *(dst++) = *(src++);
+  }
+
   // --------------------------------------------------------------------------
 
   Compressor * createCompressor(int compressionType,
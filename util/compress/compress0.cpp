@@ -395,14 +395,47 @@ namespace Plus4Compress {
     return long(b);
   }
 
+  long Compressor_M0::calculateSymbolCosts(long *symbolCostTable,
+                                           long *lengthCostTable)
+  {
+    // estimated 7501 cycle counts for decompress0_sfx.s: reading a bit takes
+    // about 26 cycles (including the shift register refill every 8 bits),
+    // and copying a byte of an LZ match 22 cycles; the remaining overhead
+    // depends on the type of the symbol
+    long    w = long(decompressionSpeed);
+    long    bitCost_ = bitCost + (w * 26L);
+    for (size_t i = 0; i < 0x0144; i++) {
+      long    nCycles = 69L;            // literal byte
+      if (i >= 0x0140)
+        nCycles = 196L;                 // LZ match with recent offset
+      else if (i >= 0x013C)
+        nCycles = 207L;                 // LZ match with delta value
+      else if (i >= 0x0108)
+        nCycles = 234L;                 // LZ match with long offset
+      else if (i >= 0x0100)
+        nCycles = 177L;                 // LZ match with short offset
+      symbolCostTable[i] = long(tmpCharBitsTable[i]) * bitCost_
+                           + (nCycles * w);
+    }
+    for (size_t i = minRepeatLen; i <= maxRepeatLen; i++) {
+      // lengths >= 10 bytes need an extra call to read the additional bits
+      long    nCycles = long(i) * 22L + (lengthBitsTable[i] > 0 ? 30L : 0L);
+      lengthCostTable[i] = long(tmpCharBitsTable[lengthCodeTable[i]]
+                                + size_t(lengthBitsTable[i])) * bitCost_
+                           + (nCycles * w);
+    }
+    return bitCost_;
+  }
+
   void Compressor_M0::optimizeMatches_RND(
       LZMatchParameters *matchTable, BitCountTableEntry *bitCountTable,
-      const size_t *lengthBitsTable_, const unsigned char *inBuf,
+      const long *symbolCostTable, const long *lengthCostTable,
+      long extraBitCost, const unsigned char *inBuf,
       size_t offs, size_t nBytes)
   {
     for (size_t i = nBytes; i-- > 0; ) {
       // check literal byte
-      long    bestSize = long(tmpCharBitsTable[inBuf[offs + i]])
+      long    bestSize = symbolCostTable[inBuf[offs + i]]
                          + bitCountTable[i + 1].totalBits;
       size_t  bestLen = 1;
       size_t  bestOffs = 0;
@@ -416,41 +449,41 @@ namespace Plus4Compress {
         size_t  len = *matchPtr & 0x03FFU;
         size_t  d = *(matchPtr++) >> 10;
         len = (len < maxLen ? len : maxLen);
-        size_t  offsBits = tmpCharBitsTable[distanceCodeTable[d]];
+        long    offsBits = symbolCostTable[distanceCodeTable[d]];
         if (d > 8) {
           // long offset: need to search the previous offsets table
-          offsBits += size_t(distanceBitsTable[d]);
+          offsBits += (long(distanceBitsTable[d]) * extraBitCost);
           for ( ; len >= minLen; len--) {
             const BitCountTableEntry& nxtMatch = bitCountTable[i + len];
-            long    nBits = long(lengthBitsTable_[len]) + nxtMatch.totalBits;
-            size_t  offsBits_ = offsBits;
+            long    nBits = lengthCostTable[len] + nxtMatch.totalBits;
+            long    offsBits_ = offsBits;
             bool    prvDistFlag = false;
             if (size_t(nxtMatch.prvDistances[0]) == d) {
-              if (tmpCharBitsTable[0x0140] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0140];
+              if (symbolCostTable[0x0140] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0140];
                 prvDistFlag = true;
               }
             }
             else if (size_t(nxtMatch.prvDistances[1]) == d) {
-              if (tmpCharBitsTable[0x0141] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0141];
+              if (symbolCostTable[0x0141] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0141];
                 prvDistFlag = true;
               }
             }
             else if (size_t(nxtMatch.prvDistances[2]) == d) {
-              if (tmpCharBitsTable[0x0142] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0142];
+              if (symbolCostTable[0x0142] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0142];
                 prvDistFlag = true;
               }
             }
             else if (size_t(nxtMatch.prvDistances[3]) == d) {
-              if (tmpCharBitsTable[0x0143] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0143];
+              if (symbolCostTable[0x0143] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0143];
                 prvDistFlag = true;
               }
             }
-            nBits += long(offsBits_);
-            if ((nBits + rndBit()) <= bestSize) {
+            nBits += offsBits_;
+            if ((nBits + (rndBit() * bitCost)) <= bestSize) {
               bestSize = nBits;
               bestLen = len;
               bestOffs = d;
@@ -462,9 +495,9 @@ namespace Plus4Compress {
           // short offset
           for ( ; len >= minLen; len--) {
             const BitCountTableEntry& nxtMatch = bitCountTable[i + len];
-            long    nBits = long(lengthBitsTable_[len] + offsBits)
+            long    nBits = lengthCostTable[len] + offsBits
                             + nxtMatch.totalBits;
-            if ((nBits + rndBit()) <= bestSize) {
+            if ((nBits + (rndBit() * bitCost)) <= bestSize) {
               bestSize = nBits;
               bestLen = len;
               bestOffs = d;
@@ -478,13 +511,13 @@ namespace Plus4Compress {
         if (len < minLen)
           continue;
         unsigned char seqDiff = searchTable->getSequenceDeltaValue(offs + i, d);
-        size_t  offsBits = tmpCharBitsTable[0x013B + d] + 7;
+        long    offsBits = symbolCostTable[0x013B + d] + (extraBitCost * 7L);
         len = (len < maxLen ? len : maxLen);
         for ( ; len >= minLen; len--) {
           const BitCountTableEntry& nxtMatch = bitCountTable[i + len];
-          long    nBits = long(lengthBitsTable_[len] + offsBits)
+          long    nBits = lengthCostTable[len] + offsBits
                           + nxtMatch.totalBits;
-          if ((nBits + rndBit()) <= bestSize) {
+          if ((nBits + (rndBit() * bitCost)) <= bestSize) {
             bestSize = nBits;
             bestLen = len;
             bestOffs = d;
@@ -509,12 +542,13 @@ namespace Plus4Compress {
 
   void Compressor_M0::optimizeMatches(
       LZMatchParameters *matchTable, BitCountTableEntry *bitCountTable,
-      const size_t *lengthBitsTable_, const unsigned char *inBuf,
+      const long *symbolCostTable, const long *lengthCostTable,
+      long extraBitCost, const unsigned char *inBuf,
       size_t offs, size_t nBytes)
   {
     for (size_t i = nBytes; i-- > 0; ) {
       // check literal byte
-      long    bestSize = long(tmpCharBitsTable[inBuf[offs + i]])
+      long    bestSize = symbolCostTable[inBuf[offs + i]]
                          + bitCountTable[i + 1].totalBits;
       size_t  bestLen = 1;
       size_t  bestOffs = 0;
@@ -528,41 +562,41 @@ namespace Plus4Compress {
         size_t  len = *matchPtr & 0x03FFU;
         size_t  d = *(matchPtr++) >> 10;
         len = (len < maxLen ? len : maxLen);
-        size_t  offsBits = tmpCharBitsTable[distanceCodeTable[d]];
+        long    offsBits = symbolCostTable[distanceCodeTable[d]];
         if (d > 8) {
           // long offset: need to search the previous offsets table
-          offsBits += size_t(distanceBitsTable[d]);
+          offsBits += (long(distanceBitsTable[d]) * extraBitCost);
           for ( ; len >= minLen; len--) {
             const BitCountTableEntry& nxtMatch = bitCountTable[i + len];
-            long    nBits = long(lengthBitsTable_[len]) + nxtMatch.totalBits;
-            size_t  offsBits_ = offsBits;
+            long    nBits = lengthCostTable[len] + nxtMatch.totalBits;
+            long    offsBits_ = offsBits;
             bool    prvDistFlag = false;
             if (size_t(nxtMatch.prvDistances[0]) == d) {
-              if (tmpCharBitsTable[0x0140] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0140];
+              if (symbolCostTable[0x0140] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0140];
                 prvDistFlag = true;
               }
             }
             else if (size_t(nxtMatch.prvDistances[1]) == d) {
-              if (tmpCharBitsTable[0x0141] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0141];
+              if (symbolCostTable[0x0141] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0141];
                 prvDistFlag = true;
               }
             }
             else if (size_t(nxtMatch.prvDistances[2]) == d) {
-              if (tmpCharBitsTable[0x0142] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0142];
+              if (symbolCostTable[0x0142] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0142];
                 prvDistFlag = true;
               }
             }
             else if (size_t(nxtMatch.prvDistances[3]) == d) {
-              if (tmpCharBitsTable[0x0143] < offsBits_) {
-                offsBits_ = tmpCharBitsTable[0x0143];
+              if (symbolCostTable[0x0143] < offsBits_) {
+                offsBits_ = symbolCostTable[0x0143];
                 prvDistFlag = true;
               }
             }
-            nBits += long(offsBits_);
-            if ((nBits + long(d >= bestOffs)) <= bestSize) {
+            nBits += offsBits_;
+            if ((nBits + (long(d >= bestOffs) * bitCost)) <= bestSize) {
               bestSize = nBits;
               bestLen = len;
               bestOffs = d;
@@ -574,9 +608,9 @@ namespace Plus4Compress {
           // short offset
           for ( ; len >= minLen; len--) {
             const BitCountTableEntry& nxtMatch = bitCountTable[i + len];
-            long    nBits = long(lengthBitsTable_[len] + offsBits)
+            long    nBits = lengthCostTable[len] + offsBits
                             + nxtMatch.totalBits;
-            if ((nBits + long(d >= bestOffs)) <= bestSize) {
+            if ((nBits + (long(d >= bestOffs) * bitCost)) <= bestSize) {
               bestSize = nBits;
               bestLen = len;
               bestOffs = d;
@@ -590,13 +624,13 @@ namespace Plus4Compress {
         if (len < minLen)
           continue;
         unsigned char seqDiff = searchTable->getSequenceDeltaValue(offs + i, d);
-        size_t  offsBits = tmpCharBitsTable[0x013B + d] + 7;
+        long    offsBits = symbolCostTable[0x013B + d] + (extraBitCost * 7L);
         len = (len < maxLen ? len : maxLen);
         for ( ; len >= minLen; len--) {
           const BitCountTableEntry& nxtMatch = bitCountTable[i + len];
-          long    nBits = long(lengthBitsTable_[len] + offsBits)
+          long    nBits = lengthCostTable[len] + offsBits
                           + nxtMatch.totalBits;
-          if ((nBits + long(d >= bestOffs)) <= bestSize) {
+          if ((nBits + (long(d >= bestOffs) * bitCost)) <= bestSize) {
             bestSize = nBits;
             bestLen = len;
             bestOffs = d;
@@ -631,23 +665,26 @@ namespace Plus4Compress {
     std::vector< LZMatchParameters >  matchTable(nBytes);
     {
       std::vector< BitCountTableEntry > bitCountTable(nBytes + 1);
-      std::vector< size_t > lengthBitsTable_(maxRepeatLen + 1, 0x7FFF);
-      for (size_t i = minRepeatLen; i <= maxRepeatLen; i++) {
-        lengthBitsTable_[i] = tmpCharBitsTable[lengthCodeTable[i]]
-                              + size_t(lengthBitsTable[i]);
-      }
+      std::vector< long > symbolCostTable(0x0144);
+      std::vector< long > lengthCostTable(maxRepeatLen + 1,
+                                          0x7FFFL * bitCost);
+      long    extraBitCost =
+          calculateSymbolCosts(&(symbolCostTable.front()),
+                               &(lengthCostTable.front()));
       bitCountTable[nBytes].totalBits = 0L;
       for (size_t i = 0; i < 4; i++)
         bitCountTable[nBytes].prvDistances[i] = 0;
       if (config.splitOptimizationDepth >= 9) {
         optimizeMatches_RND(&(matchTable.front()), &(bitCountTable.front()),
-                            &(lengthBitsTable_.front()), &(inBuf.front()),
-                            offs, nBytes);
+                            &(symbolCostTable.front()),
+                            &(lengthCostTable.front()), extraBitCost,
+                            &(inBuf.front()), offs, nBytes);
       }
       else {
         optimizeMatches(&(matchTable.front()), &(bitCountTable.front()),
-                        &(lengthBitsTable_.front()), &(inBuf.front()),
-                        offs, nBytes);
+                        &(symbolCostTable.front()),
+                        &(lengthCostTable.front()), extraBitCost,
+                        &(inBuf.front()), offs, nBytes);
       }
     }
     for (size_t i = offs; i < endPos; ) {
@@ -773,13 +810,15 @@ namespace Plus4Compress {
     tmpBlock.isLastBlock = ((startPos + nBytes) >= inBuf.size());
     if (tmpBlock.isLastBlock)
       tmpBlock.nBytes = inBuf.size() - startPos;
+    // seed the random number generator used by optimizeMatches_RND() from
+    // the block position and size, so that the result does not depend on
+    // the order in which the blocks are compressed
+    lfsrState = (((unsigned int) tmpBlock.startPos * 0x9E3779B1U)
+                 ^ ((unsigned int) tmpBlock.nBytes << 12) ^ 0x12345678U)
+                | 1U;
     if (!compressData(tmpBlock.buf, inBuf, startAddr,
                       (tmpBlock.isLastBlock && isLastBlock),
                       tmpBlock.startPos, tmpBlock.nBytes)) {
-      delete searchTable;
-      searchTable = (DSearchTable *) 0;
-      if (progressDisplayEnabled)
-        progressMessage("");
       return false;
     }
     // calculate compressed size
@@ -788,6 +827,84 @@ namespace Plus4Compress {
     return true;
   }
 
+  bool Compressor_M0::compressBlockJob(void *userData, int threadNum, size_t n)
+  {
+    SplitOptimizationJobs&  jobs =
+        *(reinterpret_cast< SplitOptimizationJobs * >(userData));
+    Compressor_M0 *compressor = jobs.compressor;
+    if (threadNum > 0)
+      compressor = compressor->workerCompressors[threadNum - 1];
+    SplitOptimizationBlock& tmpBlock = (*(jobs.blocks))[n];
+    return compressor->compressBlock(tmpBlock, *(jobs.inBuf), jobs.startAddr,
+                                     tmpBlock.startPos, tmpBlock.nBytes,
+                                     jobs.isLastBlock);
+  }
+
+  bool Compressor_M0::compressBlocks(
+      std::vector< SplitOptimizationBlock >& tmpBlocks,
+      const std::vector< unsigned char >& inBuf,
+      unsigned int startAddr, bool isLastBlock)
+  {
+    bool    retval = true;
+    if (threadCnt <= 1 || tmpBlocks.size() <= 1) {
+      for (size_t i = 0; i < tmpBlocks.size() && retval; i++) {
+        retval = compressBlock(tmpBlocks[i], inBuf, startAddr,
+                               tmpBlocks[i].startPos, tmpBlocks[i].nBytes,
+                               isLastBlock);
+      }
+    }
+    else {
+      if (workerCompressors.size() < size_t(threadCnt - 1)) {
+        workerCompressors.reserve(size_t(threadCnt - 1));
+        do {
+          Compressor_M0 *compressor = createWorkerCompressor(workerOutBuf);
+          compressor->config = config;
+          compressor->decompressionSpeed = decompressionSpeed;
+          compressor->searchTable = searchTable;
+          workerCompressors.push_back(compressor);
+        } while (workerCompressors.size() < size_t(threadCnt - 1));
+      }
+      // only the first thread updates the progress display, so account for
+      // the blocks compressed by the other threads afterwards
+      size_t  savedProgressCnt = progressCnt;
+      SplitOptimizationJobs jobs;
+      jobs.compressor = this;
+      jobs.blocks = &tmpBlocks;
+      jobs.inBuf = &inBuf;
+      jobs.startAddr = startAddr;
+      jobs.isLastBlock = isLastBlock;
+      retval = runParallelJobs(&compressBlockJob, (void *) &jobs,
+                               tmpBlocks.size());
+      progressCnt = savedProgressCnt;
+      for (size_t i = 0; i < tmpBlocks.size(); i++)
+        progressCnt += (tmpBlocks[i].nBytes * config.optimizeIterations);
+    }
+    if (!retval) {
+      deleteWorkerCompressors();
+      delete searchTable;
+      searchTable = (DSearchTable *) 0;
+      if (progressDisplayEnabled)
+        progressMessage("");
+    }
+    return retval;
+  }
+
+  void Compressor_M0::deleteWorkerCompressors()
+  {
+    for (size_t i = 0; i < workerCompressors.size(); i++) {
+      // the search table is owned by this compressor
+      workerCompressors[i]->searchTable = (DSearchTable *) 0;
+      delete workerCompressors[i];
+    }
+    workerCompressors.clear();
+  }
+
+  Compressor_M0 * Compressor_M0::createWorkerCompressor(
+      std::vector< unsigned char >& outBuf_) const
+  {
+    return new Compressor_M0(outBuf_);
+  }
+
   void Compressor_M0::packOutputData(const std::vector< unsigned int >& tmpBuf,
                                      bool isLastBlock)
   {
@@ -909,6 +1026,7 @@ namespace Plus4Compress {
 
   Compressor_M0::~Compressor_M0()
   {
+    deleteWorkerCompressors();
     delete[] lengthCodeTable;
     delete[] lengthBitsTable;
     delete[] lengthValueTable;
@@ -988,10 +1106,12 @@ namespace Plus4Compress {
 #endif
         maxOffs = (maxOffs < inBuf.size() ? maxOffs : inBuf.size());
         searchTable = new DSearchTable(minLen, maxLen, maxOffs);
+        searchTable->setMatchFinderType(matchFinderType);
         searchTable->findMatches(&(inBuf.front()), inBuf.size());
       }
       std::list< SplitOptimizationBlock >   splitPositions;
       SplitOptimizationBlock  tmpBlock;
+      std::vector< SplitOptimizationBlock > tmpBlocks;
       size_t  maxBlockSize = 65535 + size_t(compType == 0);
       progressCnt = 0;
       progressMax = inBuf.size() * config.optimizeIterations;
@@ -1041,15 +1161,17 @@ namespace Plus4Compress {
           size_t  tmp = 0;
           for (size_t startPos = 0; startPos < inBuf.size(); ) {
             tmp = tmp + inBuf.size();
+            tmpBlock.startPos = startPos;
             tmpBlock.nBytes = tmp / splitCnt;
             tmp = tmp % splitCnt;
-            if (!compressBlock(tmpBlock, inBuf, startAddr,
-                               startPos, tmpBlock.nBytes, isLastBlock)) {
-              return false;
-            }
             startPos = startPos + tmpBlock.nBytes;
-            splitPositions.push_back(tmpBlock);
+            tmpBlocks.push_back(tmpBlock);
           }
+          if (!compressBlocks(tmpBlocks, inBuf, startAddr, isLastBlock))
+            return false;
+          for (size_t i = 0; i < tmpBlocks.size(); i++)
+            splitPositions.push_back(tmpBlocks[i]);
+          tmpBlocks.clear();
         }
         while (true) {
           bool    mergeFlag = false;
@@ -1079,14 +1201,45 @@ namespace Plus4Compress {
                 > progressMax) {
               progressMax = progressCnt + (nBytes * config.optimizeIterations);
             }
-            if (!compressBlock(tmpBlock, inBuf, startAddr,
-                               (*i_0).startPos, nBytes, isLastBlock)) {
-              return false;
+            size_t  jobNum = 0;
+            while (jobNum < tmpBlocks.size() &&
+                   !(tmpBlocks[jobNum].startPos == (*i_0).startPos &&
+                     tmpBlocks[jobNum].nBytes == nBytes)) {
+              jobNum++;
             }
-            if (tmpBlock.compressedSize
+            if (jobNum >= tmpBlocks.size()) {
+              // the merged block has not been compressed yet: compress it,
+              // and with multiple threads, also the next pairs of blocks
+              // in advance, assuming that they will not be merged with the
+              // previous one; the result is the same as if the pairs were
+              // tested one at a time
+              tmpBlocks.clear();
+              jobNum = 0;
+              std::list< SplitOptimizationBlock >::iterator j_0 = i_0;
+              do {
+                std::list< SplitOptimizationBlock >::iterator j_1 = j_0;
+                j_1++;
+                if (j_1 == splitPositions.end())
+                  break;
+                uint64_t  cacheKey_ = uint64_t((*j_0).startPos)
+                                      | (uint64_t((*j_1).startPos) << 20)
+                                      | (uint64_t((*j_1).nBytes) << 40);
+                if (((*j_0).nBytes + (*j_1).nBytes) <= maxBlockSize &&
+                    splitOptimizationCache.find(cacheKey_)
+                    == splitOptimizationCache.end()) {
+                  tmpBlock.startPos = (*j_0).startPos;
+                  tmpBlock.nBytes = (*j_0).nBytes + (*j_1).nBytes;
+                  tmpBlocks.push_back(tmpBlock);
+                }
+                j_0 = j_1;
+              } while (tmpBlocks.size() < size_t(threadCnt));
+              if (!compressBlocks(tmpBlocks, inBuf, startAddr, isLastBlock))
+                return false;
+            }
+            if (tmpBlocks[jobNum].compressedSize
                 <= ((*i_0).compressedSize + (*i_1).compressedSize)) {
               // splitting does not reduce size, so use merged block
-              (*i_0) = tmpBlock;
+              (*i_0) = tmpBlocks[jobNum];
               i_0 = splitPositions.erase(i_1);
               mergeFlag = true;
             }
@@ -1126,29 +1279,43 @@ namespace Plus4Compress {
         splitPositions_[nBlocks].nBytes = 0;
         splitPositions_[nBlocks].compressedSize = 0;
         splitPositions_[nBlocks].isLastBlock = true;
+        std::vector< size_t > blockSizes;
         for (size_t i = nBlocks; i-- > 0; ) {
           size_t  startPos = i * minBlockSize;
           splitPositions_[i].compressedSize = 0x7FFFFFFF;
+          // all block sizes starting at the same position can be tested
+          // in parallel
+          tmpBlocks.clear();
+          blockSizes.clear();
           for (size_t j = minBlockSize; j <= maxBlockSize; j += minBlockSize) {
             if ((startPos % j) != 0)
               continue;
-            if (!compressBlock(tmpBlock, inBuf, startAddr, startPos, j,
-                               isLastBlock)) {
-              return false;
-            }
-            tmpBlock.compressedSize +=
-                (splitPositions_[i + (j / minBlockSize)].compressedSize);
-            if (tmpBlock.compressedSize <= splitPositions_[i].compressedSize)
-              splitPositions_[i] = tmpBlock;
-            if (tmpBlock.isLastBlock)
+            tmpBlock.startPos = startPos;
+            tmpBlock.nBytes = j;
+            tmpBlocks.push_back(tmpBlock);
+            blockSizes.push_back(j);
+            if ((startPos + j) >= inBuf.size())
               break;
           }
+          if (!compressBlocks(tmpBlocks, inBuf, startAddr, isLastBlock))
+            return false;
+          for (size_t k = 0; k < tmpBlocks.size(); k++) {
+            size_t  j = blockSizes[k];
+            tmpBlocks[k].compressedSize +=
+                (splitPositions_[i + (j / minBlockSize)].compressedSize);
+            if (tmpBlocks[k].compressedSize
+                <= splitPositions_[i].compressedSize) {
+              splitPositions_[i] = tmpBlocks[k];
+            }
+          }
         }
         for (size_t i = 0; i < nBlocks; ) {
           splitPositions.push_back(splitPositions_[i]);
           i += ((splitPositions_[i].nBytes + minBlockSize - 1) / minBlockSize);
         }
       }
+      tmpBlocks.clear();
+      deleteWorkerCompressors();
       delete searchTable;
       searchTable = (DSearchTable *) 0;
       std::vector< unsigned int >   outBufTmp;
@@ -1168,6 +1335,7 @@ namespace Plus4Compress {
       packOutputData(outBufTmp, isLastBlock);
     }
     catch (...) {
+      deleteWorkerCompressors();
       if (searchTable) {
         delete searchTable;
         searchTable = (DSearchTable *) 0;
@@ -49,6 +49,8 @@ namespace Plus4Compress {
     static const size_t maxRepeatDist = 65536;
     static const size_t minRepeatLen = 2;
     static const size_t maxRepeatLen = 256;
+    // cost of one bit of compressed data in the optimal parse
+    static const long   bitCost = 128L;
    protected:
     class DSearchTable : public LZSearchTable {
      private:
@@ -102,6 +104,10 @@ namespace Plus4Compress {
       }
     };
     // --------
+    // 'totalBits' is the cost of encoding the data from the current position
+    // to the end of the block, in units of 1/128 bit; if the decompression
+    // speed weight is not zero, the estimated number of cycles needed by
+    // the SFX decompressor multiplied by the weight is also included
     struct BitCountTableEntry {
       long    totalBits;
       unsigned int  prvDistances[4];
@@ -113,6 +119,20 @@ namespace Plus4Compress {
       size_t  nBytes;
       size_t  compressedSize;
       bool    isLastBlock;
+      SplitOptimizationBlock()
+        : startPos(0),
+          nBytes(0),
+          compressedSize(0),
+          isLastBlock(false)
+      {
+      }
+    };
+    struct SplitOptimizationJobs {
+      Compressor_M0 *compressor;
+      std::vector< SplitOptimizationBlock > *blocks;
+      const std::vector< unsigned char >    *inBuf;
+      unsigned int  startAddr;
+      bool    isLastBlock;
     };
     // --------
     CompressionParameters config;
@@ -136,6 +156,10 @@ namespace Plus4Compress {
     unsigned int    *symbolCntTable2;
     unsigned int    *encodeTable1;
     unsigned int    *encodeTable2;
+    // compressors used by threads other than the first one when evaluating
+    // split positions in parallel, these share the search table
+    std::vector< Compressor_M0 * >  workerCompressors;
+    std::vector< unsigned char >    workerOutBuf;
     // --------
     static void huffmanCompatibilityHack(unsigned int *encodeTable,
                                          const unsigned int *symbolCnts,
@@ -156,13 +180,19 @@ namespace Plus4Compress {
    protected:
     PLUS4EMU_INLINE long rndBit();
    private:
+    // calculate the cost of symbols 0 to 0x0143 and of match lengths for
+    // optimizeMatches(), and return the cost of one additional (not Huffman
+    // encoded) bit
+    long calculateSymbolCosts(long *symbolCostTable, long *lengthCostTable);
     void optimizeMatches_RND(
         LZMatchParameters *matchTable, BitCountTableEntry *bitCountTable,
-        const size_t *lengthBitsTable_, const unsigned char *inBuf,
+        const long *symbolCostTable, const long *lengthCostTable,
+        long extraBitCost, const unsigned char *inBuf,
         size_t offs, size_t nBytes);
     void optimizeMatches(
         LZMatchParameters *matchTable, BitCountTableEntry *bitCountTable,
-        const size_t *lengthBitsTable_, const unsigned char *inBuf,
+        const long *symbolCostTable, const long *lengthCostTable,
+        long extraBitCost, const unsigned char *inBuf,
         size_t offs, size_t nBytes);
     void compressData_(std::vector< unsigned int >& tmpOutBuf,
                        const std::vector< unsigned char >& inBuf,
@@ -177,6 +207,17 @@ namespace Plus4Compress {
                        const std::vector< unsigned char >& inBuf,
                        unsigned int startAddr, size_t startPos, size_t nBytes,
                        bool isLastBlock);
+    static bool compressBlockJob(void *userData, int threadNum, size_t n);
+    // compress all blocks in 'tmpBlocks' (with 'startPos' and 'nBytes'
+    // already set), using multiple threads if enabled
+    bool compressBlocks(std::vector< SplitOptimizationBlock >& tmpBlocks,
+                        const std::vector< unsigned char >& inBuf,
+                        unsigned int startAddr, bool isLastBlock);
+    void deleteWorkerCompressors();
+   protected:
+    // create a compressor of the same type for use by a worker thread
+    virtual Compressor_M0 * createWorkerCompressor(
+        std::vector< unsigned char >& outBuf_) const;
    protected:
     virtual void packOutputData(const std::vector< unsigned int >& tmpBuf,
                                 bool isLastBlock);
@@ -124,6 +124,15 @@ namespace Plus4Compress {
       size_t  startPos;
       size_t  nBytes;
     };
+    struct SplitOptimizationJobs {
+      Compressor_M1 *compressor;
+      const std::vector< SplitOptimizationBlock > *blocks;
+      std::vector< std::vector< unsigned int > >  *outBufs;
+      const std::vector< unsigned char >  *inBuf;
+      unsigned int  startAddr;
+      bool    isLastBlock;
+      bool    fastMode;
+    };
     // --------
     CompressionParameters config;
     EncodeTable   lengthEncodeTable;
@@ -136,6 +145,10 @@ namespace Plus4Compress {
     size_t        savedOutBufPos;
     unsigned char outputShiftReg;
     int           outputBitCnt;
+    // compressors used by threads other than the first one when evaluating
+    // split positions in parallel, these share the search table
+    std::vector< Compressor_M1 * > workerCompressors;
+    std::vector< unsigned char >    workerOutBuf;
     // --------
     void writeRepeatCode(std::vector< unsigned int >& buf, size_t d, size_t n);
     inline size_t getRepeatCodeLength(size_t d, size_t n) const;
@@ -157,6 +170,16 @@ namespace Plus4Compress {
                       unsigned int startAddr, bool isLastBlock,
                       size_t offs = 0, size_t nBytes = 0x7FFFFFFFUL,
                       bool fastMode = false);
+    static bool compressBlockJob(void *userData, int threadNum, size_t n);
+    // compress all blocks in 'blocks' to 'outBufs', using multiple threads
+    // if enabled; 'isLastBlock' is applied to the block at the end of the
+    // input data only
+    bool compressBlocks(std::vector< std::vector< unsigned int > >& outBufs,
+                        const std::vector< SplitOptimizationBlock >& blocks,
+                        const std::vector< unsigned char >& inBuf,
+                        unsigned int startAddr, bool isLastBlock,
+                        bool fastMode);
+    void deleteWorkerCompressors();
    public:
     Compressor_M1(std::vector< unsigned char >& outBuf_);
     virtual ~Compressor_M1();
@@ -620,6 +620,81 @@ namespace Plus4Compress {
     return true;
   }
 
+  bool Compressor_M2::compressBlockJob(void *userData, int threadNum, size_t n)
+  {
+    SplitOptimizationJobs&  jobs =
+        *(reinterpret_cast< SplitOptimizationJobs * >(userData));
+    Compressor_M2 *compressor = jobs.compressor;
+    if (threadNum > 0)
+      compressor = compressor->workerCompressors[threadNum - 1];
+    const SplitOptimizationBlock& tmpBlock = (*(jobs.blocks))[n];
+    std::vector< unsigned int >&  tmpBuf = (*(jobs.outBufs))[n];
+    tmpBuf.clear();
+    return compressor->compressData(
+               tmpBuf, *(jobs.inBuf), jobs.startAddr,
+               (jobs.isLastBlock &&
+                (tmpBlock.startPos + tmpBlock.nBytes) >= jobs.inBuf->size()),
+               tmpBlock.startPos, tmpBlock.nBytes, jobs.fastMode);
+  }
+
+  bool Compressor_M2::compressBlocks(
+      std::vector< std::vector< unsigned int > >& outBufs,
+      const std::vector< SplitOptimizationBlock >& blocks,
+      const std::vector< unsigned char >& inBuf,
+      unsigned int startAddr, bool isLastBlock, bool fastMode)
+  {
+    outBufs.resize(blocks.size());
+    SplitOptimizationJobs jobs;
+    jobs.compressor = this;
+    jobs.blocks = &blocks;
+    jobs.outBufs = &outBufs;
+    jobs.inBuf = &inBuf;
+    jobs.startAddr = startAddr;
+    jobs.isLastBlock = isLastBlock;
+    jobs.fastMode = fastMode;
+    bool    retval = true;
+    if (threadCnt <= 1 || blocks.size() <= 1) {
+      for (size_t i = 0; i < blocks.size() && retval; i++)
+        retval = compressBlockJob((void *) &jobs, 0, i);
+    }
+    else {
+      if (workerCompressors.size() < size_t(threadCnt - 1)) {
+        workerCompressors.reserve(size_t(threadCnt - 1));
+        do {
+          Compressor_M2 *compressor = new Compressor_M2(workerOutBuf);
+          compressor->config = config;
+          compressor->searchTable = searchTable;
+          workerCompressors.push_back(compressor);
+        } while (workerCompressors.size() < size_t(threadCnt - 1));
+      }
+      // only the first thread updates the progress display, so account for
+      // the blocks compressed by the other threads afterwards
+      size_t  savedProgressCnt = progressCnt;
+      retval = runParallelJobs(&compressBlockJob, (void *) &jobs,
+                               blocks.size());
+      progressCnt =
+          savedProgressCnt + (blocks.size() * config.optimizeIterations);
+    }
+    if (!retval) {
+      deleteWorkerCompressors();
+      delete searchTable;
+      searchTable = (LZSearchTable *) 0;
+      if (progressDisplayEnabled)
+        progressMessage("");
+    }
+    return retval;
+  }
+
+  void Compressor_M2::deleteWorkerCompressors()
+  {
+    for (size_t i = 0; i < workerCompressors.size(); i++) {
+      // the search table is owned by this compressor
+      workerCompressors[i]->searchTable = (LZSearchTable *) 0;
+      delete workerCompressors[i];
+    }
+    workerCompressors.clear();
+  }
+
   // --------------------------------------------------------------------------
 
   Compressor_M2::Compressor_M2(std::vector< unsigned char >& outBuf_)
@@ -644,6 +719,7 @@ namespace Plus4Compress {
 
   Compressor_M2::~Compressor_M2()
   {
+    deleteWorkerCompressors();
     if (searchTable)
       delete searchTable;
   }
@@ -700,6 +776,7 @@ namespace Plus4Compress {
       searchTable =
           new LZSearchTable(minRepeatLen, maxRepeatLen, lengthMaxValue,
                             offs1MaxValue, offs2MaxValue, maxRepeatDist);
+      searchTable->setMatchFinderType(matchFinderType);
       searchTable->findMatches(&(inBuf.front()), 0, inBuf.size());
       // split large files to improve statistical compression
       std::list< SplitOptimizationBlock >   splitPositions;
@@ -724,13 +801,56 @@ namespace Plus4Compress {
             ((i + 1) * inBuf.size() / splitCnt) - tmpBlock.startPos;
         splitPositions.push_back(tmpBlock);
       }
+      std::vector< SplitOptimizationBlock > tmpBlocks;
+      std::vector< std::vector< unsigned int > >  tmpBufs;
       while (true) {
         size_t  bestMergePos = 0;
         long    bestMergeBits = 0x7FFFFFFFL;
-        // find the pair of blocks that reduce the total compressed size
-        // the most when merged
+        // compress all blocks that are not in the cache yet (these are
+        // independent, and can be compressed in parallel), and store the
+        // compressed sizes in the cache
+        tmpBlocks.clear();
         std::list< SplitOptimizationBlock >::iterator curBlock =
             splitPositions.begin();
+        while (curBlock != splitPositions.end()) {
+          std::list< SplitOptimizationBlock >::iterator nxtBlock = curBlock;
+          nxtBlock++;
+          if (nxtBlock == splitPositions.end())
+            break;
+          for (size_t i = 0; i < 3; i++) {
+            // i = 0: merged block, i = 1: first block, i = 2: second block
+            SplitOptimizationBlock  tmpBlock;
+            tmpBlock.startPos = (i < 2 ? *curBlock : *nxtBlock).startPos;
+            tmpBlock.nBytes = (i != 2 ? (*curBlock).nBytes : 0)
+                              + (i != 1 ? (*nxtBlock).nBytes : 0);
+            size_t    endPos = tmpBlock.startPos + tmpBlock.nBytes;
+            uint64_t  cacheKey = (uint64_t(tmpBlock.startPos) << 32)
+                                 | uint64_t(endPos);
+            if (splitOptimizationCache.find(cacheKey)
+                == splitOptimizationCache.end()) {
+              splitOptimizationCache[cacheKey] = 0;
+              tmpBlocks.push_back(tmpBlock);
+            }
+          }
+          curBlock++;
+        }
+        if (!compressBlocks(tmpBufs, tmpBlocks, inBuf, startAddr, false,
+                            true)) {
+          return false;
+        }
+        for (size_t i = 0; i < tmpBlocks.size(); i++) {
+          // calculate compressed size
+          size_t  nBits = 0;
+          for (size_t j = 0; j < tmpBufs[i].size(); j++)
+            nBits += size_t((tmpBufs[i][j] & 0x7F000000U) >> 24);
+          uint64_t  cacheKey = (uint64_t(tmpBlocks[i].startPos) << 32)
+                               | uint64_t(tmpBlocks[i].startPos
+                                          + tmpBlocks[i].nBytes);
+          splitOptimizationCache[cacheKey] = nBits;
+        }
+        // find the pair of blocks that reduce the total compressed size
+        // the most when merged
+        curBlock = splitPositions.begin();
         while (curBlock != splitPositions.end()) {
           std::list< SplitOptimizationBlock >::iterator nxtBlock = curBlock;
           nxtBlock++;
@@ -757,25 +877,6 @@ namespace Plus4Compress {
               break;
             }
             uint64_t  cacheKey = (uint64_t(startPos) << 32) | uint64_t(endPos);
-            if (splitOptimizationCache.find(cacheKey)
-                == splitOptimizationCache.end()) {
-              // if this block is not in the cache yet, compress it,
-              // and store the compressed size in the cache
-              std::vector< unsigned int > tmpBuf;
-              if (!compressData(tmpBuf, inBuf, startAddr, false,
-                                startPos, endPos - startPos, true)) {
-                delete searchTable;
-                searchTable = (LZSearchTable *) 0;
-                if (progressDisplayEnabled)
-                  progressMessage("");
-                return false;
-              }
-              // calculate compressed size
-              size_t  nBits = 0;
-              for (size_t j = 0; j < tmpBuf.size(); j++)
-                nBits += size_t((tmpBuf[j] & 0x7F000000U) >> 24);
-              splitOptimizationCache[cacheKey] = nBits;
-            }
             size_t  nBits = splitOptimizationCache[cacheKey];
             switch (i) {
             case 0:
@@ -817,24 +918,23 @@ namespace Plus4Compress {
         progressCnt = (tmp * progressPercentage) / (100 - progressPercentage);
         progressMax = progressCnt + tmp;
       }
-      std::vector< unsigned int >   outBufTmp;
+      tmpBlocks.clear();
       std::list< SplitOptimizationBlock >::iterator i_ = splitPositions.begin();
       while (i_ != splitPositions.end()) {
-        std::vector< unsigned int > tmpBuf;
-        if (!compressData(tmpBuf, inBuf, startAddr,
-                          (isLastBlock &&
-                           ((*i_).startPos + (*i_).nBytes) >= inBuf.size()),
-                          (*i_).startPos, (*i_).nBytes, false)) {
-          delete searchTable;
-          searchTable = (LZSearchTable *) 0;
-          if (progressDisplayEnabled)
-            progressMessage("");
-          return false;
-        }
-        for (size_t i = 0; i < tmpBuf.size(); i++)
-          outBufTmp.push_back(tmpBuf[i]);
+        tmpBlocks.push_back(*i_);
         i_++;
       }
+      if (!compressBlocks(tmpBufs, tmpBlocks, inBuf, startAddr, isLastBlock,
+                          false)) {
+        return false;
+      }
+      std::vector< unsigned int >   outBufTmp;
+      for (size_t i = 0; i < tmpBufs.size(); i++) {
+        for (size_t j = 0; j < tmpBufs[i].size(); j++)
+          outBufTmp.push_back(tmpBufs[i][j]);
+      }
+      tmpBufs.clear();
+      deleteWorkerCompressors();
       delete searchTable;
       searchTable = (LZSearchTable *) 0;
       if (progressDisplayEnabled) {
@@ -911,6 +1011,7 @@ namespace Plus4Compress {
       }
     }
     catch (...) {
+      deleteWorkerCompressors();
       if (searchTable) {
         delete searchTable;
         searchTable = (LZSearchTable *) 0;
@@ -279,6 +279,7 @@ namespace Plus4Compress {
       searchTable =
           new LZSearchTable(minRepeatLen, maxRepeatLen, lengthMaxValue,
                             0, 510, maxRepeatDist);
+      searchTable->setMatchFinderType(matchFinderType);
       searchTable->findMatches(&(inBufRev.front()), 0, nBytes);
       std::vector< unsigned int >   tmpBuf;
       compressData_(tmpBuf, inBufRev);
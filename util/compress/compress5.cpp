@@ -651,5 +651,11 @@ namespace Plus4Compress {
   {
   }
 
+  Compressor_M0 * Compressor_ZLib::createWorkerCompressor(
+      std::vector< unsigned char >& outBuf_) const
+  {
+    return new Compressor_ZLib(outBuf_);
+  }
+
 }       // namespace Plus4Compress
 
@@ -98,6 +98,8 @@ namespace Plus4Compress {
                               size_t offs = 0, size_t nBytes = 0x7FFFFFFFUL);
     virtual void packOutputData(const std::vector< unsigned int >& tmpBuf,
                                 bool isLastBlock);
+    virtual Compressor_M0 * createWorkerCompressor(
+        std::vector< unsigned char >& outBuf_) const;
    public:
     Compressor_ZLib(std::vector< unsigned char >& outBuf_);
     virtual ~Compressor_ZLib();
@@ -27,21 +27,26 @@
 
 namespace Plus4Compress {
 
-  unsigned int Decompressor_M0::readBits(size_t nBits)
+  PLUS4EMU_INLINE void Decompressor_M0::fillBitBuffer()
   {
-    unsigned int  retval = 0U;
-    for (size_t i = 0; i < nBits; i++) {
-      if (shiftRegisterCnt < 1) {
-        if (inputBufferPosition >= inputBufferSize)
-          throw Plus4Emu::Exception("unexpected end of compressed data");
-        shiftRegister = inputBuffer[inputBufferPosition];
-        shiftRegisterCnt = 8;
-        inputBufferPosition++;
-      }
-      retval = (retval << 1) | (unsigned int) ((shiftRegister >> 7) & 0x01);
-      shiftRegister = (shiftRegister & 0x7F) << 1;
-      shiftRegisterCnt--;
+    while (bitBufferCnt <= 56 && inputBufferPosition < inputBufferSize) {
+      bitBuffer |= (uint64_t(inputBuffer[inputBufferPosition])
+                    << (56 - bitBufferCnt));
+      bitBufferCnt += 8;
+      inputBufferPosition++;
     }
+  }
+
+  PLUS4EMU_INLINE unsigned int Decompressor_M0::readBits(size_t nBits)
+  {
+    if (PLUS4EMU_UNLIKELY(bitBufferCnt < int(nBits))) {
+      fillBitBuffer();
+      if (bitBufferCnt < int(nBits))
+        throw Plus4Emu::Exception("unexpected end of compressed data");
+    }
+    unsigned int  retval = (unsigned int) ((bitBuffer >> 1) >> (63 - nBits));
+    bitBuffer = bitBuffer << nBits;
+    bitBufferCnt = bitBufferCnt - int(nBits);
     return retval;
   }
 
@@ -68,7 +73,7 @@ namespace Plus4Compress {
     return retval;
   }
 
-  unsigned int Decompressor_M0::huffmanDecode(int huffTable)
+  unsigned int Decompressor_M0::huffmanDecode_(int huffTable)
   {
     if (huffTable == 0 && !usingHuffTable0)
       return readBits(9);
@@ -93,6 +98,23 @@ namespace Plus4Compress {
     return decodeTable[tmp];
   }
 
+  PLUS4EMU_INLINE unsigned int Decompressor_M0::huffmanDecode(int huffTable)
+  {
+    if (PLUS4EMU_UNLIKELY(bitBufferCnt < huffmanLookupBits))
+      fillBitBuffer();
+    unsigned int  tmp =
+        (huffTable == 0 ? huffmanLookupTable0 : huffmanLookupTable1)[
+            (unsigned int) (bitBuffer >> (64 - huffmanLookupBits))];
+    int     nBits = int(tmp & 15U);
+    // if Huffman coding is disabled, or the code is longer than
+    // huffmanLookupBits, or at the end of the input, use the slow decoder
+    if (PLUS4EMU_UNLIKELY(nBits < 1 || nBits > bitBufferCnt))
+      return huffmanDecode_(huffTable);
+    bitBuffer = bitBuffer << nBits;
+    bitBufferCnt = bitBufferCnt - nBits;
+    return (tmp >> 4);
+  }
+
   unsigned char Decompressor_M0::readDeltaValue()
   {
     unsigned char retval = (unsigned char) readBits(7);
@@ -127,14 +149,23 @@ namespace Plus4Compress {
       decodeTable[i] = 0xFFFFFFFFU;
       symbolsUsed[i] = false;
     }
+    unsigned int  *lookupTable =
+        (huffTable == 0 ? huffmanLookupTable0 : huffmanLookupTable1);
+    for (size_t i = 0; i < (size_t(1) << huffmanLookupBits); i++)
+      lookupTable[i] = 0U;
     size_t  tablePos = 0;
     bool    huffmanEnabled = bool(readBits(1));
     if (huffTable == 0)
       usingHuffTable0 = huffmanEnabled;
     else
       usingHuffTable1 = huffmanEnabled;
-    if (!huffmanEnabled)
-      return;                   // Huffman coding is disabled, nothing to do
+    if (!huffmanEnabled) {
+      // Huffman coding is disabled, symbols are stored as 9 or 5 bit values
+      unsigned int  nBits = (huffTable == 0 ? 9U : 5U);
+      for (unsigned int i = 0U; i < (1U << huffmanLookupBits); i++)
+        lookupTable[i] = ((i >> (huffmanLookupBits - nBits)) << 4) | nBits;
+      return;
+    }
     for (size_t i = 0; i < 16; i++) {
       size_t  cnt = gammaDecode() - 1U;
       if (cnt > nSymbols)
@@ -153,10 +184,34 @@ namespace Plus4Compress {
       symCntTable[i] = (unsigned int) cnt;
       offsetTable[i] = (unsigned int) tablePos;
     }
+    // fill lookup table with the canonical codes of up to huffmanLookupBits
+    // bits; if the code is over-subscribed, the shortest match is stored,
+    // as in huffmanDecode_()
+    unsigned int  firstCode = 0U;
+    tablePos = 0;
+    for (int len = 1; len <= huffmanLookupBits; len++) {
+      unsigned int  cnt = symCntTable[len - 1];
+      for (unsigned int i = 0U; i < cnt; i++) {
+        unsigned int  code = firstCode + i;
+        if (code >= (1U << len))
+          break;
+        unsigned int  n = code << (huffmanLookupBits - len);
+        unsigned int  nEntries = 1U << (huffmanLookupBits - len);
+        unsigned int  tmp =
+            (decodeTable[tablePos + i] << 4) | (unsigned int) len;
+        for (unsigned int j = 0U; j < nEntries; j++) {
+          if (!lookupTable[n + j])
+            lookupTable[n + j] = tmp;
+        }
+      }
+      firstCode = (firstCode + cnt) << 1;
+      tablePos = tablePos + cnt;
+    }
   }
 
-  bool Decompressor_M0::decompressDataBlock(std::vector< unsigned char >& buf,
-                                            std::vector< bool >& bytesUsed)
+  bool Decompressor_M0::decompressDataBlock(
+      std::vector< unsigned char >& buf,
+      std::vector< unsigned char >& bytesUsed)
   {
     unsigned int  startAddr = readBits(16);
     unsigned int  nBytes = (readBits(16) ^ 0xFFFFU) + 1U;
@@ -168,7 +223,7 @@ namespace Plus4Compress {
         if (startAddr > 0xFFFFU || bytesUsed[startAddr])
           throw Plus4Emu::Exception("error in compressed data");
         buf[startAddr] = (unsigned char) readBits(8);
-        bytesUsed[startAddr] = true;
+        bytesUsed[startAddr] = 1;
         startAddr++;
       }
       return isLastBlock;
@@ -187,7 +242,7 @@ namespace Plus4Compress {
         if (startAddr > 0xFFFFU || bytesUsed[startAddr])
           throw Plus4Emu::Exception("error in compressed data");
         buf[startAddr] = (unsigned char) tmp;
-        bytesUsed[startAddr] = true;
+        bytesUsed[startAddr] = 1;
         startAddr++;
         i++;
         continue;
@@ -221,19 +276,31 @@ namespace Plus4Compress {
       offs++;
       unsigned int  lzMatchReadAddr = (startAddr - offs) & 0xFFFFU;
       unsigned int  matchLength = readMatchLength();
+      // block should not end within a match, and all bytes to be written
+      // must be in the address space, and not written yet
+      if ((nBytes - i) < matchLength || (0x10000U - startAddr) < matchLength)
+        throw Plus4Emu::Exception("error in compressed data");
       for (unsigned int j = 0U; j < matchLength; j++) {
-        if (i >= nBytes)                // block should not end within a match
-          throw Plus4Emu::Exception("error in compressed data");
-        if (!bytesUsed[lzMatchReadAddr])    // byte does not exist yet
+        if (bytesUsed[startAddr + j])
           throw Plus4Emu::Exception("error in compressed data");
-        if (startAddr > 0xFFFFU || bytesUsed[startAddr])
+      }
+      // bytes read before the ones written by this match must exist
+      for (unsigned int j = 0U; j < matchLength && j < offs; j++) {
+        if (!bytesUsed[(lzMatchReadAddr + j) & 0xFFFFU])
           throw Plus4Emu::Exception("error in compressed data");
-        buf[startAddr] = (buf[lzMatchReadAddr] + deltaValue) & 0xFF;
-        bytesUsed[startAddr] = true;
-        startAddr++;
-        lzMatchReadAddr = (lzMatchReadAddr + 1U) & 0xFFFFU;
-        i++;
       }
+      if (deltaValue == 0x00 && offs <= startAddr) {
+        copyLZMatch(&(buf.front()) + startAddr, offs, matchLength);
+      }
+      else {
+        for (unsigned int j = 0U; j < matchLength; j++) {
+          buf[startAddr + j] = (buf[lzMatchReadAddr] + deltaValue) & 0xFF;
+          lzMatchReadAddr = (lzMatchReadAddr + 1U) & 0xFFFFU;
+        }
+      }
+      std::memset(&(bytesUsed.front()) + startAddr, 1, matchLength);
+      startAddr = startAddr + matchLength;
+      i = i + matchLength;
     }
     return isLastBlock;
   }
@@ -248,16 +315,19 @@ namespace Plus4Compress {
       huffmanSymCntTable1((unsigned int *) 0),
       huffmanOffsetTable1((unsigned int *) 0),
       huffmanDecodeTable1((unsigned int *) 0),
+      huffmanLookupTable0((unsigned int *) 0),
+      huffmanLookupTable1((unsigned int *) 0),
       usingHuffTable0(false),
       usingHuffTable1(false),
-      shiftRegister(0x00),
-      shiftRegisterCnt(0),
+      bitBuffer(0U),
+      bitBufferCnt(0),
       inputBuffer((unsigned char *) 0),
       inputBufferSize(0),
       inputBufferPosition(0),
       prvMatchOffsetsPos(0U)
   {
-    size_t  totalTableSize = 16 + 16 + 324 + 16 + 16 + 28;
+    size_t  totalTableSize = 16 + 16 + 324 + 16 + 16 + 28
+                             + (size_t(2) << huffmanLookupBits);
     huffmanSymCntTable0 = new unsigned int[totalTableSize];
     for (size_t i = 0; i < totalTableSize; i++)
       huffmanSymCntTable0[i] = 0U;
@@ -266,6 +336,8 @@ namespace Plus4Compress {
     huffmanSymCntTable1 = &(huffmanDecodeTable0[324]);
     huffmanOffsetTable1 = &(huffmanSymCntTable1[16]);
     huffmanDecodeTable1 = &(huffmanOffsetTable1[16]);
+    huffmanLookupTable0 = &(huffmanDecodeTable1[28]);
+    huffmanLookupTable1 = &(huffmanLookupTable0[1 << huffmanLookupBits]);
     for (size_t i = 0; i < 4; i++)
       prvMatchOffsets[i] = 0xFFFFFFFFU;
   }
@@ -298,29 +370,31 @@ namespace Plus4Compress {
       }
     }
     std::vector< unsigned char >  tmpBuf;
-    std::vector< bool > bytesUsed;
+    std::vector< unsigned char >  bytesUsed;
     tmpBuf.resize(65536);
     bytesUsed.resize(65536);
     bool    doneFlag = false;
     for (size_t i = 0; i < 1024; i++) {
       if (!startPosTable[i])
         continue;
-      for (size_t j = 0; j < 65536; j++) {
-        tmpBuf[j] = 0x00;
-        bytesUsed[j] = false;
-      }
+      // only the bytes marked as used are stored in the output,
+      // so tmpBuf does not need to be cleared
+      std::memset(&(bytesUsed.front()), 0, 65536);
       // if found a position where the checksum matches, try to decompress data
       inputBuffer = &(inBuf.front());
       inputBufferSize = inBuf.size();
       inputBufferPosition = i + 1;
-      shiftRegister = 0x00;
-      shiftRegisterCnt = 0;
+      bitBuffer = 0U;
+      bitBufferCnt = 0;
       try {
         while (!decompressDataBlock(tmpBuf, bytesUsed))
           ;
-        // on successful decompression, all input data must be consumed
-        if (!(inputBufferPosition >= inputBufferSize && shiftRegister == 0x00))
+        // on successful decompression, all input data must be consumed,
+        // and the unused bits of the last byte must be zero
+        if (!(inputBufferPosition >= inputBufferSize &&
+              bitBufferCnt < 8 && bitBuffer == 0U)) {
           throw Plus4Emu::Exception("error in compressed data");
+        }
         doneFlag = true;
       }
       catch (Plus4Emu::Exception) {
@@ -336,12 +410,13 @@ namespace Plus4Compress {
     for (size_t i = 0; i <= 65536; i++) {
       if (i >= 65536 || !bytesUsed[i]) {
         if (nBytes > 0) {
-          std::vector< unsigned char >  newBuf;
+          outBuf.resize(outBuf.size() + 1);
+          std::vector< unsigned char >& newBuf = outBuf.back();
+          newBuf.reserve(nBytes + 2);
           newBuf.push_back((unsigned char) (startPos & 0xFFU));
           newBuf.push_back((unsigned char) ((startPos >> 8) & 0xFFU));
-          for (size_t j = 0U; j < nBytes; j++)
-            newBuf.push_back(tmpBuf[startPos + j]);
-          outBuf.push_back(newBuf);
+          newBuf.insert(newBuf.end(), tmpBuf.begin() + startPos,
+                        tmpBuf.begin() + (startPos + nBytes));
         }
         startPos = (unsigned int) (i + 1);
         nBytes = 0;
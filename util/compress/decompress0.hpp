@@ -40,25 +40,34 @@ namespace Plus4Compress {
     unsigned int  *huffmanSymCntTable1;
     unsigned int  *huffmanOffsetTable1;
     unsigned int  *huffmanDecodeTable1;
+    // tables for decoding Huffman codes of up to 'huffmanLookupBits' bits
+    // in a single step, indexed with the next input bits; each entry is
+    // the decoded symbol * 16 + code length, or 0 for longer codes
+    unsigned int  *huffmanLookupTable0;
+    unsigned int  *huffmanLookupTable1;
     bool          usingHuffTable0;
     bool          usingHuffTable1;
-    unsigned char shiftRegister;
-    int           shiftRegisterCnt;
+    // input bits not used yet (MSB first)
+    uint64_t      bitBuffer;
+    int           bitBufferCnt;
     const unsigned char *inputBuffer;
     size_t        inputBufferSize;
     size_t        inputBufferPosition;
     unsigned int  prvMatchOffsets[4];
     unsigned int  prvMatchOffsetsPos;
+    static const int  huffmanLookupBits = 10;
     // --------
-    unsigned int readBits(size_t nBits);
+    PLUS4EMU_INLINE void fillBitBuffer();
+    PLUS4EMU_INLINE unsigned int readBits(size_t nBits);
     unsigned int readLZMatchParameterBits(unsigned char n);
     unsigned int gammaDecode();
-    unsigned int huffmanDecode(int huffTable);
+    unsigned int huffmanDecode_(int huffTable);
+    PLUS4EMU_INLINE unsigned int huffmanDecode(int huffTable);
     unsigned char readDeltaValue();
     unsigned int readMatchLength();
     void huffmanInit(int huffTable);
     bool decompressDataBlock(std::vector< unsigned char >& buf,
-                             std::vector< bool >& bytesUsed);
+                             std::vector< unsigned char >& bytesUsed);
    public:
     Decompressor_M0();
     virtual ~Decompressor_M0();
@@ -27,10 +27,28 @@
 
 namespace Plus4Compress {
 
+  PLUS4EMU_INLINE unsigned int Decompressor_M2::readBit()
+  {
+    if (PLUS4EMU_UNLIKELY(shiftRegisterCnt < 1)) {
+      if (inputBufferPosition >= inputBufferSize)
+        throw Plus4Emu::Exception("unexpected end of compressed data");
+      shiftRegister = inputBuffer[inputBufferPosition];
+      shiftRegisterCnt = 8;
+      inputBufferPosition++;
+    }
+    unsigned int  retval = (unsigned int) (shiftRegister >> 7);
+    shiftRegister = (shiftRegister & 0x7F) << 1;
+    shiftRegisterCnt--;
+    return retval;
+  }
+
   unsigned int Decompressor_M2::readBits(size_t nBits)
   {
+    // literal bytes are interleaved with the bit stream, so only the
+    // current byte can be buffered; read as many bits at once from it
+    // as possible
     unsigned int  retval = 0U;
-    for (size_t i = 0; i < nBits; i++) {
+    while (nBits > 0) {
       if (shiftRegisterCnt < 1) {
         if (inputBufferPosition >= inputBufferSize)
           throw Plus4Emu::Exception("unexpected end of compressed data");
@@ -38,9 +56,12 @@ namespace Plus4Compress {
         shiftRegisterCnt = 8;
         inputBufferPosition++;
       }
-      retval = (retval << 1) | (unsigned int) ((shiftRegister >> 7) & 0x01);
-      shiftRegister = (shiftRegister & 0x7F) << 1;
-      shiftRegisterCnt--;
+      int     n = (nBits < size_t(shiftRegisterCnt) ?
+                   int(nBits) : shiftRegisterCnt);
+      retval = (retval << n) | (unsigned int) (shiftRegister >> (8 - n));
+      shiftRegister = (unsigned char) ((unsigned int) shiftRegister << n);
+      shiftRegisterCnt = shiftRegisterCnt - n;
+      nBits = nBits - size_t(n);
     }
     return retval;
   }
@@ -58,7 +79,7 @@ namespace Plus4Compress {
   {
     unsigned int  slotNum = 0U;
     do {
-      if (readBits(1) == 0U)
+      if (readBit() == 0U)
         break;
       slotNum++;
     } while (slotNum < 9U);
@@ -104,8 +125,9 @@ namespace Plus4Compress {
     }
   }
 
-  bool Decompressor_M2::decompressDataBlock(std::vector< unsigned char >& buf,
-                                            std::vector< bool >& bytesUsed)
+  bool Decompressor_M2::decompressDataBlock(
+      std::vector< unsigned char >& buf,
+      std::vector< unsigned char >& bytesUsed)
   {
     unsigned int  startAddr = readBits(16);
     unsigned int  nSymbols = readBits(16) + 1U;
@@ -117,7 +139,7 @@ namespace Plus4Compress {
         if (startAddr > 0xFFFFU || bytesUsed[startAddr])
           throw Plus4Emu::Exception("error in compressed data");
         buf[startAddr] = readLiteralByte();
-        bytesUsed[startAddr] = true;
+        bytesUsed[startAddr] = 1;
         startAddr++;
       }
       return isLastBlock;
@@ -130,20 +152,25 @@ namespace Plus4Compress {
         if (startAddr > 0xFFFFU || bytesUsed[startAddr])
           throw Plus4Emu::Exception("error in compressed data");
         buf[startAddr] = readLiteralByte();
-        bytesUsed[startAddr] = true;
+        bytesUsed[startAddr] = 1;
         startAddr++;
       }
       else if (matchLength >= 0x80000000U) {
         // literal sequence
         matchLength &= 0x7FFFFFFFU;
-        while (matchLength > 0U) {
-          if (startAddr > 0xFFFFU || bytesUsed[startAddr])
+        if ((0x10000U - startAddr) < matchLength)
+          throw Plus4Emu::Exception("error in compressed data");
+        for (unsigned int j = 0U; j < matchLength; j++) {
+          if (bytesUsed[startAddr + j])
             throw Plus4Emu::Exception("error in compressed data");
-          buf[startAddr] = readLiteralByte();
-          bytesUsed[startAddr] = true;
-          startAddr++;
-          matchLength--;
         }
+        if ((inputBufferSize - inputBufferPosition) < matchLength)
+          throw Plus4Emu::Exception("unexpected end of compressed data");
+        std::memcpy(&(buf.front()) + startAddr,
+                    inputBuffer + inputBufferPosition, matchLength);
+        std::memset(&(bytesUsed.front()) + startAddr, 1, matchLength);
+        inputBufferPosition = inputBufferPosition + matchLength;
+        startAddr = startAddr + matchLength;
       }
       else {
         if (matchLength > 65535U)
@@ -168,17 +195,23 @@ namespace Plus4Compress {
         if (offs >= 0xFFFFU || offs >= startAddr)
           throw Plus4Emu::Exception("error in compressed data");
         offs++;
-        unsigned int  lzMatchReadAddr = (startAddr - offs) & 0xFFFFU;
+        unsigned int  lzMatchReadAddr = startAddr - offs;
+        // all bytes to be written must be in the address space, and not
+        // written yet, and the bytes read before the ones written by this
+        // match must exist
+        if ((0x10000U - startAddr) < matchLength)
+          throw Plus4Emu::Exception("error in compressed data");
         for (unsigned int j = 0U; j < matchLength; j++) {
-          if (!bytesUsed[lzMatchReadAddr])  // byte does not exist yet
+          if (bytesUsed[startAddr + j])
             throw Plus4Emu::Exception("error in compressed data");
-          if (startAddr > 0xFFFFU || bytesUsed[startAddr])
+        }
+        for (unsigned int j = 0U; j < matchLength && j < offs; j++) {
+          if (!bytesUsed[lzMatchReadAddr + j])
             throw Plus4Emu::Exception("error in compressed data");
-          buf[startAddr] = buf[lzMatchReadAddr];
-          bytesUsed[startAddr] = true;
-          startAddr++;
-          lzMatchReadAddr = (lzMatchReadAddr + 1U) & 0xFFFFU;
         }
+        copyLZMatch(&(buf.front()) + startAddr, offs, matchLength);
+        std::memset(&(bytesUsed.front()) + startAddr, 1, matchLength);
+        startAddr = startAddr + matchLength;
       }
     }
     return isLastBlock;
@@ -224,17 +257,16 @@ namespace Plus4Compress {
       }
     }
     std::vector< unsigned char >  tmpBuf;
-    std::vector< bool > bytesUsed;
+    std::vector< unsigned char >  bytesUsed;
     tmpBuf.resize(65536);
     bytesUsed.resize(65536);
     bool    doneFlag = false;
     for (size_t i = 0; i < 1024; i++) {
       if (!startPosTable[i])
         continue;
-      for (size_t j = 0; j < 65536; j++) {
-        tmpBuf[j] = 0x00;
-        bytesUsed[j] = false;
-      }
+      // only the bytes marked as used are stored in the output,
+      // so tmpBuf does not need to be cleared
+      std::memset(&(bytesUsed.front()), 0, 65536);
       // if found a position where the checksum matches, try to decompress data
       inputBuffer = &(inBuf.front());
       inputBufferSize = inBuf.size();
@@ -262,12 +294,13 @@ namespace Plus4Compress {
     for (size_t i = 0; i <= 65536; i++) {
       if (i >= 65536 || !bytesUsed[i]) {
         if (nBytes > 0) {
-          std::vector< unsigned char >  newBuf;
+          outBuf.resize(outBuf.size() + 1);
+          std::vector< unsigned char >& newBuf = outBuf.back();
+          newBuf.reserve(nBytes + 2);
           newBuf.push_back((unsigned char) (startPos & 0xFFU));
           newBuf.push_back((unsigned char) ((startPos >> 8) & 0xFFU));
-          for (size_t j = 0U; j < nBytes; j++)
-            newBuf.push_back(tmpBuf[startPos + j]);
-          outBuf.push_back(newBuf);
+          newBuf.insert(newBuf.end(), tmpBuf.begin() + startPos,
+                        tmpBuf.begin() + (startPos + nBytes));
         }
         startPos = (unsigned int) (i + 1);
         nBytes = 0;
@@ -43,6 +43,7 @@ namespace Plus4Compress {
     size_t        inputBufferSize;
     size_t        inputBufferPosition;
     // --------
+    PLUS4EMU_INLINE unsigned int readBit();
     unsigned int readBits(size_t nBits);
     unsigned char readLiteralByte();
     // returns LZ match length (1..65535), or zero for literal byte,
@@ -52,7 +53,7 @@ namespace Plus4Compress {
                                       const unsigned int *decodeTable);
     void readDecodeTables();
     bool decompressDataBlock(std::vector< unsigned char >& buf,
-                             std::vector< bool >& bytesUsed);
+                             std::vector< unsigned char >& bytesUsed);
    public:
     Decompressor_M2();
     virtual ~Decompressor_M2();
@@ -116,8 +116,7 @@ namespace Plus4Compress {
     }
     if (uncompressedSize == compressedSize) {
       // uncompressed data
-      for (size_t i = 0; i < compressedSize; i++)
-        outBuf.push_back(inBuf[i + 2]);
+      outBuf.assign(inBuf.begin() + 2, inBuf.begin() + (compressedSize + 2));
       return;
     }
     std::vector< unsigned char >  tmpOutBuf(uncompressedSize);
@@ -132,9 +131,14 @@ namespace Plus4Compress {
         throw Plus4Emu::Exception("Decompressor_M3::decompressData(): "
                                   "error in compressed data");
       }
+      if (size_t(n) > inBufPos) {
+        throw Plus4Emu::Exception("Decompressor_M3::readByte(): "
+                                  "unexpected end of input data");
+      }
       for (unsigned int i = 0U; i < n; i++) {
         outBufPos--;
-        tmpOutBuf[outBufPos] = readByte();
+        inBufPos--;
+        tmpOutBuf[outBufPos] = inBufPtr[inBufPos];
       }
       if (outBufPos < 1)
         break;
@@ -152,10 +156,18 @@ namespace Plus4Compress {
           throw Plus4Emu::Exception("Decompressor_M3::decompressData(): "
                                     "error in compressed data");
         }
-        // copy LZ77 match
-        for (unsigned int i = 0U; i < n; i++) {
-          outBufPos--;
-          tmpOutBuf[outBufPos] = tmpOutBuf[outBufPos + size_t(d)];
+        // copy LZ77 match (backwards, from higher addresses)
+        outBufPos = outBufPos - size_t(n);
+        if (size_t(d) >= size_t(n)) {
+          std::memcpy(&(tmpOutBuf.front()) + outBufPos,
+                      &(tmpOutBuf.front()) + (outBufPos + size_t(d)),
+                      size_t(n));
+        }
+        else {
+          for (unsigned int i = n; i-- > 0U; ) {
+            tmpOutBuf[outBufPos + i] =
+                tmpOutBuf[outBufPos + i + size_t(d)];
+          }
         }
         if (outBufPos < 1)
           break;
@@ -171,8 +183,7 @@ namespace Plus4Compress {
       throw Plus4Emu::Exception("Decompressor_M3::decompressData(): "
                                 "error in compressed data");
     }
-    for (size_t i = 0; i < uncompressedSize; i++)
-      outBuf.push_back(tmpOutBuf[i]);
+    outBuf.swap(tmpOutBuf);
   }
 
 }       // namespace Plus4Compress
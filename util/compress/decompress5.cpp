@@ -35,44 +35,48 @@ namespace Plus4Compress {
 
   // --------------------------------------------------------------------------
 
+  PLUS4EMU_INLINE void Decompressor_ZLib::fillBitBuffer()
+  {
+    while (bitBufferCnt <= 56 && inputBufferPosition < inputBufferSize) {
+      bitBuffer |=
+          (uint64_t(inputBuffer[inputBufferPosition]) << bitBufferCnt);
+      bitBufferCnt += 8;
+      inputBufferPosition++;
+    }
+  }
+
+  void Decompressor_ZLib::alignToByte()
+  {
+    // discard the remaining bits of the current byte, and return any
+    // complete bytes in the bit buffer to the input
+    inputBufferPosition -= size_t(bitBufferCnt >> 3);
+    bitBuffer = 0U;
+    bitBufferCnt = 0;
+  }
+
   unsigned int Decompressor_ZLib::readByte()
   {
     if (inputBufferPosition >= inputBufferSize)
       throw Plus4Emu::Exception("unexpected end of compressed data");
-    shiftRegister = inputBuffer[inputBufferPosition];
-    shiftRegisterCnt = 8;
+    unsigned int  retval = inputBuffer[inputBufferPosition];
     inputBufferPosition++;
-    return (unsigned int) shiftRegister;
-  }
-
-  PLUS4EMU_INLINE unsigned int Decompressor_ZLib::readBit()
-  {
-    unsigned int  retval = (unsigned int) (shiftRegister & 0x01);
-    if (PLUS4EMU_UNLIKELY(shiftRegisterCnt < 1))
-      retval = readByte() & 1U;
-    shiftRegister = shiftRegister >> 1;
-    shiftRegisterCnt--;
     return retval;
   }
 
-  unsigned int Decompressor_ZLib::readBits(size_t nBits)
+  PLUS4EMU_INLINE unsigned int Decompressor_ZLib::readBits(size_t nBits)
   {
-    unsigned int  retval = 0U;
-    for (unsigned char i = 0; i < (unsigned char) nBits; ) {
-      if (PLUS4EMU_UNLIKELY(shiftRegisterCnt < 1))
-        (void) readByte();
-      unsigned char n = (unsigned char) nBits - i;
-      if (n > (unsigned char) shiftRegisterCnt)
-        n = (unsigned char) shiftRegisterCnt;
-      retval |= (((unsigned int) shiftRegister & ((1U << n) - 1U)) << i);
-      shiftRegister = shiftRegister >> n;
-      shiftRegisterCnt = shiftRegisterCnt - n;
-      i = i + n;
+    if (PLUS4EMU_UNLIKELY(bitBufferCnt < int(nBits))) {
+      fillBitBuffer();
+      if (bitBufferCnt < int(nBits))
+        throw Plus4Emu::Exception("unexpected end of compressed data");
     }
+    unsigned int  retval = (unsigned int) bitBuffer & ((1U << nBits) - 1U);
+    bitBuffer = bitBuffer >> nBits;
+    bitBufferCnt = bitBufferCnt - int(nBits);
     return retval;
   }
 
-  unsigned int Decompressor_ZLib::huffmanDecode(int huffTable)
+  unsigned int Decompressor_ZLib::huffmanDecode_(int huffTable)
   {
     int     tmp = 0;
     int     cnt = -1;
@@ -85,7 +89,7 @@ namespace Plus4Compress {
     do {
       if (++cnt >= 15)
         throw Plus4Emu::Exception("error in compressed data");
-      tmp = ((tmp << 1) | int(readBit())) - int(symCntTable[cnt]);
+      tmp = ((tmp << 1) | int(readBits(1))) - int(symCntTable[cnt]);
     } while (tmp >= 0);
     tmp = tmp + int(offsetTable[cnt]);
     if (decodeTable[tmp] == 0xFFFFFFFFU)
@@ -93,6 +97,21 @@ namespace Plus4Compress {
     return decodeTable[tmp];
   }
 
+  PLUS4EMU_INLINE unsigned int Decompressor_ZLib::huffmanDecode(int huffTable)
+  {
+    if (PLUS4EMU_UNLIKELY(bitBufferCnt < huffmanLookupBits))
+      fillBitBuffer();
+    unsigned int  tmp =
+        (huffTable == 0 ? huffmanLookupTable0 : huffmanLookupTable1)[
+            (unsigned int) bitBuffer & ((1U << huffmanLookupBits) - 1U)];
+    int     nBits = int(tmp & 15U);
+    if (PLUS4EMU_UNLIKELY(nBits < 1 || nBits > bitBufferCnt))
+      return huffmanDecode_(huffTable);         // long code or end of data
+    bitBuffer = bitBuffer >> nBits;
+    bitBufferCnt = bitBufferCnt - nBits;
+    return (tmp >> 4);
+  }
+
   void Decompressor_ZLib::buildDecodeTable(int huffTable,
                                            const unsigned char *lenBuf,
                                            size_t nSymbols)
@@ -126,6 +145,34 @@ namespace Plus4Compress {
         offsetTable[len] = offs + 1U;
       }
     }
+    // fill lookup table with the canonical codes of up to huffmanLookupBits
+    // bits; if the code is over-subscribed, the shortest match is stored,
+    // as in huffmanDecode_()
+    unsigned int  *lookupTable =
+        (huffTable == 0 ? huffmanLookupTable0 : huffmanLookupTable1);
+    for (size_t i = 0; i < (size_t(1) << huffmanLookupBits); i++)
+      lookupTable[i] = 0U;
+    unsigned int  firstCode = 0U;
+    unsigned int  offs = 0U;
+    for (int len = 1; len <= huffmanLookupBits; len++) {
+      unsigned int  cnt = symCntTable[len - 1];
+      for (unsigned int i = 0U; i < cnt; i++) {
+        unsigned int  code = firstCode + i;
+        if (code >= (1U << len))
+          break;
+        // the first bit of the code is read from the LSB of the input
+        unsigned int  n = 0U;
+        for (int j = 0; j < len; j++)
+          n = (n << 1) | ((code >> j) & 1U);
+        unsigned int  tmp = (decodeTable[offs + i] << 4) | (unsigned int) len;
+        for ( ; n < (1U << huffmanLookupBits); n = n + (1U << len)) {
+          if (!lookupTable[n])
+            lookupTable[n] = tmp;
+        }
+      }
+      firstCode = (firstCode + cnt) << 1;
+      offs = offs + cnt;
+    }
   }
 
   void Decompressor_ZLib::huffmanInit(unsigned char blockType)
@@ -190,7 +237,7 @@ namespace Plus4Compress {
   bool Decompressor_ZLib::decompressDataBlock(std::vector< unsigned char >& buf)
   {
     static const size_t maxDataSize = 0x04000000;
-    bool    isLastBlock = bool(readBit());
+    bool    isLastBlock = bool(readBits(1));
     unsigned char blockType = (unsigned char) readBits(2);
     if (blockType == 3)
       throw Plus4Emu::Exception("error in compressed data");
@@ -198,17 +245,21 @@ namespace Plus4Compress {
       buf.reserve(((buf.size() + (buf.size() >> 2)) | 0xFFFF) + 1);
     if (!blockType) {
       // uncompressed data
-      shiftRegisterCnt = 0;
-      unsigned int  blockSize = readBits(32);
+      alignToByte();
+      unsigned int  blockSize = readByte();
+      blockSize = blockSize | (readByte() << 8);
+      blockSize = blockSize | (readByte() << 16);
+      blockSize = blockSize | (readByte() << 24);
       blockSize = blockSize ^ ((~blockSize & 0xFFFFU) << 16);
       if (!(blockSize >= 1U && blockSize <= 0xFFFFU))
         throw Plus4Emu::Exception("error in compressed data");
-      do {
-        if (PLUS4EMU_UNLIKELY(buf.size() >= maxDataSize))
-          throw Plus4Emu::Exception("error in compressed data");
-        buf.push_back((unsigned char) readByte());
-      } while (--blockSize);
-      shiftRegisterCnt = 0;
+      if ((buf.size() + size_t(blockSize)) > maxDataSize)
+        throw Plus4Emu::Exception("error in compressed data");
+      if ((inputBufferPosition + size_t(blockSize)) > inputBufferSize)
+        throw Plus4Emu::Exception("unexpected end of compressed data");
+      buf.insert(buf.end(), inputBuffer + inputBufferPosition,
+                 inputBuffer + (inputBufferPosition + size_t(blockSize)));
+      inputBufferPosition = inputBufferPosition + size_t(blockSize);
       return isLastBlock;
     }
     huffmanInit(blockType);
@@ -267,9 +318,9 @@ namespace Plus4Compress {
       prvDistance = d;
       if (PLUS4EMU_UNLIKELY((buf.size() + size_t(len)) > maxDataSize))
         throw Plus4Emu::Exception("error in compressed data");
-      do {
-        buf.push_back(buf[buf.size() - size_t(d)]);
-      } while (--len);
+      size_t  writePos = buf.size();
+      buf.resize(writePos + size_t(len));
+      copyLZMatch(&(buf.front()) + writePos, size_t(d), size_t(len));
     }
     return isLastBlock;
   }
@@ -284,13 +335,16 @@ namespace Plus4Compress {
       huffmanSymCntTable1((unsigned int *) 0),
       huffmanOffsetTable1((unsigned int *) 0),
       huffmanDecodeTable1((unsigned int *) 0),
-      shiftRegister(0x00),
-      shiftRegisterCnt(0),
+      huffmanLookupTable0((unsigned int *) 0),
+      huffmanLookupTable1((unsigned int *) 0),
+      bitBuffer(0U),
+      bitBufferCnt(0),
       inputBuffer((unsigned char *) 0),
       inputBufferSize(0),
       inputBufferPosition(0)
   {
-    size_t  totalTableSize = 15 + 15 + 288 + 15 + 15 + 32;
+    size_t  totalTableSize = 15 + 15 + 288 + 15 + 15 + 32
+                             + (size_t(2) << huffmanLookupBits);
     huffmanSymCntTable0 = new unsigned int[totalTableSize];
     for (size_t i = 0; i < totalTableSize; i++)
       huffmanSymCntTable0[i] = 0U;
@@ -299,6 +353,8 @@ namespace Plus4Compress {
     huffmanSymCntTable1 = &(huffmanDecodeTable0[288]);
     huffmanOffsetTable1 = &(huffmanSymCntTable1[15]);
     huffmanDecodeTable1 = &(huffmanOffsetTable1[15]);
+    huffmanLookupTable0 = &(huffmanDecodeTable1[32]);
+    huffmanLookupTable1 = &(huffmanLookupTable0[1 << huffmanLookupBits]);
   }
 
   Decompressor_ZLib::~Decompressor_ZLib()
@@ -349,11 +405,12 @@ namespace Plus4Compress {
         throw Plus4Emu::Exception("error in compressed data");
       }
     }
-    shiftRegister = 0x00;
-    shiftRegisterCnt = 0;
+    bitBuffer = 0U;
+    bitBufferCnt = 0;
     // decompress all data blocks
     while (!decompressDataBlock(outBuf))
       ;
+    alignToByte();
     // verify Adler-32 checksum
     unsigned int  adler32Sum = (readByte() << 24) | (readByte() << 16)
                                | (readByte() << 8) | readByte();
@@ -35,16 +35,25 @@ namespace Plus4Compress {
     unsigned int  *huffmanSymCntTable1;
     unsigned int  *huffmanOffsetTable1;
     unsigned int  *huffmanDecodeTable1;
-    unsigned char shiftRegister;
-    int           shiftRegisterCnt;
+    // tables for decoding Huffman codes of up to 'huffmanLookupBits' bits
+    // in a single step, indexed with the next input bits; each entry is
+    // the decoded symbol * 16 + code length, or 0 for longer codes
+    unsigned int  *huffmanLookupTable0;
+    unsigned int  *huffmanLookupTable1;
+    // input bits not used yet (LSB first)
+    uint64_t      bitBuffer;
+    int           bitBufferCnt;
     const unsigned char *inputBuffer;
     size_t        inputBufferSize;
     size_t        inputBufferPosition;
+    static const int  huffmanLookupBits = 10;
     // --------
+    PLUS4EMU_INLINE void fillBitBuffer();
+    void alignToByte();
     unsigned int readByte();
-    PLUS4EMU_INLINE unsigned int readBit();
-    unsigned int readBits(size_t nBits);
-    unsigned int huffmanDecode(int huffTable);
+    PLUS4EMU_INLINE unsigned int readBits(size_t nBits);
+    unsigned int huffmanDecode_(int huffTable);
+    PLUS4EMU_INLINE unsigned int huffmanDecode(int huffTable);
     void buildDecodeTable(int huffTable,
                           const unsigned char *lenBuf, size_t nSymbols);
     void huffmanInit(unsigned char blockType);
@@ -17,8 +17,10 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "plus4emu.hpp"
+#include "system.hpp"
 #include "compress.hpp"
 
+#include <algorithm>
 #include <vector>
 
 // compression type (0, 1, 2, 3 or 5, or -1 to use default or auto-detect)
@@ -27,8 +29,16 @@ static int    compressionType = -1;
 static bool   extractMode = false;
 // test compressed file(s)
 static bool   testMode = false;
+// measure compression ratio and speed on the input file(s)
+static bool   benchmarkMode = false;
 // compression level (1: fast, low compression ... 10: slow, high compression)
 static int    compressionLevel = 5;
+// number of threads to be used for compression (-m0, -m1, -m2 and -mz only)
+static int    threadCnt = 1;
+// use suffix array instead of radix tree for finding matches
+static bool   suffixArrayMatchFinder = false;
+// weight of the estimated decompression time on the Plus/4 (0 to 32, -m0 only)
+static int    decompressionSpeed = 0;
 // use all RAM (up to $4000) on the C16
 static bool   c16Mode = false;
 // do not verify checksum in self-extracting module
@@ -189,6 +199,106 @@ static void readInputFile(std::vector< unsigned char >& buf,
     buf.resize(lengthLimit);
 }
 
+// compress all input files (as raw data, using at most 61439 bytes from each)
+// with the selected method(s) and level(s), and print the compression ratio,
+// and the compression and decompression speed in MB/s; the decompressed data
+// is verified against the input
+
+static void runBenchmark(const std::vector< std::string >& fileNames,
+                         const std::vector< int >& fileOffsets,
+                         const std::vector< int >& fileLengths,
+                         bool compressionLevelSet)
+{
+  static const int  compressionTypes[5] = { 0, 1, 2, 3, 5 };
+  std::vector< std::vector< unsigned char > > inBufs;
+  size_t  totalSize = 0;
+  noPRGMode = true;
+  for (size_t i = 0; i < fileNames.size(); i++) {
+    inBufs.resize(inBufs.size() + 1);
+    unsigned int  startAddr = 0U;
+    size_t  lengthLimit = size_t(fileLengths[i]);
+    if (lengthLimit > 0xEFFF)
+      lengthLimit = 0xEFFF;             // load address is $1001
+    readInputFile(inBufs.back(), startAddr, fileNames[i].c_str(),
+                  size_t(fileOffsets[i]), lengthLimit);
+    if (inBufs.back().size() < 1)
+      inBufs.pop_back();
+    else
+      totalSize += inBufs.back().size();
+  }
+  if (inBufs.size() < 1)
+    throw Plus4Emu::Exception("no input data to compress");
+  std::printf("%lu files, %lu bytes\n",
+              (unsigned long) inBufs.size(), (unsigned long) totalSize);
+  std::vector< unsigned char >  outBuf;
+  std::vector< std::vector< unsigned char > > compressedData(inBufs.size());
+  std::vector< std::vector< unsigned char > > tmpBufs;
+  for (int i = 0; i < 5; i++) {
+    int     method = compressionTypes[i];
+    if (compressionType >= 0 && method != compressionType)
+      continue;
+    for (int level = 1; level <= 9; level++) {
+      if (compressionLevelSet)
+        level = compressionLevel;
+      // compress all files
+      size_t  compressedSize = 0;
+      Plus4Emu::Timer timer;
+      for (size_t j = 0; j < inBufs.size(); j++) {
+        outBuf.clear();
+        Plus4Compress::Compressor *compress =
+            Plus4Compress::createCompressor(method, outBuf);
+        try {
+          compress->setThreadCount(threadCnt);
+          compress->setMatchFinderType(suffixArrayMatchFinder ? 1 : 0);
+          compress->setDecompressionSpeed(decompressionSpeed);
+          compress->setCompressionLevel(level);
+          compress->compressData(inBufs[j], (method < 3 ? 0x1001U : 0U),
+                                 true, false);
+        }
+        catch (...) {
+          delete compress;
+          throw;
+        }
+        delete compress;
+        compressedData[j] = outBuf;
+        compressedSize += outBuf.size();
+      }
+      double  compressTime = timer.getRealTime();
+      // decompress and verify all files, repeat for at least 0.5 seconds
+      size_t  nRepeats = 0;
+      timer.reset();
+      double  decompressTime = 0.0;
+      do {
+        for (size_t j = 0; j < inBufs.size(); j++) {
+          Plus4Compress::decompressData(tmpBufs, compressedData[j], method);
+          if (nRepeats == 0) {
+            if (tmpBufs.size() != 1 ||
+                tmpBufs[0].size() != (inBufs[j].size() + 2) ||
+                !std::equal(inBufs[j].begin(), inBufs[j].end(),
+                            tmpBufs[0].begin() + 2)) {
+              throw Plus4Emu::Exception("decompressed data does not match "
+                                        "the input");
+            }
+          }
+        }
+        nRepeats++;
+        decompressTime = timer.getRealTime();
+      } while (decompressTime < 0.5);
+      double  s = double(long(totalSize)) / 1048576.0;
+      std::printf("-m%d -%d: %8lu bytes (%6.2f%%), compress: %7.3f MB/s, "
+                  "decompress: %7.2f MB/s\n",
+                  method, level, (unsigned long) compressedSize,
+                  double(long(compressedSize)) * 100.0
+                  / double(long(totalSize)),
+                  s / (compressTime > 0.000001 ? compressTime : 0.000001),
+                  s * double(long(nRepeats)) / decompressTime);
+      std::fflush(stdout);
+      if (compressionLevelSet)
+        break;
+    }
+  }
+}
+
 int main(int argc, char **argv)
 {
   const char  *programName = argv[0];
@@ -213,6 +323,7 @@ int main(int argc, char **argv)
   loadAddresses.push_back(-1);
   bool    printUsageFlag = false;
   bool    helpFlag = false;
+  bool    compressionLevelSet = false;
   bool    endOfOptions = false;
   std::FILE *f = (std::FILE *) 0;
   Plus4Compress::Compressor *compress = (Plus4Compress::Compressor *) 0;
@@ -250,6 +361,9 @@ int main(int argc, char **argv)
         testMode = true;
         extractMode = false;
       }
+      else if (tmp == "-bench") {
+        benchmarkMode = true;
+      }
       else if (tmp.length() == 3 &&
                (tmp[1] == 'm' && (tmp[2] >= '0' && tmp[2] <= '5'))) {
         compressionType = int(tmp[2] - '0');
@@ -268,9 +382,30 @@ int main(int argc, char **argv)
       }
       else if (tmp.length() == 2 && (tmp[1] >= '1' && tmp[1] <= '9')) {
         compressionLevel = int(tmp[1] - '0');
+        compressionLevelSet = true;
       }
       else if (tmp == "-X") {
         compressionLevel = 10;
+        compressionLevelSet = true;
+      }
+      else if (tmp == "-j") {
+        if (++i >= argc) {
+          printUsageFlag = true;
+          throw Plus4Emu::Exception("missing argument for '-j'");
+        }
+        int     n = int(convertStringToInteger(argv[i]));
+        threadCnt = (n > 1 ? (n < 64 ? n : 64) : 1);
+      }
+      else if (tmp == "-sa") {
+        suffixArrayMatchFinder = true;
+      }
+      else if (tmp == "-speed") {
+        if (++i >= argc) {
+          printUsageFlag = true;
+          throw Plus4Emu::Exception("missing argument for '-speed'");
+        }
+        int     n = int(convertStringToInteger(argv[i]));
+        decompressionSpeed = (n > 0 ? (n < 32 ? n : 32) : 0);
       }
       else if (tmp == "-c16") {
         c16Mode = true;
@@ -379,11 +514,12 @@ int main(int argc, char **argv)
         throw Plus4Emu::Exception("invalid command line option");
       }
     }
-    if (fileNames.size() < (testMode ? 1 : 2)) {
+    if (fileNames.size() < ((testMode || benchmarkMode) ? 1 : 2)) {
       printUsageFlag = true;
       throw Plus4Emu::Exception("missing file name");
     }
-    if (compressionType >= 3 && !(noPRGMode && noZPUpdate)) {
+    if (compressionType >= 3 && !(noPRGMode && noZPUpdate) &&
+        !benchmarkMode) {
       if (compressionType == 3)
         throw Plus4Emu::Exception("-m3 compression requires -noprg");
       else
@@ -397,6 +533,10 @@ int main(int argc, char **argv)
       fileLengths[fileNames.size() - 1] = fileLengths[fileNames.size()];
     if (loadAddresses[fileNames.size()] >= 0)
       loadAddresses[fileNames.size() - 1] = loadAddresses[fileNames.size()];
+    if (benchmarkMode) {
+      runBenchmark(fileNames, fileOffsets, fileLengths, compressionLevelSet);
+      return 0;
+    }
     if (!(extractMode || testMode)) {
       // in compress mode, these parameters can only be applied to the input
       // files
@@ -519,6 +659,9 @@ int main(int argc, char **argv)
     std::vector< bool >           bytesUsed;
     std::vector< unsigned char >  tmpBuf;
     compress = Plus4Compress::createCompressor(compressionType, outBuf);
+    compress->setThreadCount(threadCnt);
+    compress->setMatchFinderType(suffixArrayMatchFinder ? 1 : 0);
+    compress->setDecompressionSpeed(decompressionSpeed);
     inBuf.resize(65536);
     bytesUsed.resize(65536);
     for (size_t i = 0; i < 65536; i++) {
@@ -650,6 +793,11 @@ int main(int argc, char **argv)
       std::fprintf(stderr, "        extract compressed file (experimental)\n");
       std::fprintf(stderr, "    %s -t [OPTIONS...] <infile...>\n", programName);
       std::fprintf(stderr, "        test compressed file(s)\n");
+      std::fprintf(stderr, "    %s -bench [OPTIONS...] <infile...>\n",
+                   programName);
+      std::fprintf(stderr, "        print compression ratio and speed for "
+                           "the selected (default: all)\n"
+                           "        methods and levels\n");
     }
     if (printUsageFlag && !helpFlag) {
       std::fprintf(stderr, "    %s --help\n", programName);
@@ -669,6 +817,24 @@ int main(int argc, char **argv)
       std::fprintf(stderr, "        set maximum compression level (very slow "
                            "and may or may not make\n");
       std::fprintf(stderr, "        the output file smaller)\n");
+      std::fprintf(stderr, "    -j <N>              (-m0, -m1, -m2 and -mz "
+                           "only)\n");
+      std::fprintf(stderr, "        use N threads for testing block split "
+                           "positions (default: 1);\n"
+                           "        the output does not depend on N\n");
+      std::fprintf(stderr, "    -sa                 (-m0 ... -m3 and -mz "
+                           "only)\n");
+      std::fprintf(stderr, "        find matches using a suffix array instead "
+                           "of a radix tree (faster\n"
+                           "        and uses less memory on large files, the "
+                           "output is the same)\n");
+      std::fprintf(stderr, "    -speed <N>          (-m0 only)\n");
+      std::fprintf(stderr, "        optimize for faster decompression by the "
+                           "SFX module at the\n"
+                           "        expense of compression ratio, N = 0 "
+                           "(default, size only) to 32 (one\n"
+                           "        bit of output is worth 128 / N cycles of "
+                           "estimated decompression time)\n");
       std::fprintf(stderr, "    -noprg\n");
       std::fprintf(stderr, "        read and write raw files without PRG or "
                            "P00 header (implies\n");
@@ -0,0 +1,151 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// benchmark for the match finders of Plus4Compress::LZSearchTable: the match
+// tables are created for each input file a number of times with both the
+// radix tree and the suffix array (lcp-interval tree) algorithm, and the
+// time and temporary memory used, as well as the number of positions where
+// the matches found differ are printed
+
+#include "plus4emu.hpp"
+#include "system.hpp"
+#include "comprlib.hpp"
+
+#include <vector>
+
+using Plus4Compress::LZSearchTable;
+
+static void readInputFile(std::vector< unsigned char >& buf,
+                          const char *fileName)
+{
+  buf.clear();
+  std::FILE *f = std::fopen(fileName, "rb");
+  if (!f)
+    throw Plus4Emu::Exception("error opening input file");
+  int     c;
+  while ((c = std::fgetc(f)) != EOF)
+    buf.push_back((unsigned char) (c & 0xFF));
+  std::fclose(f);
+  if (buf.size() < 1 || buf.size() > 0x003FFFFE) {
+    throw Plus4Emu::Exception("input file is empty or too large "
+                              "(must be less than 4 MB)");
+  }
+}
+
+static double runMatchFinder(LZSearchTable& searchTable,
+                             int matchFinderType, int nRepeats,
+                             const std::vector< unsigned char >& buf)
+{
+  searchTable.setMatchFinderType(matchFinderType);
+  Plus4Emu::Timer timer;
+  for (int i = 0; i < nRepeats; i++)
+    searchTable.findMatches(&(buf.front()), 0, buf.size());
+  return timer.getRealTime();
+}
+
+static size_t compareMatches(const LZSearchTable& t1,
+                             const LZSearchTable& t2, size_t nBytes)
+{
+  size_t  nErrors = 0;
+  for (size_t i = 0; i < nBytes; i++) {
+    const unsigned int  *p1 = t1.getMatches(i);
+    const unsigned int  *p2 = t2.getMatches(i);
+    while (*p1 == *p2 && *p1 != 0U) {
+      p1++;
+      p2++;
+    }
+    nErrors += size_t(*p1 != *p2);
+  }
+  return nErrors;
+}
+
+int main(int argc, char **argv)
+{
+  try {
+    int     nRepeats = 5;
+    size_t  maxOffs = 65535;
+    int     firstFile = 1;
+    while (argc > (firstFile + 1)) {
+      if (std::strcmp(argv[firstFile], "-n") == 0) {
+        nRepeats = int(std::atoi(argv[firstFile + 1]));
+        nRepeats = (nRepeats > 1 ? nRepeats : 1);
+      }
+      else if (std::strcmp(argv[firstFile], "-d") == 0) {
+        maxOffs = size_t(std::atol(argv[firstFile + 1]));
+        maxOffs = (maxOffs > 1 ? (maxOffs < 0x003FFFFF ? maxOffs : 0x003FFFFF)
+                               : 1);
+      }
+      else {
+        break;
+      }
+      firstFile = firstFile + 2;
+    }
+    if (argc <= firstFile) {
+      throw Plus4Emu::Exception("Usage: matchbench [-n REPEATS] "
+                                "[-d MAXOFFSET] <infile> [infile2 ...]");
+    }
+    // use the parameters of the M2 compressor, with a configurable
+    // maximum offset
+    LZSearchTable rtSearchTable(1, 512, 65535, 4096, 16384, maxOffs);
+    LZSearchTable saSearchTable(1, 512, 65535, 4096, 16384, maxOffs);
+    std::vector< unsigned char >  buf;
+    double  totalSize = 0.0;
+    double  rtTotalTime = 0.0;
+    double  saTotalTime = 0.0;
+    size_t  totalErrors = 0;
+    std::printf("%-24s %8s %9s %9s %9s %9s %8s\n", "file", "size",
+                "RT ms", "RT KB", "SA ms", "SA KB", "diffs");
+    for (int i = firstFile; i < argc; i++) {
+      readInputFile(buf, argv[i]);
+      double  rtTime =
+          runMatchFinder(rtSearchTable, LZSearchTable::MATCH_FINDER_RADIX_TREE,
+                         nRepeats, buf);
+      double  saTime =
+          runMatchFinder(saSearchTable,
+                         LZSearchTable::MATCH_FINDER_SUFFIX_ARRAY,
+                         nRepeats, buf);
+      size_t  nErrors = compareMatches(rtSearchTable, saSearchTable,
+                                       buf.size());
+      std::printf("%-24.24s %8lu %9.2f %9lu %9.2f %9lu %8lu\n", argv[i],
+                  (unsigned long) buf.size(),
+                  rtTime * 1000.0 / double(nRepeats),
+                  (unsigned long) (rtSearchTable.getWorkspaceSize() >> 10),
+                  saTime * 1000.0 / double(nRepeats),
+                  (unsigned long) (saSearchTable.getWorkspaceSize() >> 10),
+                  (unsigned long) nErrors);
+      totalSize = totalSize + double(long(buf.size()));
+      rtTotalTime = rtTotalTime + rtTime;
+      saTotalTime = saTotalTime + saTime;
+      totalErrors = totalErrors + nErrors;
+    }
+    totalSize = totalSize * double(nRepeats) / 1048576.0;
+    std::printf("radix tree:   %.2f MB/s\n",
+                (rtTotalTime > 0.0 ? (totalSize / rtTotalTime) : 0.0));
+    std::printf("suffix array: %.2f MB/s\n",
+                (saTotalTime > 0.0 ? (totalSize / saTotalTime) : 0.0));
+    std::printf("%lu positions with different matches\n",
+                (unsigned long) totalErrors);
+  }
+  catch (std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return -1;
+  }
+  return 0;
+}
+
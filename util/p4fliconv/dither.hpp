@@ -27,10 +27,148 @@
 
 namespace Plus4FLIConv {
 
-  extern const int  ditherTable_FloydSteinberg[13];
-  extern const int  ditherTable_Jarvis[13];
-  extern const int  ditherTable_Stucki[13];
-  extern const int  ditherTable_Sierra2[13];
+  // error diffusion kernels for dither modes 2 (Floyd-Steinberg), 3 (Jarvis),
+  // 4 (Stucki), and 5 (Sierra2); 'd' is the divisor, and w0 to w11 are the
+  // weights for the pixels at (xc + 1, yc), (xc + 2, yc), (xc - 2, yc + 1)
+  // to (xc + 2, yc + 1), and (xc - 2, yc + 2) to (xc + 2, yc + 2), with the
+  // X offsets mirrored on odd lines (serpentine scan)
+
+  template < int N >
+  struct ErrorDiffusionKernel {
+  };
+
+  template <>
+  struct ErrorDiffusionKernel< 2 > {
+    enum {
+      d = 16,
+      w0 = 7,   w1 = 0,
+      w2 = 0,   w3 = 3,   w4 = 5,   w5 = 1,   w6 = 0,
+      w7 = 0,   w8 = 0,   w9 = 0,   w10 = 0,  w11 = 0
+    };
+  };
+
+  template <>
+  struct ErrorDiffusionKernel< 3 > {
+    enum {
+      d = 48,
+      w0 = 7,   w1 = 5,
+      w2 = 3,   w3 = 5,   w4 = 7,   w5 = 5,   w6 = 3,
+      w7 = 1,   w8 = 3,   w9 = 5,   w10 = 3,  w11 = 1
+    };
+  };
+
+  template <>
+  struct ErrorDiffusionKernel< 4 > {
+    enum {
+      d = 42,
+      w0 = 8,   w1 = 4,
+      w2 = 2,   w3 = 4,   w4 = 8,   w5 = 4,   w6 = 2,
+      w7 = 1,   w8 = 2,   w9 = 4,   w10 = 2,  w11 = 1
+    };
+  };
+
+  template <>
+  struct ErrorDiffusionKernel< 5 > {
+    enum {
+      d = 16,
+      w0 = 4,   w1 = 3,
+      w2 = 1,   w3 = 2,   w4 = 3,   w5 = 2,   w6 = 1,
+      w7 = 0,   w8 = 0,   w9 = 0,   w10 = 0,  w11 = 0
+    };
+  };
+
+  template < int W, int D, typename T >
+  static PLUS4EMU_INLINE void addDitherError(T& line, long xc, long w,
+                                             float err)
+  {
+    if (W != 0 && xc >= 0L && xc < w)
+      line.setPixel(xc, line.getPixel(xc) + (err * (float(W) / float(D))));
+  }
+
+  // distribute the error 'err' of pixel (xc, yc) of a 'w' * 'h' image to
+  // the lines yc to yc + 2, using error diffusion kernel 'N'
+
+  template < int N, typename T >
+  static PLUS4EMU_INLINE void diffuseDitherError(T& img, long xc, long yc,
+                                                 long w, long h, float err)
+  {
+    typedef ErrorDiffusionKernel< N > K;
+    long    dx = ((yc & 1L) == 0L ? 1L : -1L);
+    addDitherError< K::w0, K::d >(img[yc], xc + dx, w, err);
+    addDitherError< K::w1, K::d >(img[yc], xc + (dx * 2L), w, err);
+    if ((yc + 1L) >= h)
+      return;
+    addDitherError< K::w2, K::d >(img[yc + 1L], xc - (dx * 2L), w, err);
+    addDitherError< K::w3, K::d >(img[yc + 1L], xc - dx, w, err);
+    addDitherError< K::w4, K::d >(img[yc + 1L], xc, w, err);
+    addDitherError< K::w5, K::d >(img[yc + 1L], xc + dx, w, err);
+    addDitherError< K::w6, K::d >(img[yc + 1L], xc + (dx * 2L), w, err);
+    if ((K::w7 | K::w8 | K::w9 | K::w10 | K::w11) == 0 || (yc + 2L) >= h)
+      return;
+    addDitherError< K::w7, K::d >(img[yc + 2L], xc - (dx * 2L), w, err);
+    addDitherError< K::w8, K::d >(img[yc + 2L], xc - dx, w, err);
+    addDitherError< K::w9, K::d >(img[yc + 2L], xc, w, err);
+    addDitherError< K::w10, K::d >(img[yc + 2L], xc + dx, w, err);
+    addDitherError< K::w11, K::d >(img[yc + 2L], xc + (dx * 2L), w, err);
+  }
+
+  // error diffusion of a single channel image (dither modes 2 to 5,
+  // any other mode is treated as Floyd-Steinberg)
+
+  template < typename T >
+  static inline void diffuseDitherError(int ditherMode, T& img,
+                                        long xc, long yc, long w, long h,
+                                        float err)
+  {
+    switch (ditherMode) {
+    case 3:
+      diffuseDitherError< 3 >(img, xc, yc, w, h, err);
+      break;
+    case 4:
+      diffuseDitherError< 4 >(img, xc, yc, w, h, err);
+      break;
+    case 5:
+      diffuseDitherError< 5 >(img, xc, yc, w, h, err);
+      break;
+    default:
+      diffuseDitherError< 2 >(img, xc, yc, w, h, err);
+      break;
+    }
+  }
+
+  template < int N, typename T >
+  static PLUS4EMU_INLINE void diffuseDitherErrorYUV(T& img, long xc, long yc,
+                                                    long w, long h,
+                                                    float errY, float errU,
+                                                    float errV)
+  {
+    diffuseDitherError< N >(img.y(), xc, yc, w, h, errY);
+    diffuseDitherError< N >(img.u(), xc, yc, w, h, errU);
+    diffuseDitherError< N >(img.v(), xc, yc, w, h, errV);
+  }
+
+  // error diffusion of a YUV image
+
+  template < typename T >
+  static inline void diffuseDitherErrorYUV(int ditherMode, T& img,
+                                           long xc, long yc, long w, long h,
+                                           float errY, float errU, float errV)
+  {
+    switch (ditherMode) {
+    case 3:
+      diffuseDitherErrorYUV< 3 >(img, xc, yc, w, h, errY, errU, errV);
+      break;
+    case 4:
+      diffuseDitherErrorYUV< 4 >(img, xc, yc, w, h, errY, errU, errV);
+      break;
+    case 5:
+      diffuseDitherErrorYUV< 5 >(img, xc, yc, w, h, errY, errU, errV);
+      break;
+    default:
+      diffuseDitherErrorYUV< 2 >(img, xc, yc, w, h, errY, errU, errV);
+      break;
+    }
+  }
 
   extern const int  ditherTable_Bayer[4096];
   extern const int  ditherTable[4096];
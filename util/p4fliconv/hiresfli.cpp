@@ -181,16 +181,21 @@ namespace Plus4FLIConv {
     delete[] paletteY;
   }
 
-  void P4FLI_HiResNoInterlace::pixelStoreCallback(
-      void *userData, int xc, int yc, float y, float u, float v)
+  void P4FLI_HiResNoInterlace::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     P4FLI_HiResNoInterlace&  this_ =
         *(reinterpret_cast<P4FLI_HiResNoInterlace *>(userData));
-    if (!this_.enable40ColumnMode)
-      xc = xc + 16;
-    this_.resizedImage.y()[yc >> 1][xc >> 1] += (y * 0.25f);
-    this_.resizedImage.u()[yc >> 1][xc >> 1] += (u * 0.25f);
-    this_.resizedImage.v()[yc >> 1][xc >> 1] += (v * 0.25f);
+    int     xOffs = (this_.enable40ColumnMode ? 0 : 16);
+    Line320& lineY = this_.resizedImage.y()[yc >> 1];
+    Line320& lineU = this_.resizedImage.u()[yc >> 1];
+    Line320& lineV = this_.resizedImage.v()[yc >> 1];
+    for (int xc = 0; xc < w; xc++) {
+      lineY[(xc + xOffs) >> 1] += (y[xc] * 0.25f);
+      lineU[(xc + xOffs) >> 1] += (u[xc] * 0.25f);
+      lineV[(xc + xOffs) >> 1] += (v[xc] * 0.25f);
+    }
   }
 
   void P4FLI_HiResNoInterlace::colorToUV(int c, float& u, float& v)
@@ -324,31 +329,8 @@ namespace Plus4FLIConv {
     if (pixelValueDithered > pixelValue1)
       pixelValueDithered = pixelValue1;
     double  err = double(pixelValueDithered) - double(newPixelValue);
-    const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-    switch (ditherMode) {
-    case 3:
-      errMultTbl = &(ditherTable_Jarvis[0]);
-      break;
-    case 4:
-      errMultTbl = &(ditherTable_Stucki[0]);
-      break;
-    case 5:
-      errMultTbl = &(ditherTable_Sierra2[0]);
-      break;
-    }
-    for (int i = 0; i < 12; i++) {
-      if (errMultTbl[i + 1] == 0)
-        continue;
-      long    yc_ = yc + ((i + 3) / 5);
-      if (yc_ >= 248L)
-        break;
-      long    xc_ = ((i + 3) % 5) - 2;
-      xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-      float   tmp = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-      ditherErrorImage.y()[yc_].setPixel(xc_,
-                                         ditherErrorImage.y()[yc_].getPixel(xc_)
-                                         + (float(err) * tmp));
-    }
+    diffuseDitherError(ditherMode, ditherErrorImage.y(), xc, yc, 320L, 248L,
+                       float(err));
   }
 
   inline double P4FLI_HiResNoInterlace::calculateLuminanceError(float n,
@@ -875,34 +857,8 @@ namespace Plus4FLIConv {
       float   errY = y - paletteY[c];
       float   errU = u - paletteU[c];
       float   errV = v - paletteV[c];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < long(nLines) && xc_ >= 0L && xc_ < 320L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage.y()[yc_].setPixel(
-              xc_, ditherErrorImage.y()[yc_].getPixel(xc_) + (errY * errMult));
-          ditherErrorImage.u()[yc_].setPixel(
-              xc_, ditherErrorImage.u()[yc_].getPixel(xc_) + (errU * errMult));
-          ditherErrorImage.v()[yc_].setPixel(
-              xc_, ditherErrorImage.v()[yc_].getPixel(xc_) + (errV * errMult));
-        }
-      }
+      diffuseDitherErrorYUV(ditherMode, ditherErrorImage,
+                            xc, yc, 320L, long(nLines), errY, errU, errV);
       if (yc & 1L)
         xc = 319L - xc;
     }
@@ -1095,7 +1051,7 @@ namespace Plus4FLIConv {
       line1V.setBorderColor(borderV);
       imgConv.setImageSize((enable40ColumnMode ? 640 : 608), nLines << 1);
       imgConv.setPixelAspectRatio(1.0f);
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       progressMessage("Calculating FLI data");
       // initialize horizontal scroll table
@@ -154,7 +154,9 @@ namespace Plus4FLIConv {
     float   *paletteU;
     float   *paletteV;
     // ----------------
-    static void pixelStoreCallback(void *, int, int, float, float, float);
+    static void rowStoreCallback(void *, int,
+                                 const float *, const float *, const float *,
+                                 int);
     void colorToUV(int c, float& u, float& v);
     void createYTable();
     void createUVTables();
@@ -171,14 +171,20 @@ namespace Plus4FLIConv {
     delete[] paletteY;
   }
 
-  void P4FLI_HiResNoFLI::pixelStoreCallback(void *userData, int xc, int yc,
-                                            float y, float u, float v)
+  void P4FLI_HiResNoFLI::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     P4FLI_HiResNoFLI&  this_ =
         *(reinterpret_cast<P4FLI_HiResNoFLI *>(userData));
-    this_.resizedImage.y()[yc >> 1][xc >> 1] += (y * 0.25f);
-    this_.resizedImage.u()[yc >> 1][xc >> 1] += (u * 0.25f);
-    this_.resizedImage.v()[yc >> 1][xc >> 1] += (v * 0.25f);
+    Line320& lineY = this_.resizedImage.y()[yc >> 1];
+    Line320& lineU = this_.resizedImage.u()[yc >> 1];
+    Line320& lineV = this_.resizedImage.v()[yc >> 1];
+    for (int xc = 0; xc < w; xc++) {
+      lineY[xc >> 1] += (y[xc] * 0.25f);
+      lineU[xc >> 1] += (u[xc] * 0.25f);
+      lineV[xc >> 1] += (v[xc] * 0.25f);
+    }
   }
 
   void P4FLI_HiResNoFLI::colorToUV(int c, float& u, float& v)
@@ -303,31 +309,8 @@ namespace Plus4FLIConv {
     if (pixelValueDithered > pixelValue1)
       pixelValueDithered = pixelValue1;
     double  err = double(pixelValueDithered) - double(newPixelValue);
-    const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-    switch (ditherMode) {
-    case 3:
-      errMultTbl = &(ditherTable_Jarvis[0]);
-      break;
-    case 4:
-      errMultTbl = &(ditherTable_Stucki[0]);
-      break;
-    case 5:
-      errMultTbl = &(ditherTable_Sierra2[0]);
-      break;
-    }
-    for (int i = 0; i < 12; i++) {
-      if (errMultTbl[i + 1] == 0)
-        continue;
-      long    yc_ = yc + ((i + 3) / 5);
-      if (yc_ >= 200L)
-        break;
-      long    xc_ = ((i + 3) % 5) - 2;
-      xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-      float   tmp = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-      ditherErrorImage.y()[yc_].setPixel(xc_,
-                                         ditherErrorImage.y()[yc_].getPixel(xc_)
-                                         + (float(err) * tmp));
-    }
+    diffuseDitherError(ditherMode, ditherErrorImage.y(), xc, yc, 320L, 200L,
+                       float(err));
   }
 
   inline double P4FLI_HiResNoFLI::calculateLuminanceError(float n,
@@ -844,34 +827,8 @@ namespace Plus4FLIConv {
       float   errY = y - paletteY[c];
       float   errU = u - paletteU[c];
       float   errV = v - paletteV[c];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < 200L && xc_ >= 0L && xc_ < 320L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage.y()[yc_].setPixel(
-              xc_, ditherErrorImage.y()[yc_].getPixel(xc_) + (errY * errMult));
-          ditherErrorImage.u()[yc_].setPixel(
-              xc_, ditherErrorImage.u()[yc_].getPixel(xc_) + (errU * errMult));
-          ditherErrorImage.v()[yc_].setPixel(
-              xc_, ditherErrorImage.v()[yc_].getPixel(xc_) + (errV * errMult));
-        }
-      }
+      diffuseDitherErrorYUV(ditherMode, ditherErrorImage,
+                            xc, yc, 320L, 200L, errY, errU, errV);
       if (yc & 1L)
         xc = 319L - xc;
     }
@@ -1053,7 +1010,7 @@ namespace Plus4FLIConv {
       }
       imgConv.setImageSize(640, 400);
       imgConv.setPixelAspectRatio(1.0f);
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       progressMessage("Calculating FLI data");
       for (int yc = 0; yc < 200; yc++) {
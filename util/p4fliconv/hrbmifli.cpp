@@ -182,16 +182,21 @@ namespace Plus4FLIConv {
     delete[] paletteY;
   }
 
-  void P4FLI_HiResBitmapInterlace::pixelStoreCallback(
-      void *userData, int xc, int yc, float y, float u, float v)
+  void P4FLI_HiResBitmapInterlace::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     P4FLI_HiResBitmapInterlace&  this_ =
         *(reinterpret_cast<P4FLI_HiResBitmapInterlace *>(userData));
-    if (!this_.enable40ColumnMode)
-      xc = xc + 16;
-    this_.resizedImage.y()[yc][xc >> 1] += (y * 0.5f);
-    this_.resizedImage.u()[yc][xc >> 1] += (u * 0.5f);
-    this_.resizedImage.v()[yc][xc >> 1] += (v * 0.5f);
+    int     xOffs = (this_.enable40ColumnMode ? 0 : 16);
+    Line320& lineY = this_.resizedImage.y()[yc];
+    Line320& lineU = this_.resizedImage.u()[yc];
+    Line320& lineV = this_.resizedImage.v()[yc];
+    for (int xc = 0; xc < w; xc++) {
+      lineY[(xc + xOffs) >> 1] += (y[xc] * 0.5f);
+      lineU[(xc + xOffs) >> 1] += (u[xc] * 0.5f);
+      lineV[(xc + xOffs) >> 1] += (v[xc] * 0.5f);
+    }
   }
 
   void P4FLI_HiResBitmapInterlace::colorToUV(int c, float& u, float& v)
@@ -326,31 +331,8 @@ namespace Plus4FLIConv {
     if (pixelValueDithered > pixelValue1)
       pixelValueDithered = pixelValue1;
     double  err = double(pixelValueDithered) - double(newPixelValue);
-    const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-    switch (ditherMode) {
-    case 3:
-      errMultTbl = &(ditherTable_Jarvis[0]);
-      break;
-    case 4:
-      errMultTbl = &(ditherTable_Stucki[0]);
-      break;
-    case 5:
-      errMultTbl = &(ditherTable_Sierra2[0]);
-      break;
-    }
-    for (int i = 0; i < 12; i++) {
-      if (errMultTbl[i + 1] == 0)
-        continue;
-      long    yc_ = yc + ((i + 3) / 5);
-      if (yc_ >= 496L)
-        break;
-      long    xc_ = ((i + 3) % 5) - 2;
-      xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-      float   tmp = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-      ditherErrorImage.y()[yc_].setPixel(xc_,
-                                         ditherErrorImage.y()[yc_].getPixel(xc_)
-                                         + (float(err) * tmp));
-    }
+    diffuseDitherError(ditherMode, ditherErrorImage.y(), xc, yc, 320L, 496L,
+                       float(err));
   }
 
   inline double P4FLI_HiResBitmapInterlace::calculateLuminanceError(
@@ -876,34 +858,8 @@ namespace Plus4FLIConv {
       float   errY = y - paletteY[c];
       float   errU = u - paletteU[c];
       float   errV = v - paletteV[c];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < long(nLines) && xc_ >= 0L && xc_ < 320L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage.y()[yc_].setPixel(
-              xc_, ditherErrorImage.y()[yc_].getPixel(xc_) + (errY * errMult));
-          ditherErrorImage.u()[yc_].setPixel(
-              xc_, ditherErrorImage.u()[yc_].getPixel(xc_) + (errU * errMult));
-          ditherErrorImage.v()[yc_].setPixel(
-              xc_, ditherErrorImage.v()[yc_].getPixel(xc_) + (errV * errMult));
-        }
-      }
+      diffuseDitherErrorYUV(ditherMode, ditherErrorImage,
+                            xc, yc, 320L, long(nLines), errY, errU, errV);
       if (yc & 1L)
         xc = 319L - xc;
     }
@@ -1096,7 +1052,7 @@ namespace Plus4FLIConv {
       }
       imgConv.setImageSize((enable40ColumnMode ? 640 : 608), nLines);
       imgConv.setPixelAspectRatio(1.0f);
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       progressMessage("Calculating FLI data");
       for (int yc = 0; yc < nLines; yc += 2) {
@@ -54,6 +54,26 @@ static bool defaultProgressPercentageCb(void *userData, int n)
   return true;
 }
 
+// Fl_Shared_Image keeps a global list of the loaded images, so loading and
+// releasing images is serialized to allow converting several files in
+// parallel (batch mode)
+static Plus4Emu::Mutex  sharedImageMutex;
+
+static Fl_Shared_Image * loadSharedImage(const char *fileName)
+{
+  sharedImageMutex.lock();
+  Fl_Shared_Image *f = Fl_Shared_Image::get(fileName);
+  sharedImageMutex.unlock();
+  return f;
+}
+
+static void releaseSharedImage(Fl_Shared_Image *f)
+{
+  sharedImageMutex.lock();
+  f->release();
+  sharedImageMutex.unlock();
+}
+
 static void parseXPMHeader(std::vector< long >& buf, const char *s)
 {
   buf.resize(0);
@@ -282,6 +302,9 @@ namespace Plus4FLIConv {
       borderColorV(0.0f),
       storePixelFunc(&defaultStorePixelFunc),
       storePixelFuncUserData((void *) 0),
+      storeRowFunc((void (*)(void *, int, const float *, const float *,
+                             const float *, int)) 0),
+      storeRowFuncUserData((void *) 0),
       progressMessageCallback(&defaultProgressMessageCb),
       progressMessageUserData((void *) 0),
       progressPercentageCallback(&defaultProgressPercentageCb),
@@ -449,14 +472,13 @@ namespace Plus4FLIConv {
     borderY = float(std::pow(borderY, monitorGamma));
     float   borderU = borderColorU;
     float   borderV = borderColorV;
+    std::vector< float >  outBuf(size_t(width) * 3);
+    float   *outY = &(outBuf.front());
+    float   *outU = outY + width;
+    float   *outV = outU + width;
     for (int yc = 0; yc < height; yc++) {
       if (!setProgressPercentage(yc * 100 / height)) {
-        for (int tmpY = 0; tmpY < height; tmpY++) {
-          for (int tmpX = 0; tmpX < width; tmpX++) {
-            storePixelFunc(storePixelFuncUserData, tmpX, tmpY,
-                           borderY, borderU, borderV);
-          }
-        }
+        storeBorderColorImage(borderY, borderU, borderV);
         progressMessage("");
         return false;
       }
@@ -470,11 +492,11 @@ namespace Plus4FLIConv {
           FLIConverter::convertPlus4Color(imageData[(yi * 320) + xi], y, u, v,
                                           monitorGamma);
         }
-        y = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
-        u = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
-        v = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
-        storePixelFunc(storePixelFuncUserData, xc, yc, y, u, v);
+        outY[xc] = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
+        outU[xc] = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
+        outV[xc] = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
       }
+      storeRow(yc, outY, outU, outV);
     }
     setProgressPercentage(100);
     progressMessage("");
@@ -596,14 +618,13 @@ namespace Plus4FLIConv {
     int     xOffs_i = int(xOffs + (xOffs >= 0.0f ? 0.5f : -0.5f));
     int     yOffs_i = int(yOffs + (yOffs >= 0.0f ? 0.5f : -0.5f));
     // scale image to the specified width and height
+    std::vector< float >  outBuf(size_t(width) * 3);
+    float   *outY = &(outBuf.front());
+    float   *outU = outY + width;
+    float   *outV = outU + width;
     for (int yc = 0; yc < height; yc++) {
       if (!setProgressPercentage(yc * 100 / height)) {
-        for (int tmpY = 0; tmpY < height; tmpY++) {
-          for (int tmpX = 0; tmpX < width; tmpX++) {
-            storePixelFunc(storePixelFuncUserData, tmpX, tmpY,
-                           borderY, borderU, borderV);
-          }
-        }
+        storeBorderColorImage(borderY, borderU, borderV);
         progressMessage("");
         return false;
       }
@@ -619,11 +640,11 @@ namespace Plus4FLIConv {
           u = paletteU[c];
           v = paletteV[c];
         }
-        y = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
-        u = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
-        v = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
-        storePixelFunc(storePixelFuncUserData, xc, yc, y, u, v);
+        outY[xc] = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
+        outU[xc] = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
+        outV[xc] = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
       }
+      storeRow(yc, outY, outU, outV);
     }
     setProgressPercentage(100);
     progressMessage("");
@@ -633,149 +654,211 @@ namespace Plus4FLIConv {
     return true;
   }
 
+  void YUVImageConverter::convertInputLine(
+      float *bufY, float *bufU, float *bufV,
+      const unsigned char *pixelData, int d,
+      const uint16_t *pixelIndices, const uint32_t *palette, int n,
+      float borderY, float yGamma)
+  {
+    bool    haveAlpha = !(d & 1);
+    for (int xc = 0; xc < n; xc++) {
+      if (xc > 0) {
+        // copy the result for the previous pixel if the input is the same
+        bool    isEqual = false;
+        if (pixelData) {
+          isEqual = (std::memcmp(&(pixelData[xc * d]),
+                                 &(pixelData[(xc - 1) * d]), size_t(d)) == 0);
+        }
+        else {
+          isEqual = (pixelIndices[xc] == pixelIndices[xc - 1]);
+        }
+        if (isEqual) {
+          bufY[xc] = bufY[xc - 1];
+          bufU[xc] = bufU[xc - 1];
+          bufV[xc] = bufV[xc - 1];
+          continue;
+        }
+      }
+      float   r = 0.0f;
+      float   g = 0.0f;
+      float   b = 0.0f;
+      const unsigned char *pixelPtr = (unsigned char *) 0;
+      if (pixelData) {
+        // RGB or greyscale format
+        pixelPtr = &(pixelData[xc * d]);
+        if (d < 3) {
+          r = float(pixelPtr[0]) * (1.0f / 255.0f);
+          g = r;
+          b = r;
+        }
+        else {
+          r = float(pixelPtr[0]) * (1.0f / 255.0f);
+          g = float(pixelPtr[1]) * (1.0f / 255.0f);
+          b = float(pixelPtr[2]) * (1.0f / 255.0f);
+        }
+      }
+      else {
+        // colormap format
+        uint32_t  tmp = palette[pixelIndices[xc]];
+        r = float(int((tmp >> 16) & 0xFFU)) * (1.0f / 255.0f);
+        g = float(int((tmp >> 8) & 0xFFU)) * (1.0f / 255.0f);
+        b = float(int(tmp & 0xFFU)) * (1.0f / 255.0f);
+        haveAlpha = (tmp >= 0x80000000U);
+      }
+      float   y = 0.0f;
+      float   u = 0.0f;
+      float   v = 0.0f;
+      rgbToYUV(y, u, v, r, g, b);
+      u *= (colorSaturationMult * (yMax - yMin));
+      v *= (colorSaturationMult * (yMax - yMin));
+      y = (y * (yMax - yMin)) + yMin;
+      double  c = std::sqrt((u * u) + (v * v));
+      if (double(y) < (c - 0.05) || double(y) > (1.05 - c)) {
+        double  tmp = 0.5 / c;
+        if (double(y) < (c - 0.05))
+          tmp = tmp * (double(y) + c + 0.05);
+        else
+          tmp = tmp * ((1.05 + c) - double(y));
+        if (tmp < 0.0) {
+          u = 0.0f;
+          v = 0.0f;
+          c = 0.0;
+        }
+        else {
+          u = u * float(tmp);
+          v = v * float(tmp);
+          c = c * tmp;
+        }
+      }
+      y = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
+      y = float(std::pow(y, yGamma));
+      if (c > 0.000001) {
+        c = c * (1.0 / double(FLIConverter::defaultColorSaturation));
+        c = std::pow(c, double(colorSaturationPow)) / c;
+        u = float(c * u);
+        v = float(c * v);
+      }
+      if (haveAlpha) {
+        float   a = 0.0f;
+        if (pixelPtr)
+          a = float(pixelPtr[d - 1]) * (1.0f / 255.0f);
+        y = (y * a) + (borderY * (1.0f - a));
+        u = (u * a) + (borderColorU * (1.0f - a));
+        v = (v * a) + (borderColorV * (1.0f - a));
+      }
+      bufY[xc] = y;
+      bufU[xc] = u;
+      bufV[xc] = v;
+    }
+  }
+
+  void YUVImageConverter::initializeResampleWindow(
+      std::vector< float >& windowBuf, int& halfWidth, float scale)
+  {
+    // windowed sinc filter with 64 phases per input pixel; the window is
+    // 16 input pixels wide, or wider when reducing the size by more than
+    // a factor of 5, so that the cutoff frequency can follow the scale
+    float   xs = (scale <= 1.0f ? 1.0f : (1.0f / scale));
+    halfWidth = 8;
+    if (xs < 0.2f) {
+      halfWidth = int(std::ceil(1.6f / xs));
+      if (halfWidth >= 64) {
+        halfWidth = 64;
+        xs = 1.6f / 64.0f;
+      }
+    }
+    windowBuf.resize(size_t(halfWidth) * 128 + 1);
+    for (int x = 0; x <= (halfWidth * 128); x++) {
+      double  xf = double(x - (halfWidth * 64))
+                   * (3.14159265 / double(halfWidth * 128));
+      double  wx = std::cos(xf);
+      wx = wx * wx;
+      xf = xf * double(halfWidth * 2) * xs;
+      if (xf < -0.000001 || xf > 0.000001)
+        wx = wx * std::sin(xf) / xf;
+      windowBuf[x] = float(wx * xs);
+    }
+  }
+
+  void YUVImageConverter::storeRow(int yc, const float *bufY,
+                                   const float *bufU, const float *bufV)
+  {
+    if (storeRowFunc) {
+      storeRowFunc(storeRowFuncUserData, yc, bufY, bufU, bufV, width);
+      return;
+    }
+    for (int xc = 0; xc < width; xc++)
+      storePixelFunc(storePixelFuncUserData, xc, yc, bufY[xc], bufU[xc],
+                     bufV[xc]);
+  }
+
+  void YUVImageConverter::storeBorderColorImage(float y, float u, float v)
+  {
+    std::vector< float >  bufY(size_t(width), y);
+    std::vector< float >  bufU(size_t(width), u);
+    std::vector< float >  bufV(size_t(width), v);
+    for (int yc = 0; yc < height; yc++)
+      storeRow(yc, &(bufY.front()), &(bufU.front()), &(bufV.front()));
+  }
+
   bool YUVImageConverter::convertImageFile(const char *fileName)
   {
     if (fileName == (char *) 0 || fileName[0] == '\0')
       throw Plus4Emu::Exception("invalid image file name");
     if (isC64ImageFile(fileName))
       return convertC64ImageFile(fileName);
-    float     *windowX = (float *) 0;
-    float     *windowY = (float *) 0;
-    float     *inputImage = (float *) 0;
-    Fl_Shared_Image *f = Fl_Shared_Image::get(fileName);
+    Fl_Shared_Image *f = loadSharedImage(fileName);
     if (!f)
       throw Plus4Emu::Exception("error opening image file");
     try {
       int     cnt = f->count();
       int     d = f->d();
-      size_t  w = size_t(f->w());
-      size_t  h = size_t(f->h());
-      const char  *p = (char *) 0;
+      int     w = f->w();
+      int     h = f->h();
+      const unsigned char *p = (unsigned char *) 0;
       std::vector< uint16_t > pixelBuf;
       std::vector< uint32_t > palette;
-      // read input image, and convert it to YUV format
+      // read input image; it is converted to YUV format one line at a time
+      // as needed by the resize code below
       if (d == 1 && cnt > 2) {
         // colormap format
         readColormapImage(pixelBuf, palette, *f);
-        f->release();
+        releaseSharedImage(f);
         f = (Fl_Shared_Image *) 0;
         if (isPlus4Colormap(palette))
-          return convertPlus4ColormapImage(pixelBuf, palette, int(w), int(h));
+          return convertPlus4ColormapImage(pixelBuf, palette, w, h);
       }
       else {
         // RGB or greyscale format
         if (cnt == 1)
-          p = f->data()[0];
-        if ((d < 1 || d > 4) || p == (char *) 0)
+          p = reinterpret_cast< const unsigned char * >(f->data()[0]);
+        if ((d < 1 || d > 4) || p == (unsigned char *) 0)
           throw Plus4Emu::Exception("image format is not supported");
       }
       if (w < 32 || w > 8192 || h < 32 || h > 6144)
         throw Plus4Emu::Exception("image size is out of range");
       progressMessage("Resizing image");
-      inputImage = new float[w * h * 3];
-      bool    haveAlpha = !(d & 1);
       float   borderY = borderColorY;
       borderY = (borderY > 0.0f ? (borderY < 1.0f ? borderY : 1.0f) : 0.0f);
       borderY = float(std::pow(borderY, monitorGamma));
       float   borderU = borderColorU;
       float   borderV = borderColorV;
       float   yGamma = monitorGamma / gammaCorrection;
-      for (size_t yc = 0; yc < h; yc++) {
-        if (!setProgressPercentage(int(yc) * (interpolationEnabled ? 50 : 90)
-                                   / int(h))) {
-          for (int tmpY = 0; tmpY < height; tmpY++) {
-            for (int tmpX = 0; tmpX < width; tmpX++) {
-              storePixelFunc(storePixelFuncUserData, tmpX, tmpY,
-                             borderY, borderU, borderV);
-            }
-          }
-          delete[] inputImage;
-          progressMessage("");
-          return false;
-        }
-        for (size_t xc = 0; xc < w; xc++) {
-          float   r = 0.0f;
-          float   g = 0.0f;
-          float   b = 0.0f;
-          const char  *pixelPtr = (char *) 0;
-          if (p) {
-            // RGB or greyscale format
-            pixelPtr = &(p[((yc * w) + xc) * size_t(d)]);
-            if (d < 3) {
-              r = float((unsigned char) pixelPtr[0]) * (1.0f / 255.0f);
-              g = r;
-              b = r;
-            }
-            else {
-              r = float((unsigned char) pixelPtr[0]) * (1.0f / 255.0f);
-              g = float((unsigned char) pixelPtr[1]) * (1.0f / 255.0f);
-              b = float((unsigned char) pixelPtr[2]) * (1.0f / 255.0f);
-            }
-          }
-          else {
-            // colormap format
-            uint32_t  tmp = palette[pixelBuf[(yc * w) + xc]];
-            r = float(int((tmp >> 16) & 0xFFU)) * (1.0f / 255.0f);
-            g = float(int((tmp >> 8) & 0xFFU)) * (1.0f / 255.0f);
-            b = float(int(tmp & 0xFFU)) * (1.0f / 255.0f);
-            haveAlpha = (tmp >= 0x80000000U);
-          }
-          float   y = 0.0f;
-          float   u = 0.0f;
-          float   v = 0.0f;
-          rgbToYUV(y, u, v, r, g, b);
-          u *= (colorSaturationMult * (yMax - yMin));
-          v *= (colorSaturationMult * (yMax - yMin));
-          y = (y * (yMax - yMin)) + yMin;
-          double  c = std::sqrt((u * u) + (v * v));
-          if (double(y) < (c - 0.05) || double(y) > (1.05 - c)) {
-            double  tmp = 0.5 / c;
-            if (double(y) < (c - 0.05))
-              tmp = tmp * (double(y) + c + 0.05);
-            else
-              tmp = tmp * ((1.05 + c) - double(y));
-            if (tmp < 0.0) {
-              u = 0.0f;
-              v = 0.0f;
-              c = 0.0;
-            }
-            else {
-              u = u * float(tmp);
-              v = v * float(tmp);
-              c = c * tmp;
-            }
-          }
-          y = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
-          y = float(std::pow(y, yGamma));
-          if (c > 0.000001) {
-            c = c * (1.0 / double(FLIConverter::defaultColorSaturation));
-            c = std::pow(c, double(colorSaturationPow)) / c;
-            u = float(c * u);
-            v = float(c * v);
-          }
-          if (haveAlpha) {
-            float   a = 0.0f;
-            if (pixelPtr)
-              a = float((unsigned char) pixelPtr[d - 1]) * (1.0f / 255.0f);
-            y = (y * a) + (borderY * (1.0f - a));
-            u = (u * a) + (borderU * (1.0f - a));
-            v = (v * a) + (borderV * (1.0f - a));
-          }
-          float   *ptr = &(inputImage[((yc * w) + xc) * 3]);
-          ptr[0] = y;
-          ptr[1] = u;
-          ptr[2] = v;
-        }
-      }
-      if (f) {
-        f->release();
-        f = (Fl_Shared_Image *) 0;
-      }
+      // input line converted to YUV, and output line
+      std::vector< float >  inBuf(size_t(w) * 3);
+      std::vector< float >  outBuf(size_t(width) * 3);
+      float   *inY = &(inBuf.front());
+      float   *inU = inY + w;
+      float   *inV = inU + w;
+      float   *outY = &(outBuf.front());
+      float   *outU = outY + width;
+      float   *outV = outU + width;
+      int     inLine = -1;
       // calculate X and Y scale
       float   aspectScale = (float(width) * pixelAspectRatio / float(height))
-                            / (float(int(w)) / float(int(h)));
-      float   xScale = float(int(w)) / float(width);
-      float   yScale = float(int(h)) / float(height);
+                            / (float(w) / float(h));
+      float   xScale = float(w) / float(width);
+      float   yScale = float(h) / float(height);
       if (aspectScale < 1.0f)
         yScale = yScale / aspectScale;
       else
@@ -790,90 +873,121 @@ namespace Plus4FLIConv {
         yScale_i = (yScale_i > 1 ? yScale_i : 1);
         xScale = 1.0f / float(xScale_i);
         yScale = 1.0f / float(yScale_i);
-        float   xOffs =
-            (float(int(w)) * 0.5f) - (float(width) * 0.5f * xScale);
-        float   yOffs =
-            (float(int(h)) * 0.5f) - (float(height) * 0.5f * yScale);
+        float   xOffs = (float(w) * 0.5f) - (float(width) * 0.5f * xScale);
+        float   yOffs = (float(h) * 0.5f) - (float(height) * 0.5f * yScale);
         xOffs = xOffs - (offsetX * xScale);
         yOffs = yOffs - (offsetY * yScale);
         int     xOffs_i = int(xOffs + (xOffs >= 0.0f ? 0.5f : -0.5f));
         int     yOffs_i = int(yOffs + (yOffs >= 0.0f ? 0.5f : -0.5f));
         // scale image to the specified width and height
         for (int yc = 0; yc < height; yc++) {
-          if (!setProgressPercentage((yc * 10 / height) + 90)) {
-            for (int tmpY = 0; tmpY < height; tmpY++) {
-              for (int tmpX = 0; tmpX < width; tmpX++) {
-                storePixelFunc(storePixelFuncUserData, tmpX, tmpY,
-                               borderY, borderU, borderV);
-              }
-            }
+          if (!setProgressPercentage(yc * 100 / height)) {
+            if (f)
+              releaseSharedImage(f);
+            storeBorderColorImage(borderY, borderU, borderV);
             progressMessage("");
             return false;
           }
           int     yi = (yc / yScale_i) + yOffs_i;
+          bool    yInRange = (yi >= 0 && yi < h);
+          if (yInRange && yi != inLine) {
+            convertInputLine(inY, inU, inV,
+                             (p ? (p + (size_t(yi) * size_t(w * d)))
+                                : (unsigned char *) 0),
+                             d,
+                             (p ? (uint16_t *) 0
+                                : &(pixelBuf[size_t(yi) * size_t(w)])),
+                             (p ? (uint32_t *) 0 : &(palette.front())),
+                             w, borderY, yGamma);
+            inLine = yi;
+          }
           for (int xc = 0; xc < width; xc++) {
             int     xi = (xc / xScale_i) + xOffs_i;
             float   y = borderY;
             float   u = borderU;
             float   v = borderV;
-            if (xi >= 0 && xi < int(w) && yi >= 0 && yi < int(h)) {
-              float   *ptr = &(inputImage[(yi * int(w) + xi) * 3]);
-              y = ptr[0];
-              u = ptr[1];
-              v = ptr[2];
+            if (xi >= 0 && xi < w && yInRange) {
+              y = inY[xi];
+              u = inU[xi];
+              v = inV[xi];
             }
-            y = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
-            u = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
-            v = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
-            storePixelFunc(storePixelFuncUserData, xc, yc, y, u, v);
+            outY[xc] = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
+            outU[xc] = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
+            outV[xc] = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
           }
+          storeRow(yc, outY, outU, outV);
         }
       }
       else {
         // ---- resize image with interpolation and anti-aliasing ----
-        float   xOffs =
-            (float(int(w)) * 0.5f) - (float(width) * 0.5f * xScale);
-        float   yOffs =
-            (float(int(h)) * 0.5f) - (float(height) * 0.5f * yScale);
+        // the filter is separable: each input line that is needed is
+        // resampled horizontally first, and the output lines are then
+        // calculated from these
+        float   xOffs = (float(w) * 0.5f) - (float(width) * 0.5f * xScale);
+        float   yOffs = (float(h) * 0.5f) - (float(height) * 0.5f * yScale);
         xOffs = xOffs - (offsetX * xScale);
         yOffs = yOffs - (offsetY * yScale);
-        // initialize interpolation window
-        windowX = new float[1025];
-        windowY = new float[1025];
-        for (int x = 0; x < 1025; x++) {
-          double  xf = double(x - 512) * (3.14159265 / 1024.0);
-          double  wx = std::cos(xf);
-          wx = wx * wx;
-          float   xs = (xScale <= 1.0f ? 1.0f : (1.0f / xScale));
-          xs = (xs > 0.2f ? xs : 0.2f);
-          xf = xf * 16.0 * xs;
-          if (xf < -0.000001 || xf > 0.000001)
-            wx = wx * std::sin(xf) / xf;
-          windowX[x] = float(wx * xs);
-        }
-        for (int y = 0; y < 1025; y++) {
-          double  yf = double(y - 512) * (3.14159265 / 1024.0);
-          double  wy = std::cos(yf);
-          wy = wy * wy;
-          float   ys = (yScale <= 1.0f ? 1.0f : (1.0f / yScale));
-          ys = (ys > 0.2f ? ys : 0.2f);
-          yf = yf * 16.0 * ys;
-          if (yf < -0.000001 || yf > 0.000001)
-            wy = wy * std::sin(yf) / yf;
-          windowY[y] = float(wy * ys);
+        // initialize interpolation windows
+        std::vector< float >  windowX;
+        std::vector< float >  windowY;
+        int     halfWidthX = 8;
+        int     halfWidthY = 8;
+        initializeResampleWindow(windowX, halfWidthX, xScale);
+        initializeResampleWindow(windowY, halfWidthY, yScale);
+        int     nTapsX = halfWidthX * 2;
+        int     nTapsY = halfWidthY * 2;
+        // filter coefficients and first input pixel for each output column
+        std::vector< float >  weightsX(size_t(width) * size_t(nTapsX));
+        std::vector< int >    firstX;
+        std::vector< float >  weightsY;
+        firstX.resize(size_t(width));
+        weightsY.resize(size_t(nTapsY));
+        // output of the horizontal filter for input lines outside the image
+        std::vector< float >  borderLine(size_t(width) * 3);
+        for (int xc = 0; xc < width; xc++) {
+          double  xf = double(xc) * xScale + xOffs;
+          int     xi = int(xf);
+          xf = xf - double(xi);
+          if (xf < 0.0) {
+            xf += 1.0;
+            xi--;
+          }
+          double  wxf = 63.999999 * (1.0 - xf);
+          int     wxi = int(wxf);
+          wxf = wxf - double(wxi);
+          float   xs0 = float(1.0 - wxf);
+          float   xs1 = float(wxf);
+          float   *wPtr = &(weightsX[size_t(xc) * size_t(nTapsX)]);
+          float   y = 0.0f;
+          float   u = 0.0f;
+          float   v = 0.0f;
+          for (int i = 0; i < nTapsX; i++) {
+            float   wsx = (windowX[wxi] * xs0) + (windowX[wxi + 1] * xs1);
+            wPtr[i] = wsx;
+            y += (borderY * wsx);
+            u += (borderU * wsx);
+            v += (borderV * wsx);
+            wxi = wxi + 64;
+          }
+          borderLine[xc] = y;
+          borderLine[width + xc] = u;
+          borderLine[(width * 2) + xc] = v;
+          // pixels that are entirely outside the image are set to the
+          // border color
+          if (xi < -1 || xi > w)
+            firstX[xc] = -0x40000000;
+          else
+            firstX[xc] = xi - (halfWidthX - 1);
         }
+        // horizontally resampled input lines, used as a ring buffer
+        std::vector< float >  lineBuf(size_t(nTapsY) * size_t(width) * 3);
+        std::vector< int >    lineBufTags(size_t(nTapsY), -1);
         // scale image to the specified width and height
         for (int yc = 0; yc < height; yc++) {
-          if (!setProgressPercentage((yc * 50 / height) + 50)) {
-            for (int tmpY = 0; tmpY < height; tmpY++) {
-              for (int tmpX = 0; tmpX < width; tmpX++) {
-                storePixelFunc(storePixelFuncUserData, tmpX, tmpY,
-                               borderY, borderU, borderV);
-              }
-            }
-            delete[] windowX;
-            delete[] windowY;
-            delete[] inputImage;
+          if (!setProgressPercentage(yc * 100 / height)) {
+            if (f)
+              releaseSharedImage(f);
+            storeBorderColorImage(borderY, borderU, borderV);
             progressMessage("");
             return false;
           }
@@ -884,102 +998,107 @@ namespace Plus4FLIConv {
             yf += 1.0;
             yi--;
           }
-          for (int xc = 0; xc < width; xc++) {
-            double  xf = double(xc) * xScale + xOffs;
-            int     xi = int(xf);
-            xf = xf - double(xi);
-            if (xf < 0.0) {
-              xf += 1.0;
-              xi--;
-            }
-            double  wxf = 63.999999 * (1.0 - xf);
-            double  wyf = 63.999999 * (1.0 - yf);
-            int     wxi = int(wxf);
-            wxf = wxf - double(wxi);
-            int     wyi = int(wyf);
-            wyf = wyf - double(wyi);
-            float   xs0 = float(1.0 - wxf);
-            float   xs1 = float(wxf);
-            float   ys0 = float(1.0 - wyf);
-            float   ys1 = float(wyf);
-            float   y = 0.0f;
-            float   u = 0.0f;
-            float   v = 0.0f;
-            if (xi >= 7 && xi < int(w - 8) && yi >= 7 && yi < int(h - 8)) {
-              // faster code for the case when no pixels are clipped
-              float   *ptr =
-                  &(inputImage[(((yi - 7) * int(w)) + (xi - 7)) * 3]);
-              for (int wy = -7; wy <= 8; wy++) {
-                float   wsy = (windowY[wyi] * ys0) + (windowY[wyi + 1] * ys1);
-                for (int wx = -7; wx <= 8; wx++) {
-                  float   wsx = (windowX[wxi] * xs0) + (windowX[wxi + 1] * xs1);
-                  float   w_ = wsx * wsy;
-                  y += (ptr[0] * w_);
-                  u += (ptr[1] * w_);
-                  v += (ptr[2] * w_);
-                  wxi = wxi + 64;
-                  ptr = ptr + 3;
+          double  wyf = 63.999999 * (1.0 - yf);
+          int     wyi = int(wyf);
+          wyf = wyf - double(wyi);
+          float   ys0 = float(1.0 - wyf);
+          float   ys1 = float(wyf);
+          for (int i = 0; i < nTapsY; i++) {
+            weightsY[i] = (windowY[wyi] * ys0) + (windowY[wyi + 1] * ys1);
+            wyi = wyi + 64;
+          }
+          for (int xc = 0; xc < (width * 3); xc++)
+            outY[xc] = 0.0f;
+          if (yi >= -1 && yi <= h) {
+            for (int i = 0; i < nTapsY; i++) {
+              int     y_ = yi - (halfWidthY - 1) + i;
+              const float *srcPtr = &(borderLine.front());
+              if (y_ >= 0 && y_ < h) {
+                float   *linePtr =
+                    &(lineBuf[size_t(y_ % nTapsY) * size_t(width) * 3]);
+                if (lineBufTags[y_ % nTapsY] != y_) {
+                  // resample input line horizontally
+                  convertInputLine(inY, inU, inV,
+                                   (p ? (p + (size_t(y_) * size_t(w * d)))
+                                      : (unsigned char *) 0),
+                                   d,
+                                   (p ? (uint16_t *) 0
+                                      : &(pixelBuf[size_t(y_) * size_t(w)])),
+                                   (p ? (uint32_t *) 0 : &(palette.front())),
+                                   w, borderY, yGamma);
+                  for (int xc = 0; xc < width; xc++) {
+                    const float *wPtr =
+                        &(weightsX[size_t(xc) * size_t(nTapsX)]);
+                    int     x0 = firstX[xc];
+                    float   y = 0.0f;
+                    float   u = 0.0f;
+                    float   v = 0.0f;
+                    if (x0 >= 0 && (x0 + nTapsX) <= w) {
+                      // faster code for the case when no pixels are clipped
+                      for (int j = 0; j < nTapsX; j++) {
+                        y += (inY[x0 + j] * wPtr[j]);
+                        u += (inU[x0 + j] * wPtr[j]);
+                        v += (inV[x0 + j] * wPtr[j]);
+                      }
+                    }
+                    else if (x0 > -0x40000000) {
+                      for (int j = 0; j < nTapsX; j++) {
+                        int     x_ = x0 + j;
+                        if (x_ < 0 || x_ >= w) {
+                          y += (borderY * wPtr[j]);
+                          u += (borderU * wPtr[j]);
+                          v += (borderV * wPtr[j]);
+                        }
+                        else {
+                          y += (inY[x_] * wPtr[j]);
+                          u += (inU[x_] * wPtr[j]);
+                          v += (inV[x_] * wPtr[j]);
+                        }
+                      }
+                    }
+                    linePtr[xc] = y;
+                    linePtr[width + xc] = u;
+                    linePtr[(width * 2) + xc] = v;
+                  }
+                  lineBufTags[y_ % nTapsY] = y_;
                 }
-                wxi = wxi - 1024;
-                wyi = wyi + 64;
-                ptr = ptr + ((int(w) - 16) * 3);
+                srcPtr = linePtr;
               }
+              // vertical filter
+              float   wsy = weightsY[i];
+              for (int xc = 0; xc < (width * 3); xc++)
+                outY[xc] += (srcPtr[xc] * wsy);
             }
-            else if (xi < -1 || xi > int(w) || yi < -1 || yi > int(h)) {
+          }
+          for (int xc = 0; xc < width; xc++) {
+            float   y = outY[xc];
+            float   u = outU[xc];
+            float   v = outV[xc];
+            if (yi < -1 || yi > h || firstX[xc] <= -0x40000000) {
               y = borderY;
               u = borderU;
               v = borderV;
             }
-            else {
-              for (int wy = -7; wy <= 8; wy++) {
-                float   wsy = (windowY[wyi] * ys0) + (windowY[wyi + 1] * ys1);
-                for (int wx = -7; wx <= 8; wx++) {
-                  int     x_ = xi + wx;
-                  int     y_ = yi + wy;
-                  float   wsx = (windowX[wxi] * xs0) + (windowX[wxi + 1] * xs1);
-                  float   w_ = wsx * wsy;
-                  if (x_ < 0 || x_ >= int(w) || y_ < 0 || y_ >= int(h)) {
-                    y += (borderY * w_);
-                    u += (borderU * w_);
-                    v += (borderV * w_);
-                  }
-                  else {
-                    float   *ptr = &(inputImage[((y_ * int(w)) + x_) * 3]);
-                    y += (ptr[0] * w_);
-                    u += (ptr[1] * w_);
-                    v += (ptr[2] * w_);
-                  }
-                  wxi = wxi + 64;
-                }
-                wxi = wxi - 1024;
-                wyi = wyi + 64;
-              }
-            }
-            y = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
-            u = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
-            v = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
-            storePixelFunc(storePixelFuncUserData, xc, yc, y, u, v);
+            outY[xc] = (y > 0.0f ? (y < 1.0f ? y : 1.0f) : 0.0f);
+            outU[xc] = (u > -0.436f ? (u < 0.436f ? u : 0.436f) : -0.436f);
+            outV[xc] = (v > -0.615f ? (v < 0.615f ? v : 0.615f) : -0.615f);
           }
+          storeRow(yc, outY, outU, outV);
         }
       }
-      delete[] windowX;
-      delete[] windowY;
-      delete[] inputImage;
+      if (f) {
+        releaseSharedImage(f);
+        f = (Fl_Shared_Image *) 0;
+      }
       setProgressPercentage(100);
       progressMessage("");
       char    tmpBuf[64];
-      std::sprintf(&(tmpBuf[0]), "Loaded %dx%d image", int(w), int(h));
+      std::sprintf(&(tmpBuf[0]), "Loaded %dx%d image", w, h);
       progressMessage(&(tmpBuf[0]));
     }
     catch (...) {
-      if (windowX)
-        delete[] windowX;
-      if (windowY)
-        delete[] windowY;
-      if (inputImage)
-        delete[] inputImage;
       if (f)
-        f->release();
+        releaseSharedImage(f);
       progressMessage("");
       throw;
     }
@@ -49,6 +49,10 @@ namespace Plus4FLIConv {
     void    (*storePixelFunc)(void *userData, int xc, int yc,
                               float y, float u, float v);
     void    *storePixelFuncUserData;
+    void    (*storeRowFunc)(void *userData, int yc,
+                            const float *y, const float *u, const float *v,
+                            int w);
+    void    *storeRowFuncUserData;
     void    (*progressMessageCallback)(void *userData, const char *msg);
     void    *progressMessageUserData;
     bool    (*progressPercentageCallback)(void *userData, int n);
@@ -63,6 +67,18 @@ namespace Plus4FLIConv {
     bool convertPlus4ColormapImage(const std::vector< uint16_t >& pixelBuf,
                                    const std::vector< uint32_t >& colorMap,
                                    int w, int h);
+    // convert 'n' pixels of RGB, greyscale ('d' = 1 to 4 bytes per pixel),
+    // or colormap ('pixelData' is NULL) input to YUV
+    void convertInputLine(float *bufY, float *bufU, float *bufV,
+                          const unsigned char *pixelData, int d,
+                          const uint16_t *pixelIndices,
+                          const uint32_t *palette, int n,
+                          float borderY, float yGamma);
+    static void initializeResampleWindow(std::vector< float >& windowBuf,
+                                         int& halfWidth, float scale);
+    void storeRow(int yc, const float *bufY,
+                  const float *bufU, const float *bufV);
+    void storeBorderColorImage(float y, float u, float v);
    public:
     YUVImageConverter();
     virtual ~YUVImageConverter();
@@ -120,6 +136,21 @@ namespace Plus4FLIConv {
     {
       storePixelFunc = func;
       storePixelFuncUserData = userData_;
+      storeRowFunc = (void (*)(void *, int, const float *, const float *,
+                               const float *, int)) 0;
+      storeRowFuncUserData = (void *) 0;
+    }
+    // set a function to be called with each line of 'w' pixels of the
+    // converted image (Y, U, and V in separate arrays), this is used
+    // instead of the pixel store callback until that is set again
+    inline void setRowStoreCallback(void (*func)(void *userData, int yc,
+                                                 const float *y,
+                                                 const float *u,
+                                                 const float *v, int w),
+                                    void *userData_)
+    {
+      storeRowFunc = func;
+      storeRowFuncUserData = userData_;
     }
     void setProgressMessageCallback(void (*func)(void *userData,
                                                  const char *msg),
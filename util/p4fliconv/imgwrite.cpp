@@ -45,6 +45,19 @@ static bool defaultProgressPercentageCb(void *userData, int n)
   return true;
 }
 
+static void quietProgressMessageCb(void *userData, const char *msg)
+{
+  (void) userData;
+  (void) msg;
+}
+
+static bool quietProgressPercentageCb(void *userData, int n)
+{
+  (void) userData;
+  (void) n;
+  return true;
+}
+
 namespace Plus4FLIConv {
 
   void writeConvertedImageFile(
@@ -262,5 +275,124 @@ namespace Plus4FLIConv {
     }
   }
 
+  // --------------------------------------------------------------------------
+
+  ImageSequenceWriter::ImageSequenceWriter(const char *fileName_,
+                                           int compressionType_,
+                                           int compressionLevel_)
+    : f((std::FILE *) 0),
+      compressionType(compressionType_),
+      compressionLevel(compressionLevel_),
+      prvFrameStartAddr(0U),
+      frameCnt(0)
+  {
+    if (fileName_ == (char *) 0 || fileName_[0] == '\0')
+      throw Plus4Emu::Exception("invalid file name");
+    if (compressionType < 0 || compressionType > 2)
+      throw Plus4Emu::Exception("invalid compression type");
+    if (compressionLevel < 1 || compressionLevel > 9)
+      throw Plus4Emu::Exception("invalid compression level");
+    fileName = fileName_;
+    f = Plus4Emu::fileOpen(fileName_, "wb");
+    if (!f)
+      throw Plus4Emu::Exception("error opening sequence file");
+  }
+
+  ImageSequenceWriter::~ImageSequenceWriter()
+  {
+    if (f) {
+      std::fclose(f);
+      Plus4Emu::fileRemove(fileName.c_str());
+    }
+  }
+
+  void ImageSequenceWriter::writeFrame(PRGData& prgData,
+                                       unsigned int prgEndAddr)
+  {
+    if (!f)
+      throw Plus4Emu::Exception("sequence file is not open");
+    unsigned int  startAddr = prgData.getImageDataStartAddress();
+    if (prgEndAddr <= startAddr || prgEndAddr > 0x10000U)
+      throw Plus4Emu::Exception("invalid image data end address");
+    size_t  nBytes = prgEndAddr - startAddr;
+    bool    fullFrame = (startAddr != prvFrameStartAddr ||
+                         nBytes != prvFrameData.size());
+    std::vector< unsigned char >  frameData(nBytes);
+    for (size_t i = 0; i < nBytes; i++)
+      frameData[i] = prgData[long(startAddr - 0x0FFFU) + long(i)];
+    // find the changed areas, merging those that are separated by fewer
+    // unchanged bytes than the overhead of starting a new block
+    std::vector< size_t > spans;
+    if (fullFrame) {
+      spans.push_back(0);
+      spans.push_back(nBytes);
+    }
+    else {
+      for (size_t i = 0; i < nBytes; i++) {
+        if (frameData[i] == prvFrameData[i])
+          continue;
+        if (spans.size() > 0 && (i - spans.back()) < 32)
+          spans.back() = i + 1;
+        else {
+          spans.push_back(i);
+          spans.push_back(i + 1);
+        }
+      }
+    }
+    std::vector< unsigned char >  outBuf;
+    if (spans.size() > 0) {
+      Plus4Compress::Compressor *compress_ =
+          Plus4Compress::createCompressor(compressionType, outBuf);
+      try {
+        compress_->setCompressionLevel(compressionLevel);
+        compress_->setProgressMessageCallback(&quietProgressMessageCb,
+                                              (void *) 0);
+        compress_->setProgressPercentageCallback(&quietProgressPercentageCb,
+                                                 (void *) 0);
+        std::vector< unsigned char >  inBuf;
+        for (size_t i = 0; i < spans.size(); i += 2) {
+          inBuf.assign(frameData.begin() + spans[i],
+                       frameData.begin() + spans[i + 1]);
+          compress_->compressData(inBuf,
+                                  (unsigned int) (startAddr + spans[i]),
+                                  (i + 2) >= spans.size(), false);
+        }
+      }
+      catch (...) {
+        delete compress_;
+        throw;
+      }
+      delete compress_;
+      if (outBuf.size() < 1 || outBuf.size() > 0xFFFF)
+        throw Plus4Emu::Exception("error compressing sequence frame");
+    }
+    if (std::fputc(int(outBuf.size() >> 8), f) == EOF ||
+        std::fputc(int(outBuf.size() & 0xFF), f) == EOF) {
+      throw Plus4Emu::Exception("error writing sequence file");
+    }
+    if (outBuf.size() > 0) {
+      if (std::fwrite(&(outBuf.front()), sizeof(unsigned char), outBuf.size(),
+                      f) != outBuf.size()) {
+        throw Plus4Emu::Exception("error writing sequence file "
+                                  "- is the disk full ?");
+      }
+    }
+    prvFrameData.swap(frameData);
+    prvFrameStartAddr = startAddr;
+    frameCnt++;
+  }
+
+  void ImageSequenceWriter::closeFile()
+  {
+    if (!f)
+      return;
+    if (std::fflush(f) != 0) {
+      throw Plus4Emu::Exception("error writing sequence file "
+                                "- is the disk full ?");
+    }
+    std::fclose(f);
+    f = (std::FILE *) 0;
+  }
+
 }       // namespace Plus4FLIConv
 
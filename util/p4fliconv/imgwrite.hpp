@@ -26,6 +26,8 @@
 #include "plus4emu.hpp"
 #include "prgdata.hpp"
 
+#include <vector>
+
 namespace Plus4FLIConv {
 
   /*!
@@ -63,6 +65,43 @@ namespace Plus4FLIConv {
           (bool (*)(void *, int)) 0,
       void *progressCallbackUserData = (void *) 0);
 
+  /*!
+   * Writes the converted frames of an animation to a single file, storing
+   * only the memory areas that have changed since the previous frame.
+   * Each frame is a 2 byte (high byte first) length, followed by that many
+   * bytes of compressed data in the format selected by 'compressionType'
+   * (0 to 2), which consists of one block with its own start address for
+   * each changed area of the image data. The first frame, and any frame
+   * with a different size or start address than the previous one, is
+   * stored in full. A zero length means that the frame is the same as the
+   * previous one.
+   * If an error occurs, std::exception is thrown.
+   */
+  class ImageSequenceWriter {
+   private:
+    std::FILE     *f;
+    std::string   fileName;
+    int           compressionType;
+    int           compressionLevel;
+    std::vector< unsigned char >  prvFrameData;
+    unsigned int  prvFrameStartAddr;
+    size_t        frameCnt;
+   public:
+    ImageSequenceWriter(const char *fileName_,
+                        int compressionType_, int compressionLevel_);
+    virtual ~ImageSequenceWriter();
+    // append the image in 'prgData' from its image data start address
+    // to 'prgEndAddr' (exclusive) to the file
+    void writeFrame(PRGData& prgData, unsigned int prgEndAddr);
+    // flush and close the file; if this is not called, the destructor
+    // removes the incomplete file
+    void closeFile();
+    inline size_t getFrameCount() const
+    {
+      return frameCnt;
+    }
+  };
+
 }       // namespace Plus4FLIConv
 
 #endif  // P4FLICONV_IMGWRITE_HPP
@@ -183,16 +183,26 @@ namespace Plus4FLIConv {
     delete[] paletteY;
   }
 
-  void P4FLI_Interlace7::pixelStoreCallback(void *userData, int xc, int yc,
-                                            float y, float u, float v)
+  bool P4FLI_Interlace7::isPreviousFrameReuseSupported() const
+  {
+    return true;
+  }
+
+  void P4FLI_Interlace7::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     P4FLI_Interlace7&  this_ =
         *(reinterpret_cast<P4FLI_Interlace7 *>(userData));
-    if (!this_.enable40ColumnMode)
-      xc = xc + 16;
-    this_.resizedImage.y()[yc][xc >> 1] += (y * 0.5f);
-    this_.resizedImage.u()[yc][xc >> 1] += (u * 0.5f);
-    this_.resizedImage.v()[yc][xc >> 1] += (v * 0.5f);
+    int     xOffs = (this_.enable40ColumnMode ? 0 : 16);
+    Line320& lineY = this_.resizedImage.y()[yc];
+    Line320& lineU = this_.resizedImage.u()[yc];
+    Line320& lineV = this_.resizedImage.v()[yc];
+    for (int xc = 0; xc < w; xc++) {
+      lineY[(xc + xOffs) >> 1] += (y[xc] * 0.5f);
+      lineU[(xc + xOffs) >> 1] += (u[xc] * 0.5f);
+      lineV[(xc + xOffs) >> 1] += (v[xc] * 0.5f);
+    }
   }
 
   void P4FLI_Interlace7::colorToUV(int c, float& u, float& v)
@@ -350,31 +360,8 @@ namespace Plus4FLIConv {
     if (pixelValueDithered > pixelValue1)
       pixelValueDithered = pixelValue1;
     double  err = double(pixelValueDithered) - double(newPixelValue);
-    const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-    switch (ditherMode) {
-    case 3:
-      errMultTbl = &(ditherTable_Jarvis[0]);
-      break;
-    case 4:
-      errMultTbl = &(ditherTable_Stucki[0]);
-      break;
-    case 5:
-      errMultTbl = &(ditherTable_Sierra2[0]);
-      break;
-    }
-    for (int i = 0; i < 12; i++) {
-      if (errMultTbl[i + 1] == 0)
-        continue;
-      long    yc_ = yc + ((i + 3) / 5);
-      if (yc_ >= 496L)
-        break;
-      long    xc_ = ((i + 3) % 5) - 2;
-      xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-      float   tmp = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-      ditherErrorImage.y()[yc_].setPixel(xc_,
-                                         ditherErrorImage.y()[yc_].getPixel(xc_)
-                                         + (float(err) * tmp));
-    }
+    diffuseDitherError(ditherMode, ditherErrorImage.y(), xc, yc, 320L, 496L,
+                       float(err));
   }
 
   inline double P4FLI_Interlace7::calculateLuminanceError(float n,
@@ -540,9 +527,10 @@ namespace Plus4FLIConv {
     return err;
   }
 
-  void P4FLI_Interlace7::findAttributes_YUVMode(PRGData& prgData,
-                                                long xc, long yc,
-                                                int& randomSeed)
+  double P4FLI_Interlace7::findAttributes_YUVMode(PRGData& prgData,
+                                                  long xc, long yc,
+                                                  int& randomSeed,
+                                                  const int *prvColors)
   {
     xc = xc & (~(long(7)));
     yc = yc & (~(long(3)));
@@ -607,11 +595,25 @@ namespace Plus4FLIConv {
     int     bestColor0_1 = 0;
     int     bestColor1_1 = 0;
     double  bestError = 1000000.0;
-    for (int l = 0; l < conversionQuality; l++) {
-      int     color0_0 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
-      int     color1_0 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
-      int     color0_1 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
-      int     color1_1 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
+    // pass -1 starts from the colors of the previous frame
+    for (int l = (prvColors ? -1 : 0);
+         l < (prvColors ? 0 : conversionQuality); l++) {
+      int     color0_0 = 0;
+      int     color1_0 = 0;
+      int     color0_1 = 0;
+      int     color1_1 = 0;
+      if (l < 0) {
+        color0_0 = prvColors[0];
+        color1_0 = prvColors[1];
+        color0_1 = prvColors[2];
+        color1_1 = prvColors[3];
+      }
+      else {
+        color0_0 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
+        color1_0 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
+        color0_1 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
+        color1_1 = Plus4Emu::getRandomNumber(randomSeed) & 0x7F;
+      }
       if ((color0_0 & 0x0F) == 0)
         color0_0 = 0;
       else if (luminance1BitMode)
@@ -787,6 +789,12 @@ namespace Plus4FLIConv {
         bestError = minErr;
       }
     }
+    int     *colorParams =
+        getFrameParams(size_t(((yc >> 2) * 40) + (xc >> 3)));
+    colorParams[0] = bestColor0_0;
+    colorParams[1] = bestColor1_0;
+    colorParams[2] = bestColor0_1;
+    colorParams[3] = bestColor1_1;
     // store luminance and color codes
     int     l0_0 = (bestColor0_0 & 0x70) >> 4;
     int     l1_0 = (bestColor1_0 & 0x70) >> 4;
@@ -820,6 +828,7 @@ namespace Plus4FLIConv {
     prgData.l1(xc, yc + 1L) = l1_1;
     prgData.c0(xc, yc + 1L) = c0_1;
     prgData.c1(xc, yc + 1L) = c1_1;
+    return bestError;
   }
 
   void P4FLI_Interlace7::generateBitmaps(PRGData& prgData)
@@ -952,41 +961,16 @@ namespace Plus4FLIConv {
       float   errY = y - paletteY[c];
       float   errU = u - paletteU[c];
       float   errV = v - paletteV[c];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < long(nLines) && xc_ >= 0L && xc_ < 320L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage.y()[yc_].setPixel(
-              xc_, ditherErrorImage.y()[yc_].getPixel(xc_) + (errY * errMult));
-          ditherErrorImage.u()[yc_].setPixel(
-              xc_, ditherErrorImage.u()[yc_].getPixel(xc_) + (errU * errMult));
-          ditherErrorImage.v()[yc_].setPixel(
-              xc_, ditherErrorImage.v()[yc_].getPixel(xc_) + (errV * errMult));
-        }
-      }
+      diffuseDitherErrorYUV(ditherMode, ditherErrorImage,
+                            xc, yc, 320L, long(nLines), errY, errU, errV);
       if (yc & 1L)
         xc = 319L - xc;
     }
   }
 
   void P4FLI_Interlace7::findColorCodes(PRGData& prgData,
-                                        long xc, long yc, int dir_)
+                                        long xc, long yc, int dir_,
+                                        const int *prvParams)
   {
     bool    oddField = bool(yc & 1L);
     float   savedU0[9];
@@ -1007,124 +991,162 @@ namespace Plus4FLIConv {
     double  minColorErr = 1000000.0;
     int     colorCnt =
         (colorInterlaceMode == 0 ? 15 : (colorInterlaceMode == 2 ? 43 : 29));
-    for (int i0 = 0; i0 < colorCnt; i0++) {
-      for (int i1 = 0; i1 < colorCnt; i1++) {
-        int     c0tmp = 0;
-        int     c1tmp = 0;
-        double  err = 0.0;
-        float   u0 = 0.0f;
-        float   v0 = 0.0f;
-        float   u1 = 0.0f;
-        float   v1 = 0.0f;
-        {
-          double  err0 = 0.0;
-          double  err1 = 0.0;
-          if (l0 > 0) {
-            c0tmp = (oddField ? uvTable[i0].c1 : uvTable[i0].c0);
-            u0 = uvTable[i0].u;
-            v0 = uvTable[i0].v;
-            err0 = uvTable[i0].err;
-          }
-          if (l1 > 0) {
-            c1tmp = (oddField ? uvTable[i1].c1 : uvTable[i1].c0);
-            u1 = uvTable[i1].u;
-            v1 = uvTable[i1].v;
-            err1 = uvTable[i1].err;
-          }
-          for (int x = 0; x < 9; x++) {
-            bool    b = prgData.getPixel(xc + ((x <= 7 ? x : 7) * dir_), yc);
-            float   u_ = (b ? u1 : u0);
-            float   v_ = (b ? v1 : v0);
-            if (x < 8)
-              err += (b ? err1 : err0);
-            line0U.setPixelShifted(xc + (x * dir_), u_);
-            line0V.setPixelShifted(xc + (x * dir_), v_);
-            b = prgData.getPixel(xc + ((x <= 7 ? x : 7) * dir_), yc + 2L);
-            u_ = (b ? u1 : u0);
-            v_ = (b ? v1 : v0);
-            if (x < 8)
-              err += (b ? err1 : err0);
-            line1U.setPixelShifted(xc + (x * dir_), u_);
-            line1V.setPixelShifted(xc + (x * dir_), v_);
-          }
+    // the UV table indexes of each character are stored after the X shifts
+    // of the four line group, with a separate error for each character
+    size_t  unitNum = size_t(yc >> 2);
+    size_t  errNum = size_t(1L + ((yc & 1L) * 40L) + (xc >> 3));
+    size_t  n = (errNum << 1) + 2;
+    int     bestI0 = 0;
+    int     bestI1 = 0;
+    bool    prvColorsUsed = false;
+    for (int k = (prvParams ? -1 : 0); k < (colorCnt * colorCnt); k++) {
+      int     i0 = k / colorCnt;
+      int     i1 = k % colorCnt;
+      if (k < 0) {
+        // try the colors of the previous frame first
+        i0 = prvParams[n];
+        i1 = prvParams[n + 1];
+      }
+      else if (prvParams && i0 == prvParams[n] && i1 == prvParams[n + 1]) {
+        continue;
+      }
+      int     c0tmp = 0;
+      int     c1tmp = 0;
+      double  err = 0.0;
+      float   u0 = 0.0f;
+      float   v0 = 0.0f;
+      float   u1 = 0.0f;
+      float   v1 = 0.0f;
+      {
+        double  err0 = 0.0;
+        double  err1 = 0.0;
+        if (l0 > 0) {
+          c0tmp = (oddField ? uvTable[i0].c1 : uvTable[i0].c0);
+          u0 = uvTable[i0].u;
+          v0 = uvTable[i0].v;
+          err0 = uvTable[i0].err;
+        }
+        if (l1 > 0) {
+          c1tmp = (oddField ? uvTable[i1].c1 : uvTable[i1].c0);
+          u1 = uvTable[i1].u;
+          v1 = uvTable[i1].v;
+          err1 = uvTable[i1].err;
         }
-        for (int j = 0; j < 16; j++) {
-          int     x = j & 7;
-          Line320 *l0U = (j < 8 ? (&line0U) : (&line1U));
-          Line320 *l0V = (j < 8 ? (&line0V) : (&line1V));
-          float   u_ = l0U->getPixelShifted(xc + (x * dir_));
-          float   v_ = l0V->getPixelShifted(xc + (x * dir_));
-          if (!disablePAL) {
-            // assume PAL filtering if requested
-            Line320 *lm1U = (j < 8 ? (&prvLineU) : (&line0U));
-            Line320 *lm1V = (j < 8 ? (&prvLineV) : (&line0V));
-            u_ += lm1U->getPixelShifted(xc + (x * dir_));
-            v_ += lm1V->getPixelShifted(xc + (x * dir_));
-            u_ *= 0.96f;
-            v_ *= 0.96f;
-            u_ += (l0U->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
-            v_ += (l0V->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
-            u_ += (l0U->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
-            v_ += (l0V->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
-            u_ += (lm1U->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
-            v_ += (lm1V->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
-            u_ += (lm1U->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
-            v_ += (lm1V->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
-            u_ *= 0.25f;
-            v_ *= 0.25f;
+        for (int x = 0; x < 9; x++) {
+          bool    b = prgData.getPixel(xc + ((x <= 7 ? x : 7) * dir_), yc);
+          float   u_ = (b ? u1 : u0);
+          float   v_ = (b ? v1 : v0);
+          if (x < 8)
+            err += (b ? err1 : err0);
+          line0U.setPixelShifted(xc + (x * dir_), u_);
+          line0V.setPixelShifted(xc + (x * dir_), v_);
+          b = prgData.getPixel(xc + ((x <= 7 ? x : 7) * dir_), yc + 2L);
+          u_ = (b ? u1 : u0);
+          v_ = (b ? v1 : v0);
+          if (x < 8)
+            err += (b ? err1 : err0);
+          line1U.setPixelShifted(xc + (x * dir_), u_);
+          line1V.setPixelShifted(xc + (x * dir_), v_);
+        }
+      }
+      for (int j = 0; j < 16; j++) {
+        int     x = j & 7;
+        Line320 *l0U = (j < 8 ? (&line0U) : (&line1U));
+        Line320 *l0V = (j < 8 ? (&line0V) : (&line1V));
+        float   u_ = l0U->getPixelShifted(xc + (x * dir_));
+        float   v_ = l0V->getPixelShifted(xc + (x * dir_));
+        if (!disablePAL) {
+          // assume PAL filtering if requested
+          Line320 *lm1U = (j < 8 ? (&prvLineU) : (&line0U));
+          Line320 *lm1V = (j < 8 ? (&prvLineV) : (&line0V));
+          u_ += lm1U->getPixelShifted(xc + (x * dir_));
+          v_ += lm1V->getPixelShifted(xc + (x * dir_));
+          u_ *= 0.96f;
+          v_ *= 0.96f;
+          u_ += (l0U->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
+          v_ += (l0V->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
+          u_ += (l0U->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
+          v_ += (l0V->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
+          u_ += (lm1U->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
+          v_ += (lm1V->getPixelShifted(xc + ((x - 1) * dir_)) * 0.52f);
+          u_ += (lm1U->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
+          v_ += (lm1V->getPixelShifted(xc + ((x + 1) * dir_)) * 0.52f);
+          u_ *= 0.25f;
+          v_ *= 0.25f;
+        }
+        float   u = resizedImage.u()[yc + ((j & 8) >> 2)].getPixelShifted(
+                        xc + (x * dir_));
+        float   v = resizedImage.v()[yc + ((j & 8) >> 2)].getPixelShifted(
+                        xc + (x * dir_));
+        if (disablePAL && l0 == l1) {
+          if ((calculateErrorSqr(u1, u) + calculateErrorSqr(v1, v))
+              < (calculateErrorSqr(u0, u) + calculateErrorSqr(v0, v))) {
+            u_ = u1;
+            v_ = v1;
           }
-          float   u = resizedImage.u()[yc + ((j & 8) >> 2)].getPixelShifted(
-                          xc + (x * dir_));
-          float   v = resizedImage.v()[yc + ((j & 8) >> 2)].getPixelShifted(
-                          xc + (x * dir_));
-          if (disablePAL && l0 == l1) {
-            if ((calculateErrorSqr(u1, u) + calculateErrorSqr(v1, v))
-                < (calculateErrorSqr(u0, u) + calculateErrorSqr(v0, v))) {
-              u_ = u1;
-              v_ = v1;
-            }
-            else {
-              u_ = u0;
-              v_ = v0;
-            }
+          else {
+            u_ = u0;
+            v_ = v0;
           }
-          err = err + calculateErrorSqr(u_, u) + calculateErrorSqr(v_, v);
-          if (err > (minColorErr * 1.000001))
-            break;
         }
-        if (err < minColorErr) {
-          c0 = c0tmp;
-          c1 = c1tmp;
-          minColorErr = err;
-          if (disablePAL && l0 == l1) {
-            for (int l = 0; l < 2; l++) {
-              for (int x = 0; x < 8; x++) {
-                long    xc_ = xc + (x * dir_);
-                long    yc_ = yc + (l << 1);
-                float   u = resizedImage.u()[yc_].getPixelShifted(xc_);
-                float   v = resizedImage.v()[yc_].getPixelShifted(xc_);
-                prgData.setPixel(xc_, yc_,
-                                 ((calculateErrorSqr(u1, u)
-                                   + calculateErrorSqr(v1, v))
-                                  < (calculateErrorSqr(u0, u)
-                                     + calculateErrorSqr(v0, v))));
-              }
+        err = err + calculateErrorSqr(u_, u) + calculateErrorSqr(v_, v);
+        if (err > (minColorErr * 1.000001))
+          break;
+      }
+      if (err < minColorErr) {
+        c0 = c0tmp;
+        c1 = c1tmp;
+        bestI0 = i0;
+        bestI1 = i1;
+        minColorErr = err;
+        if (disablePAL && l0 == l1) {
+          for (int l = 0; l < 2; l++) {
+            for (int x = 0; x < 8; x++) {
+              long    xc_ = xc + (x * dir_);
+              long    yc_ = yc + (l << 1);
+              float   u = resizedImage.u()[yc_].getPixelShifted(xc_);
+              float   v = resizedImage.v()[yc_].getPixelShifted(xc_);
+              prgData.setPixel(xc_, yc_,
+                               ((calculateErrorSqr(u1, u)
+                                 + calculateErrorSqr(v1, v))
+                                < (calculateErrorSqr(u0, u)
+                                   + calculateErrorSqr(v0, v))));
             }
           }
         }
-        else {
+      }
+      else {
+        for (int i = 0; i < 9; i++) {
+          line0U.setPixelShifted(xc + (i * dir_), savedU0[i]);
+          line0V.setPixelShifted(xc + (i * dir_), savedV0[i]);
+          line1U.setPixelShifted(xc + (i * dir_), savedU1[i]);
+          line1V.setPixelShifted(xc + (i * dir_), savedV1[i]);
+        }
+      }
+      if (k < 0) {
+        // keep the colors of the previous frame if the error is not much
+        // worse than that of the last full search
+        if (checkPrvFrameError(unitNum, minColorErr, errNum)) {
+          // leave the U and V lines as the full search would, which
+          // restores them after the last (normally not the best) pair
           for (int i = 0; i < 9; i++) {
             line0U.setPixelShifted(xc + (i * dir_), savedU0[i]);
             line0V.setPixelShifted(xc + (i * dir_), savedV0[i]);
             line1U.setPixelShifted(xc + (i * dir_), savedU1[i]);
             line1V.setPixelShifted(xc + (i * dir_), savedV1[i]);
           }
+          prvColorsUsed = true;
+          break;
         }
       }
     }
+    if (!prvColorsUsed)
+      setFrameError(unitNum, minColorErr, errNum);
     // store color codes
     prgData.c0(xc, yc) = c0;
     prgData.c1(xc, yc) = c1;
+    getFrameParams(unitNum)[n] = bestI0;
+    getFrameParams(unitNum)[n + 1] = bestI1;
   }
 
   bool P4FLI_Interlace7::processImage(PRGData& prgData,
@@ -1188,9 +1210,24 @@ namespace Plus4FLIConv {
       line1V.setBorderColor(borderV);
       imgConv.setImageSize((enable40ColumnMode ? 640 : 608), nLines);
       imgConv.setPixelAspectRatio(1.0f);
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       progressMessage("Calculating FLI data");
+      // the units of previous frame reuse are groups of four lines with the
+      // X shifts and UV table indexes as parameters, or 8x4 blocks with the
+      // colors in YUV mode
+      if (luminanceSearchMode != 6)
+        beginFrame(size_t(nLines >> 2), 4 + 160, 320 * 4,
+                   (xShift0 & 0xFF) | ((xShift1 & 0xFF) << 8)
+                   | (luminanceSearchMode << 16)
+                   | (int(noLuminanceInterlace) << 19)
+                   | (int(luminance1BitMode) << 20)
+                   | (colorInterlaceMode << 21) | (int(disablePAL) << 23),
+                   1 + 80);
+      else
+        beginFrame(size_t((nLines >> 2) * 40), 4, 8 * 4,
+                   (luminanceSearchMode << 16)
+                   | (int(luminance1BitMode) << 20));
       for (int yc = 0; yc < nLines; yc += 2) {
         for (int xc = 0; xc < 320; xc++) {
           if (disableInterlace) {
@@ -1243,6 +1280,19 @@ namespace Plus4FLIConv {
           resizedImage.y()[yc][xc] =
               float(std::pow(double(resizedImage.y()[yc][xc]),
                              (luminanceSearchMode != 6 ? 0.704 : 0.7272727)));
+          if (luminanceSearchMode != 6) {
+            storeFramePixel(size_t(yc >> 2), size_t(((yc & 3) * 320) + xc),
+                            resizedImage.y()[yc][xc],
+                            resizedImage.u()[yc][xc],
+                            resizedImage.v()[yc][xc]);
+          }
+          else {
+            storeFramePixel(size_t(((yc >> 2) * 40) + (xc >> 3)),
+                            size_t(((yc & 3) << 3) + (xc & 7)),
+                            resizedImage.y()[yc][xc],
+                            resizedImage.u()[yc][xc],
+                            resizedImage.v()[yc][xc]);
+          }
         }
       }
       if (luminanceSearchMode != 6) {
@@ -1263,66 +1313,99 @@ namespace Plus4FLIConv {
               findLuminanceCodes(prgData, xc, yc);
           }
           else if (!(yc & 3)) {
-            // find optimal horizontal shifts
-            double  minErr = 1000000.0;
-            int     bestXShift[4];
-            int     xs[4];
-            for (int i = 0; i < 4; i++) {
-              bestXShift[i] = 0;
-              xs[i] = 0;
+            // try the horizontal shifts of the previous frame first
+            size_t  unitNum = size_t(yc >> 2);
+            const int *prvXShifts = getPrvFrameParams(unitNum);
+            if (prvXShifts && yc > 0) {
+              // do not allow stepping by more than one pixel at once
+              int     d = (prvXShifts[0] & 7)
+                          - resizedImage.y()[yc - 1].getXShift();
+              if (!(d == 0 || d == 1 || d == -1 || d == 7 || d == -7))
+                prvXShifts = (int *) 0;
             }
-            do {
+            bool    doneFlag = false;
+            if (prvXShifts) {
               for (int i = 0; i < 4; i++) {
-                xs[i] = xs[i] & 7;
-                resizedImage.y()[yc + i].setXShift(xs[i]);
-                resizedImage.u()[yc + i].setXShift(xs[i]);
-                resizedImage.v()[yc + i].setXShift(xs[i]);
+                resizedImage.y()[yc + i].setXShift(prvXShifts[i]);
+                resizedImage.u()[yc + i].setXShift(prvXShifts[i]);
+                resizedImage.v()[yc + i].setXShift(prvXShifts[i]);
               }
-              bool    skipFlag = false;
+              double  err = 0.0;
+              for (int xc = 0; xc < 320; xc += 8)
+                err += findLuminanceCodes(prgData, xc, yc);
+              if (!noLuminanceInterlace) {
+                for (int xc = 0; xc < 320; xc += 8)
+                  err += findLuminanceCodes(prgData, xc, yc + 1);
+              }
+              doneFlag = checkPrvFrameError(unitNum, err);
+            }
+            if (!doneFlag) {
+              // find optimal horizontal shifts
+              double  minErr = 1000000.0;
+              int     bestXShift[4];
+              int     xs[4];
               for (int i = 0; i < 4; i++) {
-                // do not allow stepping by more than one pixel at once
-                if ((yc + i) > 0) {
-                  int     d = resizedImage.y()[yc + i].getXShift()
-                              - resizedImage.y()[yc + i - 1].getXShift();
-                  if (!(d == 0 || d == 1 || d == -1 || d == 7 || d == -7)) {
-                    skipFlag = true;
-                    break;
+                bestXShift[i] = 0;
+                xs[i] = 0;
+              }
+              do {
+                for (int i = 0; i < 4; i++) {
+                  xs[i] = xs[i] & 7;
+                  resizedImage.y()[yc + i].setXShift(xs[i]);
+                  resizedImage.u()[yc + i].setXShift(xs[i]);
+                  resizedImage.v()[yc + i].setXShift(xs[i]);
+                }
+                bool    skipFlag = false;
+                for (int i = 0; i < 4; i++) {
+                  // do not allow stepping by more than one pixel at once
+                  if ((yc + i) > 0) {
+                    int     d = resizedImage.y()[yc + i].getXShift()
+                                - resizedImage.y()[yc + i - 1].getXShift();
+                    if (!(d == 0 || d == 1 || d == -1 ||
+                          d == 7 || d == -7)) {
+                      skipFlag = true;
+                      break;
+                    }
                   }
                 }
-              }
-              if (!skipFlag) {
-                // calculate the total error for four lines
-                double  err = 0.0;
-                for (int xc = 0; xc < 320; xc += 8)
-                  err += findLuminanceCodes(prgData, xc, yc);
-                if (!noLuminanceInterlace) {
+                if (!skipFlag) {
+                  // calculate the total error for four lines
+                  double  err = 0.0;
                   for (int xc = 0; xc < 320; xc += 8)
-                    err += findLuminanceCodes(prgData, xc, yc + 1);
+                    err += findLuminanceCodes(prgData, xc, yc);
+                  if (!noLuminanceInterlace) {
+                    for (int xc = 0; xc < 320; xc += 8)
+                      err += findLuminanceCodes(prgData, xc, yc + 1);
+                  }
+                  if (err < minErr) {
+                    for (int i = 0; i < 4; i++)
+                      bestXShift[i] = xs[i];
+                    minErr = err;
+                  }
                 }
-                if (err < minErr) {
-                  for (int i = 0; i < 4; i++)
-                    bestXShift[i] = xs[i];
-                  minErr = err;
+                for (int i = 0; i < 4; i++) {
+                  xs[i] = xs[i] + 1;
+                  if (xs[i] < 8)
+                    break;
                 }
-              }
+              } while (xs[3] < 8);
+              // use the best horizontal shift that was found
               for (int i = 0; i < 4; i++) {
-                xs[i] = xs[i] + 1;
-                if (xs[i] < 8)
-                  break;
+                resizedImage.y()[yc + i].setXShift(bestXShift[i]);
+                resizedImage.u()[yc + i].setXShift(bestXShift[i]);
+                resizedImage.v()[yc + i].setXShift(bestXShift[i]);
               }
-            } while (xs[3] < 8);
-            // use the best horizontal shift that was found
-            for (int i = 0; i < 4; i++) {
-              resizedImage.y()[yc + i].setXShift(bestXShift[i]);
-              resizedImage.u()[yc + i].setXShift(bestXShift[i]);
-              resizedImage.v()[yc + i].setXShift(bestXShift[i]);
-            }
-            for (int xc = 0; xc < 320; xc += 8)
-              findLuminanceCodes(prgData, xc, yc);
-            if (!noLuminanceInterlace) {
               for (int xc = 0; xc < 320; xc += 8)
-                findLuminanceCodes(prgData, xc, yc + 1);
+                findLuminanceCodes(prgData, xc, yc);
+              if (!noLuminanceInterlace) {
+                for (int xc = 0; xc < 320; xc += 8)
+                  findLuminanceCodes(prgData, xc, yc + 1);
+              }
+              setFrameError(unitNum, minErr);
             }
+            int     *xShiftParams = getFrameParams(unitNum);
+            for (int i = 0; i < 4; i++)
+              xShiftParams[i] = resizedImage.y()[yc + i].getXShift();
           }
         }
         generateBitmaps(prgData);
@@ -1358,14 +1441,15 @@ namespace Plus4FLIConv {
             line0V.setXShift(resizedImage.v()[yc].getXShift());
             line1U.setXShift(resizedImage.u()[yc + 2].getXShift());
             line1V.setXShift(resizedImage.v()[yc + 2].getXShift());
+            const int *prvParams = getPrvFrameParams(size_t(yc >> 2));
             if (resizedImage.y()[yc].getXShift()
                 >= resizedImage.y()[yc + 2].getXShift()) {
               for (int xc = 0; xc < 320; xc += 8)
-                findColorCodes(prgData, xc, yc, 1);
+                findColorCodes(prgData, xc, yc, 1, prvParams);
             }
             else {
               for (int xc = 319; xc >= 0; xc -= 8)
-                findColorCodes(prgData, xc, yc, -1);
+                findColorCodes(prgData, xc, yc, -1, prvParams);
             }
             for (int xc = 0; xc < 320; xc++) {
               prvLineU[xc] = (line1U[xc] * 0.5f) + (savedPrvLineU[xc] * 0.5f);
@@ -1390,12 +1474,31 @@ namespace Plus4FLIConv {
               progressMessage("");
               return false;
             }
-            findAttributes_YUVMode(prgData, xc, yc, randomSeed);
+            // try the colors of the previous frame first
+            size_t  unitNum = size_t(((yc >> 2) * 40) + (xc >> 3));
+            const int *prvColors = getPrvFrameParams(unitNum);
+            bool    doneFlag = false;
+            if (prvColors) {
+              double  err = findAttributes_YUVMode(prgData, xc, yc,
+                                                   randomSeed, prvColors);
+              doneFlag = checkPrvFrameError(unitNum, err);
+            }
+            if (!doneFlag) {
+              setFrameError(unitNum, findAttributes_YUVMode(prgData, xc, yc,
+                                                            randomSeed));
+            }
+            else {
+              // keep the random numbers the same as with a full search, so
+              // that the blocks searched again start from the same colors
+              for (int i = 0; i < (conversionQuality * 4); i++)
+                (void) Plus4Emu::getRandomNumber(randomSeed);
+            }
           }
           for (int i = 0; i < 4; i++)
             ditherLine_YUVMode(prgData, yc + i);
         }
       }
+      endFrame();
       setProgressPercentage(100);
       progressMessage("");
       if (!enable40ColumnMode) {
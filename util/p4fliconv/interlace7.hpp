@@ -160,7 +160,9 @@ namespace Plus4FLIConv {
     float   *paletteU;
     float   *paletteV;
     // ----------------
-    static void pixelStoreCallback(void *, int, int, float, float, float);
+    static void rowStoreCallback(void *, int,
+                                 const float *, const float *, const float *,
+                                 int);
     void colorToUV(int c, float& u, float& v);
     void createYTable();
     void createUVTables();
@@ -168,14 +170,22 @@ namespace Plus4FLIConv {
     void ditherPixel(PRGData& prgData, long xc, long yc);
     inline double calculateLuminanceError(float n, int l0, int l1);
     double findLuminanceCodes(PRGData& prgData, long xc, long yc);
-    void findAttributes_YUVMode(PRGData& prgData, long xc, long yc,
-                                int& randomSeed);
+    // returns the error of the best colors found for the 8x4 block, and
+    // stores them as the parameters of the frame unit; if 'prvColors' is
+    // not NULL, only a single search starting from these colors is done
+    double findAttributes_YUVMode(PRGData& prgData, long xc, long yc,
+                                  int& randomSeed,
+                                  const int *prvColors = (const int *) 0);
     void generateBitmaps(PRGData& prgData);
     void ditherLine_YUVMode(PRGData& prgData, long yc);
-    void findColorCodes(PRGData& prgData, long xc, long yc, int dir_);
+    // if 'prvParams' is not NULL, the colors used in the previous frame
+    // are tried first, and kept if the error is not much worse
+    void findColorCodes(PRGData& prgData, long xc, long yc, int dir_,
+                        const int *prvParams);
    public:
     P4FLI_Interlace7();
     virtual ~P4FLI_Interlace7();
+    virtual bool isPreviousFrameReuseSupported() const;
     virtual bool processImage(PRGData& prgData, unsigned int& prgEndAddr,
                               const char *infileName,
                               YUVImageConverter& imgConv,
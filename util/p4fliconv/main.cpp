@@ -39,6 +39,524 @@
 #include <FL/Fl.H>
 #include <FL/Fl_Image.H>
 #include <FL/Fl_Shared_Image.H>
+#include <FL/filename.H>
+
+static void quietProgressMessageCb(void *userData, const char *msg)
+{
+  (void) userData;
+  (void) msg;
+}
+
+static bool quietProgressPercentageCb(void *userData, int n)
+{
+  (void) userData;
+  (void) n;
+  return true;
+}
+
+typedef std::map< std::string, std::vector< std::string > >
+    P4FLIConvOptionTable;
+
+static void initializeOptionTable(P4FLIConvOptionTable& optionTable)
+{
+  optionTable["-mode"].push_back("i:conversionType");
+  optionTable["-ymin"].push_back("f:yMin");
+  optionTable["-ymax"].push_back("f:yMax");
+  optionTable["-scale"].push_back("f:scaleX");
+  optionTable["-scale"].push_back("f:scaleY");
+  optionTable["-offset"].push_back("f:offsetX");
+  optionTable["-offset"].push_back("f:offsetY");
+  optionTable["-saturation"].push_back("f:saturationMult");
+  optionTable["-saturation"].push_back("f:saturationPow");
+  optionTable["-gamma"].push_back("f:gammaCorrection");
+  optionTable["-gamma"].push_back("f:monitorGamma");
+  optionTable["-dither"].push_back("i:ditherMode");
+  optionTable["-dither"].push_back("f:ditherLimit");
+  optionTable["-dither"].push_back("f:ditherDiffusion");
+  optionTable["-pal"].push_back("b:enablePAL");
+  optionTable["-xshift"].push_back("i:xShift0");
+  optionTable["-xshift"].push_back("i:xShift1");
+  optionTable["-border"].push_back("i:borderColor");
+  optionTable["-size"].push_back("i:verticalSize");
+  optionTable["-y1bit"].push_back("b:luminance1BitMode");
+  optionTable["-nointerp"].push_back("b:disableInterpolation");
+  optionTable["-no_li"].push_back("b:noLuminanceInterlace");
+  optionTable["-nofx"].push_back("b:disableFLIEffects");
+  optionTable["-ci"].push_back("i:colorInterlaceMode");
+  optionTable["-searchmode"].push_back("i:luminanceSearchMode");
+  optionTable["-searchmode"].push_back("f:luminanceSearchModeParam");
+  optionTable["-mcchromaerr"].push_back("f:mcColorErrorScale");
+  optionTable["-mcquality"].push_back("i:multiColorQuality");
+  optionTable["-c64color0"].push_back("i:c64Color0");
+  optionTable["-c64color1"].push_back("i:c64Color1");
+  optionTable["-c64color2"].push_back("i:c64Color2");
+  optionTable["-c64color3"].push_back("i:c64Color3");
+  optionTable["-c64color4"].push_back("i:c64Color4");
+  optionTable["-c64color5"].push_back("i:c64Color5");
+  optionTable["-c64color6"].push_back("i:c64Color6");
+  optionTable["-c64color7"].push_back("i:c64Color7");
+  optionTable["-c64color8"].push_back("i:c64Color8");
+  optionTable["-c64color9"].push_back("i:c64Color9");
+  optionTable["-c64color10"].push_back("i:c64Color10");
+  optionTable["-c64color11"].push_back("i:c64Color11");
+  optionTable["-c64color12"].push_back("i:c64Color12");
+  optionTable["-c64color13"].push_back("i:c64Color13");
+  optionTable["-c64color14"].push_back("i:c64Color14");
+  optionTable["-c64color15"].push_back("i:c64Color15");
+  optionTable["-outfmt"].push_back("i:outputFileFormat");
+  optionTable["-compress"].push_back("i:prgCompressionLevel");
+}
+
+// store the options in 'args' (each option name is followed by its
+// arguments, as checked by the command line parser) in 'config'
+static void setConfigurationOptions(Plus4Emu::ConfigurationDB& config,
+                                    const P4FLIConvOptionTable& optionTable,
+                                    const std::vector< std::string >& args)
+{
+  for (size_t i = 0; i < args.size(); i++) {
+    const std::vector< std::string >& v = optionTable.find(args[i])->second;
+    for (size_t j = 0; j < v.size(); j++) {
+      char        optionType = v[j][0];
+      const char  *optionName = v[j].c_str() + 2;
+      i++;
+      if (optionType == 'b')
+        config[optionName] = bool(std::atoi(args[i].c_str()));
+      else if (optionType == 'i')
+        config[optionName] = int(std::atoi(args[i].c_str()));
+      else if (optionType == 'f')
+        config[optionName] = float(std::atof(args[i].c_str()));
+    }
+  }
+}
+
+static Plus4FLIConv::FLIConverter * createFLIConverter(int convType)
+{
+  if (convType == 0)
+    return new Plus4FLIConv::P4FLI_Interlace7();
+  else if (convType == 1)
+    return new Plus4FLIConv::P4FLI_MultiColor();
+  else if (convType == 2)
+    return new Plus4FLIConv::P4FLI_HiResBitmapInterlace();
+  else if (convType == 3)
+    return new Plus4FLIConv::P4FLI_MultiColorBitmapInterlace();
+  else if (convType == 4)
+    return new Plus4FLIConv::P4FLI_HiResNoInterlace();
+  else if (convType == 5)
+    return new Plus4FLIConv::P4FLI_MultiColorNoInterlace();
+  else if (convType == 6)
+    return new Plus4FLIConv::P4FLI_HiResNoFLI();
+  else if (convType == 7)
+    return new Plus4FLIConv::P4FLI_MultiColorNoFLI();
+  else if (convType == 8)
+    return new Plus4FLIConv::P4FLI_MultiColorChar();
+  throw Plus4Emu::Exception("invalid conversion type");
+}
+
+static void setImageConverterOptions(Plus4FLIConv::YUVImageConverter& imgConv,
+                                     Plus4Emu::ConfigurationDB& config)
+{
+  imgConv.setXYScaleAndOffset(float(config["scaleX"]),
+                              float(config["scaleY"]),
+                              float(config["offsetX"]),
+                              float(config["offsetY"]));
+  imgConv.setEnableInterpolation(!(bool(config["disableInterpolation"])));
+  imgConv.setGammaCorrection(
+      float(config["gammaCorrection"]),
+      float(config["monitorGamma"]) * 0.625f);
+  imgConv.setLuminanceRange(float(config["yMin"]),
+                            float(config["yMax"]));
+  imgConv.setColorSaturation(float(config["saturationMult"]),
+                             float(config["saturationPow"]));
+  float   borderY = 0.0f;
+  float   borderU = 0.0f;
+  float   borderV = 0.0f;
+  Plus4FLIConv::FLIConverter::convertPlus4Color(
+      int(config["borderColor"]), borderY, borderU, borderV, 1.0);
+  imgConv.setBorderColor(borderY, borderU, borderV);
+  imgConv.setC64Color(0, int(config["c64Color0"]));
+  imgConv.setC64Color(1, int(config["c64Color1"]));
+  imgConv.setC64Color(2, int(config["c64Color2"]));
+  imgConv.setC64Color(3, int(config["c64Color3"]));
+  imgConv.setC64Color(4, int(config["c64Color4"]));
+  imgConv.setC64Color(5, int(config["c64Color5"]));
+  imgConv.setC64Color(6, int(config["c64Color6"]));
+  imgConv.setC64Color(7, int(config["c64Color7"]));
+  imgConv.setC64Color(8, int(config["c64Color8"]));
+  imgConv.setC64Color(9, int(config["c64Color9"]));
+  imgConv.setC64Color(10, int(config["c64Color10"]));
+  imgConv.setC64Color(11, int(config["c64Color11"]));
+  imgConv.setC64Color(12, int(config["c64Color12"]));
+  imgConv.setC64Color(13, int(config["c64Color13"]));
+  imgConv.setC64Color(14, int(config["c64Color14"]));
+  imgConv.setC64Color(15, int(config["c64Color15"]));
+}
+
+// convert 'infileName' to 'outfileName' with the settings from 'config',
+// using (and creating if necessary) the converter for the selected mode
+// from 'fliConvTable'; if 'seqWriter' is not NULL, the image is also
+// appended to it as the next frame of an animation
+static void convertImage(Plus4FLIConv::FLIConverter **fliConvTable,
+                         Plus4FLIConv::YUVImageConverter& imgConv,
+                         Plus4FLIConv::PRGData& prgData,
+                         Plus4Emu::ConfigurationDB& config,
+                         const char *infileName, const char *outfileName,
+                         bool quietMode,
+                         Plus4FLIConv::ImageSequenceWriter *seqWriter =
+                             (Plus4FLIConv::ImageSequenceWriter *) 0)
+{
+  unsigned int  prgEndAddr = 0x1003U;
+  int     convType = config["conversionType"];
+  if (convType < 0 || convType > 8)
+    throw Plus4Emu::Exception("invalid conversion type");
+  if (!fliConvTable[convType]) {
+    fliConvTable[convType] = createFLIConverter(convType);
+    if (quietMode) {
+      fliConvTable[convType]->setProgressMessageCallback(
+          &quietProgressMessageCb, (void *) 0);
+      fliConvTable[convType]->setProgressPercentageCallback(
+          &quietProgressPercentageCb, (void *) 0);
+    }
+    fliConvTable[convType]->setPreviousFrameReuse(bool(seqWriter));
+    if (seqWriter &&
+        !fliConvTable[convType]->isPreviousFrameReuseSupported()) {
+      std::fprintf(stderr, " *** p4fliconv warning: mode %d does not "
+                           "support converting a frame starting from the "
+                           "previous one, all frames are converted in "
+                           "full\n", convType);
+    }
+  }
+  setImageConverterOptions(imgConv, config);
+  prgData.clear();
+  prgData.borderColor() =
+      (unsigned char) ((int(config["borderColor"]) & 0x7F) | 0x80);
+  prgData.lineBlankFXEnabled() =
+      (unsigned char) (bool(config["disableFLIEffects"]) ? 0 : 1);
+  fliConvTable[convType]->processImage(prgData, prgEndAddr,
+                                       infileName, imgConv, config);
+  Plus4FLIConv::writeConvertedImageFile(
+      outfileName, prgData, prgEndAddr, convType,
+      int(config["outputFileFormat"]), int(config["prgCompressionLevel"]),
+      (quietMode ? &quietProgressMessageCb
+                 : (void (*)(void *, const char *)) 0),
+      (quietMode ? &quietProgressPercentageCb
+                 : (bool (*)(void *, int)) 0));
+  if (seqWriter)
+    seqWriter->writeFrame(prgData, prgEndAddr);
+}
+
+// ----------------------------------------------------------------------------
+
+struct P4FLIConvBatchJob {
+  std::string infileName;
+  std::string outfileName;
+  // options that override the command line for this image only
+  std::vector< std::string >  args;
+};
+
+struct P4FLIConvBatch {
+  std::vector< P4FLIConvBatchJob >  jobs;
+  // options from the command line
+  std::vector< std::string >  args;
+  P4FLIConvOptionTable  optionTable;
+  Plus4Emu::Mutex mutex;
+  size_t  nextJob;
+  int     errorCnt;
+  P4FLIConvBatch()
+    : nextJob(0),
+      errorCnt(0)
+  {
+  }
+};
+
+// read the list of images to be converted in batch mode from 'fileName':
+// each line contains an input and an output file name, optionally followed
+// by options that override the command line for that image only; file
+// names with spaces can be quoted, and empty lines and lines beginning
+// with '#' are ignored
+static void readBatchListFile(P4FLIConvBatch& batch, const char *fileName)
+{
+  std::FILE *f = std::fopen(fileName, "rb");
+  if (!f)
+    throw Plus4Emu::Exception("error opening batch list file");
+  try {
+    int     c = '\n';
+    while (c != EOF) {
+      std::vector< std::string >  tokens;
+      std::string s;
+      bool    haveToken = false;
+      bool    quoteFlag = false;
+      while (true) {
+        c = std::fgetc(f);
+        if (c == EOF || c == '\n' || c == '\r' ||
+            ((c == ' ' || c == '\t') && !quoteFlag)) {
+          if (haveToken)
+            tokens.push_back(s);
+          s.clear();
+          haveToken = false;
+          quoteFlag = false;
+          if (c == ' ' || c == '\t')
+            continue;
+          break;
+        }
+        if (c == '#' && tokens.size() == 0 && !haveToken) {
+          // comment
+          do {
+            c = std::fgetc(f);
+          } while (!(c == EOF || c == '\n' || c == '\r'));
+          break;
+        }
+        haveToken = true;
+        if (c == '"')
+          quoteFlag = !quoteFlag;
+        else
+          s += char(c);
+      }
+      if (tokens.size() == 0)
+        continue;
+      if (tokens.size() < 2)
+        throw Plus4Emu::Exception("missing file name in batch list file");
+      P4FLIConvBatchJob job;
+      job.infileName = tokens[0];
+      job.outfileName = tokens[1];
+      for (size_t i = 2; i < tokens.size(); i++) {
+        P4FLIConvOptionTable::const_iterator  j =
+            batch.optionTable.find(tokens[i]);
+        if (j == batch.optionTable.end())
+          throw Plus4Emu::Exception("invalid option in batch list file");
+        if ((tokens.size() - (i + 1)) < j->second.size()) {
+          throw Plus4Emu::Exception("missing argument(s) for option "
+                                    "in batch list file");
+        }
+        for (size_t k = 0; k <= j->second.size(); k++)
+          job.args.push_back(tokens[i + k]);
+        i = i + j->second.size();
+      }
+      batch.jobs.push_back(job);
+    }
+  }
+  catch (...) {
+    std::fclose(f);
+    throw;
+  }
+  std::fclose(f);
+}
+
+// add all files from directory 'inDir' to the batch job list, the output
+// files are written to 'outDir' with the extension replaced by ".prg"
+static void readBatchDirectory(P4FLIConvBatch& batch,
+                               const char *inDir, const char *outDir)
+{
+  std::string inDir_(inDir);
+  std::string outDir_(outDir);
+  if (inDir_.length() > 0 && inDir_[inDir_.length() - 1] != '/' &&
+      inDir_[inDir_.length() - 1] != '\\') {
+    inDir_ += '/';
+  }
+  if (outDir_.length() > 0 && outDir_[outDir_.length() - 1] != '/' &&
+      outDir_[outDir_.length() - 1] != '\\') {
+    outDir_ += '/';
+  }
+  dirent  **fileList = (dirent **) 0;
+  int     n = fl_filename_list(inDir_.c_str(), &fileList, fl_numericsort);
+  if (n < 0)
+    throw Plus4Emu::Exception("error reading batch input directory");
+  try {
+    for (int i = 0; i < n; i++) {
+      const char  *s = fileList[i]->d_name;
+      // skip hidden files and directories
+      if (s[0] == '.' || s[0] == '\0' || s[std::strlen(s) - 1] == '/')
+        continue;
+      P4FLIConvBatchJob job;
+      job.infileName = inDir_ + s;
+      if (fl_filename_isdir(job.infileName.c_str()))
+        continue;
+      std::string baseName(s);
+      const char  *ext = fl_filename_ext(s);
+      if (ext && ext[0] == '.')
+        baseName.resize(size_t(ext - s));
+      job.outfileName = outDir_ + baseName + ".prg";
+      batch.jobs.push_back(job);
+    }
+  }
+  catch (...) {
+    fl_filename_free_list(&fileList, n);
+    throw;
+  }
+  fl_filename_free_list(&fileList, n);
+}
+
+class P4FLIConvBatchThread : public Plus4Emu::Thread {
+ private:
+  P4FLIConvBatch& batch;
+ public:
+  P4FLIConvBatchThread(P4FLIConvBatch& batch_)
+    : Plus4Emu::Thread(),
+      batch(batch_)
+  {
+  }
+  virtual ~P4FLIConvBatchThread()
+  {
+    join();
+  }
+ protected:
+  virtual void run();
+};
+
+void P4FLIConvBatchThread::run()
+{
+  // the converters, the image converter and the PRG data buffer are reused
+  // for all images processed by this thread
+  Plus4FLIConv::FLIConverter  *fliConvTable[9];
+  for (int i = 0; i < 9; i++)
+    fliConvTable[i] = (Plus4FLIConv::FLIConverter *) 0;
+  try {
+    Plus4FLIConv::FLIConfiguration  config;
+    Plus4FLIConv::YUVImageConverter imgConv;
+    Plus4FLIConv::PRGData   prgData;
+    imgConv.setProgressMessageCallback(&quietProgressMessageCb, (void *) 0);
+    imgConv.setProgressPercentageCallback(&quietProgressPercentageCb,
+                                          (void *) 0);
+    while (true) {
+      batch.mutex.lock();
+      size_t  n = batch.nextJob;
+      if (n < batch.jobs.size())
+        batch.nextJob++;
+      batch.mutex.unlock();
+      if (n >= batch.jobs.size())
+        break;
+      const P4FLIConvBatchJob&  job = batch.jobs[n];
+      const char  *errMsg = (char *) 0;
+      std::string errMsgBuf;
+      try {
+        config.resetDefaultSettings();
+        setConfigurationOptions(config, batch.optionTable, batch.args);
+        setConfigurationOptions(config, batch.optionTable, job.args);
+        convertImage(&(fliConvTable[0]), imgConv, prgData, config,
+                     job.infileName.c_str(), job.outfileName.c_str(), true);
+      }
+      catch (std::exception& e) {
+        errMsgBuf = (e.what() ? e.what() : "");
+        errMsg = errMsgBuf.c_str();
+      }
+      batch.mutex.lock();
+      if (!errMsg) {
+        std::fprintf(stderr, "%s -> %s\n",
+                     job.infileName.c_str(), job.outfileName.c_str());
+      }
+      else {
+        std::fprintf(stderr, " *** p4fliconv error: %s: %s\n",
+                     job.infileName.c_str(), errMsg);
+        batch.errorCnt++;
+      }
+      batch.mutex.unlock();
+    }
+  }
+  catch (std::exception& e) {
+    batch.mutex.lock();
+    std::fprintf(stderr, " *** p4fliconv error: %s\n", e.what());
+    batch.errorCnt++;
+    batch.mutex.unlock();
+  }
+  for (int i = 0; i < 9; i++) {
+    if (fliConvTable[i])
+      delete fliConvTable[i];
+  }
+}
+
+// convert all images in 'batch' on 'threadCnt' threads; returns the number
+// of images that could not be converted
+static int runBatchConversion(P4FLIConvBatch& batch, int threadCnt)
+{
+  if (size_t(threadCnt) > batch.jobs.size())
+    threadCnt = int(batch.jobs.size());
+  std::vector< P4FLIConvBatchThread * > threads;
+  try {
+    for (int i = 0; i < threadCnt; i++) {
+      threads.push_back((P4FLIConvBatchThread *) 0);
+      threads[i] = new P4FLIConvBatchThread(batch);
+    }
+    for (int i = 0; i < threadCnt; i++)
+      threads[i]->start();
+  }
+  catch (...) {
+    // stop the threads that are already running
+    batch.mutex.lock();
+    batch.nextJob = batch.jobs.size();
+    batch.mutex.unlock();
+    for (size_t i = 0; i < threads.size(); i++) {
+      if (threads[i])
+        delete threads[i];
+    }
+    throw;
+  }
+  for (int i = 0; i < threadCnt; i++)
+    delete threads[i];
+  return batch.errorCnt;
+}
+
+// convert the images in 'batch' in order on a single thread as the frames
+// of an animation, and also write them to the sequence file 'seqFileName';
+// each frame is converted starting from the previous one if the converter
+// supports it, and the sequence file only stores the changes between frames;
+// returns the number of images that could not be converted
+static int runSequenceConversion(P4FLIConvBatch& batch,
+                                 const char *seqFileName)
+{
+  Plus4FLIConv::FLIConverter  *fliConvTable[9];
+  for (int i = 0; i < 9; i++)
+    fliConvTable[i] = (Plus4FLIConv::FLIConverter *) 0;
+  Plus4FLIConv::ImageSequenceWriter *seqWriter =
+      (Plus4FLIConv::ImageSequenceWriter *) 0;
+  try {
+    Plus4FLIConv::FLIConfiguration  config;
+    Plus4FLIConv::YUVImageConverter imgConv;
+    Plus4FLIConv::PRGData   prgData;
+    imgConv.setProgressMessageCallback(&quietProgressMessageCb, (void *) 0);
+    imgConv.setProgressPercentageCallback(&quietProgressPercentageCb,
+                                          (void *) 0);
+    // the compression type and level are taken from the command line only
+    config.resetDefaultSettings();
+    setConfigurationOptions(config, batch.optionTable, batch.args);
+    int     outputFormat = config["outputFileFormat"];
+    int     compressionLevel = config["prgCompressionLevel"];
+    seqWriter = new Plus4FLIConv::ImageSequenceWriter(
+        seqFileName, (outputFormat >= 4 ? (outputFormat - 3) : 0),
+        (compressionLevel > 0 ? compressionLevel : 5));
+    for (size_t n = 0; n < batch.jobs.size(); n++) {
+      const P4FLIConvBatchJob&  job = batch.jobs[n];
+      try {
+        config.resetDefaultSettings();
+        setConfigurationOptions(config, batch.optionTable, batch.args);
+        setConfigurationOptions(config, batch.optionTable, job.args);
+        convertImage(&(fliConvTable[0]), imgConv, prgData, config,
+                     job.infileName.c_str(), job.outfileName.c_str(), true,
+                     seqWriter);
+      }
+      catch (std::exception& e) {
+        // a missing frame would make the rest of the sequence invalid
+        std::fprintf(stderr, " *** p4fliconv error: %s: %s\n",
+                     job.infileName.c_str(), e.what());
+        batch.errorCnt = int(batch.jobs.size() - n);
+        break;
+      }
+      std::fprintf(stderr, "%s -> %s\n",
+                   job.infileName.c_str(), job.outfileName.c_str());
+    }
+    if (batch.errorCnt == 0)
+      seqWriter->closeFile();
+  }
+  catch (std::exception& e) {
+    std::fprintf(stderr, " *** p4fliconv error: %s\n", e.what());
+    batch.errorCnt = int(batch.jobs.size());
+  }
+  if (seqWriter)
+    delete seqWriter;
+  for (int i = 0; i < 9; i++) {
+    if (fliConvTable[i])
+      delete fliConvTable[i];
+  }
+  return batch.errorCnt;
+}
 
 int main(int argc, char **argv)
 {
@@ -52,55 +570,16 @@ int main(int argc, char **argv)
     config.resetDefaultSettings();
     std::string infileName = "";
     std::string outfileName = "";
+    std::string batchListName = "";
+    std::string batchInDirName = "";
+    std::string batchOutDirName = "";
+    std::string sequenceFileName = "";
+    int     threadCnt = Plus4Emu::getProcessorCount();
+    P4FLIConvBatch  batch;
     {
-      std::vector< std::string >    args;
-      std::map< std::string, std::vector< std::string > >   optionTable;
-      optionTable["-mode"].push_back("i:conversionType");
-      optionTable["-ymin"].push_back("f:yMin");
-      optionTable["-ymax"].push_back("f:yMax");
-      optionTable["-scale"].push_back("f:scaleX");
-      optionTable["-scale"].push_back("f:scaleY");
-      optionTable["-offset"].push_back("f:offsetX");
-      optionTable["-offset"].push_back("f:offsetY");
-      optionTable["-saturation"].push_back("f:saturationMult");
-      optionTable["-saturation"].push_back("f:saturationPow");
-      optionTable["-gamma"].push_back("f:gammaCorrection");
-      optionTable["-gamma"].push_back("f:monitorGamma");
-      optionTable["-dither"].push_back("i:ditherMode");
-      optionTable["-dither"].push_back("f:ditherLimit");
-      optionTable["-dither"].push_back("f:ditherDiffusion");
-      optionTable["-pal"].push_back("b:enablePAL");
-      optionTable["-xshift"].push_back("i:xShift0");
-      optionTable["-xshift"].push_back("i:xShift1");
-      optionTable["-border"].push_back("i:borderColor");
-      optionTable["-size"].push_back("i:verticalSize");
-      optionTable["-y1bit"].push_back("b:luminance1BitMode");
-      optionTable["-nointerp"].push_back("b:disableInterpolation");
-      optionTable["-no_li"].push_back("b:noLuminanceInterlace");
-      optionTable["-nofx"].push_back("b:disableFLIEffects");
-      optionTable["-ci"].push_back("i:colorInterlaceMode");
-      optionTable["-searchmode"].push_back("i:luminanceSearchMode");
-      optionTable["-searchmode"].push_back("f:luminanceSearchModeParam");
-      optionTable["-mcchromaerr"].push_back("f:mcColorErrorScale");
-      optionTable["-mcquality"].push_back("i:multiColorQuality");
-      optionTable["-c64color0"].push_back("i:c64Color0");
-      optionTable["-c64color1"].push_back("i:c64Color1");
-      optionTable["-c64color2"].push_back("i:c64Color2");
-      optionTable["-c64color3"].push_back("i:c64Color3");
-      optionTable["-c64color4"].push_back("i:c64Color4");
-      optionTable["-c64color5"].push_back("i:c64Color5");
-      optionTable["-c64color6"].push_back("i:c64Color6");
-      optionTable["-c64color7"].push_back("i:c64Color7");
-      optionTable["-c64color8"].push_back("i:c64Color8");
-      optionTable["-c64color9"].push_back("i:c64Color9");
-      optionTable["-c64color10"].push_back("i:c64Color10");
-      optionTable["-c64color11"].push_back("i:c64Color11");
-      optionTable["-c64color12"].push_back("i:c64Color12");
-      optionTable["-c64color13"].push_back("i:c64Color13");
-      optionTable["-c64color14"].push_back("i:c64Color14");
-      optionTable["-c64color15"].push_back("i:c64Color15");
-      optionTable["-outfmt"].push_back("i:outputFileFormat");
-      optionTable["-compress"].push_back("i:prgCompressionLevel");
+      std::vector< std::string >&   args = batch.args;
+      P4FLIConvOptionTable& optionTable = batch.optionTable;
+      initializeOptionTable(optionTable);
       bool    endOfOptions = false;
       size_t  skipCnt = 0;
       for (int i = 1; i < argc; i++) {
@@ -139,6 +618,33 @@ int main(int argc, char **argv)
           helpFlag = true;
           throw Plus4Emu::Exception("");
         }
+        if (std::strcmp(s, "-batch") == 0 ||
+            std::strcmp(s, "-batchdir") == 0 ||
+            std::strcmp(s, "-sequence") == 0 ||
+            std::strcmp(s, "-threads") == 0) {
+          int     nArgs = (std::strcmp(s, "-batchdir") == 0 ? 2 : 1);
+          if ((i + nArgs) >= argc) {
+            printUsageFlag = true;
+            throw Plus4Emu::Exception("missing argument(s) "
+                                      "for command line option");
+          }
+          if (s[1] == 't') {
+            threadCnt = std::atoi(argv[++i]);
+            threadCnt = (threadCnt > 1 ? threadCnt : 1);
+            threadCnt = (threadCnt < 64 ? threadCnt : 64);
+          }
+          else if (s[1] == 's') {
+            sequenceFileName = argv[++i];
+          }
+          else if (nArgs == 1) {
+            batchListName = argv[++i];
+          }
+          else {
+            batchInDirName = argv[++i];
+            batchOutDirName = argv[++i];
+          }
+          continue;
+        }
         if (optionTable.find(s) == optionTable.end()) {
           printUsageFlag = true;
           throw Plus4Emu::Exception("invalid command line option");
@@ -151,6 +657,33 @@ int main(int argc, char **argv)
         throw Plus4Emu::Exception("missing argument(s) "
                                   "for command line option");
       }
+      if (batchListName != "" || batchInDirName != "") {
+        if (infileName != "") {
+          printUsageFlag = true;
+          throw Plus4Emu::Exception("file name arguments cannot be used "
+                                    "in batch mode");
+        }
+        // run in batch mode
+        if (batchListName != "")
+          readBatchListFile(batch, batchListName.c_str());
+        if (batchInDirName != "") {
+          readBatchDirectory(batch, batchInDirName.c_str(),
+                             batchOutDirName.c_str());
+        }
+        int     errorCnt = 0;
+        if (sequenceFileName != "")
+          errorCnt = runSequenceConversion(batch, sequenceFileName.c_str());
+        else
+          errorCnt = runBatchConversion(batch, threadCnt);
+        std::fprintf(stderr, "Converted %d of %d images\n",
+                     int(batch.jobs.size()) - errorCnt,
+                     int(batch.jobs.size()));
+        return (errorCnt == 0 ? 0 : -1);
+      }
+      if (sequenceFileName != "") {
+        printUsageFlag = true;
+        throw Plus4Emu::Exception("-sequence requires -batch or -batchdir");
+      }
 #ifdef DISABLE_OPENGL_DISPLAY
       if (infileName == "" || outfileName == "") {
         printUsageFlag = true;
@@ -173,107 +706,35 @@ int main(int argc, char **argv)
         catch (...) {
         }
       }
-      for (size_t i = 0; i < args.size(); i++) {
-        std::vector< std::string >&   v = optionTable[args[i]];
-        for (size_t j = 0; j < v.size(); j++) {
-          char        optionType = v[j][0];
-          const char  *optionName = v[j].c_str() + 2;
-          i++;
-          if (optionType == 'b')
-            config[optionName] = bool(std::atoi(args[i].c_str()));
-          else if (optionType == 'i')
-            config[optionName] = int(std::atoi(args[i].c_str()));
-          else if (optionType == 'f')
-            config[optionName] = float(std::atof(args[i].c_str()));
-        }
-      }
 #endif  // !DISABLE_OPENGL_DISPLAY
+      setConfigurationOptions(config, optionTable, args);
     }
 #ifndef DISABLE_OPENGL_DISPLAY
     if (infileName != "")
 #endif
     {
       // run in command line mode
-      Plus4FLIConv::FLIConverter  *fliConv = (Plus4FLIConv::FLIConverter *) 0;
-      Plus4FLIConv::PRGData       prgData;
-      unsigned int  prgEndAddr = 0x1003U;
-      int     convType = config["conversionType"];
+      Plus4FLIConv::FLIConverter  *fliConvTable[9];
+      for (int i = 0; i < 9; i++)
+        fliConvTable[i] = (Plus4FLIConv::FLIConverter *) 0;
       try {
-        if (convType == 0)
-          fliConv = new Plus4FLIConv::P4FLI_Interlace7();
-        else if (convType == 1)
-          fliConv = new Plus4FLIConv::P4FLI_MultiColor();
-        else if (convType == 2)
-          fliConv = new Plus4FLIConv::P4FLI_HiResBitmapInterlace();
-        else if (convType == 3)
-          fliConv = new Plus4FLIConv::P4FLI_MultiColorBitmapInterlace();
-        else if (convType == 4)
-          fliConv = new Plus4FLIConv::P4FLI_HiResNoInterlace();
-        else if (convType == 5)
-          fliConv = new Plus4FLIConv::P4FLI_MultiColorNoInterlace();
-        else if (convType == 6)
-          fliConv = new Plus4FLIConv::P4FLI_HiResNoFLI();
-        else if (convType == 7)
-          fliConv = new Plus4FLIConv::P4FLI_MultiColorNoFLI();
-        else if (convType == 8)
-          fliConv = new Plus4FLIConv::P4FLI_MultiColorChar();
-        else
-          throw Plus4Emu::Exception("invalid conversion type");
         Plus4FLIConv::YUVImageConverter imgConv;
-        imgConv.setXYScaleAndOffset(float(config["scaleX"]),
-                                    float(config["scaleY"]),
-                                    float(config["offsetX"]),
-                                    float(config["offsetY"]));
-        imgConv.setEnableInterpolation(!(bool(config["disableInterpolation"])));
-        imgConv.setGammaCorrection(
-            float(config["gammaCorrection"]),
-            float(config["monitorGamma"]) * 0.625f);
-        imgConv.setLuminanceRange(float(config["yMin"]),
-                                  float(config["yMax"]));
-        imgConv.setColorSaturation(float(config["saturationMult"]),
-                                   float(config["saturationPow"]));
-        float   borderY = 0.0f;
-        float   borderU = 0.0f;
-        float   borderV = 0.0f;
-        Plus4FLIConv::FLIConverter::convertPlus4Color(
-            int(config["borderColor"]), borderY, borderU, borderV, 1.0);
-        imgConv.setBorderColor(borderY, borderU, borderV);
-        imgConv.setC64Color(0, int(config["c64Color0"]));
-        imgConv.setC64Color(1, int(config["c64Color1"]));
-        imgConv.setC64Color(2, int(config["c64Color2"]));
-        imgConv.setC64Color(3, int(config["c64Color3"]));
-        imgConv.setC64Color(4, int(config["c64Color4"]));
-        imgConv.setC64Color(5, int(config["c64Color5"]));
-        imgConv.setC64Color(6, int(config["c64Color6"]));
-        imgConv.setC64Color(7, int(config["c64Color7"]));
-        imgConv.setC64Color(8, int(config["c64Color8"]));
-        imgConv.setC64Color(9, int(config["c64Color9"]));
-        imgConv.setC64Color(10, int(config["c64Color10"]));
-        imgConv.setC64Color(11, int(config["c64Color11"]));
-        imgConv.setC64Color(12, int(config["c64Color12"]));
-        imgConv.setC64Color(13, int(config["c64Color13"]));
-        imgConv.setC64Color(14, int(config["c64Color14"]));
-        imgConv.setC64Color(15, int(config["c64Color15"]));
-        prgData.clear();
-        prgData.borderColor() =
-            (unsigned char) ((int(config["borderColor"]) & 0x7F) | 0x80);
-        prgData.lineBlankFXEnabled() =
-            (unsigned char) (bool(config["disableFLIEffects"]) ? 0 : 1);
-        fliConv->processImage(prgData, prgEndAddr,
-                              infileName.c_str(), imgConv, config);
-        delete fliConv;
-        fliConv = (Plus4FLIConv::FLIConverter *) 0;
+        Plus4FLIConv::PRGData       prgData;
+        config.clearConfigurationChangeFlag();
+        convertImage(&(fliConvTable[0]), imgConv, prgData, config,
+                     infileName.c_str(), outfileName.c_str(), false);
       }
       catch (...) {
-        if (fliConv)
-          delete fliConv;
+        for (int i = 0; i < 9; i++) {
+          if (fliConvTable[i])
+            delete fliConvTable[i];
+        }
         throw;
       }
-      config.clearConfigurationChangeFlag();
-      Plus4FLIConv::writeConvertedImageFile(outfileName.c_str(), prgData,
-                                            prgEndAddr, convType,
-                                            int(config["outputFileFormat"]),
-                                            int(config["prgCompressionLevel"]));
+      for (int i = 0; i < 9; i++) {
+        if (fliConvTable[i])
+          delete fliConvTable[i];
+      }
       return 0;
     }
 #ifndef DISABLE_OPENGL_DISPLAY
@@ -295,6 +756,10 @@ int main(int argc, char **argv)
     if (printUsageFlag || helpFlag) {
       std::fprintf(stderr, "Usage: %s [OPTIONS...] infile.jpg outfile.prg\n",
                            argv[0]);
+      std::fprintf(stderr, "       %s [OPTIONS...] -batch <LISTFILE>\n",
+                           argv[0]);
+      std::fprintf(stderr, "       %s [OPTIONS...] -batchdir <INDIR> "
+                           "<OUTDIR>\n", argv[0]);
       std::fprintf(stderr, "Options:\n");
       std::fprintf(stderr, "    -mode <N>           (0 to 8, default: 0)\n");
       std::fprintf(stderr, "        select video mode (0: interlaced hires "
@@ -372,6 +837,25 @@ int main(int argc, char **argv)
                            "PRG (compression type 2)\n");
       std::fprintf(stderr, "    -compress <N>       (0 to 9, default: 0)\n");
       std::fprintf(stderr, "        compress output file if N is not zero\n");
+      std::fprintf(stderr, "    -batch <LISTFILE>\n");
+      std::fprintf(stderr, "        convert the images listed in LISTFILE, "
+                           "each line of which\n        contains an input "
+                           "and an output file name, optionally\n"
+                           "        followed by options for that image "
+                           "only\n");
+      std::fprintf(stderr, "    -batchdir <INDIR> <OUTDIR>\n");
+      std::fprintf(stderr, "        convert all files in INDIR, and write "
+                           "the output files to\n        OUTDIR with .prg "
+                           "extension\n");
+      std::fprintf(stderr, "    -sequence <FILE>\n");
+      std::fprintf(stderr, "        in batch mode, convert the images in "
+                           "order as the frames of an\n        animation, "
+                           "and also write the changes between frames to "
+                           "FILE\n");
+      std::fprintf(stderr, "    -threads <N>        (1 to 64, default: "
+                           "number of CPUs)\n");
+      std::fprintf(stderr, "        number of images to convert in parallel "
+                           "in batch mode\n");
     }
     if (!helpFlag) {
       const char  *errMsg = e.what();
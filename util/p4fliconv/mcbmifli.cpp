@@ -138,7 +138,9 @@ namespace Plus4FLIConv {
       ditherPaletteV((float *) 0),
       errorPaletteY((float *) 0),
       errorPaletteU((float *) 0),
-      errorPaletteV((float *) 0)
+      errorPaletteV((float *) 0),
+      paletteMonitorGamma(-1.0),
+      errorTableColorScale(-1.0)
   {
     try {
       ditheredImage = new int[304 * 248];
@@ -171,14 +173,25 @@ namespace Plus4FLIConv {
       delete[] ditherPaletteY;  // as a single block of memory
   }
 
-  void P4FLI_MultiColorBitmapInterlace::pixelStoreCallback(
-      void *userData, int xc, int yc, float y, float u, float v)
+  void P4FLI_MultiColorBitmapInterlace::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     P4FLI_MultiColorBitmapInterlace&  this_ =
         *(reinterpret_cast<P4FLI_MultiColorBitmapInterlace *>(userData));
-    this_.resizedImage.y()[yc >> 1][xc >> 1] += (y * 0.25f);
-    this_.resizedImage.u()[yc >> 1][xc >> 1] += (u * 0.25f);
-    this_.resizedImage.v()[yc >> 1][xc >> 1] += (v * 0.25f);
+    Line304& lineY = this_.resizedImage.y()[yc >> 1];
+    Line304& lineU = this_.resizedImage.u()[yc >> 1];
+    Line304& lineV = this_.resizedImage.v()[yc >> 1];
+    for (int xc = 0; xc < w; xc++) {
+      lineY[xc >> 1] += (y[xc] * 0.25f);
+      lineU[xc >> 1] += (u[xc] * 0.25f);
+      lineV[xc >> 1] += (v[xc] * 0.25f);
+    }
+  }
+
+  bool P4FLI_MultiColorBitmapInterlace::isPreviousFrameReuseSupported() const
+  {
+    return true;
   }
 
   void P4FLI_MultiColorBitmapInterlace::checkParameters()
@@ -379,104 +392,56 @@ namespace Plus4FLIConv {
         color2 = 0x00;
       return 0.0;
     }
-    double  minErr = 1000000.0;
+    int     nPixels_ = 0;
+    int     pixelColors_[16];
+    int     pixelCounts_[16];
+    double  baseErrors_[16];
+    double  baseErrors2_[16];
+    for (int i = 0; i < 16; i++) {
+      pixelColors_[i] = 0;
+      pixelCounts_[i] = 0;
+      baseErrors_[i] = 0.0;
+      baseErrors2_[i] = 0.0;
+    }
+    for (int k = 0; k < 4; k++) {
+      for (int i = 0; i < lineColors_[k]; i++) {
+        int     c = linePixelColorCodes_[k][i];
+        double  err0 = errorTable[(c << 7) | color0[k]];
+        double  err3 = errorTable[(c << 7) | color3[k]];
+        pixelColors_[nPixels_] = c;
+        pixelCounts_[nPixels_] = linePixelColorCounts_[k][i];
+        baseErrors_[nPixels_] = (err3 < err0 ? err3 : err0);
+        nPixels_++;
+      }
+    }
     if (colorTable_.size() <= 48) {
       // color #1 and color #2
-      int     bestColor1 = color1;
-      int     bestColor2 = color2;
-      for (size_t c1i = 0; c1i < colorTable_.size(); c1i++) {
-        for (size_t c2i = c1i + 1; c2i < colorTable_.size(); c2i++) {
-          color1 = colorTable_[c1i];
-          color2 = colorTable_[c2i];
-          double  err = 0.0;
-          for (int k = 0; k < 4; k++) {
-            for (int i = 0; i < lineColors_[k]; i++) {
-              int     c = linePixelColorCodes_[k][i];
-              double  minErr2 = errorTable[(c << 7) | color0[k]];
-              double  err2 = errorTable[(c << 7) | color1];
-              if (err2 < minErr2)
-                minErr2 = err2;
-              err2 = errorTable[(c << 7) | color2];
-              if (err2 < minErr2)
-                minErr2 = err2;
-              err2 = errorTable[(c << 7) | color3[k]];
-              if (err2 < minErr2)
-                minErr2 = err2;
-              err += (minErr2 * double(linePixelColorCounts_[k][i]));
-            }
-          }
-          if (err < minErr) {
-            bestColor1 = color1;
-            bestColor2 = color2;
-            minErr = err;
-          }
-        }
-      }
-      color1 = bestColor1;
-      color2 = bestColor2;
+      return FLIConverter::findBestColors(color1, color2, true, colorTable_,
+                                          errorTable, pixelColors_,
+                                          pixelCounts_, baseErrors_,
+                                          nPixels_);
     }
-    else {
-      // color #1
-      int     bestColor = color1;
-      for (size_t j = 0; j < colorTable_.size(); j++) {
-        color1 = colorTable_[j];
-        double  err = 0.0;
-        for (int k = 0; k < 4; k++) {
-          for (int i = 0; i < lineColors_[k]; i++) {
-            int     c = linePixelColorCodes_[k][i];
-            double  minErr2 = errorTable[(c << 7) | color0[k]];
-            double  err2 = errorTable[(c << 7) | color1];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color2];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color3[k]];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err += (minErr2 * double(linePixelColorCounts_[k][i]));
-          }
-        }
-        if (err < minErr) {
-          bestColor = color1;
-          minErr = err;
-        }
-      }
-      color1 = bestColor;
-      // color #2
-      minErr = 1000000.0;
-      bestColor = color2;
-      for (size_t j = 0; j < colorTable_.size(); j++) {
-        color2 = colorTable_[j];
-        double  err = 0.0;
-        for (int k = 0; k < 4; k++) {
-          for (int i = 0; i < lineColors_[k]; i++) {
-            int     c = linePixelColorCodes_[k][i];
-            double  minErr2 = errorTable[(c << 7) | color0[k]];
-            double  err2 = errorTable[(c << 7) | color1];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color2];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color3[k]];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err += (minErr2 * double(linePixelColorCounts_[k][i]));
-          }
-        }
-        if (err < minErr) {
-          bestColor = color2;
-          minErr = err;
-        }
-      }
-      color2 = bestColor;
+    // color #1
+    for (int i = 0; i < nPixels_; i++) {
+      double  err = errorTable[(pixelColors_[i] << 7) | color2];
+      baseErrors2_[i] = (err < baseErrors_[i] ? err : baseErrors_[i]);
+    }
+    FLIConverter::findBestColors(color1, color2, false, colorTable_,
+                                 errorTable, pixelColors_, pixelCounts_,
+                                 baseErrors2_, nPixels_);
+    // color #2
+    for (int i = 0; i < nPixels_; i++) {
+      double  err = errorTable[(pixelColors_[i] << 7) | color1];
+      baseErrors2_[i] = (err < baseErrors_[i] ? err : baseErrors_[i]);
     }
-    return minErr;
+    return FLIConverter::findBestColors(color2, color1, false, colorTable_,
+                                        errorTable, pixelColors_,
+                                        pixelCounts_, baseErrors2_, nPixels_);
   }
 
   void P4FLI_MultiColorBitmapInterlace::initializePalettes()
   {
+    paletteMonitorGamma = monitorGamma;
     if (!ditherPaletteY) {
       ditherPaletteY = new float[768];
       ditherPaletteU = &(ditherPaletteY[128]);
@@ -495,6 +460,7 @@ namespace Plus4FLIConv {
 
   void P4FLI_MultiColorBitmapInterlace::createErrorTable(double colorErrorScale)
   {
+    errorTableColorScale = colorErrorScale;
     limitValue(colorErrorScale, 0.05, 1.0);
     for (int c0 = 0; c0 < 128; c0++) {
       for (int c1 = 0; c1 < 128; c1++) {
@@ -691,41 +657,15 @@ namespace Plus4FLIConv {
       float   errY = y - ditherPaletteY[c];
       float   errU = u - ditherPaletteU[c];
       float   errV = v - ditherPaletteV[c];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < long(nLines) && xc_ >= 0L && xc_ < 304L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage.y()[yc_].setPixel(
-              xc_, ditherErrorImage.y()[yc_].getPixel(xc_) + (errY * errMult));
-          ditherErrorImage.u()[yc_].setPixel(
-              xc_, ditherErrorImage.u()[yc_].getPixel(xc_) + (errU * errMult));
-          ditherErrorImage.v()[yc_].setPixel(
-              xc_, ditherErrorImage.v()[yc_].getPixel(xc_) + (errV * errMult));
-        }
-      }
+      diffuseDitherErrorYUV(ditherMode, ditherErrorImage,
+                            xc, yc, 304L, long(nLines), errY, errU, errV);
       if (yc & 1L)
         xc = 303L - xc;
     }
   }
 
   double P4FLI_MultiColorBitmapInterlace::convertTwoLines(
-      PRGData& prgData, long yc)
+      PRGData& prgData, long yc, const int *prvColors)
   {
     int     color0[4];
     int     color3[4];
@@ -866,7 +806,9 @@ namespace Plus4FLIConv {
     std::vector< int >  colorCnts(128);
     int     randomSeed = 0;
     Plus4Emu::setRandomSeed(randomSeed, 1U);
-    for (int l = 0; l < conversionQuality; l++) {
+    // pass -1 starts from the colors of the previous frame
+    for (int l = (prvColors ? -1 : 0); l < (prvColors ? 0 : conversionQuality);
+         l++) {
       // set initial palette with different methods, and choose the one
       // that results in the least error after optimization
       for (int i = 0; i < 128; i++)
@@ -879,6 +821,10 @@ namespace Plus4FLIConv {
         }
         else {
           switch (l) {
+          case -1:
+            attrBlocks[i].color1 = prvColors[i << 1];
+            attrBlocks[i].color2 = prvColors[(i << 1) + 1];
+            break;
           case 0:
           case 6:
             attrBlocks[i].color1 = attrBlocks[i].pixelColorCodes[nColors - 1];
@@ -935,7 +881,13 @@ namespace Plus4FLIConv {
           }
         }
       }
-      if (l == 4 || l == 10) {
+      if (l < 0) {
+        for (int i = 0; i < 4; i++) {
+          color0[i] = prvColors[i + 80];
+          color3[i] = prvColors[i + 84];
+        }
+      }
+      else if (l == 4 || l == 10) {
         color0[0] = 0x71;
         color3[0] = 0x71;
       }
@@ -965,13 +917,15 @@ namespace Plus4FLIConv {
         color3[0] = colorTable0[Plus4Emu::getRandomNumber(randomSeed)
                                 % int(colorTable0.size())];
       }
-      for (int i = 1; i < 4; i++) {
-        color0[i] = color0[0];
-        color3[i] = color3[0];
+      if (l >= 0) {
+        for (int i = 1; i < 4; i++) {
+          color0[i] = color0[0];
+          color3[i] = color3[0];
+        }
       }
       // optimize attributes and color registers
       double  prvErr = 1000000.0;
-      for (int i = (l < 6 ? 7 : -1); i >= 0; i--) {
+      for (int i = (l >= 0 && l < 6 ? 7 : -1); i >= 0; i--) {
         // color #0 (FF15), line 0 and 1
         double  minErr = prvErr;
         int     bestColor = color0[0];
@@ -1146,6 +1100,13 @@ namespace Plus4FLIConv {
       color0[i] = bestColors[i + 80];
       color3[i] = bestColors[i + 84];
     }
+    {
+      int     *p = getFrameParams(size_t(yc >> 1));
+      for (int i = 0; i < 88; i++)
+        p[i] = bestColors[i];
+      p[88] = xs[0];
+      p[89] = xs[1];
+    }
     // store the attributes and color registers
     for (int i = 0; i < 4; i++) {
       prgData.lineColor0((yc << 1) | long(i)) = (unsigned char) color0[i];
@@ -1217,8 +1178,17 @@ namespace Plus4FLIConv {
       conversionQuality = config["multiColorQuality"];
       luminance1BitMode = config["luminance1BitMode"];
       checkParameters();
-      initializePalettes();
-      createErrorTable(double(config["mcColorErrorScale"]));
+      if (monitorGamma != paletteMonitorGamma ||
+          double(config["mcColorErrorScale"]) != errorTableColorScale) {
+        // only needs to be done again if the converter is reused for
+        // another image with different parameters
+        initializePalettes();
+        createErrorTable(double(config["mcColorErrorScale"]));
+        invalidatePrvFrame();
+      }
+      // the previous frame can only be used with the same X shift mode
+      beginFrame(size_t(nLines >> 1), 90, 608,
+                 (xShift0 & 0xFF) | (int(luminance1BitMode) << 8));
       prgData.setConversionType(3);
       prgData.clear();
       prgData.borderColor() = (unsigned char) borderColor;
@@ -1235,13 +1205,17 @@ namespace Plus4FLIConv {
       imgConv.setPixelAspectRatio(1.0f);
       imgConv.setGammaCorrection(float(double(config["gammaCorrection"])),
                                  float(double(config["monitorGamma"]) / 1.65));
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       for (int yc = 0; yc < nLines; yc++) {
         for (int xc = 0; xc < 304; xc++) {
           limitYUVColor(resizedImage.y()[yc][xc],
                         resizedImage.u()[yc][xc],
                         resizedImage.v()[yc][xc]);
+          storeFramePixel(size_t(yc >> 1), size_t(((yc & 1) * 304) + xc),
+                          resizedImage.y()[yc][xc],
+                          resizedImage.u()[yc][xc],
+                          resizedImage.v()[yc][xc]);
         }
       }
       // initialize horizontal scroll table
@@ -1282,6 +1256,23 @@ namespace Plus4FLIConv {
           progressMessage("");
           return false;
         }
+        const int *prvColors = getPrvFrameParams(size_t(yc >> 1));
+        if (prvColors) {
+          // try the X shifts and colors of the previous frame first, and
+          // keep the result if the error is not much worse than that of the
+          // last full search on this line pair
+          int     savedXShift0 = xShiftTable[yc + 0];
+          int     savedXShift1 = xShiftTable[yc + 1];
+          xShiftTable[yc + 0] = prvColors[88];
+          xShiftTable[yc + 1] = prvColors[89];
+          double  err = convertTwoLines(prgData, yc, prvColors);
+          if (checkPrvFrameError(size_t(yc >> 1), err)) {
+            totalError += err;
+            continue;
+          }
+          xShiftTable[yc + 0] = savedXShift0;
+          xShiftTable[yc + 1] = savedXShift1;
+        }
         int     bestXShift0 = xShiftTable[yc + 0];
         int     bestXShift1 = xShiftTable[yc + 1];
         if (xShift0 == -1) {
@@ -1302,8 +1293,11 @@ namespace Plus4FLIConv {
         }
         xShiftTable[yc + 0] = bestXShift0;
         xShiftTable[yc + 1] = bestXShift1;
-        totalError += convertTwoLines(prgData, yc);
+        double  err = convertTwoLines(prgData, yc);
+        setFrameError(size_t(yc >> 1), err);
+        totalError += err;
       }
+      endFrame();
       setProgressPercentage(100);
       progressMessage("");
       {
@@ -137,8 +137,13 @@ namespace Plus4FLIConv {
     float   *errorPaletteY;
     float   *errorPaletteU;
     float   *errorPaletteV;
+    // parameters used for the current palettes and error table
+    double  paletteMonitorGamma;
+    double  errorTableColorScale;
     // ----------------
-    static void pixelStoreCallback(void *, int, int, float, float, float);
+    static void rowStoreCallback(void *, int,
+                                 const float *, const float *, const float *,
+                                 int);
     void checkParameters();
     void initializePalettes();
     void createErrorTable(double colorErrorScale);
@@ -147,10 +152,17 @@ namespace Plus4FLIConv {
                          const float *paletteU,
                          const float *paletteV);
     void ditherLine(long yc);
-    double convertTwoLines(PRGData& prgData, long yc);
+    // the attributes, color registers, and X shifts of each line pair are
+    // stored as the frame parameters (90 integers: color #1 and #2 of the
+    // 40 blocks, FF15 and FF16 of line 0 and 1 in both fields, X shift of
+    // line 0 and 1); if 'prvColors' is not NULL, it points to the
+    // parameters to start from, and only a single optimization pass is done
+    double convertTwoLines(PRGData& prgData, long yc,
+                           const int *prvColors = (const int *) 0);
    public:
     P4FLI_MultiColorBitmapInterlace();
     virtual ~P4FLI_MultiColorBitmapInterlace();
+    virtual bool isPreviousFrameReuseSupported() const;
     virtual bool processImage(PRGData& prgData, unsigned int& prgEndAddr,
                               const char *infileName,
                               YUVImageConverter& imgConv,
@@ -115,14 +115,17 @@ namespace Plus4FLIConv {
     delete[] ditheredImage;
   }
 
-  void P4FLI_MultiColorChar::pixelStoreCallback(void *userData, int xc, int yc,
-                                                float y, float u, float v)
+  void P4FLI_MultiColorChar::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     (void) u;
     (void) v;
     P4FLI_MultiColorChar&  this_ =
         *(reinterpret_cast<P4FLI_MultiColorChar *>(userData));
-    this_.resizedImage[yc >> 1][xc >> 2] += (y * 0.125f);
+    Line128& lineY = this_.resizedImage[yc >> 1];
+    for (int xc = 0; xc < w; xc++)
+      lineY[xc >> 2] += (y[xc] * 0.125f);
   }
 
   void P4FLI_MultiColorChar::checkParameters()
@@ -226,30 +229,8 @@ namespace Plus4FLIConv {
       }
       y = y0 + ((y - y0) * float(ditherScale));
       float   errY = y - ditherYTable[colorTable[c]];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < 64L && xc_ >= 0L && xc_ < 128L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage[yc_].setPixel(
-              xc_, ditherErrorImage[yc_].getPixel(xc_) + (errY * errMult));
-        }
-      }
+      diffuseDitherError(ditherMode, ditherErrorImage,
+                         xc, yc, 128L, 64L, errY);
       if (yc & 1L)
         xc = 127L - xc;
     }
@@ -286,7 +267,7 @@ namespace Plus4FLIConv {
       }
       imgConv.setImageSize(512, 128);
       imgConv.setPixelAspectRatio(1.0f);
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       progressMessage("Calculating FLI data");
       setProgressPercentage(0);
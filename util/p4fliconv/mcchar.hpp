@@ -83,7 +83,9 @@ namespace Plus4FLIConv {
     float   ditherYTable[9];
     float   errorYTable[9];
     // ----------------
-    static void pixelStoreCallback(void *, int, int, float, float, float);
+    static void rowStoreCallback(void *, int,
+                                 const float *, const float *, const float *,
+                                 int);
     void checkParameters();
     void ditherLine(long yc);
    public:
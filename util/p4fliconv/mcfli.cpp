@@ -138,7 +138,9 @@ namespace Plus4FLIConv {
       ditherPaletteV((float *) 0),
       errorPaletteY((float *) 0),
       errorPaletteU((float *) 0),
-      errorPaletteV((float *) 0)
+      errorPaletteV((float *) 0),
+      paletteMonitorGamma(-1.0),
+      errorTableColorScale(-1.0)
   {
     try {
       ditheredImage = new int[160 * 248];
@@ -171,16 +173,26 @@ namespace Plus4FLIConv {
       delete[] ditherPaletteY;  // as a single block of memory
   }
 
-  void P4FLI_MultiColorNoInterlace::pixelStoreCallback(
-      void *userData, int xc, int yc, float y, float u, float v)
+  void P4FLI_MultiColorNoInterlace::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     P4FLI_MultiColorNoInterlace&  this_ =
         *(reinterpret_cast<P4FLI_MultiColorNoInterlace *>(userData));
-    if (!this_.enable40ColumnMode)
-      xc = xc + 16;
-    this_.resizedImage.y()[yc >> 1][xc >> 2] += (y * 0.125f);
-    this_.resizedImage.u()[yc >> 1][xc >> 2] += (u * 0.125f);
-    this_.resizedImage.v()[yc >> 1][xc >> 2] += (v * 0.125f);
+    int     xOffs = (this_.enable40ColumnMode ? 0 : 16);
+    Line160& lineY = this_.resizedImage.y()[yc >> 1];
+    Line160& lineU = this_.resizedImage.u()[yc >> 1];
+    Line160& lineV = this_.resizedImage.v()[yc >> 1];
+    for (int xc = 0; xc < w; xc++) {
+      lineY[(xc + xOffs) >> 2] += (y[xc] * 0.125f);
+      lineU[(xc + xOffs) >> 2] += (u[xc] * 0.125f);
+      lineV[(xc + xOffs) >> 2] += (v[xc] * 0.125f);
+    }
+  }
+
+  bool P4FLI_MultiColorNoInterlace::isPreviousFrameReuseSupported() const
+  {
+    return true;
   }
 
   void P4FLI_MultiColorNoInterlace::checkParameters()
@@ -451,140 +463,63 @@ namespace Plus4FLIConv {
         color2 = 0x00;
       return 0.0;
     }
-    double  minErr = 1000000.0;
+    int     nPixels_ = 0;
+    int     pixelColors_[8];
+    int     pixelCounts_[8];
+    double  baseErrors_[8];
+    double  baseErrors2_[8];
+    for (int i = 0; i < 8; i++) {
+      pixelColors_[i] = 0;
+      pixelCounts_[i] = 0;
+      baseErrors_[i] = 0.0;
+      baseErrors2_[i] = 0.0;
+    }
+    for (int i = 0; i < nColors_0_; i++) {
+      int     c = pixelColorCodes_0_[i];
+      double  err0 = errorTable[(c << 7) | color0_0];
+      double  err3 = errorTable[(c << 7) | color3_0];
+      pixelColors_[nPixels_] = c;
+      pixelCounts_[nPixels_] = pixelColorCounts_0_[i];
+      baseErrors_[nPixels_] = (err3 < err0 ? err3 : err0);
+      nPixels_++;
+    }
+    for (int i = 0; i < nColors_1_; i++) {
+      int     c = pixelColorCodes_1_[i];
+      double  err0 = errorTable[(c << 7) | color0_1];
+      double  err3 = errorTable[(c << 7) | color3_1];
+      pixelColors_[nPixels_] = c;
+      pixelCounts_[nPixels_] = pixelColorCounts_1_[i];
+      baseErrors_[nPixels_] = (err3 < err0 ? err3 : err0);
+      nPixels_++;
+    }
     if (colorTable_.size() <= 48) {
       // color #1 and color #2
-      int     bestColor1 = color1;
-      int     bestColor2 = color2;
-      for (size_t c1i = 0; c1i < colorTable_.size(); c1i++) {
-        for (size_t c2i = c1i + 1; c2i < colorTable_.size(); c2i++) {
-          color1 = colorTable_[c1i];
-          color2 = colorTable_[c2i];
-          double  err = 0.0;
-          for (int i = 0; i < nColors_0_; i++) {
-            int     c = pixelColorCodes_0_[i];
-            double  minErr2 = errorTable[(c << 7) | color0_0];
-            double  err2 = errorTable[(c << 7) | color1];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color2];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color3_0];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err += (minErr2 * double(pixelColorCounts_0_[i]));
-          }
-          for (int i = 0; i < nColors_1_; i++) {
-            int     c = pixelColorCodes_1_[i];
-            double  minErr2 = errorTable[(c << 7) | color0_1];
-            double  err2 = errorTable[(c << 7) | color1];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color2];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err2 = errorTable[(c << 7) | color3_1];
-            if (err2 < minErr2)
-              minErr2 = err2;
-            err += (minErr2 * double(pixelColorCounts_1_[i]));
-          }
-          if (err < minErr) {
-            bestColor1 = color1;
-            bestColor2 = color2;
-            minErr = err;
-          }
-        }
-      }
-      color1 = bestColor1;
-      color2 = bestColor2;
+      return FLIConverter::findBestColors(color1, color2, true, colorTable_,
+                                          errorTable, pixelColors_,
+                                          pixelCounts_, baseErrors_,
+                                          nPixels_);
     }
-    else {
-      // color #1
-      int     bestColor = color1;
-      for (size_t j = 0; j < colorTable_.size(); j++) {
-        color1 = colorTable_[j];
-        double  err = 0.0;
-        for (int i = 0; i < nColors_0_; i++) {
-          int     c = pixelColorCodes_0_[i];
-          double  minErr2 = errorTable[(c << 7) | color0_0];
-          double  err2 = errorTable[(c << 7) | color1];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color2];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color3_0];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err += (minErr2 * double(pixelColorCounts_0_[i]));
-        }
-        for (int i = 0; i < nColors_1_; i++) {
-          int     c = pixelColorCodes_1_[i];
-          double  minErr2 = errorTable[(c << 7) | color0_1];
-          double  err2 = errorTable[(c << 7) | color1];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color2];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color3_1];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err += (minErr2 * double(pixelColorCounts_1_[i]));
-        }
-        if (err < minErr) {
-          bestColor = color1;
-          minErr = err;
-        }
-      }
-      color1 = bestColor;
-      // color #2
-      minErr = 1000000.0;
-      bestColor = color2;
-      for (size_t j = 0; j < colorTable_.size(); j++) {
-        color2 = colorTable_[j];
-        double  err = 0.0;
-        for (int i = 0; i < nColors_0_; i++) {
-          int     c = pixelColorCodes_0_[i];
-          double  minErr2 = errorTable[(c << 7) | color0_0];
-          double  err2 = errorTable[(c << 7) | color1];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color2];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color3_0];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err += (minErr2 * double(pixelColorCounts_0_[i]));
-        }
-        for (int i = 0; i < nColors_1_; i++) {
-          int     c = pixelColorCodes_1_[i];
-          double  minErr2 = errorTable[(c << 7) | color0_1];
-          double  err2 = errorTable[(c << 7) | color1];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color2];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err2 = errorTable[(c << 7) | color3_1];
-          if (err2 < minErr2)
-            minErr2 = err2;
-          err += (minErr2 * double(pixelColorCounts_1_[i]));
-        }
-        if (err < minErr) {
-          bestColor = color2;
-          minErr = err;
-        }
-      }
-      color2 = bestColor;
+    // color #1
+    for (int i = 0; i < nPixels_; i++) {
+      double  err = errorTable[(pixelColors_[i] << 7) | color2];
+      baseErrors2_[i] = (err < baseErrors_[i] ? err : baseErrors_[i]);
     }
-    return minErr;
+    FLIConverter::findBestColors(color1, color2, false, colorTable_,
+                                 errorTable, pixelColors_, pixelCounts_,
+                                 baseErrors2_, nPixels_);
+    // color #2
+    for (int i = 0; i < nPixels_; i++) {
+      double  err = errorTable[(pixelColors_[i] << 7) | color1];
+      baseErrors2_[i] = (err < baseErrors_[i] ? err : baseErrors_[i]);
+    }
+    return FLIConverter::findBestColors(color2, color1, false, colorTable_,
+                                        errorTable, pixelColors_,
+                                        pixelCounts_, baseErrors2_, nPixels_);
   }
 
   void P4FLI_MultiColorNoInterlace::initializePalettes()
   {
+    paletteMonitorGamma = monitorGamma;
     if (!ditherPaletteY) {
       ditherPaletteY = new float[768];
       ditherPaletteU = &(ditherPaletteY[128]);
@@ -603,6 +538,7 @@ namespace Plus4FLIConv {
 
   void P4FLI_MultiColorNoInterlace::createErrorTable(double colorErrorScale)
   {
+    errorTableColorScale = colorErrorScale;
     limitValue(colorErrorScale, 0.05, 1.0);
     for (int c0 = 0; c0 < 128; c0++) {
       for (int c1 = 0; c1 < 128; c1++) {
@@ -799,40 +735,15 @@ namespace Plus4FLIConv {
       float   errY = y - ditherPaletteY[c];
       float   errU = u - ditherPaletteU[c];
       float   errV = v - ditherPaletteV[c];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < long(nLines) && xc_ >= 0L && xc_ < 160L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage.y()[yc_].setPixel(
-              xc_, ditherErrorImage.y()[yc_].getPixel(xc_) + (errY * errMult));
-          ditherErrorImage.u()[yc_].setPixel(
-              xc_, ditherErrorImage.u()[yc_].getPixel(xc_) + (errU * errMult));
-          ditherErrorImage.v()[yc_].setPixel(
-              xc_, ditherErrorImage.v()[yc_].getPixel(xc_) + (errV * errMult));
-        }
-      }
+      diffuseDitherErrorYUV(ditherMode, ditherErrorImage,
+                            xc, yc, 160L, long(nLines), errY, errU, errV);
       if (yc & 1L)
         xc = 159L - xc;
     }
   }
 
-  double P4FLI_MultiColorNoInterlace::convertTwoLines(PRGData& prgData, long yc)
+  double P4FLI_MultiColorNoInterlace::convertTwoLines(PRGData& prgData, long yc,
+                                                      const int *prvColors)
   {
     int     color0_0 = 0;
     int     color0_1 = 0;
@@ -966,7 +877,9 @@ namespace Plus4FLIConv {
     std::vector< int >  colorCnts(128);
     int     randomSeed = 0;
     Plus4Emu::setRandomSeed(randomSeed, 1U);
-    for (int l = 0; l < conversionQuality; l++) {
+    // pass -1 starts from the colors of the previous frame
+    for (int l = (prvColors ? -1 : 0); l < (prvColors ? 0 : conversionQuality);
+         l++) {
       // set initial palette with different methods, and choose the one
       // that results in the least error after optimization
       for (int i = 0; i < 128; i++)
@@ -979,6 +892,10 @@ namespace Plus4FLIConv {
         }
         else {
           switch (l) {
+          case -1:
+            attrBlocks[i].color1 = prvColors[i << 1];
+            attrBlocks[i].color2 = prvColors[(i << 1) + 1];
+            break;
           case 0:
           case 6:
             attrBlocks[i].color1 = attrBlocks[i].pixelColorCodes[nColors - 1];
@@ -1035,7 +952,13 @@ namespace Plus4FLIConv {
           }
         }
       }
-      if (l == 4 || l == 10) {
+      if (l < 0) {
+        color0_0 = prvColors[80];
+        color0_1 = prvColors[81];
+        color3_0 = prvColors[82];
+        color3_1 = prvColors[83];
+      }
+      else if (l == 4 || l == 10) {
         color0_0 = 0x71;
         color3_0 = 0x71;
       }
@@ -1065,11 +988,13 @@ namespace Plus4FLIConv {
         color3_0 = colorTable0[Plus4Emu::getRandomNumber(randomSeed)
                                % int(colorTable0.size())];
       }
-      color0_1 = color0_0;
-      color3_1 = color3_0;
+      if (l >= 0) {
+        color0_1 = color0_0;
+        color3_1 = color3_0;
+      }
       // optimize attributes and color registers
       double  prvErr = 1000000.0;
-      for (int i = (l < 6 ? 7 : -1); i >= 0; i--) {
+      for (int i = (l >= 0 && l < 6 ? 7 : -1); i >= 0; i--) {
         // color #0 (FF15), line 0 and 1
         double  minErr = prvErr;
         int     bestColor = color0_0;
@@ -1263,6 +1188,13 @@ namespace Plus4FLIConv {
     color0_1 = bestColors[81];
     color3_0 = bestColors[82];
     color3_1 = bestColors[83];
+    {
+      int     *p = getFrameParams(size_t(yc >> 1));
+      for (int i = 0; i < 84; i++)
+        p[i] = bestColors[i];
+      p[84] = xs[0];
+      p[85] = xs[1];
+    }
     // store the attributes and color registers
     prgData.lineColor0(yc << 1) = (unsigned char) color0_0;
     prgData.lineColor0((yc << 1) | 2L) = (unsigned char) color0_1;
@@ -1335,8 +1267,17 @@ namespace Plus4FLIConv {
       conversionQuality = config["multiColorQuality"];
       luminance1BitMode = config["luminance1BitMode"];
       checkParameters();
-      initializePalettes();
-      createErrorTable(double(config["mcColorErrorScale"]));
+      if (monitorGamma != paletteMonitorGamma ||
+          double(config["mcColorErrorScale"]) != errorTableColorScale) {
+        // only needs to be done again if the converter is reused for
+        // another image with different parameters
+        initializePalettes();
+        createErrorTable(double(config["mcColorErrorScale"]));
+        invalidatePrvFrame();
+      }
+      // the previous frame can only be used with the same X shift mode
+      beginFrame(size_t(nLines >> 1), 86, 320,
+                 (xShift0 & 0xFF) | (int(luminance1BitMode) << 8));
       enable40ColumnMode = (xShift0 == 0);
       prgData.setConversionType(5);
       prgData.clear();
@@ -1352,13 +1293,17 @@ namespace Plus4FLIConv {
       }
       imgConv.setImageSize((enable40ColumnMode ? 640 : 608), nLines * 2);
       imgConv.setPixelAspectRatio(1.0f);
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       for (int yc = 0; yc < nLines; yc++) {
         for (int xc = 0; xc < 160; xc++) {
           limitYUVColor(resizedImage.y()[yc][xc],
                         resizedImage.u()[yc][xc],
                         resizedImage.v()[yc][xc]);
+          storeFramePixel(size_t(yc >> 1), size_t(((yc & 1) * 160) + xc),
+                          resizedImage.y()[yc][xc],
+                          resizedImage.u()[yc][xc],
+                          resizedImage.v()[yc][xc]);
         }
       }
       // initialize horizontal scroll table
@@ -1399,6 +1344,23 @@ namespace Plus4FLIConv {
           progressMessage("");
           return false;
         }
+        const int *prvColors = getPrvFrameParams(size_t(yc >> 1));
+        if (prvColors) {
+          // try the X shifts and colors of the previous frame first, and
+          // keep the result if the error is not much worse than that of the
+          // last full search on this line pair
+          int     savedXShift0 = xShiftTable[yc + 0];
+          int     savedXShift1 = xShiftTable[yc + 1];
+          xShiftTable[yc + 0] = prvColors[84];
+          xShiftTable[yc + 1] = prvColors[85];
+          double  err = convertTwoLines(prgData, yc, prvColors);
+          if (checkPrvFrameError(size_t(yc >> 1), err)) {
+            totalError += err;
+            continue;
+          }
+          xShiftTable[yc + 0] = savedXShift0;
+          xShiftTable[yc + 1] = savedXShift1;
+        }
         int     bestXShift0 = xShiftTable[yc + 0];
         int     bestXShift1 = xShiftTable[yc + 1];
         if (xShift0 == -1) {
@@ -1419,8 +1381,11 @@ namespace Plus4FLIConv {
         }
         xShiftTable[yc + 0] = bestXShift0;
         xShiftTable[yc + 1] = bestXShift1;
-        totalError += convertTwoLines(prgData, yc);
+        double  err = convertTwoLines(prgData, yc);
+        setFrameError(size_t(yc >> 1), err);
+        totalError += err;
       }
+      endFrame();
       setProgressPercentage(100);
       progressMessage("");
       {
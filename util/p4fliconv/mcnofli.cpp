@@ -133,7 +133,9 @@ namespace Plus4FLIConv {
       ditherPaletteV((float *) 0),
       errorPaletteY((float *) 0),
       errorPaletteU((float *) 0),
-      errorPaletteV((float *) 0)
+      errorPaletteV((float *) 0),
+      paletteMonitorGamma(-1.0),
+      errorTableColorScale(-1.0)
   {
     try {
       ditheredImage = new int[160 * 200];
@@ -160,14 +162,25 @@ namespace Plus4FLIConv {
       delete[] ditherPaletteY;  // as a single block of memory
   }
 
-  void P4FLI_MultiColorNoFLI::pixelStoreCallback(void *userData, int xc, int yc,
-                                                 float y, float u, float v)
+  void P4FLI_MultiColorNoFLI::rowStoreCallback(
+      void *userData, int yc,
+      const float *y, const float *u, const float *v, int w)
   {
     P4FLI_MultiColorNoFLI&  this_ =
         *(reinterpret_cast<P4FLI_MultiColorNoFLI *>(userData));
-    this_.resizedImage.y()[yc >> 1][xc >> 2] += (y * 0.125f);
-    this_.resizedImage.u()[yc >> 1][xc >> 2] += (u * 0.125f);
-    this_.resizedImage.v()[yc >> 1][xc >> 2] += (v * 0.125f);
+    Line160& lineY = this_.resizedImage.y()[yc >> 1];
+    Line160& lineU = this_.resizedImage.u()[yc >> 1];
+    Line160& lineV = this_.resizedImage.v()[yc >> 1];
+    for (int xc = 0; xc < w; xc++) {
+      lineY[xc >> 2] += (y[xc] * 0.125f);
+      lineU[xc >> 2] += (u[xc] * 0.125f);
+      lineV[xc >> 2] += (v[xc] * 0.125f);
+    }
+  }
+
+  bool P4FLI_MultiColorNoFLI::isPreviousFrameReuseSupported() const
+  {
+    return true;
   }
 
   void P4FLI_MultiColorNoFLI::checkParameters()
@@ -265,6 +278,7 @@ namespace Plus4FLIConv {
 
   void P4FLI_MultiColorNoFLI::initializePalettes()
   {
+    paletteMonitorGamma = monitorGamma;
     if (!ditherPaletteY) {
       ditherPaletteY = new float[768];
       ditherPaletteU = &(ditherPaletteY[128]);
@@ -283,6 +297,7 @@ namespace Plus4FLIConv {
 
   void P4FLI_MultiColorNoFLI::createErrorTable(double colorErrorScale)
   {
+    errorTableColorScale = colorErrorScale;
     limitValue(colorErrorScale, 0.05, 1.0);
     for (int c0 = 0; c0 < 128; c0++) {
       for (int c1 = 0; c1 < 128; c1++) {
@@ -479,40 +494,15 @@ namespace Plus4FLIConv {
       float   errY = y - ditherPaletteY[c];
       float   errU = u - ditherPaletteU[c];
       float   errV = v - ditherPaletteV[c];
-      const int *errMultTbl = &(ditherTable_FloydSteinberg[0]);
-      switch (ditherMode) {
-      case 3:
-        errMultTbl = &(ditherTable_Jarvis[0]);
-        break;
-      case 4:
-        errMultTbl = &(ditherTable_Stucki[0]);
-        break;
-      case 5:
-        errMultTbl = &(ditherTable_Sierra2[0]);
-        break;
-      }
-      for (int i = 0; i < 12; i++) {
-        if (errMultTbl[i + 1] == 0)
-          continue;
-        long    yc_ = yc + ((i + 3) / 5);
-        long    xc_ = ((i + 3) % 5) - 2;
-        xc_ = ((yc & 1L) == 0L ? (xc + xc_) : (xc - xc_));
-        if (yc_ >= 0L && yc_ < 200L && xc_ >= 0L && xc_ < 160L) {
-          float   errMult = float(errMultTbl[i + 1]) / float(errMultTbl[0]);
-          ditherErrorImage.y()[yc_].setPixel(
-              xc_, ditherErrorImage.y()[yc_].getPixel(xc_) + (errY * errMult));
-          ditherErrorImage.u()[yc_].setPixel(
-              xc_, ditherErrorImage.u()[yc_].getPixel(xc_) + (errU * errMult));
-          ditherErrorImage.v()[yc_].setPixel(
-              xc_, ditherErrorImage.v()[yc_].getPixel(xc_) + (errV * errMult));
-        }
-      }
+      diffuseDitherErrorYUV(ditherMode, ditherErrorImage,
+                            xc, yc, 160L, 200L, errY, errU, errV);
       if (yc & 1L)
         xc = 159L - xc;
     }
   }
 
-  bool P4FLI_MultiColorNoFLI::convertImage(PRGData& prgData, double& totalError)
+  bool P4FLI_MultiColorNoFLI::convertImage(PRGData& prgData, double& totalError,
+                                           const int *prvColors)
   {
     totalError = 0.0;
     int     color0 = 0x00;
@@ -631,14 +621,16 @@ namespace Plus4FLIConv {
       attrBlocks[i].color2 = attrBlocks[i].pixelColorCodes[1];
     }
     std::vector< int >  colorCnts(128);
-    if (conversionQuality < 16) {
+    if (conversionQuality < 16 || prvColors) {
       double  bestErr = 1000000.0;
       int     bestColors[2];
       bestColors[0] = color0;
       bestColors[1] = color3;
       int     randomSeed = 0;
       Plus4Emu::setRandomSeed(randomSeed, 1U);
-      for (int l = 0; l < (conversionQuality * 2); l++) {
+      // pass -1 starts from the colors of the previous frame
+      for (int l = (prvColors ? -1 : 0);
+           l < (prvColors ? 0 : (conversionQuality * 2)); l++) {
         if (!setProgressPercentage(((l * 90) / (conversionQuality * 2)) + 10))
           return false;
         // set initial palette with different methods, and choose the one
@@ -657,6 +649,7 @@ namespace Plus4FLIConv {
               attrBlocks[i].color1 = attrBlocks[i].pixelColorCodes[nColors - 1];
               attrBlocks[i].color2 = attrBlocks[i].pixelColorCodes[nColors - 2];
               break;
+            case -1:
             case 1:
               attrBlocks[i].color1 = attrBlocks[i].pixelColorCodes[0];
               attrBlocks[i].color2 = attrBlocks[i].pixelColorCodes[1];
@@ -704,7 +697,11 @@ namespace Plus4FLIConv {
             }
           }
         }
-        if (l == 4) {
+        if (l < 0) {
+          color0 = prvColors[0];
+          color3 = prvColors[1];
+        }
+        else if (l == 4) {
           color0 = 0x71;
           color3 = 0x71;
         }
@@ -737,10 +734,14 @@ namespace Plus4FLIConv {
         // optimize attributes and color registers
         double  prvErr = 1000000.0;
         for (int i = 7; i >= 0; i--) {
+          // when starting from the previous frame, the first iteration only
+          // calculates the error of the old color registers, so that they
+          // are kept unless a better pair is found
+          size_t  nColors0 = ((l < 0 && i == 7) ? 0 : colorTable0.size());
           // color #0 (FF15)
           double  minErr = prvErr;
           int     bestColor = color0;
-          for (size_t j = 0; j < colorTable0.size(); j++) {
+          for (size_t j = 0; j < nColors0; j++) {
             color0 = colorTable0[j];
             double  err = 0.0;
             for (int k = 0; k < 1000; k++) {
@@ -758,7 +759,7 @@ namespace Plus4FLIConv {
           color0 = bestColor;
           // color #3 (FF16)
           bestColor = color3;
-          for (size_t j = 0; j < colorTable0.size(); j++) {
+          for (size_t j = 0; j < nColors0; j++) {
             color3 = colorTable0[j];
             double  err = 0.0;
             for (int k = 0; k < 1000; k++) {
@@ -942,6 +943,8 @@ namespace Plus4FLIConv {
       attrBlocks[k].color1 = bestColor1;
       attrBlocks[k].color2 = bestColor2;
     }
+    getFrameParams(0)[0] = color0;
+    getFrameParams(0)[1] = color3;
     // store the attributes and color registers
     prgData[0x7BFE - 0x0FFF] =
         (unsigned char) (((color3 & 0x70) >> 4) | ((color3 & 0x0F) << 4));
@@ -1010,8 +1013,16 @@ namespace Plus4FLIConv {
       conversionQuality = config["multiColorQuality"];
       luminance1BitMode = config["luminance1BitMode"];
       checkParameters();
-      initializePalettes();
-      createErrorTable(double(config["mcColorErrorScale"]));
+      if (monitorGamma != paletteMonitorGamma ||
+          double(config["mcColorErrorScale"]) != errorTableColorScale) {
+        // only needs to be done again if the converter is reused for
+        // another image with different parameters
+        initializePalettes();
+        createErrorTable(double(config["mcColorErrorScale"]));
+        invalidatePrvFrame();
+      }
+      // the whole image is converted as a single unit
+      beginFrame(1, 2, 160 * 200, int(luminance1BitMode));
       prgData.setConversionType(7);
       prgData.clear();
       prgData.borderColor() = (unsigned char) borderColor;
@@ -1025,13 +1036,17 @@ namespace Plus4FLIConv {
       }
       imgConv.setImageSize(640, 400);
       imgConv.setPixelAspectRatio(1.0f);
-      imgConv.setPixelStoreCallback(&pixelStoreCallback, (void *) this);
+      imgConv.setRowStoreCallback(&rowStoreCallback, (void *) this);
       imgConv.convertImageFile(infileName);
       for (int yc = 0; yc < 200; yc++) {
         for (int xc = 0; xc < 160; xc++) {
           limitYUVColor(resizedImage.y()[yc][xc],
                         resizedImage.u()[yc][xc],
                         resizedImage.v()[yc][xc]);
+          storeFramePixel(0, size_t((yc * 160) + xc),
+                          resizedImage.y()[yc][xc],
+                          resizedImage.u()[yc][xc],
+                          resizedImage.v()[yc][xc]);
         }
       }
       // convert input image to 121 colors with dithering
@@ -1050,15 +1065,30 @@ namespace Plus4FLIConv {
       }
       // generate FLI data
       double  totalError = 0.0;
-      if (!convertImage(prgData, totalError)) {
-        prgData[0] = 0x01;
-        prgData[1] = 0x10;
-        prgData[2] = 0x00;
-        prgData[3] = 0x00;
-        prgEndAddr = 0x1003U;
-        progressMessage("");
-        return false;
+      const int *prvColors = getPrvFrameParams(0);
+      for (int i = (prvColors ? 0 : 1); i < 2; i++) {
+        // try the color registers of the previous frame first, and keep
+        // the result if the error is not much worse than that of the last
+        // full search
+        if (!convertImage(prgData, totalError,
+                          (i == 0 ? prvColors : (const int *) 0))) {
+          prgData[0] = 0x01;
+          prgData[1] = 0x10;
+          prgData[2] = 0x00;
+          prgData[3] = 0x00;
+          prgEndAddr = 0x1003U;
+          progressMessage("");
+          return false;
+        }
+        if (i == 0) {
+          if (checkPrvFrameError(0, totalError))
+            break;
+        }
+        else {
+          setFrameError(0, totalError);
+        }
       }
+      endFrame();
       setProgressPercentage(100);
       progressMessage("");
       {
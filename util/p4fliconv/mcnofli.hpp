@@ -129,8 +129,13 @@ namespace Plus4FLIConv {
     float   *errorPaletteY;
     float   *errorPaletteU;
     float   *errorPaletteV;
+    // parameters used for the current palettes and error table
+    double  paletteMonitorGamma;
+    double  errorTableColorScale;
     // ----------------
-    static void pixelStoreCallback(void *, int, int, float, float, float);
+    static void rowStoreCallback(void *, int,
+                                 const float *, const float *, const float *,
+                                 int);
     void checkParameters();
     void initializePalettes();
     void createErrorTable(double colorErrorScale);
@@ -139,10 +144,16 @@ namespace Plus4FLIConv {
                          const float *paletteU,
                          const float *paletteV);
     void ditherLine(long yc);
-    bool convertImage(PRGData& prgData, double& totalError);
+    // the color registers (FF15 and FF16) are stored as the parameters of
+    // the only frame unit; if 'prvColors' is not NULL, it points to the
+    // color registers to start from, and only a single optimization pass
+    // is done
+    bool convertImage(PRGData& prgData, double& totalError,
+                      const int *prvColors = (const int *) 0);
    public:
     P4FLI_MultiColorNoFLI();
     virtual ~P4FLI_MultiColorNoFLI();
+    virtual bool isPreviousFrameReuseSupported() const;
     virtual bool processImage(PRGData& prgData, unsigned int& prgEndAddr,
                               const char *infileName,
                               YUVImageConverter& imgConv,
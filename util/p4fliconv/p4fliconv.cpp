@@ -96,12 +96,75 @@ namespace Plus4FLIConv {
     }
   }
 
+  double FLIConverter::findBestColors(int& color1, int& color2,
+                                      bool searchColor2,
+                                      const std::vector< int >& colorTable_,
+                                      const double *errorTable,
+                                      const int *pixelColors,
+                                      const int *pixelCounts,
+                                      const double *baseErrors, int nPixels)
+  {
+    // colorTable_ contains each color code at most once
+    int     n = int(colorTable_.size());
+    double  pixelErrors[16][128];
+    double  pixelWeights[16];
+    double  minErrors[16];
+    double  totalErrors[128];
+    double  minErr = 1000000.0;
+    for (int i = 0; i < nPixels; i++) {
+      const double  *t = &(errorTable[pixelColors[i] << 7]);
+      for (int k = 0; k < n; k++)
+        pixelErrors[i][k] = t[colorTable_[k]];
+      pixelWeights[i] = double(pixelCounts[i]);
+    }
+    // with searchColor2 == false, a single pass is done with j = -1
+    for (int j = (searchColor2 ? 0 : -1); j < (searchColor2 ? (n - 1) : 0);
+         j++) {
+      for (int i = 0; i < nPixels; i++) {
+        double  err = baseErrors[i];
+        if (j >= 0 && pixelErrors[i][j] < err)
+          err = pixelErrors[i][j];
+        minErrors[i] = err;
+      }
+      for (int k = j + 1; k < n; k++)
+        totalErrors[k] = 0.0;
+      for (int i = 0; i < nPixels; i++) {
+        const double  *e = &(pixelErrors[i][0]);
+        double  b = minErrors[i];
+        double  w = pixelWeights[i];
+        for (int k = j + 1; k < n; k++)
+          totalErrors[k] += ((e[k] < b ? e[k] : b) * w);
+      }
+      for (int k = j + 1; k < n; k++) {
+        if (totalErrors[k] < minErr) {
+          minErr = totalErrors[k];
+          if (j >= 0) {
+            color1 = colorTable_[j];
+            color2 = colorTable_[k];
+          }
+          else {
+            color1 = colorTable_[k];
+          }
+        }
+      }
+    }
+    return minErr;
+  }
+
   FLIConverter::FLIConverter()
     : progressMessageCallback(&defaultProgressMessageCb),
       progressMessageUserData((void *) 0),
       progressPercentageCallback(&defaultProgressPercentageCb),
       progressPercentageUserData((void *) 0),
-      prvProgressPercentage(-1)
+      prvProgressPercentage(-1),
+      prvFrameReuseEnabled(false),
+      frameUnitParams(0),
+      frameUnitErrors(0),
+      frameUnitPixels(0),
+      frameFormat(0),
+      prvFrameFormat(0),
+      prvFrameCnt(0),
+      prvFrameValid(false)
   {
   }
 
@@ -153,6 +216,16 @@ namespace Plus4FLIConv {
     }
   }
 
+  void FLIConverter::setPreviousFrameReuse(bool isEnabled)
+  {
+    prvFrameReuseEnabled = isEnabled;
+  }
+
+  bool FLIConverter::isPreviousFrameReuseSupported() const
+  {
+    return false;
+  }
+
   void FLIConverter::progressMessage(const char *msg)
   {
     if (msg == (char *) 0)
@@ -170,6 +243,65 @@ namespace Plus4FLIConv {
     return true;
   }
 
+  void FLIConverter::beginFrame(size_t nUnits, size_t nParams, size_t nPixels,
+                                int frameFormat_, size_t nErrors)
+  {
+    prvFrameValid = (prvFrameReuseEnabled &&
+                     prvFrameErrors.size() == (nUnits * nErrors) &&
+                     nParams == frameUnitParams &&
+                     nErrors == frameUnitErrors &&
+                     nPixels == frameUnitPixels &&
+                     frameFormat_ == prvFrameFormat);
+    frameUnitParams = nParams;
+    frameUnitErrors = nErrors;
+    frameUnitPixels = nPixels;
+    frameFormat = frameFormat_;
+    frameParams.resize(nUnits * nParams);
+    frameErrors.resize(nUnits * nErrors);
+    frameImage.resize(nUnits * nPixels * 3);
+  }
+
+  void FLIConverter::invalidatePrvFrame()
+  {
+    prvFrameErrors.clear();
+    prvFrameValid = false;
+  }
+
+  const int * FLIConverter::getPrvFrameParams(size_t unitNum) const
+  {
+    if (!prvFrameValid || ((size_t(prvFrameCnt) + unitNum) & 7) == 0)
+      return (int *) 0;
+    const float *p = &(frameImage[unitNum * frameUnitPixels * 3]);
+    const float *prvp = &(prvFrameImage[unitNum * frameUnitPixels * 3]);
+    double  diff = 0.0;
+    for (size_t i = 0; i < (frameUnitPixels * 3); i++)
+      diff += std::fabs(double(p[i]) - double(prvp[i]));
+    // the average difference of the Y, U and V components
+    if ((diff / double(frameUnitPixels)) >= 0.03)
+      return (int *) 0;
+    return &(prvFrameParams[unitNum * frameUnitParams]);
+  }
+
+  bool FLIConverter::checkPrvFrameError(size_t unitNum, double err,
+                                        size_t errNum)
+  {
+    size_t  n = (unitNum * frameUnitErrors) + errNum;
+    if (err <= (prvFrameErrors[n] * 1.25 + 0.01)) {
+      frameErrors[n] = prvFrameErrors[n];
+      return true;
+    }
+    return false;
+  }
+
+  void FLIConverter::endFrame()
+  {
+    frameParams.swap(prvFrameParams);
+    frameErrors.swap(prvFrameErrors);
+    frameImage.swap(prvFrameImage);
+    prvFrameFormat = frameFormat;
+    prvFrameCnt = (prvFrameCnt + 1) & 7;
+  }
+
 }       // namespace Plus4FLIConv
 
 // ----------------------------------------------------------------------------
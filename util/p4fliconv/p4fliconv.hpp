@@ -30,6 +30,7 @@
 #include "ted.hpp"
 
 #include <cmath>
+#include <vector>
 
 #include <FL/Fl.H>
 #include <FL/Fl_File_Chooser.H>
@@ -60,6 +61,30 @@ namespace Plus4FLIConv {
     bool    (*progressPercentageCallback)(void *userData, int n);
     void    *progressPercentageUserData;
     int     prvProgressPercentage;
+    // if true, processImage() may use the results of the previous call as
+    // the starting point (see setPreviousFrameReuse())
+    bool    prvFrameReuseEnabled;
+   private:
+    // for previous frame reuse, the image is divided into units (e.g. line
+    // pairs) that are converted separately; for each unit of the current
+    // and previous frame, the parameters found by the converter (attributes,
+    // color registers, X shifts, etc.), the error(s) of the last full search,
+    // and the Y, U and V components of the resized image are stored
+    std::vector< int >    frameParams;
+    std::vector< int >    prvFrameParams;
+    std::vector< double > frameErrors;
+    std::vector< double > prvFrameErrors;
+    std::vector< float >  frameImage;
+    std::vector< float >  prvFrameImage;
+    size_t  frameUnitParams;
+    size_t  frameUnitErrors;
+    size_t  frameUnitPixels;
+    int     frameFormat;
+    int     prvFrameFormat;
+    // number of frames converted (0 to 7), selects the units that are
+    // searched again
+    int     prvFrameCnt;
+    bool    prvFrameValid;
    public:
     static const float  defaultColorSaturation;
     FLIConverter();
@@ -75,11 +100,76 @@ namespace Plus4FLIConv {
     virtual void setProgressPercentageCallback(bool (*func)(void *userData,
                                                             int n),
                                                void *userData_);
+    // If enabled, converting an image may start from the attributes and
+    // color registers found for the previous one, which is much faster for
+    // the frames of an animation, and results in fewer changes between
+    // frames. Has no effect if isPreviousFrameReuseSupported() is false.
+    virtual void setPreviousFrameReuse(bool isEnabled);
+    // returns true if the converter implements previous frame reuse
+    virtual bool isPreviousFrameReuseSupported() const;
     static void convertPlus4Color(int c, float& y, float& u, float& v,
                                   double monitorGamma_ = 1.0);
+    // Search 'colorTable_' for the color(s) that result in the lowest total
+    // error for 'nPixels' (at most 16) pixels with color codes 'pixelColors',
+    // weights 'pixelCounts', and minimum error with the colors not being
+    // searched (e.g. background colors) 'baseErrors'. If 'searchColor2' is
+    // true, the best pair of different colors is stored in 'color1' and
+    // 'color2', otherwise only 'color1' is searched. Colors are not changed
+    // if no error is less than 1000000.0, which is also returned in that
+    // case. The search uses a table of per-pixel errors for each candidate
+    // color, and calculates the errors for all possible second colors in one
+    // loop, which can be vectorized by the compiler. The result is the same
+    // as evaluating each color (pair) in the order of 'colorTable_'.
+    static double findBestColors(int& color1, int& color2,
+                                 bool searchColor2,
+                                 const std::vector< int >& colorTable_,
+                                 const double *errorTable,
+                                 const int *pixelColors,
+                                 const int *pixelCounts,
+                                 const double *baseErrors, int nPixels);
    protected:
     virtual void progressMessage(const char *msg);
     virtual bool setProgressPercentage(int n);
+    // Start converting a frame of 'nUnits' units, with 'nParams' parameters
+    // and 'nPixels' pixels stored for each unit. The previous frame is only
+    // used if it has the same size and 'frameFormat_' (a converter specific
+    // code of the settings that the stored parameters depend on).
+    // 'nErrors' is the number of errors stored per unit, if the parts of
+    // a unit are searched (and can be reused) separately.
+    void beginFrame(size_t nUnits, size_t nParams, size_t nPixels,
+                    int frameFormat_, size_t nErrors = 1);
+    // discard the previous frame (e.g. after changing the error table)
+    void invalidatePrvFrame();
+    // returns the parameters of unit 'unitNum' in the previous frame, or
+    // NULL if they should not be used because reuse is disabled, there is
+    // no previous frame in the same format, the image of the unit has
+    // changed too much, or the unit needs a full search; each unit is
+    // searched again on every 8th frame (1/8 of them on each frame), so
+    // that the error limit is re-anchored from the current image
+    const int *getPrvFrameParams(size_t unitNum) const;
+    // returns true if 'err', the error of converting unit 'unitNum' starting
+    // from the parameters of the previous frame, is not much worse than that
+    // of the last full search, and the result can be kept
+    bool checkPrvFrameError(size_t unitNum, double err, size_t errNum = 0);
+    // save the current frame as the previous one for the next image
+    void endFrame();
+    inline int *getFrameParams(size_t unitNum)
+    {
+      return &(frameParams[unitNum * frameUnitParams]);
+    }
+    // store the error of a full search on unit 'unitNum'
+    inline void setFrameError(size_t unitNum, double err, size_t errNum = 0)
+    {
+      frameErrors[unitNum * frameUnitErrors + errNum] = err;
+    }
+    inline void storeFramePixel(size_t unitNum, size_t pixelNum,
+                                float y, float u, float v)
+    {
+      float   *p = &(frameImage[(unitNum * frameUnitPixels + pixelNum) * 3]);
+      p[0] = y;
+      p[1] = u;
+      p[2] = v;
+    }
   };
 
   // --------------------------------------------------------------------------
@@ -0,0 +1,167 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// benchmark for the self-extracting programs created by the compress
+// utility: each file specified on the command line is loaded on an emulated
+// Plus/4 and started, and the time until the decompressor returns to BASIC
+// is printed (the programs must be created without the '-start' option);
+// this can be used for checking the effect of 'compress -speed'
+
+#include "plus4emu.hpp"
+#include "display.hpp"
+#include "soundio.hpp"
+#include "cpu.hpp"
+#include "plus4vm.hpp"
+
+#include <vector>
+
+class SFXBenchVideoDisplay : public Plus4Emu::VideoDisplay {
+ private:
+  Plus4Emu::VideoDisplay::DisplayParameters displayParameters;
+ public:
+  SFXBenchVideoDisplay()
+    : Plus4Emu::VideoDisplay()
+  {
+  }
+  virtual ~SFXBenchVideoDisplay()
+  {
+  }
+  virtual void setDisplayParameters(
+      const Plus4Emu::VideoDisplay::DisplayParameters& dp)
+  {
+    displayParameters = dp;
+  }
+  virtual const Plus4Emu::VideoDisplay::DisplayParameters&
+      getDisplayParameters() const
+  {
+    return displayParameters;
+  }
+  virtual void sendVideoOutput(const uint8_t *buf, size_t nBytes)
+  {
+    (void) buf;
+    (void) nBytes;
+  }
+};
+
+// the decompressor jumps here after restoring the zeropage variables
+// (see decompress0_sfx.s)
+static const uint16_t basicWarmStartAddr = 0x867E;
+
+static void breakPointCallback(void *userData, int debugContext_, int type,
+                               uint16_t addr, uint8_t value)
+{
+  (void) debugContext_;
+  (void) value;
+  if (type == 0 && addr == basicWarmStartAddr)
+    *(reinterpret_cast< bool * >(userData)) = true;
+}
+
+// returns the start address from the SYS command in the BASIC stub
+static uint16_t readPRGFile(std::vector< uint8_t >& buf, const char *fileName)
+{
+  buf.clear();
+  std::FILE *f = std::fopen(fileName, "rb");
+  if (!f)
+    throw Plus4Emu::Exception("error opening input file");
+  int     c;
+  while ((c = std::fgetc(f)) != EOF) {
+    if (buf.size() >= 0x10001)
+      break;
+    buf.push_back(uint8_t(c));
+  }
+  std::fclose(f);
+  if (buf.size() < 3 || buf.size() > 0x10000 || buf[0] != 0x01 ||
+      buf[1] != 0x10) {
+    throw Plus4Emu::Exception("invalid self-extracting program file");
+  }
+  unsigned int  startAddr = 0U;
+  size_t  i = 6;
+  if (buf.size() > 7 && buf[i] == 0x9E) {       // SYS token
+    while (++i < buf.size() && buf[i] >= 0x30 && buf[i] <= 0x39) {
+      startAddr = (startAddr * 10U) + (unsigned int) (buf[i] - 0x30);
+      if (startAddr > 0xFFFFU)
+        break;
+    }
+  }
+  if (startAddr < 0x1001U || startAddr > 0xFFFFU)
+    throw Plus4Emu::Exception("invalid self-extracting program file");
+  return uint16_t(startAddr);
+}
+
+int main(int argc, char **argv)
+{
+  try {
+    std::string romDir("roms");
+    int     firstFile = 1;
+    if (argc > 2 && std::strcmp(argv[1], "-rom") == 0) {
+      romDir = argv[2];
+      firstFile = 3;
+    }
+    if (argc <= firstFile) {
+      throw Plus4Emu::Exception("Usage: sfxbench [-rom ROMDIR] "
+                                "<infile.prg> [infile2.prg ...]");
+    }
+    if (romDir.length() > 0 && romDir[romDir.length() - 1] != '/' &&
+        romDir[romDir.length() - 1] != '\\') {
+      romDir += '/';
+    }
+    SFXBenchVideoDisplay    videoDisplay;
+    Plus4Emu::AudioOutput   audioOutput;
+    Plus4::Plus4VM  vm(videoDisplay, audioOutput);
+    bool    doneFlag = false;
+    vm.resetMemoryConfiguration(64);
+    vm.loadROMSegment(0x00, (romDir + "p4_basic.rom").c_str(), 0);
+    vm.loadROMSegment(0x01, (romDir + "p4kernal.rom").c_str(), 0);
+    vm.setBreakPointCallback(&breakPointCallback, (void *) &doneFlag);
+    vm.setBreakPoint(6, basicWarmStartAddr, 3);
+    std::vector< uint8_t >  prgBuf;
+    double  totalTime = 0.0;
+    for (int i = firstFile; i < argc; i++) {
+      uint16_t  startAddr = readPRGFile(prgBuf, argv[i]);
+      // start from the same state for each file
+      vm.reset(true);
+      vm.run(3000000);
+      vm.injectProgram(&(prgBuf.front()), prgBuf.size());
+      Plus4::M7501Registers r;
+      vm.getCPURegisters(r);
+      r.reg_PC = startAddr;
+      vm.setCPURegisters(r);
+      doneFlag = false;
+      // run in 100 us steps for up to 60 seconds
+      long    t = 0L;
+      while (!doneFlag && t < 60000000L) {
+        vm.run(100);
+        t += 100L;
+      }
+      if (!doneFlag)
+        throw Plus4Emu::Exception("decompression did not finish in 60 s");
+      totalTime = totalTime + (double(t) * 0.000001);
+      std::printf("%s: %lu bytes, %.1f ms\n",
+                  argv[i], (unsigned long) (prgBuf.size() - 2),
+                  double(t) * 0.001);
+    }
+    std::printf("total time: %.3f s\n", totalTime);
+  }
+  catch (std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return -1;
+  }
+  return 0;
+}
+
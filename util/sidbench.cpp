@@ -0,0 +1,115 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// benchmark for the SID emulation: each chip model is run with a number of
+// filter routings on the same sequence of register writes, and a checksum of
+// the output and the emulation speed are printed; with the default number of
+// cycles, the checksums are also compared against the expected values, and
+// the exit status is non-zero if any of them differ, so that changes to the
+// emulation (e.g. optimizations in the filter) can be verified to not affect
+// the output
+
+#include "plus4emu.hpp"
+#include "system.hpp"
+#include "sid.hpp"
+
+static const long     defaultCycles = 20000000L;
+
+// checksums of the output with the default number of cycles, for the
+// MOS6581 and then the MOS8580 model, and filter routings 00, 11, 17 and F7
+static const uint32_t expectedChecksums[8] = {
+  0x2767571DU, 0x1B60C03DU, 0xA1933805U, 0x098BE3DDU,
+  0xD4E8D58DU, 0x34EB8A8DU, 0xC22A8B65U, 0xD255F975U
+};
+
+int main(int argc, char **argv)
+{
+  int     retval = 0;
+  try {
+    long    nCycles = defaultCycles;
+    if (argc > 2 && std::strcmp(argv[1], "-n") == 0) {
+      nCycles = std::atol(argv[2]);
+      if (nCycles < 1L)
+        nCycles = 1L;
+    }
+    else if (argc > 1) {
+      throw Plus4Emu::Exception("Usage: sidbench [-n CYCLES]");
+    }
+    static const uint8_t  sidRegs[25] = {
+      0x37, 0x12, 0x00, 0x08, 0x41, 0x09, 0xF0,
+      0x11, 0x25, 0x00, 0x00, 0x21, 0x0A, 0xA8,
+      0x55, 0x06, 0x00, 0x04, 0x15, 0x00, 0xF9,
+      0x00, 0x40, 0x00, 0x1F
+    };
+    static const uint8_t  filterRouting[4] = { 0x00, 0x11, 0x17, 0xF7 };
+    double  totalTime = 0.0;
+    for (int i = 0; i < 8; i++) {
+      int32_t soundOutputAccumulator = 0;
+      Plus4::SID  sid(soundOutputAccumulator);
+      sid.set_chip_model(!(i & 4) ? Plus4::MOS6581 : Plus4::MOS8580);
+      sid.enable_external_filter(false);
+      sid.reset();
+      for (int j = 0; j < 25; j++)
+        sid.write(Plus4::reg8(j), sidRegs[j]);
+      sid.write(0x17, filterRouting[i & 3]);
+      uint32_t  h = 0x811C9DC5U;
+      Plus4Emu::Timer timer;
+      for (long j = 0L; j < nCycles; j += 4L) {
+        // run the SID for one TED sound sample
+        sid.clock_fast(4);
+        h = (h ^ uint32_t(soundOutputAccumulator)) * 0x01000193U;
+        soundOutputAccumulator = 0;
+        if (!(j & 0xFFFFL)) {
+          sid.write(0x01, Plus4::reg8((j >> 16) & 0x3F));
+          sid.write(0x16, Plus4::reg8((j >> 14) & 0xFF));
+          sid.write(0x12, ((j >> 17) & 1L) != 0L ? 0x15 : 0x14);
+          sid.write(0x04, ((j >> 18) & 1L) != 0L ? 0x41 : 0x40);
+        }
+      }
+      double  t = timer.getRealTime();
+      totalTime = totalTime + t;
+      std::printf("%s, filter %02X: checksum %08X, %.3f s (%.2f MHz)",
+                  (!(i & 4) ? "6581" : "8580"),
+                  (unsigned int) filterRouting[i & 3], (unsigned int) h, t,
+                  (t > 0.0 ? (double(nCycles) / (t * 1000000.0)) : 0.0));
+      if (nCycles == defaultCycles) {
+        if (h == expectedChecksums[i]) {
+          std::printf(", OK\n");
+        }
+        else {
+          std::printf(", MISMATCH (expected %08X)\n",
+                      (unsigned int) expectedChecksums[i]);
+          retval = 1;
+        }
+      }
+      else {
+        std::printf("\n");
+      }
+    }
+    std::printf("total time: %.3f s\n", totalTime);
+    if (retval != 0)
+      std::fprintf(stderr, "sidbench: output checksum mismatch\n");
+  }
+  catch (std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return -1;
+  }
+  return retval;
+}
+
@@ -0,0 +1,73 @@
+
+// plus4emu -- portable Commodore Plus/4 emulator
+// Copyright (C) 2003-2018 Istvan Varga <istvanv@users.sourceforge.net>
+// https://github.com/istvan-v/plus4emu/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// benchmark for the ZIP file decompressor: all files in the archives
+// specified on the command line are extracted a number of times, and the
+// total uncompressed size and time are printed
+
+#include "plus4emu.hpp"
+#include "fileio.hpp"
+#include "system.hpp"
+
+#include <vector>
+
+int main(int argc, char **argv)
+{
+  try {
+    int     nRepeats = 10;
+    int     firstFile = 1;
+    if (argc > 2 && std::strcmp(argv[1], "-n") == 0) {
+      nRepeats = int(std::atoi(argv[2]));
+      if (nRepeats < 1)
+        nRepeats = 1;
+      firstFile = 3;
+    }
+    if (argc <= firstFile) {
+      throw Plus4Emu::Exception("Usage: zipbench [-n REPEATS] "
+                                "<infile.zip> [infile2.zip ...]");
+    }
+    std::vector< unsigned char >  buf;
+    std::string fileName;
+    double  totalSize = 0.0;
+    size_t  nFiles = 0;
+    Plus4Emu::Timer timer;
+    for (int i = 0; i < nRepeats; i++) {
+      for (int j = firstFile; j < argc; j++) {
+        Plus4Emu::ZIPFile zipFile(argv[j]);
+        while (true) {
+          int     fileType = -1;
+          if (!zipFile.getFile(buf, fileName, fileType))
+            break;
+          totalSize = totalSize + double(long(buf.size()));
+          nFiles++;
+        }
+      }
+    }
+    double  t = timer.getRealTime();
+    std::printf("%lu files, %.2f MB uncompressed in %.3f s (%.2f MB/s)\n",
+                (unsigned long) nFiles, totalSize / 1048576.0, t,
+                (t > 0.0 ? (totalSize / (t * 1048576.0)) : 0.0));
+  }
+  catch (std::exception& e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return -1;
+  }
+  return 0;
+}
+